@@ -774,6 +774,11 @@ public:
     {
         m_IndirectObjs.GetNextAssoc(rPos, (void*&)objnum, (void*&)pObject);
     }
+
+    CFX_Mutex*				GetLock()
+    {
+        return &m_Lock;
+    }
 protected:
 
     CFX_MapPtrToPtr			m_IndirectObjs;
@@ -781,5 +786,7 @@ protected:
     IPDF_DocParser*			m_pParser;
 
     FX_DWORD				m_LastObjNum;
+
+    CFX_Mutex				m_Lock;
 };
 #endif
@@ -16,6 +16,7 @@
 #include "../fxge/fx_dib.h"
 #endif
 class CPDF_PageObjects;
+class CPDF_PageObjectGrid;
 class CPDF_Page;
 class CPDF_Form;
 class CPDF_ParseOptions;
@@ -32,6 +33,7 @@ class CPDF_ResourceNaming;
 #define PDF_CONTENT_NOT_PARSED	0
 #define PDF_CONTENT_PARSING		1
 #define PDF_CONTENT_PARSED		2
+#define PDF_OBJECTGRID_THRESHOLD	512
 class CPDF_PageObjects : public CFX_Object
 {
 public:
@@ -109,6 +111,17 @@ public:
 
     CFX_FloatRect		CalcBoundingBox() const;
 
+    void				GetObjectsInRect(const CFX_FloatRect& rect, CFX_ArrayTemplate<FX_POSITION>& positions) const;
+
+    void				BuildObjectGrid();
+
+    void				InvalidateObjectGrid();
+
+    FX_DWORD			GetMoveGeneration() const
+    {
+        return (FX_DWORD)m_MoveGeneration;
+    }
+
     CPDF_Dictionary*	m_pFormDict;
 
     CPDF_Stream*		m_pFormStream;
@@ -127,6 +140,7 @@ protected:
     friend class		CPDF_ContentParser;
     friend class		CPDF_StreamContentParser;
     friend class		CPDF_AllStates;
+    friend class		CPDF_PageObject;
 
     CFX_PtrList			m_ObjectList;
 
@@ -139,6 +153,10 @@ protected:
     CPDF_ContentParser*	m_pParser;
 
     FX_BOOL				m_ParseState;
+
+    CPDF_PageObjectGrid*	m_pObjectGrid;
+
+    long volatile		m_MoveGeneration;
 };
 class CPDF_Page : public CPDF_PageObjects, public CFX_PrivateData
 {
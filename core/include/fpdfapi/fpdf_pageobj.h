@@ -32,6 +32,7 @@ class CPDF_ImageObject;
 class CPDF_ShadingObject;
 class CPDF_FormObject;
 class CPDF_InlineImages;
+class CPDF_PageObjects;
 typedef CFX_PathData CPDF_PathData;
 class CPDF_Path : public CFX_CountRef<CFX_PathData>
 {
@@ -464,6 +465,8 @@ public:
 
     virtual void		Transform(const CFX_AffineMatrix& matrix) = 0;
 
+    void				OnMoved();
+
 
 
     void				RemoveClipPath();
@@ -494,6 +497,10 @@ public:
 
     FX_FLOAT			m_Bottom;
 
+    // The page or form that owns this object, or NULL before it is inserted; OnMoved
+    // bumps its move generation.
+    CPDF_PageObjects*	m_pOwner;
+
     CPDF_ContentMark	m_ContentMark;
 protected:
 
@@ -501,7 +508,7 @@ protected:
 
     void				RecalcBBox();
 
-    CPDF_PageObject() {}
+    CPDF_PageObject() : m_pOwner(NULL) {}
 
     virtual ~CPDF_PageObject() {}
 };
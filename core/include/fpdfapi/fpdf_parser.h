@@ -15,6 +15,7 @@
 class CPDF_Document;
 class IPDF_DocParser;
 class CPDF_Parser;
+class CPDF_ObjectStreamIndex;
 class CPDF_SecurityHandler;
 class CPDF_StandardSecurityHandler;
 class CPDF_CryptoHandler;
@@ -332,6 +333,8 @@ protected:
 
     FX_BYTE*			m_pFileBuf;
 
+    FX_LPCBYTE			m_pMappedData;
+
     FX_DWORD			m_BufSize;
 
     FX_FILESIZE			m_BufOffset;
@@ -485,6 +488,8 @@ public:
 
     void				GetIndirectBinary(FX_DWORD objnum, FX_BYTE*& pBuffer, FX_DWORD& size);
 
+    int					LoadObjectStream(FX_DWORD stream_objnum);
+
     FX_BOOL				GetFileStreamOption()
     {
         return m_Syntax.m_bFileStream;
@@ -557,6 +562,12 @@ protected:
 
     CPDF_StreamAcc*		GetObjectStream(FX_DWORD number);
 
+    CFX_MapPtrToPtr		m_ObjectStreamIndexMap;
+
+    CPDF_ObjectStreamIndex*	GetObjectStreamIndex(FX_DWORD number);
+
+    void				ReleaseObjectStreams();
+
     FX_BOOL				IsLinearizedFile(IFX_FileRead* pFileAccess, FX_DWORD offset);
 
 
@@ -199,6 +199,10 @@ protected:
 
     FX_POSITION			m_PrevLastPos;
 
+    CFX_ArrayTemplate<FX_POSITION>	m_VisibleObjects;
+
+    int					m_VisibleIndex;
+
     void				RenderStep();
 };
 class CPDF_TextRenderer : public CFX_Object
@@ -240,7 +244,14 @@ class IPDF_PageImageCache
 {
 public:
 
-    static IPDF_PageImageCache* Create();
+    static IPDF_PageImageCache* Create(FX_BSTR cache_dir);
+
+    // Drops the content digest remembered for a page, must be called after the page is edited.
+    static void			InvalidatePage(CPDF_Page* pPage);
+
+    // A cached image equals a direct render only onto the same backdrop, so caching is limited to
+    // areas filled with a single color, returned in backdrop.
+    static FX_BOOL		GetUniformBackdrop(const CFX_DIBitmap* pBitmap, const FX_RECT& rect, FX_DWORD& backdrop);
 
     virtual ~IPDF_PageImageCache() {}
 
@@ -248,6 +259,13 @@ public:
                                    int pos_x, int pos_y, int size_x, int size_y, int rotate) = 0;
 
     virtual void		SetCacheLimit(FX_DWORD limit) = 0;
+
+    virtual FX_BOOL		GetPageKey(CPDF_Page* pPage, int size_x, int size_y, int rotate, FX_DWORD flags,
+                                   FXDIB_Format format, FX_DWORD backdrop, CFX_ByteString& key) = 0;
+
+    virtual CFX_DIBitmap*	LoadPageImage(const CFX_ByteString& key) = 0;
+
+    virtual void		StorePageImage(const CFX_ByteString& key, const CFX_DIBitmap* pBitmap) = 0;
 };
 class CPDF_PageRenderCache : public CFX_Object
 {
@@ -282,7 +300,8 @@ public:
 
     void				GetCachedBitmap(CPDF_Stream* pStream, CFX_DIBSource*& pBitmap, CFX_DIBSource*& pMask, FX_DWORD& MatteColor,
                                         FX_BOOL bStdCS = FALSE, FX_DWORD GroupFamily = 0, FX_BOOL bLoadMask = FALSE,
-                                        CPDF_RenderStatus* pRenderStatus = NULL, FX_INT32 downsampleWidth = 0, FX_INT32 downsampleHeight = 0);
+                                        CPDF_RenderStatus* pRenderStatus = NULL, FX_INT32 downsampleWidth = 0, FX_INT32 downsampleHeight = 0,
+                                        const FX_RECT* pJpxWindow = NULL);
 
     void				ResetBitmap(CPDF_Stream* pStream, const CFX_DIBitmap* pBitmap);
     void				ClearImageCache(CPDF_Stream* pStream);
@@ -294,7 +313,7 @@ public:
 public:
     FX_BOOL				StartGetCachedBitmap(CPDF_Stream* pStream, FX_BOOL bStdCS = FALSE, FX_DWORD GroupFamily = 0,
             FX_BOOL bLoadMask = FALSE, CPDF_RenderStatus* pRenderStatus = NULL,
-            FX_INT32 downsampleWidth = 0, FX_INT32 downsampleHeight = 0);
+            FX_INT32 downsampleWidth = 0, FX_INT32 downsampleHeight = 0, const FX_RECT* pJpxWindow = NULL);
 
     FX_BOOL				Continue(IFX_Pause* pPause);
     CPDF_ImageCache*	m_pCurImageCache;
@@ -554,6 +554,8 @@ protected:
 
     CFX_DWordArray			m_WidthList;
 
+    FX_WORD**				m_pWidthPages;
+
     short					m_DefaultVY;
 
     short					m_DefaultW1;
@@ -563,6 +565,10 @@ protected:
 
     void					LoadMetricsArray(CPDF_Array* pArray, CFX_DWordArray& result, int nElements);
 
+    void					BuildWidthTable();
+
+    FX_DWORD				GetCIDWidth(FX_WORD CID) const;
+
     void					LoadSubstFont();
 
     FX_BOOL					m_bAdobeCourierStd;
@@ -78,6 +78,10 @@ public:
     static IPDF_TextPage*	CreateTextPage(const CPDF_PageObjects* pObjs, int flags = 0);
     static IPDF_TextPage*	CreateReflowTextPage(IPDF_ReflowedPage* pRefPage);
 
+    // Loads the page for text extraction only. ParseTextPage() parses its content in text only mode:
+    // path, image and shading operators are skipped and only the text, font and matrix state is kept.
+    static IPDF_TextPage*	CreateTextOnlyPage(CPDF_Document* pDoc, CPDF_Dictionary* pPageDict, int flags = 0);
+
     virtual void			NormalizeObjects(FX_BOOL bNormalize) = 0;
 
     virtual FX_BOOL			ParseTextPage() = 0;
@@ -151,6 +155,36 @@ public:
 
     virtual int					GetMatchedCount() const = 0;
 };
+typedef struct {
+    int					m_PageIndex;
+    int					m_CharIndex;
+    int					m_CharCount;
+} FPDF_TEXTINDEX_HIT;
+typedef CFX_ArrayTemplate<FPDF_TEXTINDEX_HIT> CFX_TextIndexHitArray;
+class IPDF_TextIndex : public CFX_Object
+{
+public:
+
+    virtual	~IPDF_TextIndex() {}
+
+    static	IPDF_TextIndex*		CreateTextIndex();
+
+    virtual void				SetDocumentKey(FX_BSTR key) = 0;
+
+    virtual CFX_ByteString		GetDocumentKey() const = 0;
+
+    virtual FX_BOOL				AddPage(int page_index, const IPDF_TextPage* pTextPage) = 0;
+
+    virtual void				FinishIndex() = 0;
+
+    virtual int					FindAll(const CFX_WideString& findwhat, int flags, CFX_TextIndexHitArray& hits) const = 0;
+
+    virtual void				GetHitRects(const FPDF_TEXTINDEX_HIT& hit, CFX_RectArray& rects) const = 0;
+
+    virtual void				Save(CFX_ArchiveSaver& saver) const = 0;
+
+    virtual FX_BOOL				Load(FX_LPCBYTE pData, FX_DWORD size) = 0;
+};
 class IPDF_LinkExtract : public CFX_Object
 {
 public:
@@ -37,6 +37,9 @@ public:
 
     void				InitIccDecoder();
 
+    // Threads used by the JPEG2000 decoder; 0 means one per processor.
+    void				SetJpxDecodeThreadCount(int nThreads);
+
     ICodec_Jbig2Encoder*		CreateJbig2Encoder();
 protected:
     CCodec_ModuleMgr();
@@ -189,6 +192,11 @@ public:
 
     virtual FX_LPVOID 	CreateDecoder(FX_LPCBYTE src_buf, FX_DWORD src_size, FX_BOOL useColorSpace = FALSE) = 0;
 
+    // Decode at 1/2^reduce_level of full resolution, optionally restricted to pClip (in full resolution
+    // pixels). Must be called before GetImageInfo; reduce_level is clamped to the levels in the codestream,
+    // and pClip is set to the decoded area in pixels of the reduced image.
+    virtual FX_BOOL		SetDecodeParams(FX_LPVOID ctx, int& reduce_level, FX_RECT* pClip = NULL) = 0;
+
     virtual void		GetImageInfo(FX_LPVOID ctx, FX_DWORD& width, FX_DWORD& height,
                                      FX_DWORD& codestream_nComps, FX_DWORD& output_nComps) = 0;
 
@@ -196,6 +204,10 @@ public:
                                FX_BOOL bTranslateColor, FX_LPBYTE offsets) = 0;
 
     virtual void		DestroyDecoder(FX_LPVOID ctx) = 0;
+
+    // Number of threads used for code-block decoding and the inverse wavelet transform of
+    // decoders created afterwards. 1 (the default) decodes on the calling thread only.
+    virtual void		SetThreadCount(int nThreads) = 0;
 };
 class ICodec_Jbig2Module : public CFX_Object
 {
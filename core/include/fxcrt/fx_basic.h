@@ -18,6 +18,9 @@
 #ifndef _FX_STREAM_H_
 #include "fx_stream.h"
 #endif
+#ifndef _FX_THREAD_H_
+#include "fx_thread.h"
+#endif
 class CFX_BinaryBuf : public CFX_Object
 {
 public:
@@ -1083,7 +1086,23 @@ public:
     void			AddValue(FX_BSTR key, void* pValue);
 private:
 
+    void*			LookupIndex(FX_BSTR key) const;
+
+    void			BuildHashIndex();
+
+    void			HashIndexInsert(FX_BSTR key, int index);
+
+    void			HashIndexRemove(FX_BSTR key);
+
+    void			FreeHashIndex();
+
     CFX_BaseSegmentedArray			m_Buffer;
+
+    FX_DWORD*		m_pHashIndex;
+
+    int				m_nHashSize;
+
+    int				m_nHashUsed;
 };
 class CFX_PtrList : public CFX_Object
 {
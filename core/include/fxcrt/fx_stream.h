@@ -15,6 +15,7 @@ FX_BOOL FX_GetNextFile(void* handle, CFX_ByteString& filename, FX_BOOL& bFolder)
 FX_BOOL FX_GetNextFile(void* handle, CFX_WideString& filename, FX_BOOL& bFolder);
 void FX_CloseFolder(void* handle);
 FX_WCHAR FX_GetFolderSeparator();
+FX_BOOL FX_GetFileStamp(FX_LPCSTR path, FX_DWORD& dwSize, FX_DWORD& dwModified);
 FX_DEFINEHANDLE(FX_HFILE)
 #if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
 #define FX_FILESIZE			FX_INT32
@@ -41,6 +42,8 @@ FX_DEFINEHANDLE(FX_HFILE)
 #define FX_FILEMODE_Write		0
 #define FX_FILEMODE_ReadOnly	1
 #define FX_FILEMODE_Truncate	2
+#define FX_FILEMODE_MemoryMapped	4
+#define FX_FILEMODE_Exclusive	8
 FX_HFILE	FX_File_Open(FX_BSTR fileName, FX_DWORD dwMode, IFX_Allocator* pAllocator = NULL);
 FX_HFILE	FX_File_Open(FX_WSTR fileName, FX_DWORD dwMode, IFX_Allocator* pAllocator = NULL);
 void		FX_File_Close(FX_HFILE hFile, IFX_Allocator* pAllocator = NULL);
@@ -130,6 +133,11 @@ public:
     {
         return 0;
     }
+
+    virtual FX_LPCBYTE		GetMappedData()
+    {
+        return NULL;
+    }
 };
 IFX_FileRead* FX_CreateFileRead(FX_LPCSTR filename, IFX_Allocator* pAllocator = NULL);
 IFX_FileRead* FX_CreateFileRead(FX_LPCWSTR filename, IFX_Allocator* pAllocator = NULL);
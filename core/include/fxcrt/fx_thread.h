@@ -0,0 +1,158 @@
+// Copyright 2014 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+ 
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#ifndef _FX_THREAD_H_
+#define _FX_THREAD_H_
+#ifndef _FX_SYSTEM_H_
+#include "fx_system.h"
+#endif
+#if _FXM_PLATFORM_ != _FXM_PLATFORM_WINDOWS_
+#include <pthread.h>
+#endif
+// Thread-safe mode.
+//
+// By default the library assumes a single thread and all synchronization below is a no-op.
+// After FX_SetThreadSafeMode(TRUE) (which must be called before any other library call,
+// and never switched back while the library is in use), the following is supported:
+// different CPDF_Page objects of the same CPDF_Document may be loaded, parsed and rendered
+// on different threads at the same time. Shared state is protected by:
+//   - the document lock (CPDF_IndirectObjects::GetLock): lazy object loading, the parser,
+//     the page list and the per-document page/render data caches;
+//   - the font lock (CFX_GEModule::GetFontLock): FreeType faces, the font manager, the
+//     glyph caches and the lazily loaded char metrics of PDF fonts (ToUnicode maps are
+//     loaded together with the font instead, since that needs the document lock);
+//   - module-level locks for the stock font table, predefined CMaps and ICC transforms;
+//   - the default memory manager and the reference counts of CFX_ByteString/CFX_WideString.
+// A single CPDF_Page, render context or device must still be used by one thread at a time,
+// and editing a document while other threads use it is not supported.
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern FX_BOOL	g_bFXThreadSafeMode;
+void			FX_SetThreadSafeMode(FX_BOOL bEnable);
+#ifdef __cplusplus
+}
+#endif
+inline FX_BOOL	FX_IsThreadSafeMode()
+{
+    return g_bFXThreadSafeMode;
+}
+inline long		FX_AtomicIncrement(long volatile* pValue)
+{
+    if (!g_bFXThreadSafeMode) {
+        return ++ *pValue;
+    }
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+    return InterlockedIncrement(pValue);
+#else
+    return __sync_add_and_fetch(pValue, 1);
+#endif
+}
+inline long		FX_AtomicDecrement(long volatile* pValue)
+{
+    if (!g_bFXThreadSafeMode) {
+        return -- *pValue;
+    }
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+    return InterlockedDecrement(pValue);
+#else
+    return __sync_sub_and_fetch(pValue, 1);
+#endif
+}
+// Pointer publication for lazily built shared data: FX_AtomicStorePointer makes every write
+// done before it visible to a thread that then reads the pointer with FX_AtomicLoadPointer.
+inline FX_LPVOID	FX_AtomicLoadPointer(FX_LPVOID volatile* ppValue)
+{
+    FX_LPVOID pValue = *ppValue;
+    if (g_bFXThreadSafeMode) {
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+        MemoryBarrier();
+#else
+        __sync_synchronize();
+#endif
+    }
+    return pValue;
+}
+inline void		FX_AtomicStorePointer(FX_LPVOID volatile* ppValue, FX_LPVOID pValue)
+{
+    if (g_bFXThreadSafeMode) {
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+        MemoryBarrier();
+#else
+        __sync_synchronize();
+#endif
+    }
+    *ppValue = pValue;
+}
+// Worker threads. FX_Thread_Create returns NULL on failure; every created thread must be
+// joined with FX_Thread_Join, which also releases the handle.
+typedef void			(*FX_THREAD_PROC)(FX_LPVOID pParam);
+FX_LPVOID		FX_Thread_Create(FX_THREAD_PROC pProc, FX_LPVOID pParam);
+void			FX_Thread_Join(FX_LPVOID hThread);
+int				FX_Thread_GetProcessorCount();
+// Runs pProc(pParam, index) for every index below nJobs on up to nThreads threads, the
+// calling thread included, and returns once all jobs are done. The helper threads belong to
+// a process-wide pool: they are started on first use and then kept waiting for more work.
+// A call made while the pool is busy (from another thread, or from inside a job) runs its
+// jobs on the calling thread.
+typedef void			(*FX_PARALLEL_PROC)(FX_LPVOID pParam, int index);
+void			FX_Parallel_Run(FX_PARALLEL_PROC pProc, FX_LPVOID pParam, int nJobs, int nThreads);
+// Recursive mutex. Lock() and Unlock() do nothing unless thread-safe mode is on.
+class CFX_Mutex
+{
+public:
+
+    CFX_Mutex();
+
+    ~CFX_Mutex();
+
+    void					Lock()
+    {
+        if (g_bFXThreadSafeMode) {
+            LockHandle();
+        }
+    }
+
+    void					Unlock()
+    {
+        if (g_bFXThreadSafeMode) {
+            UnlockHandle();
+        }
+    }
+protected:
+
+    void					LockHandle();
+
+    void					UnlockHandle();
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+    CRITICAL_SECTION		m_Handle;
+#else
+    pthread_mutex_t			m_Handle;
+#endif
+private:
+
+    CFX_Mutex(const CFX_Mutex&);
+
+    CFX_Mutex&				operator = (const CFX_Mutex&);
+};
+class CFX_CSLock
+{
+public:
+
+    CFX_CSLock(CFX_Mutex* pMutex) : m_pMutex(pMutex)
+    {
+        m_pMutex->Lock();
+    }
+
+    ~CFX_CSLock()
+    {
+        m_pMutex->Unlock();
+    }
+private:
+
+    CFX_Mutex*				m_pMutex;
+};
+#endif
@@ -66,6 +66,7 @@ typedef FX_DWORD	FX_ARGB;
 typedef FX_DWORD	FX_COLORREF;
 typedef FX_DWORD	FX_CMYK;
 class CFX_ClipRgn;
+class CFX_ClipSpans;
 class CFX_DIBSource;
 class CFX_DIBitmap;
 #define FXSYS_RGB(r, g, b)  ((r) | ((g) << 8) | ((b) << 16))
@@ -479,6 +480,7 @@ protected:
     int					m_DestLeft, m_DestTop, m_DestWidth, m_DestHeight, m_BitmapAlpha;
     FX_DWORD			m_MaskColor;
     const CFX_DIBitmap*	m_pClipMask;
+    const CFX_ClipSpans*	m_pClipSpans;
     CFX_ScanlineCompositor	m_Compositor;
     FX_BOOL				m_bVertical, m_bFlipX, m_bFlipY;
     int					m_AlphaFlag;
@@ -18,6 +18,7 @@ class IFX_FontEncoding;
 class CFX_PathData;
 class CFX_SubstFont;
 class CFX_FaceCache;
+class CFX_SizeGlyphCache;
 class IFX_FontMapper;
 class CFX_FontMapper;
 class IFX_SystemFontInfo;
@@ -312,6 +313,7 @@ public:
         return NULL;
     }
 };
+class CFontFaceInfo;
 class CFX_FolderFontInfo : public IFX_SystemFontInfo
 {
 public:
@@ -330,9 +332,18 @@ protected:
     CFX_MapByteStringToPtr	m_FontList;
     CFX_ByteStringArray	m_PathList;
     CFX_FontMapper*		m_pMapper;
+    CFX_MapByteStringToPtr	m_IndexMap;
+    CFX_ArchiveSaver*	m_pIndexSaver;
+    int					m_nIndexEntries;
+    FX_BOOL				m_bIndexChanged;
     void				ScanPath(CFX_ByteString& path);
     void				ScanFile(CFX_ByteString& path);
-    void				ReportFace(CFX_ByteString& path, FXSYS_FILE* pFile, FX_DWORD filesize, FX_DWORD offset);
+    CFontFaceInfo*		LoadFace(CFX_ByteString& path, FXSYS_FILE* pFile, FX_DWORD filesize, FX_DWORD offset);
+    void				ReportFace(CFontFaceInfo* pInfo);
+    void				LoadIndex(FX_BSTR filename);
+    void				SaveIndex(FX_BSTR filename);
+    FX_BOOL				ReportIndexedFile(CFX_ByteString& path, FX_DWORD filesize, FX_DWORD modtime);
+    void				WriteIndexEntry(FX_BSTR path, FX_DWORD filesize, FX_DWORD modtime, FX_BSTR faces);
 };
 class CFX_CountedFaceCache : public CFX_Object
 {
@@ -376,6 +387,14 @@ public:
     int						m_Left;
     CFX_DIBitmap			m_Bitmap;
 };
+typedef struct {
+    int						m_Matrix[4];
+    int						m_DestWidth;
+    int						m_AntiAlias;
+    int						m_Weight;
+    int						m_ItalicAngle;
+    int						m_Flags;
+} FX_GLYPHSIZE_KEY;
 class CFX_FaceCache : public CFX_Object
 {
 public:
@@ -386,15 +405,24 @@ public:
 
 
     CFX_FaceCache(FXFT_Face face);
+
+    FX_BOOL					IsInUse() const
+    {
+        return m_nUsers > 0;
+    }
 private:
+    friend class			CFX_FontCache;
     FXFT_Face				m_Face;
+    FX_DWORD				m_nUsers;
     CFX_GlyphBitmap*		RenderGlyph(CFX_Font* pFont, FX_DWORD glyph_index, FX_BOOL bFontStyle,
                                         const CFX_AffineMatrix* pMatrix, int dest_width, int anti_alias);
     CFX_GlyphBitmap*		RenderGlyph_Nativetext(CFX_Font* pFont, FX_DWORD glyph_index,
             const CFX_AffineMatrix* pMatrix, int dest_width, int anti_alias);
-    CFX_GlyphBitmap*        LookUpGlyphBitmap(CFX_Font* pFont, const CFX_AffineMatrix* pMatrix, CFX_ByteStringC& FaceGlyphsKey,
+    CFX_GlyphBitmap*        LookUpGlyphBitmap(CFX_Font* pFont, const CFX_AffineMatrix* pMatrix, const FX_GLYPHSIZE_KEY& SizeKey,
             FX_DWORD glyph_index, FX_BOOL bFontStyle, int dest_width, int anti_alias);
-    CFX_MapByteStringToPtr	m_SizeMap;
+    CFX_SizeGlyphCache*		GetSizeCache(const FX_GLYPHSIZE_KEY& SizeKey, FX_BOOL bCreate);
+    CFX_MapPtrToPtr			m_SizeMap;
+    CFX_SizeGlyphCache*		m_pLastSizeCache;
     CFX_MapPtrToPtr			m_PathMap;
     CFX_DIBitmap*           m_pBitmap;
     void*                   m_pPlatformGraphics;
@@ -23,6 +23,15 @@ class CFX_RenderDevice;
 class IFX_RenderDeviceDriver;
 class CCodec_ModuleMgr;
 class IFXG_PaintModuleMgr;
+class CFX_GlyphLRUList;
+typedef struct {
+    FX_DWORD				m_nHits;
+    FX_DWORD				m_nMisses;
+    FX_DWORD				m_nEvictions;
+    FX_DWORD				m_nGlyphs;
+    size_t					m_nBytes;
+    size_t					m_nLimit;
+} FX_GLYPHCACHE_STATS;
 class CFX_GEModule : public CFX_Object
 {
 public:
@@ -54,6 +63,42 @@ public:
         return m_pCodecModule;
     }
     FXFT_Library			m_FTLibrary;
+
+    CFX_Mutex*				GetFontLock()
+    {
+        return &m_FontLock;
+    }
+
+    void					SetGlyphCacheLimit(size_t nBytes);
+
+    void					GetGlyphCacheStats(FX_GLYPHCACHE_STATS& stats);
+
+    void					ResetGlyphCacheStats();
+
+    CFX_GlyphLRUList*		GetGlyphLRUList()
+    {
+        return m_pGlyphLRUList;
+    }
+
+    void					SetStretchThreadCount(int nThreads)
+    {
+        m_nStretchThreads = nThreads > 0 ? nThreads : FX_Thread_GetProcessorCount();
+    }
+
+    int						GetStretchThreadCount() const
+    {
+        return m_nStretchThreads;
+    }
+
+    void					SetFontIndexFile(FX_BSTR path)
+    {
+        m_FontIndexFile = path;
+    }
+
+    const CFX_ByteString&	GetFontIndexFile() const
+    {
+        return m_FontIndexFile;
+    }
     void*					GetPlatformData()
     {
         return m_pPlatformData;
@@ -71,6 +116,10 @@ private:
     CFX_FontMgr*			m_pFontMgr;
     CCodec_ModuleMgr*		m_pCodecModule;
     void*					m_pPlatformData;
+    CFX_Mutex				m_FontLock;
+    CFX_GlyphLRUList*		m_pGlyphLRUList;
+    int						m_nStretchThreads;
+    CFX_ByteString			m_FontIndexFile;
 };
 typedef struct {
 
@@ -87,6 +136,35 @@ typedef struct {
 #define FXPT_TYPE				0x06
 #define FXFILL_ALTERNATE		1
 #define FXFILL_WINDING			2
+class CFX_ClipSpans : public CFX_Object
+{
+public:
+
+    CFX_ClipSpans();
+
+    ~CFX_ClipSpans();
+
+    FX_BOOL			Create(int top, int height);
+
+    void			AddRun(int row, int left, int right);
+
+    void			Finish();
+
+    int				GetRowRuns(int row, const int*& pRuns) const;
+
+    int				m_Top;
+
+    int				m_Height;
+
+    int*			m_pRowStart;
+
+    int*			m_pRuns;
+
+    int				m_nRuns;
+
+    int				m_nAlloc;
+};
+typedef CFX_CountRef<CFX_ClipSpans> CFX_ClipSpansRef;
 class CFX_ClipRgn : public CFX_Object
 {
 public:
@@ -101,7 +179,8 @@ public:
 
     typedef enum {
         RectI,
-        MaskF
+        MaskF,
+        SpansI
     } ClipType;
 
     void			Reset(const FX_RECT& rect);
@@ -121,9 +200,18 @@ public:
         return m_Mask;
     }
 
+    const CFX_ClipSpans*	GetSpans() const
+    {
+        return m_Spans;
+    }
+
     void			IntersectRect(const FX_RECT& rect);
 
     void			IntersectMaskF(int left, int top, CFX_DIBitmapRef Mask);
+
+    void			IntersectSpans(const FX_RECT& span_box, CFX_ClipSpansRef Spans);
+
+    FX_BOOL			ConvertToMaskF();
 protected:
 
     ClipType		m_Type;
@@ -132,6 +220,8 @@ protected:
 
     CFX_DIBitmapRef	m_Mask;
 
+    CFX_ClipSpansRef	m_Spans;
+
     void			IntersectMaskRect(FX_RECT rect, FX_RECT mask_box, CFX_DIBitmapRef Mask);
 };
 extern const FX_BYTE g_GammaRamp[256];
@@ -6,6 +6,17 @@
 
 #include "../../../include/fxcrt/fx_basic.h"
 #include "../../../include/fdrm/fx_crypt.h"
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define _FX_CRYPT_AESNI_
+#include <wmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define FX_AESNI_FUNC
+#else
+#include <cpuid.h>
+#define FX_AESNI_FUNC __attribute__((target("aes,sse2")))
+#endif
+#endif
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -30,6 +41,11 @@ struct AESContext {
     void (*decrypt) (AESContext * ctx, unsigned int * block);
     unsigned int iv[MAX_NB];
     int Nb, Nr;
+#ifdef _FX_CRYPT_AESNI_
+    int bAESNI;
+    unsigned char aesni_enc[(MAX_NR + 1) * 16];
+    unsigned char aesni_dec[(MAX_NR + 1) * 16];
+#endif
 };
 static const unsigned char Sbox[256] = {
     0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5,
@@ -874,6 +890,131 @@ static void aes_decrypt_nb_8(AESContext * ctx, unsigned int * block)
 }
 #undef MAKEWORD
 #undef LASTWORD
+#ifdef _FX_CRYPT_AESNI_
+static int aes_has_aesni()
+{
+    static int s_HasAESNI = -1;
+    if (s_HasAESNI < 0) {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        s_HasAESNI = (info[2] & (1 << 25)) ? 1 : 0;
+#else
+        unsigned int eax, ebx, ecx, edx;
+        s_HasAESNI = (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & (1 << 25))) ? 1 : 0;
+#endif
+    }
+    return s_HasAESNI;
+}
+// Copies the round keys computed by aes_setup into the byte order used by the AES-NI instructions.
+// The decryption keys are those of the equivalent inverse cipher: the encryption keys in reverse
+// order, the middle ones passed through InvMixColumns.
+FX_AESNI_FUNC static void aes_setup_aesni(AESContext * ctx)
+{
+    int i;
+    for (i = 0; i < (ctx->Nr + 1) * 4; i++) {
+        PUT_32BIT_MSB_FIRST(ctx->aesni_enc + 4 * i, ctx->keysched[i]);
+    }
+    const __m128i* enc = (const __m128i*)ctx->aesni_enc;
+    __m128i* dec = (__m128i*)ctx->aesni_dec;
+    _mm_storeu_si128(dec, _mm_loadu_si128(enc + ctx->Nr));
+    for (i = 1; i < ctx->Nr; i++) {
+        _mm_storeu_si128(dec + i, _mm_aesimc_si128(_mm_loadu_si128(enc + ctx->Nr - i)));
+    }
+    _mm_storeu_si128(dec + ctx->Nr, _mm_loadu_si128(enc));
+}
+FX_AESNI_FUNC static __m128i aes_load_iv_aesni(AESContext * ctx)
+{
+    unsigned char iv[16];
+    for (int i = 0; i < 4; i++) {
+        PUT_32BIT_MSB_FIRST(iv + 4 * i, ctx->iv[i]);
+    }
+    return _mm_loadu_si128((const __m128i*)iv);
+}
+FX_AESNI_FUNC static void aes_save_iv_aesni(AESContext * ctx, __m128i value)
+{
+    unsigned char iv[16];
+    _mm_storeu_si128((__m128i*)iv, value);
+    for (int i = 0; i < 4; i++) {
+        ctx->iv[i] = GET_32BIT_MSB_FIRST(iv + 4 * i);
+    }
+}
+// CBC decryption has no dependency between blocks, so four blocks are kept in flight to hide the
+// latency of the round instructions.
+FX_AESNI_FUNC static void aes_decrypt_cbc_aesni(unsigned char *dest, const unsigned char *src, int len, AESContext * ctx)
+{
+    __m128i keys[MAX_NR + 1];
+    int i, Nr = ctx->Nr;
+    for (i = 0; i <= Nr; i++) {
+        keys[i] = _mm_loadu_si128((const __m128i*)ctx->aesni_dec + i);
+    }
+    __m128i iv = aes_load_iv_aesni(ctx);
+    while (len >= 64) {
+        __m128i c0 = _mm_loadu_si128((const __m128i*)src);
+        __m128i c1 = _mm_loadu_si128((const __m128i*)src + 1);
+        __m128i c2 = _mm_loadu_si128((const __m128i*)src + 2);
+        __m128i c3 = _mm_loadu_si128((const __m128i*)src + 3);
+        __m128i b0 = _mm_xor_si128(c0, keys[0]);
+        __m128i b1 = _mm_xor_si128(c1, keys[0]);
+        __m128i b2 = _mm_xor_si128(c2, keys[0]);
+        __m128i b3 = _mm_xor_si128(c3, keys[0]);
+        for (i = 1; i < Nr; i++) {
+            b0 = _mm_aesdec_si128(b0, keys[i]);
+            b1 = _mm_aesdec_si128(b1, keys[i]);
+            b2 = _mm_aesdec_si128(b2, keys[i]);
+            b3 = _mm_aesdec_si128(b3, keys[i]);
+        }
+        b0 = _mm_aesdeclast_si128(b0, keys[Nr]);
+        b1 = _mm_aesdeclast_si128(b1, keys[Nr]);
+        b2 = _mm_aesdeclast_si128(b2, keys[Nr]);
+        b3 = _mm_aesdeclast_si128(b3, keys[Nr]);
+        _mm_storeu_si128((__m128i*)dest, _mm_xor_si128(b0, iv));
+        _mm_storeu_si128((__m128i*)dest + 1, _mm_xor_si128(b1, c0));
+        _mm_storeu_si128((__m128i*)dest + 2, _mm_xor_si128(b2, c1));
+        _mm_storeu_si128((__m128i*)dest + 3, _mm_xor_si128(b3, c2));
+        iv = c3;
+        dest += 64;
+        src += 64;
+        len -= 64;
+    }
+    while (len > 0) {
+        __m128i c = _mm_loadu_si128((const __m128i*)src);
+        __m128i b = _mm_xor_si128(c, keys[0]);
+        for (i = 1; i < Nr; i++) {
+            b = _mm_aesdec_si128(b, keys[i]);
+        }
+        b = _mm_aesdeclast_si128(b, keys[Nr]);
+        _mm_storeu_si128((__m128i*)dest, _mm_xor_si128(b, iv));
+        iv = c;
+        dest += 16;
+        src += 16;
+        len -= 16;
+    }
+    aes_save_iv_aesni(ctx, iv);
+}
+FX_AESNI_FUNC static void aes_encrypt_cbc_aesni(unsigned char *dest, const unsigned char *src, int len, AESContext * ctx)
+{
+    __m128i keys[MAX_NR + 1];
+    int i, Nr = ctx->Nr;
+    for (i = 0; i <= Nr; i++) {
+        keys[i] = _mm_loadu_si128((const __m128i*)ctx->aesni_enc + i);
+    }
+    __m128i iv = aes_load_iv_aesni(ctx);
+    while (len > 0) {
+        __m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i*)src), iv);
+        b = _mm_xor_si128(b, keys[0]);
+        for (i = 1; i < Nr; i++) {
+            b = _mm_aesenc_si128(b, keys[i]);
+        }
+        iv = _mm_aesenclast_si128(b, keys[Nr]);
+        _mm_storeu_si128((__m128i*)dest, iv);
+        dest += 16;
+        src += 16;
+        len -= 16;
+    }
+    aes_save_iv_aesni(ctx, iv);
+}
+#endif
 static void aes_setup(AESContext * ctx, int blocklen,
                       const unsigned char *key, int keylen)
 {
@@ -939,6 +1080,12 @@ static void aes_setup(AESContext * ctx, int blocklen,
             ctx->invkeysched[i * ctx->Nb + j] = temp;
         }
     }
+#ifdef _FX_CRYPT_AESNI_
+    ctx->bAESNI = ctx->Nb == 4 && aes_has_aesni();
+    if (ctx->bAESNI) {
+        aes_setup_aesni(ctx);
+    }
+#endif
 }
 static void aes_decrypt(AESContext * ctx, unsigned int * block)
 {
@@ -949,6 +1096,12 @@ static void aes_decrypt_cbc(unsigned char *dest, const unsigned char *src, int l
     unsigned int iv[4], x[4], ct[4];
     int i;
     ASSERT((len & 15) == 0);
+#ifdef _FX_CRYPT_AESNI_
+    if (ctx->bAESNI) {
+        aes_decrypt_cbc_aesni(dest, src, len, ctx);
+        return;
+    }
+#endif
     FXSYS_memcpy32(iv, ctx->iv, sizeof(iv));
     while (len > 0) {
         for (i = 0; i < 4; i++) {
@@ -974,6 +1127,12 @@ static void aes_encrypt_cbc(unsigned char *dest, const unsigned char *src, int l
     unsigned int iv[4];
     int i;
     ASSERT((len & 15) == 0);
+#ifdef _FX_CRYPT_AESNI_
+    if (ctx->bAESNI) {
+        aes_encrypt_cbc_aesni(dest, src, len, ctx);
+        return;
+    }
+#endif
     FXSYS_memcpy32(iv, ctx->iv, sizeof(iv));
     while (len > 0) {
         for (i = 0; i < 4; i++) {
@@ -6,6 +6,17 @@
 
 #include "../../../include/fxcrt/fx_basic.h"
 #include "../../../include/fdrm/fx_crypt.h"
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define _FX_CRYPT_SHANI_
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define FX_SHANI_FUNC
+#else
+#include <cpuid.h>
+#define FX_SHANI_FUNC __attribute__((target("sha,sse4.1")))
+#endif
+#endif
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -195,8 +206,96 @@ void CRYPT_SHA256Start( FX_LPVOID context )
     ctx->state[6] = 0x1F83D9AB;
     ctx->state[7] = 0x5BE0CD19;
 }
+#ifdef _FX_CRYPT_SHANI_
+static int sha256_has_shani()
+{
+    static int s_HasSHANI = -1;
+    if (s_HasSHANI < 0) {
+#if defined(_MSC_VER)
+        int info[4], info7[4];
+        __cpuid(info, 0);
+        int max_leaf = info[0];
+        __cpuid(info, 1);
+        info7[1] = 0;
+        if (max_leaf >= 7) {
+            __cpuidex(info7, 7, 0);
+        }
+        s_HasSHANI = ((info[2] & (1 << 19)) && (info7[1] & (1 << 29))) ? 1 : 0;
+#else
+        unsigned int eax, ebx, ecx, edx, ebx7 = 0;
+        if (__get_cpuid_max(0, NULL) >= 7) {
+            __cpuid_count(7, 0, eax, ebx7, ecx, edx);
+        }
+        s_HasSHANI = (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & (1 << 19)) && (ebx7 & (1 << 29))) ? 1 : 0;
+#endif
+    }
+    return s_HasSHANI;
+}
+static const FX_DWORD sha256_k[64] = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+// Four rounds on the message words in m0, then the message words sixteen rounds ahead are
+// computed into m0 from the current window m0..m3.
+#define SHANI_ROUNDS(i, m0)                                                                 \
+    wk = _mm_add_epi32(m0, _mm_loadu_si128((const __m128i*)(sha256_k + 4 * (i))));          \
+    state1 = _mm_sha256rnds2_epu32(state1, state0, wk);                                     \
+    state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(wk, 0x0E));
+#define SHANI_SCHEDULE(m0, m1, m2, m3)                                                      \
+    m0 = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(m0, m1),                  \
+                                            _mm_alignr_epi8(m3, m2, 4)), m3);
+FX_SHANI_FUNC static void sha256_process_shani(FX_DWORD state[8], const FX_BYTE data[64])
+{
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i abcd = _mm_loadu_si128((const __m128i*)state);
+    __m128i efgh = _mm_loadu_si128((const __m128i*)(state + 4));
+    __m128i cdab = _mm_shuffle_epi32(abcd, 0xB1);
+    efgh = _mm_shuffle_epi32(efgh, 0x1B);
+    __m128i state0 = _mm_alignr_epi8(cdab, efgh, 8);
+    __m128i state1 = _mm_blend_epi16(efgh, cdab, 0xF0);
+    __m128i save0 = state0, save1 = state1, wk;
+    __m128i m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)data), mask);
+    __m128i m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16)), mask);
+    __m128i m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 32)), mask);
+    __m128i m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 48)), mask);
+    for (int i = 0; i < 12; i += 4) {
+        SHANI_ROUNDS(i, m0);
+        SHANI_SCHEDULE(m0, m1, m2, m3);
+        SHANI_ROUNDS(i + 1, m1);
+        SHANI_SCHEDULE(m1, m2, m3, m0);
+        SHANI_ROUNDS(i + 2, m2);
+        SHANI_SCHEDULE(m2, m3, m0, m1);
+        SHANI_ROUNDS(i + 3, m3);
+        SHANI_SCHEDULE(m3, m0, m1, m2);
+    }
+    SHANI_ROUNDS(12, m0);
+    SHANI_ROUNDS(13, m1);
+    SHANI_ROUNDS(14, m2);
+    SHANI_ROUNDS(15, m3);
+    state0 = _mm_add_epi32(state0, save0);
+    state1 = _mm_add_epi32(state1, save1);
+    __m128i feba = _mm_shuffle_epi32(state0, 0x1B);
+    __m128i dchg = _mm_shuffle_epi32(state1, 0xB1);
+    _mm_storeu_si128((__m128i*)state, _mm_blend_epi16(feba, dchg, 0xF0));
+    _mm_storeu_si128((__m128i*)(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+#undef SHANI_ROUNDS
+#undef SHANI_SCHEDULE
+#endif
 static void sha256_process( sha256_context *ctx, const FX_BYTE data[64] )
 {
+#ifdef _FX_CRYPT_SHANI_
+    if (sha256_has_shani()) {
+        sha256_process_shani(ctx->state, data);
+        return;
+    }
+#endif
     FX_DWORD temp1, temp2, W[64];
     FX_DWORD A, B, C, D, E, F, G, H;
     GET_FX_DWORD( W[0],  data,  0 );
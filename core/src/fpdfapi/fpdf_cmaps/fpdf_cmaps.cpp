@@ -121,6 +121,33 @@ FX_WORD FPDFAPI_CIDFromCharCode(const FXCMAP_CMap* pMap, FX_DWORD charcode)
     }
     return 0;
 }
+// Fills pCIDs (65536 entries, zero initialized) with the CIDs FPDFAPI_CIDFromCharCode returns
+// for every two-byte code. Maps earlier in the m_UseOffset chain take precedence, so the chain
+// is applied from its end.
+void FPDFAPI_LoadWordCIDMap(const FXCMAP_CMap* pMap, FX_WORD* pCIDs)
+{
+    if (pMap->m_pWordMap == NULL) {
+        return;
+    }
+    if (pMap->m_UseOffset) {
+        FPDFAPI_LoadWordCIDMap(pMap + pMap->m_UseOffset, pCIDs);
+    }
+    if (pMap->m_WordMapType == FXCMAP_CMap::Single) {
+        const FX_WORD* pCur = pMap->m_pWordMap;
+        for (int i = 0; i < pMap->m_WordCount; i ++) {
+            pCIDs[pCur[0]] = pCur[1];
+            pCur += 2;
+        }
+    } else if (pMap->m_WordMapType == FXCMAP_CMap::Range) {
+        const FX_WORD* pCur = pMap->m_pWordMap;
+        for (int i = 0; i < pMap->m_WordCount; i ++) {
+            for (FX_DWORD code = pCur[0]; code <= pCur[1]; code ++) {
+                pCIDs[code] = (FX_WORD)(pCur[2] + code - pCur[0]);
+            }
+            pCur += 3;
+        }
+    }
+}
 FX_DWORD FPDFAPI_CharCodeFromCID(const FXCMAP_CMap* pMap, FX_WORD cid)
 {
     while (1) {
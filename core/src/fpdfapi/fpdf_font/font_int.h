@@ -24,6 +24,7 @@ private:
 #endif
     CFX_MapByteStringToPtr	m_CMaps;
     CPDF_CID2UnicodeMap*	m_CID2UnicodeMaps[6];
+    CFX_Mutex				m_Lock;
 };
 class CPDF_FontGlobals : public CFX_Object
 {
@@ -35,6 +36,7 @@ public:
     CPDF_Font*			Find(void* key, int index);
     void				Set(void* key, int index, CPDF_Font* pFont);
     CFX_MapPtrToPtr		m_pStockMap;
+    CFX_Mutex			m_Lock;
     CPDF_CMapManager	m_CMapManager;
     struct {
         const struct FXCMAP_CMap*	m_pMapList;
@@ -118,6 +120,7 @@ protected:
     FX_LPBYTE				m_pAddMapping;
     FX_BOOL					m_bLoaded;
     const FXCMAP_CMap*		m_pEmbedMap;
+    FX_WORD*				m_pEmbedWordMap;
     CPDF_CMap*				m_pUseMap;
 };
 class CPDF_PredefinedCMap
@@ -46,6 +46,7 @@ public:
 };
 CPDF_Font* CPDF_FontGlobals::Find(void* key, int index)
 {
+    CFX_CSLock lock(&m_Lock);
     void* value = NULL;
     if (!m_pStockMap.Lookup(key, value)) {
         return NULL;
@@ -57,6 +58,7 @@ CPDF_Font* CPDF_FontGlobals::Find(void* key, int index)
 }
 void CPDF_FontGlobals::Set(void* key, int index, CPDF_Font* pFont)
 {
+    CFX_CSLock lock(&m_Lock);
     void* value = NULL;
     if (m_pStockMap.Lookup(key, value)) {
         ((CFX_StockFontArray*)value)->m_pStockFonts[index] = pFont;
@@ -70,6 +72,7 @@ void CPDF_FontGlobals::Set(void* key, int index, CPDF_Font* pFont)
 }
 void CPDF_FontGlobals::Clear(void* key)
 {
+    CFX_CSLock lock(&m_Lock);
     void* value = NULL;
     if (!m_pStockMap.Lookup(key, value)) {
         return;
@@ -88,6 +91,7 @@ void CPDF_FontGlobals::Clear(void* key)
 }
 void CPDF_FontGlobals::ClearAll()
 {
+    CFX_CSLock lock(&m_Lock);
     FX_POSITION pos = m_pStockMap.GetStartPosition();
     while (pos) {
         void *key = NULL;
@@ -400,6 +404,7 @@ CPDF_Font* CPDF_Font::GetStockFont(CPDF_Document* pDoc, FX_BSTR name)
         return NULL;
     }
     CPDF_FontGlobals* pFontGlobals = CPDF_ModuleMgr::Get()->GetPageModule()->GetFontGlobals();
+    CFX_CSLock lock(&pFontGlobals->m_Lock);
     CPDF_Font* pFont = pFontGlobals->Find(pDoc, font_id);
     if (pFont) {
         return pFont;
@@ -487,7 +492,15 @@ FX_BOOL CPDF_Font::Load()
     if (type == FX_BSTRC("MMType1")) {
         type = FX_BSTRC("Type1");
     }
-    return _Load();
+    if (!_Load()) {
+        return FALSE;
+    }
+    if (FX_IsThreadSafeMode() && !m_bToUnicodeLoaded) {
+        // Lookups may then come from several threads, and loading the map
+        // touches the document, so it cannot be done lazily under the font lock.
+        LoadUnicodeMap();
+    }
+    return TRUE;
 }
 static CFX_WideString _FontMap_GetWideString(CFX_CharMap* pMap, const CFX_ByteString& bytestr)
 {
@@ -896,6 +909,7 @@ void CPDF_SimpleFont::LoadCharMetrics(int charcode)
 }
 int CPDF_SimpleFont::GetCharWidthF(FX_DWORD charcode, int level)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     if (charcode > 0xff) {
         charcode = 0;
     }
@@ -909,6 +923,7 @@ int CPDF_SimpleFont::GetCharWidthF(FX_DWORD charcode, int level)
 }
 void CPDF_SimpleFont::GetCharBBox(FX_DWORD charcode, FX_RECT& rect, int level)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     if (charcode > 0xff) {
         charcode = 0;
     }
@@ -1679,6 +1694,7 @@ void CPDF_Type3Font::CheckType3FontMetrics()
 }
 CPDF_Type3Char* CPDF_Type3Font::LoadChar(FX_DWORD charcode, int level)
 {
+    CFX_CSLock lock(m_pDocument->GetLock());
     if (level >= _FPDF_MAX_TYPE3_FORM_LEVEL_) {
         return NULL;
     }
@@ -55,6 +55,7 @@ FX_LPVOID CPDF_CMapManager::GetPackage(FX_BOOL bPrompt)
 #endif
 CPDF_CMap* CPDF_CMapManager::GetPredefinedCMap(const CFX_ByteString& name, FX_BOOL bPromptCJK)
 {
+    CFX_CSLock lock(&m_Lock);
     CPDF_CMap* pCMap;
     if (m_CMaps.Lookup(name, (FX_LPVOID&)pCMap)) {
         return pCMap;
@@ -95,6 +96,7 @@ void CPDF_CMapManager::ReloadAll()
 }
 void CPDF_CMapManager::DropAll(FX_BOOL bReload)
 {
+    CFX_CSLock lock(&m_Lock);
     FX_POSITION pos = m_CMaps.GetStartPosition();
     while (pos) {
         CFX_ByteString name;
@@ -123,6 +125,7 @@ void CPDF_CMapManager::DropAll(FX_BOOL bReload)
 }
 CPDF_CID2UnicodeMap* CPDF_CMapManager::GetCID2UnicodeMap(int charset, FX_BOOL bPromptCJK)
 {
+    CFX_CSLock lock(&m_Lock);
     if (m_CID2UnicodeMaps[charset] == NULL) {
         m_CID2UnicodeMaps[charset] = LoadCID2UnicodeMap(charset, bPromptCJK);
     }
@@ -320,6 +323,7 @@ CPDF_CMap::CPDF_CMap()
     m_pLeadingBytes = NULL;
     m_pAddMapping = NULL;
     m_pEmbedMap = NULL;
+    m_pEmbedWordMap = NULL;
     m_pUseMap = NULL;
     m_nCodeRanges = 0;
 }
@@ -334,6 +338,9 @@ CPDF_CMap::~CPDF_CMap()
     if (m_pLeadingBytes) {
         FX_Free(m_pLeadingBytes);
     }
+    if (m_pEmbedWordMap) {
+        FX_Free(m_pEmbedWordMap);
+    }
     if (m_pUseMap) {
         delete m_pUseMap;
     }
@@ -381,6 +388,7 @@ const CPDF_PredefinedCMap g_PredefinedCMaps[] = {
 };
 extern void FPDFAPI_FindEmbeddedCMap(const char* name, int charset, int coding, const FXCMAP_CMap*& pMap);
 extern FX_WORD FPDFAPI_CIDFromCharCode(const FXCMAP_CMap* pMap, FX_DWORD charcode);
+extern void FPDFAPI_LoadWordCIDMap(const FXCMAP_CMap* pMap, FX_WORD* pCIDs);
 FX_BOOL CPDF_CMap::LoadPredefined(CPDF_CMapManager* pMgr, FX_LPCSTR pName, FX_BOOL bPromptCJK)
 {
     m_PredefinedCMap = pName;
@@ -420,6 +428,9 @@ FX_BOOL CPDF_CMap::LoadPredefined(CPDF_CMapManager* pMgr, FX_LPCSTR pName, FX_BO
     }
     FPDFAPI_FindEmbeddedCMap(pName, m_Charset, m_Coding, m_pEmbedMap);
     if (m_pEmbedMap) {
+        m_pEmbedWordMap = FX_Alloc(FX_WORD, 65536);
+        FXSYS_memset32(m_pEmbedWordMap, 0, 65536 * sizeof(FX_WORD));
+        FPDFAPI_LoadWordCIDMap(m_pEmbedMap, m_pEmbedWordMap);
         m_bLoaded = TRUE;
         return TRUE;
     }
@@ -517,6 +528,9 @@ FX_WORD CPDF_CMap::CIDFromCharCode(FX_DWORD charcode) const
         return (FX_WORD)charcode;
     }
     if (m_pEmbedMap) {
+        if (m_pEmbedWordMap && !(charcode >> 16)) {
+            return m_pEmbedWordMap[charcode];
+        }
         return FPDFAPI_CIDFromCharCode(m_pEmbedMap, charcode);
     }
     if (m_pMapping == NULL) {
@@ -814,6 +828,7 @@ CPDF_CIDFont::CPDF_CIDFont()
     m_pAllocatedCMap = NULL;
     m_pCID2UnicodeMap = NULL;
     m_pAnsiWidths = NULL;
+    m_pWidthPages = NULL;
     m_pCIDToGIDMap = NULL;
     m_bCIDIsGID = FALSE;
     m_bAdobeCourierStd = FALSE;
@@ -825,6 +840,14 @@ CPDF_CIDFont::~CPDF_CIDFont()
     if (m_pAnsiWidths) {
         FX_Free(m_pAnsiWidths);
     }
+    if (m_pWidthPages) {
+        for (int i = 0; i < 256; i ++) {
+            if (m_pWidthPages[i]) {
+                FX_Free(m_pWidthPages[i]);
+            }
+        }
+        FX_Free(m_pWidthPages);
+    }
     if (m_pAllocatedCMap) {
         delete m_pAllocatedCMap;
     }
@@ -869,12 +892,12 @@ static FX_DWORD _EmbeddedCharcodeFromUnicode(const FXCMAP_CMap* pEmbedMap, int c
     }
     return 0;
 }
-static FX_WCHAR _EmbeddedUnicodeFromCharcode(const FXCMAP_CMap* pEmbedMap, int charset, FX_DWORD charcode)
+static FX_WCHAR _EmbeddedUnicodeFromCharcode(const CPDF_CMap* pCMap, int charset, FX_DWORD charcode)
 {
     if (charset <= 0 || charset > 4) {
         return 0;
     }
-    FX_WORD cid = FPDFAPI_CIDFromCharCode(pEmbedMap, charcode);
+    FX_WORD cid = pCMap->CIDFromCharCode(charcode);
     if (cid == 0) {
         return 0;
     }
@@ -915,7 +938,7 @@ FX_WCHAR CPDF_CIDFont::_UnicodeFromCharCode(FX_DWORD charcode) const
         return unicode;
 #endif
         if (m_pCMap->m_pEmbedMap) {
-            return _EmbeddedUnicodeFromCharcode(m_pCMap->m_pEmbedMap, m_pCMap->m_Charset, charcode);
+            return _EmbeddedUnicodeFromCharcode(m_pCMap, m_pCMap->m_Charset, charcode);
         } else {
             return 0;
         }
@@ -1060,10 +1083,17 @@ FX_BOOL CPDF_CIDFont::_Load()
             FT_UseCIDCharmap(m_Font.GetFace(), m_pCMap->m_Coding);
         }
     }
-    m_DefaultWidth = pCIDFontDict->GetInteger(FX_BSTRC("DW"), 1000);
+    int default_width = pCIDFontDict->GetInteger(FX_BSTRC("DW"), 1000);
+    if (default_width < 0) {
+        default_width = 0;
+    } else if (default_width > 0xffff) {
+        default_width = 0xffff;
+    }
+    m_DefaultWidth = (FX_WORD)default_width;
     CPDF_Array* pWidthArray = pCIDFontDict->GetArray(FX_BSTRC("W"));
     if (pWidthArray) {
         LoadMetricsArray(pWidthArray, m_WidthList, 1);
+        BuildWidthTable();
     }
     if (!IsEmbedded()) {
         LoadSubstFont();
@@ -1113,6 +1143,7 @@ FX_FLOAT _CIDTransformToFloat(FX_BYTE ch)
 }
 void CPDF_CIDFont::GetCharBBox(FX_DWORD charcode, FX_RECT& rect, int level)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     if (charcode < 256 && m_CharBBox[charcode].Right != -1) {
         rect.bottom = m_CharBBox[charcode].Bottom;
         rect.left = m_CharBBox[charcode].Left;
@@ -1192,12 +1223,56 @@ int CPDF_CIDFont::GetCharWidthF(FX_DWORD charcode, int level)
     if (m_pAnsiWidths && charcode < 0x80) {
         return m_pAnsiWidths[charcode];
     }
-    FX_WORD cid = CIDFromCharCode(charcode);
+    return (int)GetCIDWidth(CIDFromCharCode(charcode));
+}
+// Spreads the W ranges over pages of 256 CIDs, so that a width lookup is two array reads.
+// The table is only built when every width fits the page entries and filling it stays cheap;
+// otherwise GetCIDWidth scans m_WidthList as before.
+#define CIDFONT_MAX_WIDTH_FILL	(65536 * 4)
+void CPDF_CIDFont::BuildWidthTable()
+{
+    int nRanges = m_WidthList.GetSize() / 3;
+    const FX_DWORD* list = m_WidthList.GetData();
+    FX_DWORD fill_count = 0;
+    int i;
+    for (i = 0; i < nRanges; i ++) {
+        if (list[i * 3 + 2] > 0xffff) {
+            return;
+        }
+        if (list[i * 3] <= list[i * 3 + 1] && list[i * 3] <= 0xffff) {
+            fill_count += FX_MIN(list[i * 3 + 1], 0xffff) - list[i * 3] + 1;
+            if (fill_count > CIDFONT_MAX_WIDTH_FILL) {
+                return;
+            }
+        }
+    }
+    m_pWidthPages = FX_Alloc(FX_WORD*, 256);
+    FXSYS_memset32(m_pWidthPages, 0, 256 * sizeof(FX_WORD*));
+    for (i = nRanges - 1; i >= 0; i --) {
+        FX_DWORD first = list[i * 3], last = FX_MIN(list[i * 3 + 1], 0xffff);
+        for (FX_DWORD cid = first; cid <= last; cid ++) {
+            FX_WORD*& pPage = m_pWidthPages[cid >> 8];
+            if (pPage == NULL) {
+                pPage = FX_Alloc(FX_WORD, 256);
+                for (int j = 0; j < 256; j ++) {
+                    pPage[j] = m_DefaultWidth;
+                }
+            }
+            pPage[cid & 0xff] = (FX_WORD)list[i * 3 + 2];
+        }
+    }
+}
+FX_DWORD CPDF_CIDFont::GetCIDWidth(FX_WORD CID) const
+{
+    if (m_pWidthPages) {
+        const FX_WORD* pPage = m_pWidthPages[CID >> 8];
+        return pPage ? pPage[CID & 0xff] : m_DefaultWidth;
+    }
     int size = m_WidthList.GetSize();
-    FX_DWORD* list = m_WidthList.GetData();
+    const FX_DWORD* list = m_WidthList.GetData();
     for (int i = 0; i < size; i += 3) {
-        if (cid >= list[i] && cid <= list[i + 1]) {
-            return (int)list[i + 2];
+        if (CID >= list[i] && CID <= list[i + 1]) {
+            return list[i + 2];
         }
     }
     return m_DefaultWidth;
@@ -1227,20 +1302,13 @@ void CPDF_CIDFont::GetVertOrigin(FX_WORD CID, short& vx, short &vy) const
                 return;
             }
     }
-    FX_DWORD dwWidth = m_DefaultWidth;
-    int size = m_WidthList.GetSize();
-    const FX_DWORD* list = m_WidthList.GetData();
-    for (int i = 0; i < size; i += 3) {
-        if (CID >= list[i] && CID <= list[i + 1]) {
-            dwWidth = (FX_WORD)list[i + 2];
-            break;
-        }
-    }
+    FX_DWORD dwWidth = (FX_WORD)GetCIDWidth(CID);
     vx = (short)dwWidth / 2;
     vy = (short)m_DefaultVY;
 }
 int	CPDF_CIDFont::GetGlyphIndex(FX_DWORD unicode, FX_BOOL *pVertGlyph)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     if (pVertGlyph) {
         *pVertGlyph = FALSE;
     }
@@ -1289,6 +1357,7 @@ int	CPDF_CIDFont::GetGlyphIndex(FX_DWORD unicode, FX_BOOL *pVertGlyph)
 }
 int CPDF_CIDFont::GlyphFromCharCode(FX_DWORD charcode, FX_BOOL *pVertGlyph)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     if (pVertGlyph) {
         *pVertGlyph = FALSE;
     }
@@ -7,6 +7,12 @@
 #include "../../../include/fpdfapi/fpdf_page.h"
 #include "../../../include/fpdfapi/fpdf_module.h"
 #include "pageint.h"
+void CPDF_PageObject::OnMoved()
+{
+    if (m_pOwner) {
+        FX_AtomicIncrement(&m_pOwner->m_MoveGeneration);
+    }
+}
 void CPDF_PageObject::Release()
 {
     delete this;
@@ -567,6 +573,7 @@ void CPDF_TextObject::Transform(const CFX_AffineMatrix& matrix)
     m_PosX = text_matrix.GetE();
     m_PosY = text_matrix.GetF();
     CalcPositionData(NULL, NULL, 0);
+    OnMoved();
 }
 void CPDF_TextObject::SetPosition(FX_FLOAT x, FX_FLOAT y)
 {
@@ -578,6 +585,7 @@ void CPDF_TextObject::SetPosition(FX_FLOAT x, FX_FLOAT y)
     m_Right += dx;
     m_Top += dy;
     m_Bottom += dy;
+    OnMoved();
 }
 void CPDF_TextObject::SetData(int nChars, FX_DWORD* pCharCodes, FX_FLOAT* pCharPos, FX_FLOAT x, FX_FLOAT y)
 {
@@ -637,6 +645,7 @@ void CPDF_ShadingObject::Transform(const CFX_AffineMatrix& matrix)
     } else {
         matrix.TransformRect(m_Left, m_Right, m_Top, m_Bottom);
     }
+    OnMoved();
 }
 void CPDF_ShadingObject::CalcBoundingBox()
 {
@@ -659,6 +668,7 @@ void CPDF_FormObject::Transform(const CFX_AffineMatrix& matrix)
 {
     m_FormMatrix.Concat(matrix);
     CalcBoundingBox();
+    OnMoved();
 }
 void CPDF_FormObject::CopyData(const CPDF_PageObject* pSrc)
 {
@@ -678,6 +688,209 @@ void CPDF_FormObject::CalcBoundingBox()
     m_Right = form_rect.right;
     m_Top = form_rect.top;
 }
+#define PDF_OBJECTGRID_MAXCELLS		256
+class CPDF_PageObjectGrid : public CFX_Object
+{
+public:
+
+    CPDF_PageObjectGrid(const CPDF_PageObjects* pObjs);
+
+    ~CPDF_PageObjectGrid();
+
+    void				GetObjectsInRect(const CFX_FloatRect& rect, CFX_ArrayTemplate<FX_POSITION>& positions) const;
+
+    // Objects may be moved without their owning list knowing, so any move
+    // after the grid was built makes its cells unreliable.
+    FX_BOOL				IsStale() const
+    {
+        return m_MoveGeneration != m_pObjs->GetMoveGeneration();
+    }
+protected:
+
+    int					GetColumn(FX_FLOAT x) const;
+
+    int					GetRow(FX_FLOAT y) const;
+
+    int					m_nObjects;
+
+    FX_POSITION*		m_pPositions;
+
+    CPDF_PageObject**	m_pObjects;
+
+    CFX_FloatRect		m_Bounds;
+
+    int					m_nCols;
+
+    int					m_nRows;
+
+    FX_FLOAT			m_CellWidth;
+
+    FX_FLOAT			m_CellHeight;
+
+    int*				m_pCellStart;
+
+    int*				m_pCellItems;
+
+    CFX_ArrayTemplate<int>	m_LargeItems;
+
+    const CPDF_PageObjects*	m_pObjs;
+
+    FX_DWORD			m_MoveGeneration;
+};
+CPDF_PageObjectGrid::CPDF_PageObjectGrid(const CPDF_PageObjects* pObjs)
+{
+    m_nObjects = pObjs->CountObjects();
+    m_pPositions = FX_Alloc(FX_POSITION, m_nObjects);
+    m_pObjects = FX_Alloc(CPDF_PageObject*, m_nObjects);
+    m_pObjs = pObjs;
+    m_MoveGeneration = pObjs->GetMoveGeneration();
+    int i = 0;
+    FX_POSITION pos = pObjs->GetFirstObjectPosition();
+    while (pos && i < m_nObjects) {
+        m_pPositions[i] = pos;
+        m_pObjects[i] = pObjs->GetNextObject(pos);
+        i ++;
+    }
+    m_nObjects = i;
+    m_Bounds = pObjs->CalcBoundingBox();
+    FX_FLOAT width = m_Bounds.Width(), height = m_Bounds.Height();
+    if (!(width > 0.0001f)) {
+        width = 0.0001f;
+    }
+    if (!(height > 0.0001f)) {
+        height = 0.0001f;
+    }
+    FX_FLOAT cells = (FX_FLOAT)(m_nObjects / 4 + 1);
+    m_nCols = (int)FXSYS_sqrt(cells * width / height);
+    m_nCols = m_nCols < 1 ? 1 : (m_nCols > PDF_OBJECTGRID_MAXCELLS ? PDF_OBJECTGRID_MAXCELLS : m_nCols);
+    m_nRows = (int)(cells / m_nCols);
+    m_nRows = m_nRows < 1 ? 1 : (m_nRows > PDF_OBJECTGRID_MAXCELLS ? PDF_OBJECTGRID_MAXCELLS : m_nRows);
+    m_CellWidth = width / m_nCols;
+    m_CellHeight = height / m_nRows;
+    int nCells = m_nCols * m_nRows;
+    m_pCellStart = FX_Alloc(int, nCells + 1);
+    FXSYS_memset32(m_pCellStart, 0, (nCells + 1) * sizeof(int));
+    int max_span = nCells / 4 + 1;
+    for (i = 0; i < m_nObjects; i ++) {
+        CPDF_PageObject* pObj = m_pObjects[i];
+        if (!pObj) {
+            continue;
+        }
+        int left = GetColumn(pObj->m_Left), right = GetColumn(pObj->m_Right);
+        int bottom = GetRow(pObj->m_Bottom), top = GetRow(pObj->m_Top);
+        if (left > right || bottom > top) {
+            continue;
+        }
+        if ((right - left + 1) * (top - bottom + 1) > max_span) {
+            continue;
+        }
+        for (int row = bottom; row <= top; row ++)
+            for (int col = left; col <= right; col ++) {
+                m_pCellStart[row * m_nCols + col + 1] ++;
+            }
+    }
+    for (i = 0; i < nCells; i ++) {
+        m_pCellStart[i + 1] += m_pCellStart[i];
+    }
+    m_pCellItems = FX_Alloc(int, m_pCellStart[nCells] + 1);
+    int* pFill = FX_Alloc(int, nCells);
+    FXSYS_memcpy32(pFill, m_pCellStart, nCells * sizeof(int));
+    for (i = 0; i < m_nObjects; i ++) {
+        CPDF_PageObject* pObj = m_pObjects[i];
+        if (!pObj) {
+            continue;
+        }
+        int left = GetColumn(pObj->m_Left), right = GetColumn(pObj->m_Right);
+        int bottom = GetRow(pObj->m_Bottom), top = GetRow(pObj->m_Top);
+        if (left > right || bottom > top) {
+            m_LargeItems.Add(i);
+            continue;
+        }
+        if ((right - left + 1) * (top - bottom + 1) > max_span) {
+            m_LargeItems.Add(i);
+            continue;
+        }
+        for (int row = bottom; row <= top; row ++)
+            for (int col = left; col <= right; col ++) {
+                m_pCellItems[pFill[row * m_nCols + col] ++] = i;
+            }
+    }
+    FX_Free(pFill);
+}
+CPDF_PageObjectGrid::~CPDF_PageObjectGrid()
+{
+    FX_Free(m_pPositions);
+    FX_Free(m_pObjects);
+    FX_Free(m_pCellStart);
+    FX_Free(m_pCellItems);
+}
+int CPDF_PageObjectGrid::GetColumn(FX_FLOAT x) const
+{
+    FX_FLOAT col = (x - m_Bounds.left) / m_CellWidth;
+    if (!(col >= 0)) {
+        return 0;
+    }
+    if (col >= m_nCols) {
+        return m_nCols - 1;
+    }
+    return (int)col;
+}
+int CPDF_PageObjectGrid::GetRow(FX_FLOAT y) const
+{
+    FX_FLOAT row = (y - m_Bounds.bottom) / m_CellHeight;
+    if (!(row >= 0)) {
+        return 0;
+    }
+    if (row >= m_nRows) {
+        return m_nRows - 1;
+    }
+    return (int)row;
+}
+extern "C" {
+    static int _CompareObjectIndex(const void* p1, const void* p2)
+    {
+        return *(int*)p1 - *(int*)p2;
+    }
+};
+void CPDF_PageObjectGrid::GetObjectsInRect(const CFX_FloatRect& rect, CFX_ArrayTemplate<FX_POSITION>& positions) const
+{
+    positions.RemoveAll();
+    if (m_nObjects == 0) {
+        return;
+    }
+    CFX_ArrayTemplate<int> hits;
+    if (rect.right >= m_Bounds.left && rect.left <= m_Bounds.right &&
+            rect.top >= m_Bounds.bottom && rect.bottom <= m_Bounds.top) {
+        int left = GetColumn(rect.left), right = GetColumn(rect.right);
+        int bottom = GetRow(rect.bottom), top = GetRow(rect.top);
+        for (int row = bottom; row <= top; row ++)
+            for (int col = left; col <= right; col ++) {
+                int cell = row * m_nCols + col;
+                for (int j = m_pCellStart[cell]; j < m_pCellStart[cell + 1]; j ++) {
+                    hits.Add(m_pCellItems[j]);
+                }
+            }
+    }
+    for (int k = 0; k < m_LargeItems.GetSize(); k ++) {
+        hits.Add(m_LargeItems[k]);
+    }
+    if (hits.GetSize() == 0) {
+        return;
+    }
+    FXSYS_qsort(hits.GetData(), hits.GetSize(), sizeof(int), _CompareObjectIndex);
+    positions.SetSize(0, hits.GetSize());
+    for (int n = 0; n < hits.GetSize(); n ++) {
+        if (n && hits[n] == hits[n - 1]) {
+            continue;
+        }
+        CPDF_PageObject* pObj = m_pObjects[hits[n]];
+        if (pObj->m_Left > rect.right || pObj->m_Right < rect.left ||
+                pObj->m_Bottom > rect.top || pObj->m_Top < rect.bottom) {
+            continue;
+        }
+        positions.Add(m_pPositions[hits[n]]);
+    }
+}
 CPDF_PageObjects::CPDF_PageObjects(FX_BOOL bReleaseMembers) : m_ObjectList(128)
 {
     m_bBackgroundAlphaNeeded = FALSE;
@@ -686,9 +899,12 @@ CPDF_PageObjects::CPDF_PageObjects(FX_BOOL bReleaseMembers) : m_ObjectList(128)
     m_pParser = NULL;
     m_pFormStream = NULL;
     m_pResources = NULL;
+    m_pObjectGrid = NULL;
+    m_MoveGeneration = 0;
 }
 CPDF_PageObjects::~CPDF_PageObjects()
 {
+    InvalidateObjectGrid();
     if (m_pParser) {
         delete m_pParser;
     }
@@ -709,11 +925,22 @@ void CPDF_PageObjects::ContinueParse(IFX_Pause* pPause)
     if (m_pParser == NULL) {
         return;
     }
+    InvalidateObjectGrid();
     m_pParser->Continue(pPause);
     if (m_pParser->GetStatus() == CPDF_ContentParser::Done) {
         m_ParseState = PDF_CONTENT_PARSED;
         delete m_pParser;
         m_pParser = NULL;
+        if (m_bReleaseMembers) {
+            FX_POSITION pos = m_ObjectList.GetHeadPosition();
+            while (pos) {
+                CPDF_PageObject* pObj = (CPDF_PageObject*)m_ObjectList.GetNext(pos);
+                if (pObj) {
+                    pObj->m_pOwner = this;
+                }
+            }
+        }
+        BuildObjectGrid();
     }
 }
 int CPDF_PageObjects::EstimateParseProgress() const
@@ -725,6 +952,10 @@ int CPDF_PageObjects::EstimateParseProgress() const
 }
 FX_POSITION CPDF_PageObjects::InsertObject(FX_POSITION posInsertAfter, CPDF_PageObject* pNewObject)
 {
+    InvalidateObjectGrid();
+    if (m_bReleaseMembers) {
+        pNewObject->m_pOwner = this;
+    }
     if (posInsertAfter == NULL) {
         return m_ObjectList.AddHead(pNewObject);
     } else {
@@ -754,11 +985,13 @@ CPDF_PageObject* CPDF_PageObjects::GetObjectByIndex(int index) const
 }
 void CPDF_PageObjects::Transform(const CFX_AffineMatrix& matrix)
 {
+    InvalidateObjectGrid();
     FX_POSITION pos = m_ObjectList.GetHeadPosition();
     while (pos) {
         CPDF_PageObject* pObj = (CPDF_PageObject*)m_ObjectList.GetNext(pos);
         pObj->Transform(matrix);
     }
+    BuildObjectGrid();
 }
 CFX_FloatRect CPDF_PageObjects::CalcBoundingBox() const
 {
@@ -786,6 +1019,38 @@ CFX_FloatRect CPDF_PageObjects::CalcBoundingBox() const
     }
     return CFX_FloatRect(left, bottom, right, top);
 }
+void CPDF_PageObjects::GetObjectsInRect(const CFX_FloatRect& rect, CFX_ArrayTemplate<FX_POSITION>& positions) const
+{
+    if (m_pObjectGrid && !m_pObjectGrid->IsStale()) {
+        m_pObjectGrid->GetObjectsInRect(rect, positions);
+        return;
+    }
+    positions.RemoveAll();
+    FX_POSITION pos = m_ObjectList.GetHeadPosition();
+    while (pos) {
+        FX_POSITION cur_pos = pos;
+        CPDF_PageObject* pObj = (CPDF_PageObject*)m_ObjectList.GetNext(pos);
+        if (pObj == NULL || pObj->m_Left > rect.right || pObj->m_Right < rect.left ||
+                pObj->m_Bottom > rect.top || pObj->m_Top < rect.bottom) {
+            continue;
+        }
+        positions.Add(cur_pos);
+    }
+}
+void CPDF_PageObjects::BuildObjectGrid()
+{
+    InvalidateObjectGrid();
+    if (IsParsed() && m_bReleaseMembers && m_ObjectList.GetCount() >= PDF_OBJECTGRID_THRESHOLD) {
+        m_pObjectGrid = FX_NEW CPDF_PageObjectGrid(this);
+    }
+}
+void CPDF_PageObjects::InvalidateObjectGrid()
+{
+    if (m_pObjectGrid) {
+        delete m_pObjectGrid;
+        m_pObjectGrid = NULL;
+    }
+}
 void CPDF_PageObjects::LoadTransInfo()
 {
     if (m_pFormDict == NULL) {
@@ -808,6 +1073,7 @@ void CPDF_PageObjects::LoadTransInfo()
 }
 void CPDF_PageObjects::ClearCacheObjects()
 {
+    InvalidateObjectGrid();
     m_ParseState = PDF_CONTENT_NOT_PARSED;
     if (m_pParser) {
         delete m_pParser;
@@ -982,8 +1248,9 @@ CPDF_Form* CPDF_Form::Clone() const
     CPDF_Form* pClone = FX_NEW CPDF_Form(m_pDocument, m_pPageResources, m_pFormStream, m_pResources);
     FX_POSITION pos = m_ObjectList.GetHeadPosition();
     while (pos) {
-        CPDF_PageObject* pObj = (CPDF_PageObject*)m_ObjectList.GetNext(pos);
-        pClone->m_ObjectList.AddTail(pObj->Clone());
+        CPDF_PageObject* pObj = ((CPDF_PageObject*)m_ObjectList.GetNext(pos))->Clone();
+        pObj->m_pOwner = pClone;
+        pClone->m_ObjectList.AddTail(pObj);
     }
     return pClone;
 }
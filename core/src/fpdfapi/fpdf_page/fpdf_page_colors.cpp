@@ -415,6 +415,180 @@ void CPDF_CalRGB::TranslateImageLine(FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int
     }
     ReverseRGB(pDestBuf, pSrcBuf, pixels);
 }
+// Sampled lookup table for converting image lines of expensive color spaces. The grid has
+// m_nLevels nodes per component, all sitting on byte values (255 is a multiple of
+// m_nLevels - 1), and every node is converted with the color space's own line conversion.
+// With 256 levels every input byte is a node and the lookup gives exactly the direct result;
+// coarser grids are interpolated over the simplex enclosing the pixel, which reads only
+// m_nComponents + 1 nodes per pixel.
+#define PDF_COLORLUT_MAX_COMPONENTS		8
+#define PDF_COLORLUT_MAX_ENTRIES		(52 * 52 * 52)
+class CPDF_ColorLUT : public CFX_Object
+{
+public:
+    CPDF_ColorLUT(int nComponents, int nLevels);
+    ~CPDF_ColorLUT();
+
+    static int			GetLevels(int nComponents);
+
+    static int			CountEntries(int nComponents, int nLevels);
+
+    FX_LPBYTE			CreateNodes() const;
+
+    void				TranslateLine(FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int pixels) const;
+    int					m_nComponents;
+    int					m_nLevels;
+    int					m_nEntries;
+    FX_LPBYTE			m_pTable;
+    int					m_Strides[PDF_COLORLUT_MAX_COMPONENTS];
+    int					m_Cell[256];
+    int					m_Frac[256];
+};
+CPDF_ColorLUT::CPDF_ColorLUT(int nComponents, int nLevels)
+{
+    m_nComponents = nComponents;
+    m_nLevels = nLevels;
+    m_nEntries = CountEntries(nComponents, nLevels);
+    m_pTable = FX_Alloc(FX_BYTE, m_nEntries * 3);
+    int stride = 1;
+    for (int c = nComponents - 1; c >= 0; c --) {
+        m_Strides[c] = stride * 3;
+        stride *= nLevels;
+    }
+    int step = 255 / (nLevels - 1);
+    for (int v = 0; v < 256; v ++) {
+        int cell = v / step;
+        if (cell > nLevels - 2) {
+            cell = nLevels - 2;
+        }
+        m_Cell[v] = cell;
+        m_Frac[v] = (v - cell * step) * 65536 / step;
+    }
+}
+CPDF_ColorLUT::~CPDF_ColorLUT()
+{
+    FX_Free(m_pTable);
+}
+int CPDF_ColorLUT::GetLevels(int nComponents)
+{
+    static const int levels[] = {256, 52, 18, 6, 4};
+    if (nComponents < 1 || nComponents > PDF_COLORLUT_MAX_COMPONENTS) {
+        return 0;
+    }
+    for (int i = 0; i < (int)(sizeof levels / sizeof levels[0]); i ++) {
+        if (CountEntries(nComponents, levels[i]) <= PDF_COLORLUT_MAX_ENTRIES) {
+            return levels[i];
+        }
+    }
+    return 0;
+}
+int CPDF_ColorLUT::CountEntries(int nComponents, int nLevels)
+{
+    int nEntries = 1;
+    for (int c = 0; c < nComponents; c ++) {
+        if (nEntries > PDF_COLORLUT_MAX_ENTRIES) {
+            break;
+        }
+        nEntries *= nLevels;
+    }
+    return nEntries;
+}
+FX_LPBYTE CPDF_ColorLUT::CreateNodes() const
+{
+    FX_LPBYTE pNodes = FX_Alloc(FX_BYTE, m_nEntries * m_nComponents);
+    int step = 255 / (m_nLevels - 1);
+    FX_LPBYTE pSrc = pNodes;
+    for (int i = 0; i < m_nEntries; i ++) {
+        int index = i;
+        for (int c = m_nComponents - 1; c >= 0; c --) {
+            pSrc[c] = (FX_BYTE)(index % m_nLevels * step);
+            index /= m_nLevels;
+        }
+        pSrc += m_nComponents;
+    }
+    return pNodes;
+}
+void CPDF_ColorLUT::TranslateLine(FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int pixels) const
+{
+    if (m_nLevels == 256) {
+        for (int i = 0; i < pixels; i ++) {
+            int index = 0;
+            for (int c = 0; c < m_nComponents; c ++) {
+                index += pSrcBuf[c] * m_Strides[c];
+            }
+            pDestBuf[0] = m_pTable[index];
+            pDestBuf[1] = m_pTable[index + 1];
+            pDestBuf[2] = m_pTable[index + 2];
+            pSrcBuf += m_nComponents;
+            pDestBuf += 3;
+        }
+        return;
+    }
+    int order[PDF_COLORLUT_MAX_COMPONENTS];
+    for (int i = 0; i < pixels; i ++) {
+        int index = 0;
+        for (int c = 0; c < m_nComponents; c ++) {
+            index += m_Cell[pSrcBuf[c]] * m_Strides[c];
+            int frac = m_Frac[pSrcBuf[c]];
+            int j = c;
+            for (; j > 0 && m_Frac[pSrcBuf[order[j - 1]]] < frac; j --) {
+                order[j] = order[j - 1];
+            }
+            order[j] = c;
+        }
+        int prev = 65536, b = 0, g = 0, r = 0;
+        for (int k = 0; k <= m_nComponents; k ++) {
+            int frac = k < m_nComponents ? m_Frac[pSrcBuf[order[k]]] : 0;
+            int weight = prev - frac;
+            b += weight * m_pTable[index];
+            g += weight * m_pTable[index + 1];
+            r += weight * m_pTable[index + 2];
+            if (k < m_nComponents) {
+                index += m_Strides[order[k]];
+            }
+            prev = frac;
+        }
+        pDestBuf[0] = (b + 32768) >> 16;
+        pDestBuf[1] = (g + 32768) >> 16;
+        pDestBuf[2] = (r + 32768) >> 16;
+        pSrcBuf += m_nComponents;
+        pDestBuf += 3;
+    }
+}
+typedef void (*PDF_CONVERTLINE)(const CPDF_ColorSpace* pCS, FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int pixels);
+// Converts the line through the lookup table in pLUT, building it on first use with pConvert.
+// Returns FALSE if the image is too small for the table to pay off, or the color space has
+// too many components; the caller then converts the line directly.
+static FX_BOOL _PDF_TranslateImageLineByLUT(const CPDF_ColorSpace* pCS, CPDF_ColorLUT*& pLUT, PDF_CONVERTLINE pConvert,
+        FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int pixels, int image_width, int image_height)
+{
+    int nComponents = pCS->CountComponents();
+    int nLevels = CPDF_ColorLUT::GetLevels(nComponents);
+    if (nLevels == 0 || pCS->m_pDocument == NULL) {
+        return FALSE;
+    }
+    if (image_width * image_height < CPDF_ColorLUT::CountEntries(nComponents, nLevels) * 3 / 2) {
+        return FALSE;
+    }
+    CPDF_ColorLUT* pTable = (CPDF_ColorLUT*)FX_AtomicLoadPointer((FX_LPVOID volatile*)&pLUT);
+    if (pTable == NULL) {
+        CFX_CSLock lock(pCS->m_pDocument->GetLock());
+        pTable = pLUT;
+        if (pTable == NULL) {
+            pTable = FX_NEW CPDF_ColorLUT(nComponents, nLevels);
+            FX_LPBYTE pNodes = pTable->CreateNodes();
+            pConvert(pCS, pTable->m_pTable, pNodes, pTable->m_nEntries);
+            FX_Free(pNodes);
+            FX_AtomicStorePointer((FX_LPVOID volatile*)&pLUT, pTable);
+        }
+    }
+    pTable->TranslateLine(pDestBuf, pSrcBuf, pixels);
+    return TRUE;
+}
+static void _PDF_ConvertLine(const CPDF_ColorSpace* pCS, FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int pixels)
+{
+    pCS->CPDF_ColorSpace::TranslateImageLine(pDestBuf, pSrcBuf, pixels, 0, 0);
+}
 class CPDF_LabCS : public CPDF_ColorSpace
 {
 public:
@@ -422,6 +596,15 @@ public:
     {
         m_Family = PDFCS_LAB;
         m_nComponents = 3;
+        m_pLUT[0] = m_pLUT[1] = NULL;
+    }
+    virtual ~CPDF_LabCS()
+    {
+        for (int i = 0; i < 2; i ++) {
+            if (m_pLUT[i]) {
+                delete m_pLUT[i];
+            }
+        }
     }
     virtual FX_BOOL		v_Load(CPDF_Document* pDoc, CPDF_Array* pArray);
     virtual void		GetDefaultValue(int iComponent, FX_FLOAT& value, FX_FLOAT& min, FX_FLOAT& max) const;
@@ -431,6 +614,7 @@ public:
     FX_FLOAT	m_WhitePoint[3];
     FX_FLOAT	m_BlackPoint[3];
     FX_FLOAT	m_Ranges[4];
+    CPDF_ColorLUT*	m_pLUT[2];
 };
 FX_BOOL CPDF_LabCS::v_Load(CPDF_Document* pDoc, CPDF_Array* pArray)
 {
@@ -498,7 +682,7 @@ FX_BOOL CPDF_LabCS::SetRGB(FX_FLOAT* pBuf, FX_FLOAT R, FX_FLOAT G, FX_FLOAT B) c
 {
     return FALSE;
 }
-void CPDF_LabCS::TranslateImageLine(FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int pixels, int image_width, int image_height, FX_BOOL bTransMask) const
+static void _PDF_ConvertLabLine(const CPDF_ColorSpace* pCS, FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int pixels)
 {
     for (int i = 0; i < pixels; i ++) {
         FX_FLOAT lab[3];
@@ -506,7 +690,7 @@ void CPDF_LabCS::TranslateImageLine(FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int
         lab[0] = (pSrcBuf[0] * 100 / 255.0f);
         lab[1] = (FX_FLOAT)(pSrcBuf[1] - 128);
         lab[2] = (FX_FLOAT)(pSrcBuf[2] - 128);
-        GetRGB(lab, R, G, B);
+        pCS->GetRGB(lab, R, G, B);
         pDestBuf[0] = (FX_INT32)(B * 255);
         pDestBuf[1] = (FX_INT32)(G * 255);
         pDestBuf[2] = (FX_INT32)(R * 255);
@@ -514,6 +698,13 @@ void CPDF_LabCS::TranslateImageLine(FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int
         pSrcBuf += 3;
     }
 }
+void CPDF_LabCS::TranslateImageLine(FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int pixels, int image_width, int image_height, FX_BOOL bTransMask) const
+{
+    CPDF_ColorLUT*& pLUT = ((CPDF_LabCS*)this)->m_pLUT[m_dwStdConversion ? 1 : 0];
+    if (!_PDF_TranslateImageLineByLUT(this, pLUT, _PDF_ConvertLabLine, pDestBuf, pSrcBuf, pixels, image_width, image_height)) {
+        _PDF_ConvertLabLine(this, pDestBuf, pSrcBuf, pixels);
+    }
+}
 CPDF_IccProfile::CPDF_IccProfile(FX_LPCBYTE pData, FX_DWORD dwSize, int nComponents)
 {
     m_bsRGB = nComponents == 3 && dwSize == 3144 && FXSYS_memcmp32(pData + 0x190, "sRGB IEC61966-2.1", 17) == 0;
@@ -544,6 +735,7 @@ public:
     FX_BOOL				SetRGB(FX_FLOAT* pBuf, FX_FLOAT R, FX_FLOAT G, FX_FLOAT B) const;
     virtual void		EnableStdConversion(FX_BOOL bEnabled);
     virtual void		TranslateImageLine(FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int pixels, int image_width, int image_height, FX_BOOL bTransMask = FALSE) const;
+    void				BuildCache(int nMaxColors) const;
     FX_FLOAT*		m_pRanges;
     CPDF_IccProfile*	m_pProfile;
     CPDF_ColorSpace*	m_pAlterCS;
@@ -670,6 +862,28 @@ void CPDF_ICCBasedCS::EnableStdConversion(FX_BOOL bEnabled)
         m_pAlterCS->EnableStdConversion(bEnabled);
     }
 }
+void CPDF_ICCBasedCS::BuildCache(int nMaxColors) const
+{
+    CFX_CSLock lock(m_pDocument->GetLock());
+    if (m_pCache) {
+        return;
+    }
+    FX_LPBYTE pCache = FX_Alloc(FX_BYTE, nMaxColors * 3);
+    FX_LPBYTE temp_src = FX_Alloc(FX_BYTE, nMaxColors * m_nComponents);
+    FX_LPBYTE pSrc = temp_src;
+    for (int i = 0; i < nMaxColors; i ++) {
+        FX_DWORD color = i;
+        FX_DWORD order = nMaxColors / 52;
+        for (int c = 0; c < m_nComponents; c ++) {
+            *pSrc++ = (FX_BYTE)(color / order * 5);
+            color %= order;
+            order /= 52;
+        }
+    }
+    CPDF_ModuleMgr::Get()->GetIccModule()->TranslateScanline(m_pProfile->m_pTransform, pCache, temp_src, nMaxColors);
+    FX_Free(temp_src);
+    FX_AtomicStorePointer((FX_LPVOID volatile*)&((CPDF_ICCBasedCS*)this)->m_pCache, pCache);
+}
 void CPDF_ICCBasedCS::TranslateImageLine(FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int pixels, int image_width, int image_height, FX_BOOL bTransMask) const
 {
     if (m_pProfile->m_bsRGB) {
@@ -682,21 +896,10 @@ void CPDF_ICCBasedCS::TranslateImageLine(FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf,
         if (m_nComponents > 3 || image_width * image_height < nMaxColors * 3 / 2) {
             CPDF_ModuleMgr::Get()->GetIccModule()->TranslateScanline(m_pProfile->m_pTransform, pDestBuf, pSrcBuf, pixels);
         } else {
-            if (m_pCache == NULL) {
-                ((CPDF_ICCBasedCS*)this)->m_pCache = FX_Alloc(FX_BYTE, nMaxColors * 3);
-                FX_LPBYTE temp_src = FX_Alloc(FX_BYTE, nMaxColors * m_nComponents);
-                FX_LPBYTE pSrc = temp_src;
-                for (int i = 0; i < nMaxColors; i ++) {
-                    FX_DWORD color = i;
-                    FX_DWORD order = nMaxColors / 52;
-                    for (int c = 0; c < m_nComponents; c ++) {
-                        *pSrc++ = (FX_BYTE)(color / order * 5);
-                        color %= order;
-                        order /= 52;
-                    }
-                }
-                CPDF_ModuleMgr::Get()->GetIccModule()->TranslateScanline(m_pProfile->m_pTransform, m_pCache, temp_src, nMaxColors);
-                FX_Free(temp_src);
+            FX_LPBYTE pCache = (FX_LPBYTE)FX_AtomicLoadPointer((FX_LPVOID volatile*)&((CPDF_ICCBasedCS*)this)->m_pCache);
+            if (pCache == NULL) {
+                BuildCache(nMaxColors);
+                pCache = m_pCache;
             }
             for (int i = 0; i < pixels; i ++) {
                 int index = 0;
@@ -705,9 +908,9 @@ void CPDF_ICCBasedCS::TranslateImageLine(FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf,
                     pSrcBuf ++;
                 }
                 index *= 3;
-                *pDestBuf++ = m_pCache[index];
-                *pDestBuf++ = m_pCache[index + 1];
-                *pDestBuf++ = m_pCache[index + 2];
+                *pDestBuf++ = pCache[index];
+                *pDestBuf++ = pCache[index + 1];
+                *pDestBuf++ = pCache[index + 2];
             }
         }
     } else if (m_pAlterCS) {
@@ -882,9 +1085,11 @@ public:
     virtual FX_BOOL		v_Load(CPDF_Document* pDoc, CPDF_Array* pArray);
     virtual FX_BOOL		GetRGB(FX_FLOAT* pBuf, FX_FLOAT& R, FX_FLOAT& G, FX_FLOAT& B) const;
     virtual void		EnableStdConversion(FX_BOOL bEnabled);
+    virtual void		TranslateImageLine(FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int pixels, int image_width, int image_height, FX_BOOL bTransMask = FALSE) const;
     CPDF_ColorSpace*	m_pAltCS;
     CPDF_Function*		m_pFunc;
     enum {None, All, Colorant}	m_Type;
+    CPDF_ColorLUT*		m_pLUT[2];
 };
 CPDF_SeparationCS::CPDF_SeparationCS()
 {
@@ -892,9 +1097,15 @@ CPDF_SeparationCS::CPDF_SeparationCS()
     m_pAltCS = NULL;
     m_pFunc = NULL;
     m_nComponents = 1;
+    m_pLUT[0] = m_pLUT[1] = NULL;
 }
 CPDF_SeparationCS::~CPDF_SeparationCS()
 {
+    for (int i = 0; i < 2; i ++) {
+        if (m_pLUT[i]) {
+            delete m_pLUT[i];
+        }
+    }
     if (m_pAltCS) {
         m_pAltCS->ReleaseCS();
     }
@@ -963,6 +1174,13 @@ void CPDF_SeparationCS::EnableStdConversion(FX_BOOL bEnabled)
         m_pAltCS->EnableStdConversion(bEnabled);
     }
 }
+void CPDF_SeparationCS::TranslateImageLine(FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int pixels, int image_width, int image_height, FX_BOOL bTransMask) const
+{
+    CPDF_ColorLUT*& pLUT = ((CPDF_SeparationCS*)this)->m_pLUT[m_dwStdConversion ? 1 : 0];
+    if (!_PDF_TranslateImageLineByLUT(this, pLUT, _PDF_ConvertLine, pDestBuf, pSrcBuf, pixels, image_width, image_height)) {
+        CPDF_ColorSpace::TranslateImageLine(pDestBuf, pSrcBuf, pixels, image_width, image_height, bTransMask);
+    }
+}
 class CPDF_DeviceNCS : public CPDF_ColorSpace
 {
 public:
@@ -977,17 +1195,25 @@ public:
     virtual FX_BOOL	v_Load(CPDF_Document* pDoc, CPDF_Array* pArray);
     virtual FX_BOOL	GetRGB(FX_FLOAT* pBuf, FX_FLOAT& R, FX_FLOAT& G, FX_FLOAT& B) const;
     virtual void	EnableStdConversion(FX_BOOL bEnabled);
+    virtual void	TranslateImageLine(FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int pixels, int image_width, int image_height, FX_BOOL bTransMask = FALSE) const;
     CPDF_ColorSpace*	m_pAltCS;
     CPDF_Function*		m_pFunc;
+    CPDF_ColorLUT*		m_pLUT[2];
 };
 CPDF_DeviceNCS::CPDF_DeviceNCS()
 {
     m_Family = PDFCS_DEVICEN;
     m_pAltCS = NULL;
     m_pFunc = NULL;
+    m_pLUT[0] = m_pLUT[1] = NULL;
 }
 CPDF_DeviceNCS::~CPDF_DeviceNCS()
 {
+    for (int i = 0; i < 2; i ++) {
+        if (m_pLUT[i]) {
+            delete m_pLUT[i];
+        }
+    }
     if (m_pFunc) {
         delete m_pFunc;
     }
@@ -1040,6 +1266,13 @@ void CPDF_DeviceNCS::EnableStdConversion(FX_BOOL bEnabled)
         m_pAltCS->EnableStdConversion(bEnabled);
     }
 }
+void CPDF_DeviceNCS::TranslateImageLine(FX_LPBYTE pDestBuf, FX_LPCBYTE pSrcBuf, int pixels, int image_width, int image_height, FX_BOOL bTransMask) const
+{
+    CPDF_ColorLUT*& pLUT = ((CPDF_DeviceNCS*)this)->m_pLUT[m_dwStdConversion ? 1 : 0];
+    if (!_PDF_TranslateImageLineByLUT(this, pLUT, _PDF_ConvertLine, pDestBuf, pSrcBuf, pixels, image_width, image_height)) {
+        CPDF_ColorSpace::TranslateImageLine(pDestBuf, pSrcBuf, pixels, image_width, image_height, bTransMask);
+    }
+}
 CPDF_ColorSpace* CPDF_ColorSpace::GetStockCS(int family)
 {
     return CPDF_ModuleMgr::Get()->GetPageModule()->GetStockCS(family);;
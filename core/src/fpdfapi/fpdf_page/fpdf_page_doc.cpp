@@ -150,6 +150,7 @@ CPDF_DocPageData::~CPDF_DocPageData()
 }
 void CPDF_DocPageData::Clear(FX_BOOL bRelease)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     FX_POSITION pos;
     FX_DWORD	nCount;
     {
@@ -246,6 +247,7 @@ void CPDF_DocPageData::Clear(FX_BOOL bRelease)
 }
 CPDF_Font* CPDF_DocPageData::GetFont(CPDF_Dictionary* pFontDict, FX_BOOL findOnly)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     if (!pFontDict) {
         return NULL;
     }
@@ -289,6 +291,7 @@ CPDF_Font* CPDF_DocPageData::GetFont(CPDF_Dictionary* pFontDict, FX_BOOL findOnl
 }
 CPDF_Font* CPDF_DocPageData::GetStandardFont(FX_BSTR fontName, CPDF_FontEncoding* pEncoding)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     if (fontName.IsEmpty()) {
         return NULL;
     }
@@ -344,6 +347,7 @@ CPDF_Font* CPDF_DocPageData::GetStandardFont(FX_BSTR fontName, CPDF_FontEncoding
 }
 void CPDF_DocPageData::ReleaseFont(CPDF_Dictionary* pFontDict)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     if (!pFontDict) {
         return;
     }
@@ -358,6 +362,7 @@ void CPDF_DocPageData::ReleaseFont(CPDF_Dictionary* pFontDict)
 }
 CPDF_ColorSpace* CPDF_DocPageData::GetColorSpace(CPDF_Object* pCSObj, CPDF_Dictionary* pResources)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     if (!pCSObj) {
         return NULL;
     }
@@ -434,6 +439,7 @@ CPDF_ColorSpace* CPDF_DocPageData::GetColorSpace(CPDF_Object* pCSObj, CPDF_Dicti
 }
 CPDF_ColorSpace* CPDF_DocPageData::GetCopiedColorSpace(CPDF_Object* pCSObj)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     if (!pCSObj) {
         return NULL;
     }
@@ -449,6 +455,7 @@ CPDF_ColorSpace* CPDF_DocPageData::GetCopiedColorSpace(CPDF_Object* pCSObj)
 }
 void CPDF_DocPageData::ReleaseColorSpace(CPDF_Object* pColorSpace)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     if (!pColorSpace) {
         return;
     }
@@ -463,6 +470,7 @@ void CPDF_DocPageData::ReleaseColorSpace(CPDF_Object* pColorSpace)
 }
 CPDF_Pattern* CPDF_DocPageData::GetPattern(CPDF_Object* pPatternObj, FX_BOOL bShading, const CFX_AffineMatrix* matrix)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     if (!pPatternObj) {
         return NULL;
     }
@@ -508,6 +516,7 @@ CPDF_Pattern* CPDF_DocPageData::GetPattern(CPDF_Object* pPatternObj, FX_BOOL bSh
 }
 void CPDF_DocPageData::ReleasePattern(CPDF_Object* pPatternObj)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     if (!pPatternObj) {
         return;
     }
@@ -522,6 +531,7 @@ void CPDF_DocPageData::ReleasePattern(CPDF_Object* pPatternObj)
 }
 CPDF_Image* CPDF_DocPageData::GetImage(CPDF_Object* pImageStream)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     if (!pImageStream) {
         return NULL;
     }
@@ -548,6 +558,7 @@ CPDF_Image* CPDF_DocPageData::GetImage(CPDF_Object* pImageStream)
 }
 void CPDF_DocPageData::ReleaseImage(CPDF_Object* pImageStream)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     if (!pImageStream) {
         return;
     }
@@ -555,6 +566,7 @@ void CPDF_DocPageData::ReleaseImage(CPDF_Object* pImageStream)
 }
 CPDF_IccProfile* CPDF_DocPageData::GetIccProfile(CPDF_Stream* pIccProfileStream, FX_INT32 nComponents)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     if (!pIccProfileStream) {
         return NULL;
     }
@@ -590,6 +602,7 @@ CPDF_IccProfile* CPDF_DocPageData::GetIccProfile(CPDF_Stream* pIccProfileStream,
 }
 void CPDF_DocPageData::ReleaseIccProfile(CPDF_Stream* pIccProfileStream, CPDF_IccProfile* pIccProfile)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     if (!pIccProfileStream && !pIccProfile) {
         return;
     }
@@ -610,6 +623,7 @@ void CPDF_DocPageData::ReleaseIccProfile(CPDF_Stream* pIccProfileStream, CPDF_Ic
 }
 CPDF_StreamAcc* CPDF_DocPageData::GetFontFileStreamAcc(CPDF_Stream* pFontStream)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     if (!pFontStream) {
         return NULL;
     }
@@ -640,6 +654,7 @@ CPDF_StreamAcc* CPDF_DocPageData::GetFontFileStreamAcc(CPDF_Stream* pFontStream)
 }
 void CPDF_DocPageData::ReleaseFontFileStreamAcc(CPDF_Stream* pFontStream, FX_BOOL bForce)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     if (!pFontStream) {
         return;
     }
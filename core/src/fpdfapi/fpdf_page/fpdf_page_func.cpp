@@ -15,14 +15,13 @@ typedef enum {PSOP_ADD, PSOP_SUB, PSOP_MUL, PSOP_DIV, PSOP_IDIV, PSOP_MOD,
               PSOP_CVI, PSOP_CVR, PSOP_EQ, PSOP_NE, PSOP_GT, PSOP_GE, PSOP_LT, PSOP_LE,
               PSOP_AND, PSOP_OR, PSOP_XOR, PSOP_NOT, PSOP_BITSHIFT, PSOP_TRUE, PSOP_FALSE,
               PSOP_IF, PSOP_IFELSE, PSOP_POP, PSOP_EXCH, PSOP_DUP, PSOP_COPY,
-              PSOP_INDEX, PSOP_ROLL, PSOP_PROC, PSOP_CONST
+              PSOP_INDEX, PSOP_ROLL, PSOP_PROC, PSOP_CONST, PSOP_JZ, PSOP_JMP
              } PDF_PSOP;
 class CPDF_PSProc : public CFX_Object
 {
 public:
     ~CPDF_PSProc();
     FX_BOOL	Parse(CPDF_SimpleParser& parser);
-    FX_BOOL	Execute(CPDF_PSEngine* pEngine);
     CFX_PtrArray		m_Operators;
 };
 #define PSENGINE_STACKSIZE 100
@@ -31,22 +30,29 @@ class CPDF_PSEngine : public CFX_Object
 public:
     CPDF_PSEngine();
     ~CPDF_PSEngine();
-    FX_BOOL	Parse(const FX_CHAR* string, int size);
-    FX_BOOL	Execute()
-    {
-        return m_MainProc.Execute(this);
-    }
     FX_BOOL	DoOperator(PDF_PSOP op);
     void	Reset()
     {
         m_StackCount = 0;
     }
-    void	Push(FX_FLOAT value);
+    void	Push(FX_FLOAT value)
+    {
+        if (m_StackCount == PSENGINE_STACKSIZE) {
+            return;
+        }
+        m_Stack[m_StackCount++] = value;
+    }
     void	Push(int value)
     {
         Push((FX_FLOAT)value);
     }
-    FX_FLOAT	Pop();
+    FX_FLOAT	Pop()
+    {
+        if (m_StackCount == 0) {
+            return 0;
+        }
+        return m_Stack[--m_StackCount];
+    }
     int		GetStackSize()
     {
         return m_StackCount;
@@ -54,7 +60,33 @@ public:
 private:
     FX_FLOAT	m_Stack[PSENGINE_STACKSIZE];
     int		m_StackCount;
-    CPDF_PSProc	m_MainProc;
+};
+// One instruction of a compiled calculator function. PSOP_CONST pushes m_Value, PSOP_JZ pops
+// the condition and jumps to m_Target if it is zero, PSOP_JMP always jumps; every other
+// operator runs through CPDF_PSEngine::DoOperator.
+typedef struct {
+    PDF_PSOP	m_Op;
+    int			m_Target;
+    FX_FLOAT	m_Value;
+} PDF_PSCODE;
+// A Type 4 function body, parsed once into a CPDF_PSProc tree and compiled into a flat
+// instruction array with the if/ifelse procedures laid out inline behind conditional jumps.
+// Operators whose operands are all constants are evaluated at compile time, including the
+// condition of if/ifelse, unless the program could overflow the operand stack.
+class CPDF_PSProgram : public CFX_Object
+{
+public:
+    CPDF_PSProgram();
+    FX_BOOL	Parse(const FX_CHAR* string, int size, int nInputs);
+    void	Execute(CPDF_PSEngine& engine) const;
+protected:
+    void	Compile(const CPDF_PSProc* pProc);
+    void	CompileProc(const CPDF_PSProc* pProc, FX_BOOL bInline);
+    void	Emit(PDF_PSOP op, FX_FLOAT value = 0);
+    FX_BOOL	PopConstCondition(FX_BOOL& bCondition);
+    CFX_ArrayTemplate<PDF_PSCODE>	m_Code;
+    int		m_Barrier;
+    FX_BOOL	m_bFold;
 };
 CPDF_PSProc::~CPDF_PSProc()
 {
@@ -69,61 +101,215 @@ CPDF_PSProc::~CPDF_PSProc()
         }
     }
 }
-#pragma optimize( "", off )
-FX_BOOL CPDF_PSProc::Execute(CPDF_PSEngine* pEngine)
+CPDF_PSEngine::CPDF_PSEngine()
 {
-    int size = m_Operators.GetSize();
+    m_StackCount = 0;
+}
+CPDF_PSEngine::~CPDF_PSEngine()
+{
+}
+CPDF_PSProgram::CPDF_PSProgram()
+{
+    m_Barrier = 0;
+    m_bFold = FALSE;
+}
+static int _PDF_PSCountOperators(const CPDF_PSProc* pProc, FX_BOOL& bCopy)
+{
+    int count = 0;
+    int size = pProc->m_Operators.GetSize();
     for (int i = 0; i < size; i ++) {
-        PDF_PSOP op = (PDF_PSOP)(FX_UINTPTR)m_Operators[i];
+        PDF_PSOP op = (PDF_PSOP)(FX_UINTPTR)pProc->m_Operators[i];
+        if (op == PSOP_PROC) {
+            count += _PDF_PSCountOperators((const CPDF_PSProc*)pProc->m_Operators[i + 1], bCopy);
+            i ++;
+            continue;
+        }
+        if (op == PSOP_CONST) {
+            i ++;
+        } else if (op == PSOP_COPY) {
+            bCopy = TRUE;
+        }
+        count ++;
+    }
+    return count;
+}
+// Returns the number of operands of an operator without side effects that pushes exactly one
+// result, or -1.
+static int _PDF_PSFoldableArity(PDF_PSOP op)
+{
+    switch (op) {
+        case PSOP_TRUE:
+        case PSOP_FALSE:
+            return 0;
+        case PSOP_NEG:
+        case PSOP_ABS:
+        case PSOP_CEILING:
+        case PSOP_FLOOR:
+        case PSOP_ROUND:
+        case PSOP_TRUNCATE:
+        case PSOP_SQRT:
+        case PSOP_SIN:
+        case PSOP_COS:
+        case PSOP_LN:
+        case PSOP_LOG:
+        case PSOP_CVI:
+        case PSOP_NOT:
+            return 1;
+        case PSOP_ADD:
+        case PSOP_SUB:
+        case PSOP_MUL:
+        case PSOP_DIV:
+        case PSOP_IDIV:
+        case PSOP_MOD:
+        case PSOP_ATAN:
+        case PSOP_EXP:
+        case PSOP_EQ:
+        case PSOP_NE:
+        case PSOP_GT:
+        case PSOP_GE:
+        case PSOP_LT:
+        case PSOP_LE:
+        case PSOP_AND:
+        case PSOP_OR:
+        case PSOP_XOR:
+        case PSOP_BITSHIFT:
+            return 2;
+        default:
+            break;
+    }
+    return -1;
+}
+FX_BOOL CPDF_PSProgram::Parse(const FX_CHAR* string, int size, int nInputs)
+{
+    CPDF_SimpleParser parser((FX_LPBYTE)string, size);
+    CFX_ByteStringC word = parser.GetWord();
+    if (word != FX_BSTRC("{")) {
+        return FALSE;
+    }
+    CPDF_PSProc proc;
+    FX_BOOL bRet = proc.Parse(parser);
+    FX_BOOL bCopy = FALSE;
+    int nOperators = _PDF_PSCountOperators(&proc, bCopy);
+    m_bFold = !bCopy && nInputs >= 0 && nInputs + nOperators < PSENGINE_STACKSIZE;
+    Compile(&proc);
+    return bRet;
+}
+void CPDF_PSProgram::Compile(const CPDF_PSProc* pProc)
+{
+    int size = pProc->m_Operators.GetSize();
+    for (int i = 0; i < size; i ++) {
+        PDF_PSOP op = (PDF_PSOP)(FX_UINTPTR)pProc->m_Operators[i];
         if (op == PSOP_PROC) {
             i ++;
         } else if (op == PSOP_CONST) {
-            pEngine->Push(*(FX_FLOAT*)m_Operators[i + 1]);
+            Emit(PSOP_CONST, *(FX_FLOAT*)pProc->m_Operators[i + 1]);
             i ++;
         } else if (op == PSOP_IF) {
-            if (i < 2 || m_Operators[i - 2] != (FX_LPVOID)PSOP_PROC) {
-                return FALSE;
+            if (i < 2 || pProc->m_Operators[i - 2] != (FX_LPVOID)PSOP_PROC) {
+                return;
             }
-            if ((int)pEngine->Pop()) {
-                ((CPDF_PSProc*)m_Operators[i - 1])->Execute(pEngine);
+            const CPDF_PSProc* pThen = (const CPDF_PSProc*)pProc->m_Operators[i - 1];
+            FX_BOOL bCondition;
+            if (PopConstCondition(bCondition)) {
+                if (bCondition) {
+                    Compile(pThen);
+                }
+                continue;
             }
+            int jump = m_Code.GetSize();
+            Emit(PSOP_JZ);
+            Compile(pThen);
+            m_Barrier = m_Code[jump].m_Target = m_Code.GetSize();
         } else if (op == PSOP_IFELSE) {
-            if (i < 4 || m_Operators[i - 2] != (FX_LPVOID)PSOP_PROC ||
-                    m_Operators[i - 4] != (FX_LPVOID)PSOP_PROC) {
-                return FALSE;
+            if (i < 4 || pProc->m_Operators[i - 2] != (FX_LPVOID)PSOP_PROC ||
+                    pProc->m_Operators[i - 4] != (FX_LPVOID)PSOP_PROC) {
+                return;
             }
-            if ((int)pEngine->Pop()) {
-                ((CPDF_PSProc*)m_Operators[i - 3])->Execute(pEngine);
-            } else {
-                ((CPDF_PSProc*)m_Operators[i - 1])->Execute(pEngine);
+            const CPDF_PSProc* pThen = (const CPDF_PSProc*)pProc->m_Operators[i - 3];
+            const CPDF_PSProc* pElse = (const CPDF_PSProc*)pProc->m_Operators[i - 1];
+            FX_BOOL bCondition;
+            if (PopConstCondition(bCondition)) {
+                Compile(bCondition ? pThen : pElse);
+                continue;
             }
-        } else {
-            pEngine->DoOperator(op);
+            int jump_else = m_Code.GetSize();
+            Emit(PSOP_JZ);
+            Compile(pThen);
+            int jump_end = m_Code.GetSize();
+            Emit(PSOP_JMP);
+            m_Barrier = m_Code[jump_else].m_Target = m_Code.GetSize();
+            Compile(pElse);
+            m_Barrier = m_Code[jump_end].m_Target = m_Code.GetSize();
+        } else if (op != PSOP_CVR) {
+            Emit(op);
         }
     }
-    return TRUE;
 }
-#pragma optimize( "", on )
-CPDF_PSEngine::CPDF_PSEngine()
-{
-    m_StackCount = 0;
-}
-CPDF_PSEngine::~CPDF_PSEngine()
+FX_BOOL CPDF_PSProgram::PopConstCondition(FX_BOOL& bCondition)
 {
+    int size = m_Code.GetSize();
+    if (!m_bFold || size <= m_Barrier || m_Code[size - 1].m_Op != PSOP_CONST) {
+        return FALSE;
+    }
+    bCondition = (int)m_Code[size - 1].m_Value != 0;
+    m_Code.RemoveAt(size - 1);
+    return TRUE;
 }
-void CPDF_PSEngine::Push(FX_FLOAT v)
+void CPDF_PSProgram::Emit(PDF_PSOP op, FX_FLOAT value)
 {
-    if (m_StackCount == 100) {
-        return;
+    int size = m_Code.GetSize();
+    int arity = m_bFold ? _PDF_PSFoldableArity(op) : -1;
+    if (arity >= 0 && size - arity >= m_Barrier) {
+        int i = size - arity;
+        for (; i < size; i ++) {
+            if (m_Code[i].m_Op != PSOP_CONST) {
+                break;
+            }
+        }
+        int divisor = arity == 2 ? (int)m_Code[size - 1].m_Value : 1;
+        if (i == size && !((op == PSOP_IDIV || op == PSOP_MOD) && (divisor == 0 || divisor == -1))) {
+            CPDF_PSEngine engine;
+            for (i = size - arity; i < size; i ++) {
+                engine.Push(m_Code[i].m_Value);
+            }
+            engine.DoOperator(op);
+            if (arity) {
+                m_Code.RemoveAt(size - arity, arity);
+            }
+            op = PSOP_CONST;
+            value = engine.Pop();
+        }
     }
-    m_Stack[m_StackCount++] = v;
+    PDF_PSCODE code;
+    code.m_Op = op;
+    code.m_Target = 0;
+    code.m_Value = value;
+    m_Code.Add(code);
 }
-FX_FLOAT CPDF_PSEngine::Pop()
+void CPDF_PSProgram::Execute(CPDF_PSEngine& engine) const
 {
-    if (m_StackCount == 0) {
-        return 0;
+    const PDF_PSCODE* pCode = m_Code.GetData();
+    int size = m_Code.GetSize();
+    int pc = 0;
+    while (pc < size) {
+        const PDF_PSCODE& code = pCode[pc ++];
+        switch (code.m_Op) {
+            case PSOP_CONST:
+                engine.Push(code.m_Value);
+                break;
+            case PSOP_JZ:
+                if (!(int)engine.Pop()) {
+                    pc = code.m_Target;
+                }
+                break;
+            case PSOP_JMP:
+                pc = code.m_Target;
+                break;
+            default:
+                engine.DoOperator(code.m_Op);
+                break;
+        }
     }
-    return m_Stack[--m_StackCount];
 }
 const struct _PDF_PSOpName {
     const FX_CHAR* name;
@@ -143,15 +329,6 @@ const struct _PDF_PSOpName {
     {"copy", PSOP_COPY}, {"index", PSOP_INDEX}, {"roll", PSOP_ROLL},
     {NULL, PSOP_PROC}
 };
-FX_BOOL CPDF_PSEngine::Parse(const FX_CHAR* string, int size)
-{
-    CPDF_SimpleParser parser((FX_LPBYTE)string, size);
-    CFX_ByteStringC word = parser.GetWord();
-    if (word != FX_BSTRC("{")) {
-        return FALSE;
-    }
-    return m_MainProc.Parse(parser);
-}
 FX_BOOL CPDF_PSProc::Parse(CPDF_SimpleParser& parser)
 {
     while (1) {
@@ -582,24 +759,23 @@ class CPDF_PSFunc : public CPDF_Function
 public:
     virtual FX_BOOL		v_Init(CPDF_Object* pObj);
     virtual FX_BOOL		v_Call(FX_FLOAT* inputs, FX_FLOAT* results) const;
-    CPDF_PSEngine m_PS;
+    CPDF_PSProgram m_Program;
 };
 FX_BOOL CPDF_PSFunc::v_Init(CPDF_Object* pObj)
 {
     CPDF_Stream* pStream = (CPDF_Stream*)pObj;
     CPDF_StreamAcc acc;
     acc.LoadAllData(pStream, FALSE);
-    return m_PS.Parse((const FX_CHAR*)acc.GetData(), acc.GetSize());
+    return m_Program.Parse((const FX_CHAR*)acc.GetData(), acc.GetSize(), m_nInputs);
 }
 FX_BOOL CPDF_PSFunc::v_Call(FX_FLOAT* inputs, FX_FLOAT* results) const
 {
-    CPDF_PSEngine& PS = (CPDF_PSEngine&)m_PS;
-    PS.Reset();
+    CPDF_PSEngine PS;
     int i;
     for (i = 0; i < m_nInputs; i ++) {
         PS.Push(inputs[i]);
     }
-    PS.Execute();
+    m_Program.Execute(PS);
     if (PS.GetStackSize() < m_nOutputs) {
         return FALSE;
     }
@@ -36,6 +36,7 @@ void CPDF_ImageObject::Transform(const CFX_AffineMatrix& matrix)
 {
     m_Matrix.Concat(matrix);
     CalcBoundingBox();
+    OnMoved();
 }
 void CPDF_ImageObject::CalcBoundingBox()
 {
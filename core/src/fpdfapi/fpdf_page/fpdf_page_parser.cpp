@@ -358,12 +358,12 @@ const struct _OpCode {
     {FXBSTR_ID('w', 0, 0, 0),		&CPDF_StreamContentParser::Handle_SetLineWidth},
     {FXBSTR_ID('y', 0, 0, 0),		&CPDF_StreamContentParser::Handle_CurveTo_13},
 };
-FX_BOOL CPDF_StreamContentParser::OnOperator(FX_LPCSTR op)
+FX_BOOL CPDF_StreamContentParser::OnOperator(FX_LPCSTR op, FX_DWORD len)
 {
-    int i = 0;
+    FX_DWORD i = 0;
     FX_DWORD opid = 0;
-    while (i < 4 && op[i]) {
-        opid = (opid << 8) + op[i];
+    while (i < 4 && i < len) {
+        opid = (opid << 8) + (FX_BYTE)op[i];
         i ++;
     }
     while (i < 4) {
@@ -927,12 +927,18 @@ void CPDF_StreamContentParser::Handle_EOFillPath()
 }
 void CPDF_StreamContentParser::Handle_SetGray_Fill()
 {
+    if (m_Options.m_bTextOnly) {
+        return;
+    }
     FX_FLOAT value = GetNumber(0);
     CPDF_ColorSpace* pCS = CPDF_ColorSpace::GetStockCS(PDFCS_DEVICEGRAY);
     m_pCurStates->m_ColorState.SetFillColor(pCS, &value, 1);
 }
 void CPDF_StreamContentParser::Handle_SetGray_Stroke()
 {
+    if (m_Options.m_bTextOnly) {
+        return;
+    }
     FX_FLOAT value = GetNumber(0);
     CPDF_ColorSpace* pCS = CPDF_ColorSpace::GetStockCS(PDFCS_DEVICEGRAY);
     m_pCurStates->m_ColorState.SetStrokeColor(pCS, &value, 1);
@@ -945,6 +951,14 @@ void CPDF_StreamContentParser::Handle_SetExtendGraphState()
         m_bResourceMissing = TRUE;
         return;
     }
+    if (m_Options.m_bTextOnly) {
+        CPDF_Array* pFont = pGS->GetArray(FX_BSTRC("Font"));
+        if (pFont) {
+            m_pCurStates->m_TextState.GetModify()->m_FontSize = pFont->GetNumber(1);
+            m_pCurStates->m_TextState.SetFont(FindFont(pFont->GetString(0)));
+        }
+        return;
+    }
     m_pCurStates->ProcessExtGS(pGS, this);
 }
 void CPDF_StreamContentParser::Handle_ClosePath()
@@ -963,6 +977,9 @@ void CPDF_StreamContentParser::Handle_ClosePath()
 }
 void CPDF_StreamContentParser::Handle_SetFlat()
 {
+    if (m_Options.m_bTextOnly) {
+        return;
+    }
 #if !defined(_FPDFAPI_MINI_) || defined(_FXCORE_FEATURE_ALL_)
     m_pCurStates->m_GeneralState.GetModify()->m_Flatness = GetNumber(0);
 #endif
@@ -972,15 +989,24 @@ void CPDF_StreamContentParser::Handle_BeginImageData()
 }
 void CPDF_StreamContentParser::Handle_SetLineJoin()
 {
+    if (m_Options.m_bTextOnly) {
+        return;
+    }
     m_pCurStates->m_GraphState.GetModify()->m_LineJoin = (CFX_GraphStateData::LineJoin)GetInteger(0);
 }
 void CPDF_StreamContentParser::Handle_SetLineCap()
 {
+    if (m_Options.m_bTextOnly) {
+        return;
+    }
     m_pCurStates->m_GraphState.GetModify()->m_LineCap = (CFX_GraphStateData::LineCap)GetInteger(0);
 }
 void CPDF_StreamContentParser::Handle_SetCMYKColor_Fill()
 {
     REQUIRE_PARAMS(4);
+    if (m_Options.m_bTextOnly) {
+        return;
+    }
     FX_FLOAT values[4];
     for (int i = 0; i < 4; i ++) {
         values[i] = GetNumber(3 - i);
@@ -991,6 +1017,9 @@ void CPDF_StreamContentParser::Handle_SetCMYKColor_Fill()
 void CPDF_StreamContentParser::Handle_SetCMYKColor_Stroke()
 {
     REQUIRE_PARAMS(4);
+    if (m_Options.m_bTextOnly) {
+        return;
+    }
     FX_FLOAT values[4];
     for (int i = 0; i < 4; i ++) {
         values[i] = GetNumber(3 - i);
@@ -1022,6 +1051,9 @@ void CPDF_StreamContentParser::Handle_MoveTo()
 }
 void CPDF_StreamContentParser::Handle_SetMiterLimit()
 {
+    if (m_Options.m_bTextOnly) {
+        return;
+    }
     m_pCurStates->m_GraphState.GetModify()->m_MiterLimit = GetNumber(0);
 }
 void CPDF_StreamContentParser::Handle_MarkPlace()
@@ -1071,6 +1103,9 @@ void CPDF_StreamContentParser::AddPathRect(FX_FLOAT x, FX_FLOAT y, FX_FLOAT w, F
 void CPDF_StreamContentParser::Handle_SetRGBColor_Fill()
 {
     REQUIRE_PARAMS(3);
+    if (m_Options.m_bTextOnly) {
+        return;
+    }
     FX_FLOAT values[3];
     for (int i = 0; i < 3; i ++) {
         values[i] = GetNumber(2 - i);
@@ -1081,6 +1116,9 @@ void CPDF_StreamContentParser::Handle_SetRGBColor_Fill()
 void CPDF_StreamContentParser::Handle_SetRGBColor_Stroke()
 {
     REQUIRE_PARAMS(3);
+    if (m_Options.m_bTextOnly) {
+        return;
+    }
     FX_FLOAT values[3];
     for (int i = 0; i < 3; i ++) {
         values[i] = GetNumber(2 - i);
@@ -1401,7 +1439,7 @@ void CPDF_StreamContentParser::AddTextObject(CFX_ByteString* pStrs, FX_FLOAT fIn
     pText->CalcPositionData(&x_advance, &y_advance, m_pCurStates->m_TextHorzScale, m_Level);
     m_pCurStates->m_TextX += x_advance;
     m_pCurStates->m_TextY += y_advance;
-    if (textmode > 3) {
+    if (textmode > 3 && !m_Options.m_bTextOnly) {
         CPDF_TextObject* pCopy = FX_NEW CPDF_TextObject;
         pCopy->Copy(pText);
         m_ClipTextList.Add(pCopy);
@@ -1535,15 +1573,24 @@ void CPDF_StreamContentParser::Handle_CurveTo_23()
 }
 void CPDF_StreamContentParser::Handle_SetLineWidth()
 {
+    if (m_Options.m_bTextOnly) {
+        return;
+    }
     FX_FLOAT width = GetNumber(0);
     m_pCurStates->m_GraphState.GetModify()->m_LineWidth = width;
 }
 void CPDF_StreamContentParser::Handle_Clip()
 {
+    if (m_Options.m_bTextOnly) {
+        return;
+    }
     m_PathClipType = FXFILL_WINDING;
 }
 void CPDF_StreamContentParser::Handle_EOClip()
 {
+    if (m_Options.m_bTextOnly) {
+        return;
+    }
     m_PathClipType = FXFILL_ALTERNATE;
 }
 void CPDF_StreamContentParser::Handle_CurveTo_13()
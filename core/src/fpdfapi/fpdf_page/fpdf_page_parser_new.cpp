@@ -576,8 +576,7 @@ void CPDF_StreamContentParser::EndKeyword()
             return;
         }
     }
-    m_pWordBuf[m_WordSize] = 0;
-    OnOperator((char*)m_pWordBuf);
+    OnOperator((FX_LPCSTR)m_pWordBuf, m_WordSize);
     ClearAllParams();
 }
 #define PAGEPARSE_STAGE_PARSE			2
@@ -18,14 +18,13 @@ extern const FX_LPCSTR _PDF_OpCharType =
     "IIIIIIIIIIIIIIIIIIIIIIIIIIIIIIII"
     "IIIIIIIIIIIIIIIIIIIIIIIIIIIIIIII"
     "IIIIIIIIIIIIIIIIIIIIIIIIIIIIIIII";
-FX_BOOL _PDF_HasInvalidOpChar(FX_LPCSTR op)
+FX_BOOL _PDF_HasInvalidOpChar(FX_LPCSTR op, FX_DWORD len)
 {
     if(!op) {
         return FALSE;
     }
-    FX_BYTE ch;
-    while((ch = *op++)) {
-        if(_PDF_OpCharType[ch] == 'I') {
+    for (FX_DWORD i = 0; i < len; i ++) {
+        if(_PDF_OpCharType[(FX_BYTE)op[i]] == 'I') {
             return TRUE;
         }
     }
@@ -49,7 +48,8 @@ FX_DWORD CPDF_StreamContentParser::Parse(FX_LPCBYTE pData, FX_DWORD dwSize, FX_D
             case CPDF_StreamParser::EndOfData:
                 return m_pSyntax->GetPos();
             case CPDF_StreamParser::Keyword:
-                if(!OnOperator((char*)syntax.GetWordBuf()) && _PDF_HasInvalidOpChar((char*)syntax.GetWordBuf())) {
+                if(!OnOperator((FX_LPCSTR)syntax.GetWordBuf(), syntax.GetWordSize()) &&
+                        _PDF_HasInvalidOpChar((FX_LPCSTR)syntax.GetWordBuf(), syntax.GetWordSize())) {
                     m_bAbort = TRUE;
                 }
                 if (m_bAbort) {
@@ -58,7 +58,7 @@ FX_DWORD CPDF_StreamContentParser::Parse(FX_LPCBYTE pData, FX_DWORD dwSize, FX_D
                 ClearAllParams();
                 break;
             case CPDF_StreamParser::Number:
-                AddNumberParam((char*)syntax.GetWordBuf(), syntax.GetWordSize());
+                AddNumberParam((FX_LPCSTR)syntax.GetWordBuf(), syntax.GetWordSize());
                 break;
             case CPDF_StreamParser::Name:
                 AddNameParam((FX_LPCSTR)syntax.GetWordBuf() + 1, syntax.GetWordSize() - 1);
@@ -103,14 +103,15 @@ void CPDF_StreamContentParser::Handle_BeginImage()
             CFX_ByteString name = pCSObj->GetString();
             if (name != FX_BSTRC("DeviceRGB") && name != FX_BSTRC("DeviceGray") && name != FX_BSTRC("DeviceCMYK")) {
                 pCSObj = FindResourceObj(FX_BSTRC("ColorSpace"), name);
-                if (pCSObj && !pCSObj->GetObjNum()) {
+                if (pCSObj && !pCSObj->GetObjNum() && !m_Options.m_bTextOnly) {
                     pCSObj = pCSObj->Clone();
                     pDict->SetAt(FX_BSTRC("ColorSpace"), pCSObj, m_pDocument);
                 }
             }
         }
     }
-    CPDF_Stream* pStream = m_pSyntax->ReadInlineStream(m_pDocument, pDict, pCSObj, m_Options.m_bDecodeInlineImage);
+    CPDF_Stream* pStream = m_pSyntax->ReadInlineStream(m_pDocument, pDict, pCSObj, m_Options.m_bDecodeInlineImage,
+                                m_Options.m_bTextOnly);
     while (1) {
         CPDF_StreamParser::SyntaxType type = m_pSyntax->ParseNextElement();
         if (type == CPDF_StreamParser::EndOfData) {
@@ -152,6 +153,7 @@ void CPDF_StreamContentParser::ParsePathObject()
         FX_BOOL bProcessed = TRUE;
         switch (type) {
             case CPDF_StreamParser::EndOfData:
+                m_pSyntax->SetPos(last_pos);
                 return;
             case CPDF_StreamParser::Keyword: {
                     int len = m_pSyntax->GetWordSize();
@@ -231,6 +233,8 @@ CPDF_StreamParser::CPDF_StreamParser(const FX_BYTE* pData, FX_DWORD dwSize)
     m_Size = dwSize;
     m_Pos = 0;
     m_pLastObj = NULL;
+    m_pWordStart = m_WordBuffer;
+    m_WordSize = 0;
 }
 CPDF_StreamParser::~CPDF_StreamParser()
 {
@@ -298,7 +302,8 @@ FX_DWORD PDF_DecodeInlineStream(const FX_BYTE* src_buf, FX_DWORD limit,
     return (FX_DWORD) - 1;
 }
 extern const FX_LPCSTR _PDF_CharType;
-CPDF_Stream* CPDF_StreamParser::ReadInlineStream(CPDF_Document* pDoc, CPDF_Dictionary* pDict, CPDF_Object* pCSObj, FX_BOOL bDecode)
+CPDF_Stream* CPDF_StreamParser::ReadInlineStream(CPDF_Document* pDoc, CPDF_Dictionary* pDict, CPDF_Object* pCSObj, FX_BOOL bDecode,
+        FX_BOOL bSkipData)
 {
     if (m_Pos == m_Size) {
         return NULL;
@@ -364,6 +369,10 @@ CPDF_Stream* CPDF_StreamParser::ReadInlineStream(CPDF_Document* pDoc, CPDF_Dicti
         if (OrigSize > m_Size - m_Pos) {
             OrigSize = m_Size - m_Pos;
         }
+        if (bSkipData) {
+            m_Pos += OrigSize;
+            return NULL;
+        }
         pData = FX_Alloc(FX_BYTE, OrigSize);
         FXSYS_memcpy32(pData, m_pBuf + m_Pos, OrigSize);
         dwStreamSize = OrigSize;
@@ -375,6 +384,13 @@ CPDF_Stream* CPDF_StreamParser::ReadInlineStream(CPDF_Document* pDoc, CPDF_Dicti
         if ((int)dwStreamSize < 0) {
             return NULL;
         }
+        if (bSkipData) {
+            if (pData) {
+                FX_Free(pData);
+            }
+            m_Pos += dwStreamSize;
+            return NULL;
+        }
         if (bDecode) {
             m_Pos += dwStreamSize;
             dwStreamSize = dwDestSize;
@@ -431,6 +447,7 @@ CPDF_StreamParser::SyntaxType CPDF_StreamParser::ParseNextElement()
         m_pLastObj->Release();
         m_pLastObj = NULL;
     }
+    m_pWordStart = m_WordBuffer;
     m_WordSize = 0;
     FX_BOOL bIsNumber = TRUE;
     if (m_Pos >= m_Size) {
@@ -465,10 +482,8 @@ CPDF_StreamParser::SyntaxType CPDF_StreamParser::ParseNextElement()
         m_pLastObj = ReadNextObject();
         return Others;
     }
+    FX_DWORD word_start = m_Pos - 1;
     while (1) {
-        if (m_WordSize < MAX_WORD_BUFFER) {
-            m_WordBuffer[m_WordSize++] = ch;
-        }
         if (type != 'N') {
             bIsNumber = FALSE;
         }
@@ -482,24 +497,27 @@ CPDF_StreamParser::SyntaxType CPDF_StreamParser::ParseNextElement()
             break;
         }
     }
-    m_WordBuffer[m_WordSize] = 0;
+    // Numbers, names and keywords are returned as views into the content data rather than
+    // copied into m_WordBuffer; callers must not use them after the data is released.
+    m_pWordStart = m_pBuf + word_start;
+    m_WordSize = m_Pos - word_start;
     if (bIsNumber) {
         return Number;
     }
-    if (m_WordBuffer[0] == '/') {
+    if (m_pWordStart[0] == '/') {
         return Name;
     }
     if (m_WordSize == 4) {
-        if (*(FX_DWORD*)m_WordBuffer == FXDWORD_TRUE) {
+        if (FXSYS_memcmp32(m_pWordStart, "true", 4) == 0) {
             m_pLastObj = CPDF_Boolean::Create(TRUE);
             return Others;
         }
-        if (*(FX_DWORD*)m_WordBuffer == FXDWORD_NULL) {
+        if (FXSYS_memcmp32(m_pWordStart, "null", 4) == 0) {
             m_pLastObj = CPDF_Null::Create();
             return Others;
         }
     } else if (m_WordSize == 5) {
-        if (*(FX_DWORD*)m_WordBuffer == FXDWORD_FALS && m_WordBuffer[4] == 'e') {
+        if (FXSYS_memcmp32(m_pWordStart, "false", 5) == 0) {
             m_pLastObj = CPDF_Boolean::Create(FALSE);
             return Others;
         }
@@ -517,6 +535,7 @@ void CPDF_StreamParser::SkipPathObject()
     while (1) {
         while (type == 'W') {
             if (m_Pos >= m_Size) {
+                m_Pos = command_startpos;
                 return;
             }
             ch = m_pBuf[m_Pos++];
@@ -529,6 +548,7 @@ void CPDF_StreamParser::SkipPathObject()
         while (1) {
             while (type != 'W') {
                 if (m_Pos >= m_Size) {
+                    m_Pos = command_startpos;
                     return;
                 }
                 ch = m_pBuf[m_Pos++];
@@ -536,6 +556,7 @@ void CPDF_StreamParser::SkipPathObject()
             }
             while (type == 'W') {
                 if (m_Pos >= m_Size) {
+                    m_Pos = command_startpos;
                     return;
                 }
                 ch = m_pBuf[m_Pos++];
@@ -547,6 +568,7 @@ void CPDF_StreamParser::SkipPathObject()
             FX_DWORD op_startpos = m_Pos - 1;
             while (type != 'W' && type != 'D') {
                 if (m_Pos >= m_Size) {
+                    m_Pos = command_startpos;
                     return;
                 }
                 ch = m_pBuf[m_Pos++];
@@ -656,6 +678,7 @@ CPDF_Object* CPDF_StreamParser::ReadNextObject(FX_BOOL bAllowNestedArray, FX_BOO
 }
 void CPDF_StreamParser::GetNextWord(FX_BOOL& bIsNumber)
 {
+    m_pWordStart = m_WordBuffer;
     m_WordSize = 0;
     bIsNumber = TRUE;
     if (m_Size <= m_Pos) {
@@ -922,9 +945,7 @@ void CPDF_ContentParser::Clear()
             }
         FX_Free(m_pStreamArray);
     }
-    if (m_pData && m_pSingleStream == NULL) {
-        FX_Free((void*)m_pData);
-    }
+    m_JoinedData.Clear();
     m_pParser = NULL;
     m_pStreamArray = NULL;
     m_pSingleStream = NULL;
@@ -945,6 +966,7 @@ void CPDF_ContentParser::Start(CPDF_Page* pPage, CPDF_ParseOptions* pOptions)
     m_Status = ToBeContinued;
     m_InternalStage = PAGEPARSE_STAGE_GETCONTENT;
     m_CurrentOffset = 0;
+    m_CurrentStream = 0;
     CPDF_Object* pContent = pPage->m_pFormDict->GetElementValue(FX_BSTRC("Contents"));
     if (pContent == NULL) {
         m_Status = Done;
@@ -1023,51 +1045,165 @@ void CPDF_ContentParser::Start(CPDF_Form* pForm, CPDF_AllStates* pGraphicStates,
     m_Status = ToBeContinued;
     m_InternalStage = PAGEPARSE_STAGE_PARSE;
     m_CurrentOffset = 0;
+    m_CurrentStream = 0;
 }
-void CPDF_ContentParser::Continue(IFX_Pause* pPause)
+// Follows the syntax of consecutive content streams far enough to tell whether the content so
+// far ends inside an array, a dictionary, a string or an inline image.
+class CPDF_ContentSegmentScanner
 {
-    int steps = 0;
-    while (m_Status == ToBeContinued) {
-        if (m_InternalStage == PAGEPARSE_STAGE_GETCONTENT) {
-            if (m_CurrentOffset == m_nStreams) {
-                if (m_pStreamArray) {
-                    m_Size = 0;
-                    FX_DWORD i;
-                    for (i = 0; i < m_nStreams; i ++) {
-                        FX_DWORD size = m_pStreamArray[i]->GetSize();
-                        if (m_Size + size + 1 <= m_Size) {
-							m_Status = Done;
-							return;
-                        }
-                        m_Size += size + 1;
+public:
+    CPDF_ContentSegmentScanner() : m_Depth(0), m_StringLevel(0), m_bHexString(FALSE), m_ImageStage(0) {}
+
+    FX_BOOL				Scan(FX_LPCBYTE pData, FX_DWORD size);
+protected:
+
+    int					m_Depth;
+
+    int					m_StringLevel;
+
+    FX_BOOL				m_bHexString;
+
+    int					m_ImageStage;
+};
+FX_BOOL CPDF_ContentSegmentScanner::Scan(FX_LPCBYTE pData, FX_DWORD size)
+{
+    FX_DWORD pos = 0;
+    while (pos < size) {
+        FX_BYTE ch = pData[pos ++];
+        if (m_ImageStage == 2) {
+            if (ch == 'E' && pos < size && pData[pos] == 'I' && (pos == 1 || _PDF_CharType[pData[pos - 2]] == 'W') &&
+                    (pos + 1 == size || _PDF_CharType[pData[pos + 1]] == 'W' || _PDF_CharType[pData[pos + 1]] == 'D')) {
+                m_ImageStage = 0;
+                pos ++;
+            }
+            continue;
+        }
+        if (m_StringLevel) {
+            if (ch == '\\') {
+                pos ++;
+            } else if (ch == '(') {
+                m_StringLevel ++;
+            } else if (ch == ')') {
+                m_StringLevel --;
+            }
+            continue;
+        }
+        if (m_bHexString) {
+            if (ch == '>') {
+                m_bHexString = FALSE;
+            }
+            continue;
+        }
+        switch (ch) {
+            case '%':
+                while (pos < size && pData[pos] != '\r' && pData[pos] != '\n') {
+                    pos ++;
+                }
+                break;
+            case '(':
+                m_StringLevel = 1;
+                break;
+            case '<':
+                if (pos < size && pData[pos] == '<') {
+                    pos ++;
+                    m_Depth ++;
+                } else {
+                    m_bHexString = TRUE;
+                }
+                break;
+            case '>':
+                if (pos < size && pData[pos] == '>') {
+                    pos ++;
+                    if (m_Depth) {
+                        m_Depth --;
                     }
-                    m_pData = FX_Alloc(FX_BYTE, m_Size);
-                    if (!m_pData) {
-                        m_Status = Done;
-                        return;
+                }
+                break;
+            case '[':
+                m_Depth ++;
+                break;
+            case ']':
+                if (m_Depth) {
+                    m_Depth --;
+                }
+                break;
+            default: {
+                    if (_PDF_CharType[ch] == 'W' || (_PDF_CharType[ch] == 'D' && ch != '/')) {
+                        break;
                     }
-                    FX_DWORD pos = 0;
-                    for (i = 0; i < m_nStreams; i ++) {
-                        FXSYS_memcpy32(m_pData + pos, m_pStreamArray[i]->GetData(), m_pStreamArray[i]->GetSize());
-                        pos += m_pStreamArray[i]->GetSize() + 1;
-                        m_pData[pos - 1] = ' ';
-                        delete m_pStreamArray[i];
+                    FX_DWORD start = pos - 1;
+                    while (pos < size && _PDF_CharType[pData[pos]] != 'W' && _PDF_CharType[pData[pos]] != 'D') {
+                        pos ++;
+                    }
+                    if (pos - start != 2) {
+                        break;
+                    }
+                    if (pData[start] == 'B' && pData[start + 1] == 'I') {
+                        m_ImageStage = 1;
+                    } else if (pData[start] == 'I' && pData[start + 1] == 'D' && m_ImageStage == 1) {
+                        m_ImageStage = 2;
+                        pos ++;
                     }
-                    FX_Free(m_pStreamArray);
-                    m_pStreamArray = NULL;
-                } else {
-                    m_pData = (FX_LPBYTE)m_pSingleStream->GetData();
-                    m_Size = m_pSingleStream->GetSize();
                 }
-                m_InternalStage = PAGEPARSE_STAGE_PARSE;
-                m_CurrentOffset = 0;
+        }
+    }
+    return m_Depth || m_StringLevel || m_bHexString || m_ImageStage;
+}
+// Makes the next stream of a /Contents array the data to parse. A stream may end in the middle
+// of an array, a dictionary or an inline image, which the parser cannot resume in other data,
+// so such a stream is joined with the following ones (separated by a blank, as PDF readers
+// concatenate them) up to the first one that ends outside of them.
+void CPDF_ContentParser::LoadNextSegment()
+{
+    m_JoinedData.Clear();
+    if (m_CurrentStream && m_pStreamArray[m_CurrentStream - 1]) {
+        delete m_pStreamArray[m_CurrentStream - 1];
+        m_pStreamArray[m_CurrentStream - 1] = NULL;
+    }
+    CPDF_Array* pContent = m_pObjects->m_pFormDict->GetArray(FX_BSTRC("Contents"));
+    CPDF_ContentSegmentScanner scanner;
+    while (1) {
+        CPDF_StreamAcc* pSegment = FX_NEW CPDF_StreamAcc;
+        m_pStreamArray[m_CurrentStream] = pSegment;
+        CPDF_Stream* pStreamObj = (CPDF_Stream*)pContent->GetElementValue(m_CurrentStream);
+        pSegment->LoadAllData(pStreamObj, FALSE);
+        m_CurrentStream ++;
+        FX_BOOL bOpen = scanner.Scan(pSegment->GetData(), pSegment->GetSize()) && m_CurrentStream < m_nStreams;
+        if (!bOpen && m_JoinedData.GetSize() == 0) {
+            m_pData = (FX_LPBYTE)pSegment->GetData();
+            m_Size = pSegment->GetSize();
+            break;
+        }
+        m_JoinedData.AppendBlock(pSegment->GetData(), pSegment->GetSize());
+        m_JoinedData.AppendByte(' ');
+        delete pSegment;
+        m_pStreamArray[m_CurrentStream - 1] = NULL;
+        if (!bOpen) {
+            m_pData = m_JoinedData.GetBuffer();
+            m_Size = m_JoinedData.GetSize();
+            break;
+        }
+    }
+    m_CurrentOffset = 0;
+}
+void CPDF_ContentParser::Continue(IFX_Pause* pPause)
+{
+    int steps = 0;
+    while (m_Status == ToBeContinued) {
+        if (m_InternalStage == PAGEPARSE_STAGE_GETCONTENT) {
+            if (m_pStreamArray) {
+                // The streams of a /Contents array are decoded and parsed one at a time rather
+                // than concatenated up front; LoadNextSegment only joins the streams that end
+                // inside an array, a dictionary or an inline image.
+                m_pData = NULL;
+                m_Size = 0;
+                m_CurrentStream = 0;
             } else {
-                CPDF_Array* pContent = m_pObjects->m_pFormDict->GetArray(FX_BSTRC("Contents"));
-                m_pStreamArray[m_CurrentOffset] = FX_NEW CPDF_StreamAcc;
-                CPDF_Stream* pStreamObj = (CPDF_Stream*)pContent->GetElementValue(m_CurrentOffset);
-                m_pStreamArray[m_CurrentOffset]->LoadAllData(pStreamObj, FALSE);
-                m_CurrentOffset ++;
+                m_pData = (FX_LPBYTE)m_pSingleStream->GetData();
+                m_Size = m_pSingleStream->GetSize();
             }
+            m_InternalStage = PAGEPARSE_STAGE_PARSE;
+            m_CurrentOffset = 0;
         }
         if (m_InternalStage == PAGEPARSE_STAGE_PARSE) {
             if (m_pParser == NULL) {
@@ -1078,7 +1214,11 @@ void CPDF_ContentParser::Continue(IFX_Pause* pPause)
                 m_pParser->m_pCurStates->m_ColorState.GetModify()->Default();
             }
             if (m_CurrentOffset >= m_Size) {
-                m_InternalStage = PAGEPARSE_STAGE_CHECKCLIP;
+                if (m_pStreamArray && m_CurrentStream < m_nStreams) {
+                    LoadNextSegment();
+                } else {
+                    m_InternalStage = PAGEPARSE_STAGE_CHECKCLIP;
+                }
             } else {
                 m_CurrentOffset += m_pParser->Parse(m_pData + m_CurrentOffset, m_Size - m_CurrentOffset, PARSE_STEP_LIMIT);
                 if (m_pParser->m_bAbort) {
@@ -1142,5 +1282,12 @@ int CPDF_ContentParser::EstimateProgress()
     if (m_InternalStage == PAGEPARSE_STAGE_CHECKCLIP) {
         return 90;
     }
+    if (m_pStreamArray) {
+        if (m_CurrentStream == 0) {
+            return 10;
+        }
+        FX_FLOAT segment = m_Size ? (FX_FLOAT)m_CurrentOffset / m_Size : 1.0f;
+        return 10 + (int)(80 * (m_CurrentStream - 1 + segment) / m_nStreams);
+    }
     return 10 + 80 * m_CurrentOffset / m_Size;
 }
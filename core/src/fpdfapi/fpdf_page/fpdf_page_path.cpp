@@ -20,6 +20,7 @@ void CPDF_PathObject::Transform(const CPDF_Matrix& matrix)
 {
     m_Matrix.Concat(matrix);
     CalcBoundingBox();
+    OnMoved();
 }
 void CPDF_PathObject::SetGraphState(CPDF_GraphState GraphState)
 {
@@ -16,13 +16,14 @@ public:
     CPDF_StreamParser(const FX_BYTE* pData, FX_DWORD dwSize);
     ~CPDF_StreamParser();
 
-    CPDF_Stream*		ReadInlineStream(CPDF_Document* pDoc, CPDF_Dictionary* pDict, CPDF_Object* pCSObj, FX_BOOL bDecode);
+    CPDF_Stream*		ReadInlineStream(CPDF_Document* pDoc, CPDF_Dictionary* pDict, CPDF_Object* pCSObj, FX_BOOL bDecode,
+                                            FX_BOOL bSkipData = FALSE);
     typedef enum { EndOfData, Number, Keyword, Name, Others } SyntaxType;
 
     SyntaxType			ParseNextElement();
-    FX_LPBYTE			GetWordBuf()
+    FX_LPCBYTE			GetWordBuf()
     {
-        return m_WordBuffer;
+        return m_pWordStart;
     }
     FX_DWORD			GetWordSize()
     {
@@ -52,7 +53,8 @@ protected:
     const FX_BYTE*		m_pBuf;
     FX_DWORD			m_Size;
     FX_DWORD			m_Pos;
-    FX_BYTE				m_WordBuffer[256];
+    FX_BYTE				m_WordBuffer[257];
+    FX_LPCBYTE			m_pWordStart;
     FX_DWORD			m_WordSize;
     CPDF_Object*		m_pLastObj;
 };
@@ -157,7 +159,7 @@ public:
     {
         return (FX_INT32)(GetNumber(index));
     }
-    FX_BOOL				OnOperator(FX_LPCSTR op);
+    FX_BOOL				OnOperator(FX_LPCSTR op, FX_DWORD len);
     void				BigCaseCaller(int index);
     FX_BOOL				m_bAbort;
 #ifndef _FPDFAPI_MINI_
@@ -334,6 +336,7 @@ public:
     int					EstimateProgress();
 protected:
     void				Clear();
+    void				LoadNextSegment();
     ParseStatus			m_Status;
     CPDF_PageObjects*	m_pObjects;
     FX_BOOL				m_bForm;
@@ -343,8 +346,10 @@ protected:
     CPDF_StreamAcc*		m_pSingleStream;
     CPDF_StreamAcc**	m_pStreamArray;
     FX_DWORD			m_nStreams;
+    FX_DWORD			m_CurrentStream;
     FX_LPBYTE			m_pData;
     FX_DWORD			m_Size;
+    CFX_BinaryBuf		m_JoinedData;
     class CPDF_StreamContentParser*	m_pParser;
     FX_DWORD			m_CurrentOffset;
     CPDF_StreamFilter*	m_pStreamFilter;
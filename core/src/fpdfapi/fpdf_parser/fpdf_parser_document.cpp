@@ -21,19 +21,31 @@ CPDF_Document::CPDF_Document(IPDF_DocParser* pParser) : CPDF_IndirectObjects(pPa
 }
 CPDF_DocPageData* CPDF_Document::GetValidatePageData()
 {
+    CPDF_DocPageData* pData = (CPDF_DocPageData*)FX_AtomicLoadPointer((FX_LPVOID volatile*)&m_pDocPage);
+    if (pData) {
+        return pData;
+    }
+    CFX_CSLock lock(&m_Lock);
     if (m_pDocPage) {
         return m_pDocPage;
     }
-    m_pDocPage = CPDF_ModuleMgr::Get()->GetPageModule()->CreateDocData(this);
-    return m_pDocPage;
+    pData = CPDF_ModuleMgr::Get()->GetPageModule()->CreateDocData(this);
+    FX_AtomicStorePointer((FX_LPVOID volatile*)&m_pDocPage, pData);
+    return pData;
 }
 CPDF_DocRenderData* CPDF_Document::GetValidateRenderData()
 {
+    CPDF_DocRenderData* pData = (CPDF_DocRenderData*)FX_AtomicLoadPointer((FX_LPVOID volatile*)&m_pDocRender);
+    if (pData) {
+        return pData;
+    }
+    CFX_CSLock lock(&m_Lock);
     if (m_pDocRender) {
         return m_pDocRender;
     }
-    m_pDocRender = CPDF_ModuleMgr::Get()->GetRenderModule()->CreateDocData(this);
-    return m_pDocRender;
+    pData = CPDF_ModuleMgr::Get()->GetRenderModule()->CreateDocData(this);
+    FX_AtomicStorePointer((FX_LPVOID volatile*)&m_pDocRender, pData);
+    return pData;
 }
 void CPDF_Document::LoadDoc()
 {
@@ -145,6 +157,7 @@ CPDF_Dictionary* CPDF_Document::GetPage(int iPage)
     if (iPage < 0 || iPage >= m_PageList.GetSize()) {
         return NULL;
     }
+    CFX_CSLock lock(&m_Lock);
     if (m_bLinearized && (iPage == (int)m_dwFirstPageNo)) {
         CPDF_Object* pObj = GetIndirectObject(m_dwFirstPageObjNum);
         if (pObj && pObj->GetType() == PDFOBJ_DICTIONARY) {
@@ -225,6 +238,7 @@ int CPDF_Document::_FindPageIndex(CPDF_Dictionary* pNode, FX_DWORD& skip_count,
 }
 int CPDF_Document::GetPageIndex(FX_DWORD objnum)
 {
+    CFX_CSLock lock(&m_Lock);
     FX_DWORD nPages = m_PageList.GetSize();
     FX_DWORD skip_count = 0;
     FX_BOOL bSkipped = FALSE;
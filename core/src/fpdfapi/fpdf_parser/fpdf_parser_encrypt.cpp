@@ -793,6 +793,23 @@ FX_BOOL CPDF_StandardCryptoHandler::CryptStream(FX_LPVOID context, FX_LPCBYTE sr
     FX_DWORD src_off = 0;
     FX_DWORD src_left = src_size;
     while (1) {
+        if (pContext->m_BlockOffset == 0 && (bEncrypt || !pContext->m_bIV) && src_left > 16) {
+            // Run all whole blocks straight from the source in one call. The last block, which may
+            // be the padding one, is still kept back for CryptFinish.
+            FX_DWORD bulk_size = (src_left - 1) / 16 * 16;
+            int old_size = dest_buf.GetSize();
+            dest_buf.AppendBlock(NULL, bulk_size);
+            if (!dest_buf.GetBuffer()) {
+                return FALSE;
+            }
+            if (bEncrypt) {
+                CRYPT_AESEncrypt(pContext->m_Context, dest_buf.GetBuffer() + old_size, src_buf + src_off, bulk_size);
+            } else {
+                CRYPT_AESDecrypt(pContext->m_Context, dest_buf.GetBuffer() + old_size, src_buf + src_off, bulk_size);
+            }
+            src_off += bulk_size;
+            src_left -= bulk_size;
+        }
         FX_DWORD copy_size = 16 - pContext->m_BlockOffset;
         if (copy_size > src_left) {
             copy_size = src_left;
@@ -1143,10 +1143,20 @@ void CPDF_StreamAcc::LoadAllData(const CPDF_Stream* pStream, FX_BOOL bRawAccess,
     if (dwSrcSize == 0) {
         return;
     }
+    FX_BOOL bMappedSrc = FALSE;
     if (!pStream->IsMemoryBased()) {
-        pSrcData = m_pSrcData = FX_Alloc(FX_BYTE, dwSrcSize);
-        if (!pSrcData || !pStream->ReadRawData(0, pSrcData, dwSrcSize)) {
-            return;
+        FX_LPCBYTE pMapped = NULL;
+        if (pStream->m_pFile && (pStream->m_pCryptoHandler || (pStream->GetDict()->KeyExist(FX_BSTRC("Filter")) && !bRawAccess))) {
+            pMapped = pStream->m_pFile->GetMappedData();
+        }
+        if (pMapped && pStream->m_FileOffset >= 0 && pStream->m_FileOffset + (FX_FILESIZE)dwSrcSize <= pStream->m_pFile->GetSize()) {
+            pSrcData = (FX_LPBYTE)pMapped + pStream->m_FileOffset;
+            bMappedSrc = TRUE;
+        } else {
+            pSrcData = m_pSrcData = FX_Alloc(FX_BYTE, dwSrcSize);
+            if (!pSrcData || !pStream->ReadRawData(0, pSrcData, dwSrcSize)) {
+                return;
+            }
         }
     } else {
         pSrcData = pStream->m_pDataBuf;
@@ -1177,7 +1187,13 @@ void CPDF_StreamAcc::LoadAllData(const CPDF_Stream* pStream, FX_BOOL bRawAccess,
             m_dwSize = dwDecryptedSize;
         }
     }
-    if (pSrcData != pStream->m_pDataBuf && pSrcData != m_pData) {
+    if (m_pData == pSrcData && bMappedSrc) {
+        m_pData = FX_Alloc(FX_BYTE, m_dwSize);
+        if (m_pData) {
+            FXSYS_memcpy32(m_pData, pSrcData, m_dwSize);
+        }
+    }
+    if (!bMappedSrc && pSrcData != pStream->m_pDataBuf && pSrcData != m_pData) {
         FX_Free(pSrcData);
     }
     if (pDecryptedData != pSrcData && pDecryptedData != m_pData) {
@@ -1259,6 +1275,7 @@ CPDF_Object* CPDF_IndirectObjects::GetIndirectObject(FX_DWORD objnum, struct PAR
     if (objnum == 0) {
         return NULL;
     }
+    CFX_CSLock lock(&m_Lock);
     FX_LPVOID value;
     {
         if (m_IndirectObjs.Lookup((FX_LPVOID)(FX_UINTPTR)objnum, value)) {
@@ -1289,6 +1306,7 @@ CPDF_Object* CPDF_IndirectObjects::GetIndirectObject(FX_DWORD objnum, struct PAR
 }
 int CPDF_IndirectObjects::GetIndirectType(FX_DWORD objnum)
 {
+    CFX_CSLock lock(&m_Lock);
     FX_LPVOID value;
     if (m_IndirectObjs.Lookup((FX_LPVOID)(FX_UINTPTR)objnum, value)) {
         return ((CPDF_Object*)value)->GetType();
@@ -1306,6 +1324,7 @@ FX_DWORD CPDF_IndirectObjects::AddIndirectObject(CPDF_Object* pObj)
     if (pObj->m_ObjNum) {
         return pObj->m_ObjNum;
     }
+    CFX_CSLock lock(&m_Lock);
     m_LastObjNum ++;
     m_IndirectObjs.SetAt((FX_LPVOID)(FX_UINTPTR)m_LastObjNum, pObj);
     pObj->m_ObjNum = m_LastObjNum;
@@ -1313,6 +1332,7 @@ FX_DWORD CPDF_IndirectObjects::AddIndirectObject(CPDF_Object* pObj)
 }
 void CPDF_IndirectObjects::ReleaseIndirectObject(FX_DWORD objnum)
 {
+    CFX_CSLock lock(&m_Lock);
     FX_LPVOID value;
     if (!m_IndirectObjs.Lookup((FX_LPVOID)(FX_UINTPTR)objnum, value)) {
         return;
@@ -1328,6 +1348,7 @@ void CPDF_IndirectObjects::InsertIndirectObject(FX_DWORD objnum, CPDF_Object* pO
     if (objnum == 0 || pObj == NULL) {
         return;
     }
+    CFX_CSLock lock(&m_Lock);
     FX_LPVOID value;
     if (m_IndirectObjs.Lookup((FX_LPVOID)(FX_UINTPTR)objnum, value)) {
         ((CPDF_Object*)value)->Destroy();
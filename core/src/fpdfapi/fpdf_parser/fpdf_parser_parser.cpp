@@ -40,6 +40,83 @@ static int _CompareFileSize(const void* p1, const void* p2)
     }
     return 0;
 }
+class CPDF_ObjectStreamIndex : public CFX_Object
+{
+public:
+
+    CPDF_ObjectStreamIndex(CPDF_StreamAcc* pStreamAcc);
+
+    FX_BOOL			GetObjectRange(FX_DWORD objnum, FX_DWORD& offset, FX_DWORD& size) const;
+
+    int				CountObjects() const
+    {
+        return m_ObjNums.GetSize();
+    }
+
+    FX_DWORD		GetObjNum(int index) const
+    {
+        return m_ObjNums[index];
+    }
+protected:
+
+    FX_DWORD		m_DataSize;
+
+    CFX_DWordArray	m_ObjNums;
+
+    CFX_DWordArray	m_Offsets;
+
+    CFX_CMapDWordToDWord	m_IndexMap;
+};
+CPDF_ObjectStreamIndex::CPDF_ObjectStreamIndex(CPDF_StreamAcc* pStreamAcc)
+{
+    m_DataSize = pStreamAcc->GetSize();
+    FX_INT32 n = pStreamAcc->GetDict()->GetInteger(FX_BSTRC("N"));
+    FX_INT32 first = pStreamAcc->GetDict()->GetInteger(FX_BSTRC("First"));
+    if (n <= 0 || first < 0) {
+        return;
+    }
+    FX_DWORD table_end = FX_MIN((FX_DWORD)first, m_DataSize);
+    if ((FX_DWORD)n > table_end / 2) {
+        n = table_end / 2;
+    }
+    CPDF_SyntaxParser syntax;
+    CFX_SmartPointer<IFX_FileStream> file(FX_CreateMemoryStream((FX_LPBYTE)pStreamAcc->GetData(), (size_t)m_DataSize, FALSE));
+    syntax.InitParser((IFX_FileStream*)file, 0);
+    m_ObjNums.SetSize(0, n);
+    m_Offsets.SetSize(0, n);
+    m_IndexMap.EstimateSize(n, n);
+    while (n) {
+        if (syntax.SavePos() >= (FX_FILESIZE)table_end) {
+            break;
+        }
+        FX_DWORD thisnum = syntax.GetDirectNum();
+        FX_DWORD thisoff = syntax.GetDirectNum();
+        FX_DWORD index;
+        if (!m_IndexMap.Lookup(thisnum, index)) {
+            m_IndexMap.SetAt(thisnum, m_ObjNums.GetSize());
+        }
+        m_ObjNums.Add(thisnum);
+        m_Offsets.Add(first + thisoff);
+        n --;
+    }
+}
+FX_BOOL CPDF_ObjectStreamIndex::GetObjectRange(FX_DWORD objnum, FX_DWORD& offset, FX_DWORD& size) const
+{
+    FX_DWORD index;
+    if (!m_IndexMap.Lookup(objnum, index)) {
+        return FALSE;
+    }
+    offset = m_Offsets[index];
+    if (offset > m_DataSize) {
+        return FALSE;
+    }
+    FX_DWORD end = m_DataSize;
+    if ((int)index + 1 < m_Offsets.GetSize() && m_Offsets[index + 1] >= offset && m_Offsets[index + 1] <= m_DataSize) {
+        end = m_Offsets[index + 1];
+    }
+    size = end - offset;
+    return TRUE;
+}
 CPDF_Parser::CPDF_Parser()
 {
     m_pDocument = NULL;
@@ -81,15 +158,9 @@ void CPDF_Parser::CloseParser(FX_BOOL bReParse)
     if (m_bOwnFileRead && m_Syntax.m_pFileAccess != NULL) {
         m_Syntax.m_pFileAccess->Release();
         m_Syntax.m_pFileAccess = NULL;
+        m_Syntax.m_pMappedData = NULL;
     }
-    FX_POSITION pos = m_ObjectStreamMap.GetStartPosition();
-    while (pos) {
-        FX_LPVOID objnum;
-        CPDF_StreamAcc* pStream;
-        m_ObjectStreamMap.GetNextAssoc(pos, objnum, (void*&)pStream);
-        delete pStream;
-    }
-    m_ObjectStreamMap.RemoveAll();
+    ReleaseObjectStreams();
     m_SortedOffset.RemoveAll();
     m_CrossRef.RemoveAll();
     m_V5Type.RemoveAll();
@@ -1183,23 +1254,16 @@ CPDF_Object* CPDF_Parser::ParseIndirectObject(CPDF_IndirectObjects* pObjList, FX
         if (pObjStream == NULL) {
             return NULL;
         }
-        FX_INT32 n = pObjStream->GetDict()->GetInteger(FX_BSTRC("N"));
-        FX_INT32 offset = pObjStream->GetDict()->GetInteger(FX_BSTRC("First"));
+        CPDF_ObjectStreamIndex* pIndex = GetObjectStreamIndex((FX_DWORD)m_CrossRef[objnum]);
+        FX_DWORD offset, size;
+        if (pIndex == NULL || !pIndex->GetObjectRange(objnum, offset, size)) {
+            return NULL;
+        }
         CPDF_SyntaxParser syntax;
         CFX_SmartPointer<IFX_FileStream> file(FX_CreateMemoryStream((FX_LPBYTE)pObjStream->GetData(), (size_t)pObjStream->GetSize(), FALSE));
         syntax.InitParser((IFX_FileStream*)file, 0);
-        CPDF_Object* pRet = NULL;
-        while (n) {
-            FX_DWORD thisnum = syntax.GetDirectNum();
-            FX_DWORD thisoff = syntax.GetDirectNum();
-            if (thisnum == objnum) {
-                syntax.RestorePos(offset + thisoff);
-                pRet = syntax.GetObject(pObjList, 0, 0, 0, pContext);
-                break;
-            }
-            n --;
-        }
-        return pRet;
+        syntax.RestorePos(offset);
+        return syntax.GetObject(pObjList, 0, 0, 0, pContext);
     }
     return NULL;
 }
@@ -1218,6 +1282,58 @@ CPDF_StreamAcc* CPDF_Parser::GetObjectStream(FX_DWORD objnum)
     m_ObjectStreamMap.SetAt((void*)(FX_UINTPTR)objnum, pStreamAcc);
     return pStreamAcc;
 }
+CPDF_ObjectStreamIndex* CPDF_Parser::GetObjectStreamIndex(FX_DWORD objnum)
+{
+    CPDF_ObjectStreamIndex* pIndex = NULL;
+    if (m_ObjectStreamIndexMap.Lookup((void*)(FX_UINTPTR)objnum, (void*&)pIndex)) {
+        return pIndex;
+    }
+    CPDF_StreamAcc* pStreamAcc = GetObjectStream(objnum);
+    if (pStreamAcc == NULL) {
+        return NULL;
+    }
+    pIndex = FX_NEW CPDF_ObjectStreamIndex(pStreamAcc);
+    m_ObjectStreamIndexMap.SetAt((void*)(FX_UINTPTR)objnum, pIndex);
+    return pIndex;
+}
+void CPDF_Parser::ReleaseObjectStreams()
+{
+    FX_POSITION pos = m_ObjectStreamMap.GetStartPosition();
+    while (pos) {
+        FX_LPVOID objnum;
+        CPDF_StreamAcc* pStream;
+        m_ObjectStreamMap.GetNextAssoc(pos, objnum, (void*&)pStream);
+        delete pStream;
+    }
+    m_ObjectStreamMap.RemoveAll();
+    pos = m_ObjectStreamIndexMap.GetStartPosition();
+    while (pos) {
+        FX_LPVOID objnum;
+        CPDF_ObjectStreamIndex* pIndex;
+        m_ObjectStreamIndexMap.GetNextAssoc(pos, objnum, (void*&)pIndex);
+        delete pIndex;
+    }
+    m_ObjectStreamIndexMap.RemoveAll();
+}
+int CPDF_Parser::LoadObjectStream(FX_DWORD stream_objnum)
+{
+    CPDF_ObjectStreamIndex* pIndex = GetObjectStreamIndex(stream_objnum);
+    if (pIndex == NULL || m_pDocument == NULL) {
+        return 0;
+    }
+    int nLoaded = 0;
+    int count = pIndex->CountObjects();
+    for (int i = 0; i < count; i ++) {
+        FX_DWORD objnum = pIndex->GetObjNum(i);
+        if (objnum >= (FX_DWORD)m_CrossRef.GetSize() || m_V5Type[objnum] != 2 || (FX_DWORD)m_CrossRef[objnum] != stream_objnum) {
+            continue;
+        }
+        if (m_pDocument->GetIndirectObject(objnum)) {
+            nLoaded ++;
+        }
+    }
+    return nLoaded;
+}
 FX_FILESIZE CPDF_Parser::GetObjectSize(FX_DWORD objnum)
 {
     if (objnum >= (FX_DWORD)m_CrossRef.GetSize()) {
@@ -1254,30 +1370,14 @@ void CPDF_Parser::GetIndirectBinary(FX_DWORD objnum, FX_LPBYTE& pBuffer, FX_DWOR
         if (pObjStream == NULL) {
             return;
         }
-        FX_INT32 n = pObjStream->GetDict()->GetInteger(FX_BSTRC("N"));
-        FX_INT32 offset = pObjStream->GetDict()->GetInteger(FX_BSTRC("First"));
-        CPDF_SyntaxParser syntax;
-        FX_LPCBYTE pData = pObjStream->GetData();
-        FX_DWORD totalsize = pObjStream->GetSize();
-        CFX_SmartPointer<IFX_FileStream> file(FX_CreateMemoryStream((FX_LPBYTE)pData, (size_t)totalsize, FALSE));
-        syntax.InitParser((IFX_FileStream*)file, 0);
-        while (n) {
-            FX_DWORD thisnum = syntax.GetDirectNum();
-            FX_DWORD thisoff = syntax.GetDirectNum();
-            if (thisnum == objnum) {
-                if (n == 1) {
-                    size = totalsize - (thisoff + offset);
-                } else {
-                    FX_DWORD nextnum = syntax.GetDirectNum();
-                    FX_DWORD nextoff = syntax.GetDirectNum();
-                    size = nextoff - thisoff;
-                }
-                pBuffer = FX_Alloc(FX_BYTE, size);
-                FXSYS_memcpy32(pBuffer, pData + thisoff + offset, size);
-                return;
-            }
-            n --;
+        CPDF_ObjectStreamIndex* pIndex = GetObjectStreamIndex((FX_DWORD)m_CrossRef[objnum]);
+        FX_DWORD offset;
+        if (pIndex == NULL || !pIndex->GetObjectRange(objnum, offset, size)) {
+            size = 0;
+            return;
         }
+        pBuffer = FX_Alloc(FX_BYTE, size);
+        FXSYS_memcpy32(pBuffer, pObjStream->GetData() + offset, size);
         return;
     }
     if (m_V5Type[objnum] == 1) {
@@ -1527,6 +1627,7 @@ FX_DWORD CPDF_Parser::StartAsynParse(IFX_FileRead* pFileAccess, FX_BOOL bReParse
     }
     if (!IsLinearizedFile(pFileAccess, offset)) {
         m_Syntax.m_pFileAccess = NULL;
+        m_Syntax.m_pMappedData = NULL;
         return StartParse(pFileAccess, bReParse, bOwnFileRead);
     }
     if (!bReParse) {
@@ -1634,14 +1735,7 @@ FX_DWORD CPDF_Parser::LoadLinearizedMainXRefTable()
         type = _PDF_CharType[ch];
     }
     m_LastXRefOffset += dwCount;
-    FX_POSITION pos = m_ObjectStreamMap.GetStartPosition();
-    while (pos) {
-        FX_LPVOID objnum;
-        CPDF_StreamAcc* pStream;
-        m_ObjectStreamMap.GetNextAssoc(pos, objnum, (void*&)pStream);
-        delete pStream;
-    }
-    m_ObjectStreamMap.RemoveAll();
+    ReleaseObjectStreams();
     if (!LoadLinearizedAllCrossRefV4(m_LastXRefOffset, m_dwXrefStartObjNum) && !LoadLinearizedAllCrossRefV5(m_LastXRefOffset)) {
         m_LastXRefOffset = 0;
         m_Syntax.m_MetadataObjnum = dwSaveMetadataObjnum;
@@ -1656,6 +1750,7 @@ CPDF_SyntaxParser::CPDF_SyntaxParser()
     m_pFileAccess = NULL;
     m_pCryptoHandler = NULL;
     m_pFileBuf = NULL;
+    m_pMappedData = NULL;
     m_BufSize = CPDF_ModuleMgr::Get()->m_FileBufSize;
     m_pFileBuf = NULL;
     m_MetadataObjnum = 0;
@@ -1686,6 +1781,14 @@ FX_BOOL CPDF_SyntaxParser::GetNextChar(FX_BYTE& ch)
     if (pos >= m_FileLen) {
         return FALSE;
     }
+    if (m_pMappedData) {
+        if (pos < 0) {
+            return FALSE;
+        }
+        ch = m_pMappedData[pos];
+        m_Pos ++;
+        return TRUE;
+    }
     if (m_BufOffset >= pos || (FX_FILESIZE)(m_BufOffset + m_BufSize) <= pos) {
         FX_FILESIZE read_pos = pos;
         FX_DWORD read_size = m_BufSize;
@@ -1715,6 +1818,13 @@ FX_BOOL CPDF_SyntaxParser::GetCharAtBackward(FX_FILESIZE pos, FX_BYTE& ch)
     if (pos >= m_FileLen) {
         return FALSE;
     }
+    if (m_pMappedData) {
+        if (pos < 0) {
+            return FALSE;
+        }
+        ch = m_pMappedData[pos];
+        return TRUE;
+    }
     if (m_BufOffset >= pos || (FX_FILESIZE)(m_BufOffset + m_BufSize) <= pos) {
         FX_FILESIZE read_pos;
         if (pos < (FX_FILESIZE)m_BufSize) {
@@ -1741,6 +1851,15 @@ FX_BOOL CPDF_SyntaxParser::GetCharAtBackward(FX_FILESIZE pos, FX_BYTE& ch)
 }
 FX_BOOL CPDF_SyntaxParser::ReadBlock(FX_LPBYTE pBuf, FX_DWORD size)
 {
+    if (m_pMappedData) {
+        FX_FILESIZE pos = m_Pos + m_HeaderOffset;
+        if (pos < 0 || pos > m_FileLen || (FX_FILESIZE)size > m_FileLen - pos) {
+            return FALSE;
+        }
+        FXSYS_memcpy32(pBuf, m_pMappedData + pos, size);
+        m_Pos += size;
+        return TRUE;
+    }
     if (!m_pFileAccess->ReadBlock(pBuf, m_Pos + m_HeaderOffset, size)) {
         return FALSE;
     }
@@ -2493,12 +2612,16 @@ void CPDF_SyntaxParser::InitParser(IFX_FileRead* pFileAccess, FX_DWORD HeaderOff
         FX_Free(m_pFileBuf);
         m_pFileBuf = NULL;
     }
-    m_pFileBuf = FX_Alloc(FX_BYTE, m_BufSize);
     m_HeaderOffset = HeaderOffset;
     m_FileLen = pFileAccess->GetSize();
     m_Pos = 0;
     m_pFileAccess = pFileAccess;
     m_BufOffset = 0;
+    m_pMappedData = pFileAccess->GetMappedData();
+    if (m_pMappedData) {
+        return;
+    }
+    m_pFileBuf = FX_Alloc(FX_BYTE, m_BufSize);
     pFileAccess->ReadBlock(m_pFileBuf, 0, (size_t)((FX_FILESIZE)m_BufSize > m_FileLen ? m_FileLen : m_BufSize));
 }
 FX_INT32 CPDF_SyntaxParser::GetDirectNum()
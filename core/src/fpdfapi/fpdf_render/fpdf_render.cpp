@@ -21,6 +21,7 @@ CPDF_DocRenderData::~CPDF_DocRenderData()
 }
 void CPDF_DocRenderData::Clear(FX_BOOL bRelease)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     FX_POSITION pos;
     {
         pos = m_Type3FaceMap.GetStartPosition();
@@ -66,6 +67,7 @@ FX_BOOL CPDF_DocRenderData::Initialize()
 }
 CPDF_Type3Cache* CPDF_DocRenderData::GetCachedType3(CPDF_Type3Font* pFont)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     CPDF_CountedObject<CPDF_Type3Cache*>* pCache;
     if (!m_Type3FaceMap.Lookup(pFont, pCache)) {
         CPDF_Type3Cache* pType3 = FX_NEW CPDF_Type3Cache(pFont);
@@ -79,6 +81,7 @@ CPDF_Type3Cache* CPDF_DocRenderData::GetCachedType3(CPDF_Type3Font* pFont)
 }
 void CPDF_DocRenderData::ReleaseCachedType3(CPDF_Type3Font* pFont)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     CPDF_CountedObject<CPDF_Type3Cache*>* pCache;
     if (!m_Type3FaceMap.Lookup(pFont, pCache)) {
         return;
@@ -280,6 +283,17 @@ void CPDF_RenderStatus::RenderObjectList(const CPDF_PageObjects* pObjs, const CF
     CFX_AffineMatrix device2object;
     device2object.SetReverse(*pObj2Device);
     device2object.TransformRect(clip_rect);
+    if (m_pStopObj == NULL && pObjs->IsParsed() && pObjs->CountObjects() >= PDF_OBJECTGRID_THRESHOLD) {
+        CFX_ArrayTemplate<FX_POSITION> positions;
+        pObjs->GetObjectsInRect(clip_rect, positions);
+        for (int i = 0; i < positions.GetSize(); i ++) {
+            RenderSingleObject(pObjs->GetObjectAt(positions[i]), pObj2Device);
+            if (m_bStopped) {
+                return;
+            }
+        }
+        return;
+    }
     int index = 0;
     FX_POSITION pos = pObjs->GetFirstObjectPosition();
     while(pos) {
@@ -1077,6 +1091,7 @@ CPDF_ProgressiveRenderer::CPDF_ProgressiveRenderer()
     m_pContext = NULL;
     m_pDevice = NULL;
     m_Status = Ready;
+    m_VisibleIndex = -1;
 }
 CPDF_ProgressiveRenderer::~CPDF_ProgressiveRenderer()
 {
@@ -1111,6 +1126,7 @@ void CPDF_ProgressiveRenderer::Start(CPDF_RenderContext* pContext, CFX_RenderDev
     m_LayerIndex = 0;
     m_ObjectIndex = 0;
     m_PrevLastPos = NULL;
+    m_VisibleIndex = -1;
     Continue(pPause);
 }
 #ifdef _FPDFAPI_MINI_
@@ -1166,6 +1182,12 @@ void CPDF_ProgressiveRenderer::Continue(IFX_Pause* pPause)
             CFX_AffineMatrix device2object;
             device2object.SetReverse(pItem->m_Matrix);
             device2object.TransformRect(m_ClipRect);
+            m_VisibleIndex = -1;
+            if (pItem->m_pObjectList->IsParsed() && pItem->m_pObjectList->CountObjects() >= PDF_OBJECTGRID_THRESHOLD) {
+                pItem->m_pObjectList->GetObjectsInRect(m_ClipRect, m_VisibleObjects);
+                m_VisibleIndex = 0;
+                m_ObjectPos = m_VisibleObjects.GetSize() ? m_VisibleObjects[0] : NULL;
+            }
         }
         int objs_to_go = CPDF_ModuleMgr::Get()->GetRenderModule()->GetConfig()->m_RenderStepLimit;
         while (m_ObjectPos) {
@@ -1186,8 +1208,14 @@ void CPDF_ProgressiveRenderer::Continue(IFX_Pause* pPause)
                     objs_to_go --;
                 }
             }
-            m_ObjectIndex ++;
-            pItem->m_pObjectList->GetNextObject(m_ObjectPos);
+            if (m_VisibleIndex >= 0) {
+                m_VisibleIndex ++;
+                m_ObjectPos = m_VisibleIndex < m_VisibleObjects.GetSize() ? m_VisibleObjects[m_VisibleIndex] : NULL;
+                m_ObjectIndex = (FX_DWORD)((FX_FLOAT)m_VisibleIndex / m_VisibleObjects.GetSize() * pItem->m_pObjectList->CountObjects());
+            } else {
+                m_ObjectIndex ++;
+                pItem->m_pObjectList->GetNextObject(m_ObjectPos);
+            }
             if (objs_to_go == 0) {
                 if (pPause && pPause->NeedToPauseNow()) {
                     return;
@@ -1203,6 +1231,8 @@ void CPDF_ProgressiveRenderer::Continue(IFX_Pause* pPause)
         m_pDevice->RestoreState();
         m_ObjectPos = NULL;
         m_PrevLastPos = NULL;
+        m_VisibleIndex = -1;
+        m_VisibleObjects.RemoveAll();
         if (pPause && pPause->NeedToPauseNow()) {
             m_LayerIndex++;
             return;
@@ -1234,6 +1264,7 @@ int CPDF_ProgressiveRenderer::EstimateProgress()
 }
 CPDF_TransferFunc* CPDF_DocRenderData::GetTransferFunc(CPDF_Object* pObj)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     if (pObj == NULL) {
         return NULL;
     }
@@ -1311,6 +1342,7 @@ CPDF_TransferFunc* CPDF_DocRenderData::GetTransferFunc(CPDF_Object* pObj)
 }
 void CPDF_DocRenderData::ReleaseTransferFunc(CPDF_Object* pObj)
 {
+    CFX_CSLock lock(m_pPDFDoc->GetLock());
     CPDF_CountedObject<CPDF_TransferFunc*>* pTransferCounter;
     if (!m_TransferFuncMap.Lookup(pObj, pTransferCounter)) {
         return;
@@ -106,7 +106,7 @@ FX_DWORD CPDF_PageRenderCache::GetCachedSize(CPDF_Stream* pStream) const
 }
 void CPDF_PageRenderCache::GetCachedBitmap(CPDF_Stream* pStream, CFX_DIBSource*& pBitmap, CFX_DIBSource*& pMask, FX_DWORD& MatteColor,
         FX_BOOL bStdCS, FX_DWORD GroupFamily, FX_BOOL bLoadMask, CPDF_RenderStatus* pRenderStatus,
-        FX_INT32 downsampleWidth, FX_INT32 downsampleHeight)
+        FX_INT32 downsampleWidth, FX_INT32 downsampleHeight, const FX_RECT* pJpxWindow)
 {
     CPDF_ImageCache* pImageCache;
     FX_BOOL bFind = m_ImageCaches.Lookup(pStream, (FX_LPVOID&)pImageCache);
@@ -114,21 +114,24 @@ void CPDF_PageRenderCache::GetCachedBitmap(CPDF_Stream* pStream, CFX_DIBSource*&
         pImageCache = FX_NEW CPDF_ImageCache(m_pPage->m_pDocument, pStream);
     }
     m_nTimeCount ++;
-    FX_BOOL bCached = pImageCache->GetCachedBitmap(pBitmap, pMask, MatteColor, m_pPage->m_pPageResources, bStdCS, GroupFamily, bLoadMask, pRenderStatus, downsampleWidth, downsampleHeight);
+    FX_DWORD oldsize = pImageCache->EstimateSize();
+    FX_BOOL bCached = pImageCache->GetCachedBitmap(pBitmap, pMask, MatteColor, m_pPage->m_pPageResources, bStdCS, GroupFamily, bLoadMask, pRenderStatus, downsampleWidth, downsampleHeight, pJpxWindow);
     if (!bFind) {
         m_ImageCaches.SetAt(pStream, pImageCache);
     }
     if (!bCached) {
-        m_nCacheSize += pImageCache->EstimateSize();
+        m_nCacheSize += pImageCache->EstimateSize() - oldsize;
     }
 }
-FX_BOOL	CPDF_PageRenderCache::StartGetCachedBitmap(CPDF_Stream* pStream, FX_BOOL bStdCS, FX_DWORD GroupFamily, FX_BOOL bLoadMask, CPDF_RenderStatus* pRenderStatus, FX_INT32 downsampleWidth, FX_INT32 downsampleHeight)
+FX_BOOL	CPDF_PageRenderCache::StartGetCachedBitmap(CPDF_Stream* pStream, FX_BOOL bStdCS, FX_DWORD GroupFamily, FX_BOOL bLoadMask, CPDF_RenderStatus* pRenderStatus, FX_INT32 downsampleWidth, FX_INT32 downsampleHeight, const FX_RECT* pJpxWindow)
 {
     m_bCurFindCache = m_ImageCaches.Lookup(pStream, (FX_LPVOID&)m_pCurImageCache);
     if (!m_bCurFindCache) {
         m_pCurImageCache = FX_NEW CPDF_ImageCache(m_pPage->m_pDocument, pStream);
+    } else {
+        m_nCacheSize -= m_pCurImageCache->EstimateSize();
     }
-    int ret = m_pCurImageCache->StartGetCachedBitmap(pRenderStatus->m_pFormResource, m_pPage->m_pPageResources, bStdCS, GroupFamily, bLoadMask, pRenderStatus, downsampleWidth, downsampleHeight);
+    int ret = m_pCurImageCache->StartGetCachedBitmap(pRenderStatus->m_pFormResource, m_pPage->m_pPageResources, bStdCS, GroupFamily, bLoadMask, pRenderStatus, downsampleWidth, downsampleHeight, pJpxWindow);
     if (ret == 2) {
         return TRUE;
     }
@@ -136,9 +139,7 @@ FX_BOOL	CPDF_PageRenderCache::StartGetCachedBitmap(CPDF_Stream* pStream, FX_BOOL
     if (!m_bCurFindCache) {
         m_ImageCaches.SetAt(pStream, m_pCurImageCache);
     }
-    if (!ret) {
-        m_nCacheSize += m_pCurImageCache->EstimateSize();
-    }
+    m_nCacheSize += m_pCurImageCache->EstimateSize();
     return FALSE;
 }
 FX_BOOL	CPDF_PageRenderCache::Continue(IFX_Pause* pPause)
@@ -151,9 +152,7 @@ FX_BOOL	CPDF_PageRenderCache::Continue(IFX_Pause* pPause)
     if (!m_bCurFindCache) {
         m_ImageCaches.SetAt(m_pCurImageCache->GetStream(), m_pCurImageCache);
     }
-    if (!ret) {
-        m_nCacheSize += m_pCurImageCache->EstimateSize();
-    }
+    m_nCacheSize += m_pCurImageCache->EstimateSize();
     return FALSE;
 }
 void CPDF_PageRenderCache::ResetBitmap(CPDF_Stream* pStream, const CFX_DIBitmap* pBitmap)
@@ -176,6 +175,8 @@ CPDF_ImageCache::CPDF_ImageCache(CPDF_Document* pDoc, CPDF_Stream* pStream)
     , m_pCachedBitmap(NULL)
     , m_pCachedMask(NULL)
     , m_dwCacheSize(0)
+    , m_JpxReduceLevel(0)
+    , m_JpxWindow(0, 0, 0, 0)
     , m_dwTimeCount(0)
     , m_pCurBitmap(NULL)
     , m_pCurMask(NULL)
@@ -203,6 +204,25 @@ void CPDF_ImageCache::Reset(const CFX_DIBitmap* pBitmap)
     if (pBitmap) {
         m_pCachedBitmap = pBitmap->Clone();
     }
+    m_JpxWindow = FX_RECT(0, 0, 0, 0);
+    CalcSize();
+}
+void CPDF_ImageCache::ReleaseReducedBitmap(int reduce_level, const FX_RECT* pJpxWindow)
+{
+    FX_BOOL bCovered = m_JpxWindow.IsEmpty() || (pJpxWindow && !pJpxWindow->IsEmpty() && m_JpxWindow.Contains(*pJpxWindow));
+    if (reduce_level >= m_JpxReduceLevel && bCovered) {
+        return;
+    }
+    if (m_pCachedBitmap) {
+        delete m_pCachedBitmap;
+        m_pCachedBitmap = NULL;
+    }
+    if (m_pCachedMask) {
+        delete m_pCachedMask;
+        m_pCachedMask = NULL;
+    }
+    m_JpxReduceLevel = 0;
+    m_JpxWindow = FX_RECT(0, 0, 0, 0);
     CalcSize();
 }
 void CPDF_PageRenderCache::ClearImageData()
@@ -226,8 +246,10 @@ static FX_DWORD FPDF_ImageCache_EstimateImageSize(const CFX_DIBSource* pDIB)
 }
 FX_BOOL CPDF_ImageCache::GetCachedBitmap(CFX_DIBSource*& pBitmap, CFX_DIBSource*& pMask, FX_DWORD& MatteColor, CPDF_Dictionary* pPageResources,
         FX_BOOL bStdCS, FX_DWORD GroupFamily, FX_BOOL bLoadMask, CPDF_RenderStatus* pRenderStatus,
-        FX_INT32 downsampleWidth, FX_INT32 downsampleHeight)
+        FX_INT32 downsampleWidth, FX_INT32 downsampleHeight, const FX_RECT* pJpxWindow)
 {
+    int reduce_level = CPDF_DIBSource::GetJpxReduceLevel(m_pStream, downsampleWidth, downsampleHeight);
+    ReleaseReducedBitmap(reduce_level, pJpxWindow);
     if (m_pCachedBitmap) {
         pBitmap = m_pCachedBitmap;
         pMask = m_pCachedMask;
@@ -242,12 +264,18 @@ FX_BOOL CPDF_ImageCache::GetCachedBitmap(CFX_DIBSource*& pBitmap, CFX_DIBSource*
     m_dwTimeCount = pPageRenderCache->GetTimeCount();
     CPDF_DIBSource* pSrc = FX_NEW CPDF_DIBSource;
     CPDF_DIBSource* pMaskSrc = NULL;
+    pSrc->m_JpxReduceLevel = reduce_level;
+    if (pJpxWindow) {
+        pSrc->m_JpxWindow = *pJpxWindow;
+    }
     if (!pSrc->Load(m_pDocument, m_pStream, &pMaskSrc, &MatteColor, pRenderStatus->m_pFormResource, pPageResources, bStdCS, GroupFamily, bLoadMask)) {
         delete pSrc;
         pBitmap = NULL;
         return FALSE;
     }
     m_MatteColor = MatteColor;
+    m_JpxReduceLevel = pSrc->m_JpxReduceLevel;
+    m_JpxWindow = pSrc->m_JpxWindow;
 #if !defined(_FPDFAPI_MINI_)
     if (pSrc->GetPitch() * pSrc->GetHeight() < FPDF_HUGE_IMAGE_SIZE) {
         m_pCachedBitmap = pSrc->Clone();
@@ -295,8 +323,10 @@ CFX_DIBSource* CPDF_ImageCache::DetachMask()
 }
 int	CPDF_ImageCache::StartGetCachedBitmap(CPDF_Dictionary* pFormResources, CPDF_Dictionary* pPageResources, FX_BOOL bStdCS,
         FX_DWORD GroupFamily, FX_BOOL bLoadMask, CPDF_RenderStatus* pRenderStatus,
-        FX_INT32 downsampleWidth, FX_INT32 downsampleHeight)
+        FX_INT32 downsampleWidth, FX_INT32 downsampleHeight, const FX_RECT* pJpxWindow)
 {
+    int reduce_level = CPDF_DIBSource::GetJpxReduceLevel(m_pStream, downsampleWidth, downsampleHeight);
+    ReleaseReducedBitmap(reduce_level, pJpxWindow);
     if (m_pCachedBitmap) {
         m_pCurBitmap = m_pCachedBitmap;
         m_pCurMask = m_pCachedMask;
@@ -307,6 +337,10 @@ int	CPDF_ImageCache::StartGetCachedBitmap(CPDF_Dictionary* pFormResources, CPDF_
     }
     m_pRenderStatus = pRenderStatus;
     m_pCurBitmap = FX_NEW CPDF_DIBSource;
+    ((CPDF_DIBSource*)m_pCurBitmap)->m_JpxReduceLevel = reduce_level;
+    if (pJpxWindow) {
+        ((CPDF_DIBSource*)m_pCurBitmap)->m_JpxWindow = *pJpxWindow;
+    }
     int ret = ((CPDF_DIBSource*)m_pCurBitmap)->StartLoadDIBSource(m_pDocument, m_pStream, TRUE, pFormResources, pPageResources, bStdCS, GroupFamily, bLoadMask);
     if (ret == 2) {
         return ret;
@@ -322,6 +356,8 @@ int	CPDF_ImageCache::StartGetCachedBitmap(CPDF_Dictionary* pFormResources, CPDF_
 int CPDF_ImageCache::ContinueGetCachedBitmap()
 {
     m_MatteColor = ((CPDF_DIBSource*)m_pCurBitmap)->m_MatteColor;
+    m_JpxReduceLevel = ((CPDF_DIBSource*)m_pCurBitmap)->m_JpxReduceLevel;
+    m_JpxWindow = ((CPDF_DIBSource*)m_pCurBitmap)->m_JpxWindow;
     m_pCurMask = ((CPDF_DIBSource*)m_pCurBitmap)->DetachMask();
     CPDF_RenderContext*pContext = m_pRenderStatus->GetContext();
     CPDF_PageRenderCache* pPageRenderCache = pContext->m_pPageCache;
@@ -358,18 +358,39 @@ CPDF_ImageRenderer::~CPDF_ImageRenderer()
 }
 FX_BOOL CPDF_ImageRenderer::StartLoadDIBSource()
 {
-    CFX_FloatRect image_rect_f = m_ImageMatrix.GetUnitRect();
-    FX_RECT image_rect = image_rect_f.GetOutterRect();
-    int dest_width = image_rect.Width();
-    int dest_height = image_rect.Height();
+    // Device size of the image's own axes (not of its bounding box, which differs once rotated),
+    // lets a JPEG2000 image be decoded at a reduced resolution that still covers it.
+    int dest_width = (int)FXSYS_ceil(m_ImageMatrix.GetXUnit());
+    int dest_height = (int)FXSYS_ceil(m_ImageMatrix.GetYUnit());
     if (m_ImageMatrix.a < 0) {
         dest_width = -dest_width;
     }
     if (m_ImageMatrix.d > 0) {
         dest_height = -dest_height;
     }
+    // Part of the image inside the device clip box, in image pixels (top row first), so that a
+    // clipped JPEG2000 image only decodes what can be seen.
+    FX_RECT jpx_window(0, 0, 0, 0);
+    int pixel_width = m_pImageObject->m_pImage->GetPixelWidth();
+    int pixel_height = m_pImageObject->m_pImage->GetPixelHeight();
+    if (dest_width && dest_height && pixel_width > 0 && pixel_height > 0) {
+        CFX_Matrix unit_matrix;
+        unit_matrix.SetReverse(m_ImageMatrix);
+        CFX_FloatRect clip_rect(m_pRenderStatus->m_pDevice->GetClipBox());
+        clip_rect.Transform(&unit_matrix);
+        clip_rect.Intersect(CFX_FloatRect(0, 0, 1.0f, 1.0f));
+        if (!clip_rect.IsEmpty()) {
+            jpx_window.left = (int)FXSYS_floor(clip_rect.left * pixel_width);
+            jpx_window.top = (int)FXSYS_floor((1.0f - clip_rect.top) * pixel_height);
+            jpx_window.right = (int)FXSYS_ceil(clip_rect.right * pixel_width);
+            jpx_window.bottom = (int)FXSYS_ceil((1.0f - clip_rect.bottom) * pixel_height);
+            jpx_window.Intersect(0, 0, pixel_width, pixel_height);
+        }
+    }
+    FX_BOOL bJpxWindow = !jpx_window.IsEmpty() && !(jpx_window == FX_RECT(0, 0, pixel_width, pixel_height));
     if (m_Loader.StartLoadImage(m_pImageObject, m_pRenderStatus->m_pContext->m_pPageCache, m_LoadHandle, m_bStdCS,
-                                m_pRenderStatus->m_GroupFamily, m_pRenderStatus->m_bLoadMask, m_pRenderStatus, dest_width, dest_height)) {
+                                m_pRenderStatus->m_GroupFamily, m_pRenderStatus->m_bLoadMask, m_pRenderStatus, dest_width, dest_height,
+                                bJpxWindow ? &jpx_window : NULL)) {
         if (m_LoadHandle != NULL) {
             m_Status = 4;
             return TRUE;
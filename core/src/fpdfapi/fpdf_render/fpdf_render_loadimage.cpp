@@ -103,6 +103,8 @@ CPDF_DIBSource::CPDF_DIBSource()
     m_pMask = NULL;
     m_MatteColor = 0;
     m_pJbig2Context = NULL;
+    m_JpxReduceLevel = 0;
+    m_JpxWindow = FX_RECT(0, 0, 0, 0);
     m_pGlobalStream = NULL;
     m_bStdCS = FALSE;
     m_pMaskStream = NULL;
@@ -578,6 +580,9 @@ ICodec_ScanlineDecoder* FPDFAPI_CreateFlateDecoder(FX_LPCBYTE src_buf, FX_DWORD
 int CPDF_DIBSource::CreateDecoder()
 {
     const CFX_ByteString& decoder = m_pStreamAcc->GetImageDecoder();
+    if (decoder != FX_BSTRC("JPXDecode")) {
+        m_JpxWindow = FX_RECT(0, 0, 0, 0);
+    }
     if (decoder.IsEmpty()) {
         return 1;
     }
@@ -627,6 +632,39 @@ int CPDF_DIBSource::CreateDecoder()
     }
     return 0;
 }
+int CPDF_DIBSource::GetJpxReduceLevel(const CPDF_Stream* pStream, int dest_width, int dest_height)
+{
+    dest_width = FXSYS_abs(dest_width);
+    dest_height = FXSYS_abs(dest_height);
+    CPDF_Dictionary* pDict = pStream ? pStream->GetDict() : NULL;
+    if (pDict == NULL || dest_width == 0 || dest_height == 0) {
+        return 0;
+    }
+    CPDF_Object* pFilter = pDict->GetElementValue(FX_BSTRC("Filter"));
+    if (pFilter == NULL) {
+        return 0;
+    }
+    CFX_ByteString decoder;
+    if (pFilter->GetType() == PDFOBJ_ARRAY) {
+        CPDF_Array* pFilters = (CPDF_Array*)pFilter;
+        if (pFilters->GetCount() == 0) {
+            return 0;
+        }
+        decoder = pFilters->GetString(pFilters->GetCount() - 1);
+    } else {
+        decoder = pFilter->GetString();
+    }
+    if (decoder != FX_BSTRC("JPXDecode")) {
+        return 0;
+    }
+    int orig_width = pDict->GetInteger(FX_BSTRC("Width"));
+    int orig_height = pDict->GetInteger(FX_BSTRC("Height"));
+    int reduce_level = 0;
+    while (reduce_level < 30 && (orig_width >> (reduce_level + 1)) >= dest_width && (orig_height >> (reduce_level + 1)) >= dest_height) {
+        reduce_level ++;
+    }
+    return reduce_level;
+}
 void CPDF_DIBSource::LoadJpxBitmap()
 {
     ICodec_JpxModule* pJpxModule = CPDF_ModuleMgr::Get()->GetJpxModule();
@@ -637,9 +675,39 @@ void CPDF_DIBSource::LoadJpxBitmap()
     if (ctx == NULL) {
         return;
     }
+    int reduce_level = m_JpxReduceLevel;
+    FX_RECT window = m_JpxWindow;
+    FX_BOOL bWindow = !window.IsEmpty();
+    if (bWindow) {
+        // Leave a margin so that the stretcher still finds decoded pixels next to the window edge.
+        int margin = 2 << reduce_level;
+        window.left -= margin;
+        window.top -= margin;
+        window.right += margin;
+        window.bottom += margin;
+    }
+    if ((reduce_level || bWindow) && !pJpxModule->SetDecodeParams(ctx, reduce_level, bWindow ? &window : NULL)) {
+        pJpxModule->DestroyDecoder(ctx);
+        ctx = pJpxModule->CreateDecoder(m_pStreamAcc->GetData(), m_pStreamAcc->GetSize(), m_pColorSpace != NULL);
+        if (ctx == NULL) {
+            return;
+        }
+        reduce_level = 0;
+        bWindow = FALSE;
+    }
+    int scale = 1 << reduce_level;
+    int dest_width = (m_pDict->GetInteger(FX_BSTRC("Width")) + scale - 1) / scale;
+    int dest_height = (m_pDict->GetInteger(FX_BSTRC("Height")) + scale - 1) / scale;
     FX_DWORD width = 0, height = 0, codestream_nComps = 0, image_nComps = 0;
     pJpxModule->GetImageInfo(ctx, width, height, codestream_nComps, image_nComps);
-    if ((int)width < m_Width || (int)height < m_Height) {
+    if (bWindow) {
+        if ((int)width != window.Width() || (int)height != window.Height()) {
+            pJpxModule->DestroyDecoder(ctx);
+            return;
+        }
+        width = FX_MAX(dest_width, window.right);
+        height = FX_MAX(dest_height, window.bottom);
+    } else if ((int)width < dest_width || (int)height < dest_height) {
         pJpxModule->DestroyDecoder(ctx);
         return;
     }
@@ -647,6 +715,7 @@ void CPDF_DIBSource::LoadJpxBitmap()
     FX_BOOL bTranslateColor, bSwapRGB = FALSE;
     if (m_pColorSpace) {
         if (codestream_nComps != (FX_DWORD)m_pColorSpace->CountComponents()) {
+            pJpxModule->DestroyDecoder(ctx);
             return;
         }
         output_nComps = codestream_nComps;
@@ -681,13 +750,13 @@ void CPDF_DIBSource::LoadJpxBitmap()
         width = (width * output_nComps + 2) / 3;
         format = FXDIB_Rgb;
     }
-    m_pCachedBitmap = FX_NEW CFX_DIBitmap;
-    if (!m_pCachedBitmap->Create(width, height, format)) {
-        delete m_pCachedBitmap;
-        m_pCachedBitmap = NULL;
+    CFX_DIBitmap* pBitmap = FX_NEW CFX_DIBitmap;
+    if (!pBitmap->Create(width, height, format)) {
+        delete pBitmap;
+        pJpxModule->DestroyDecoder(ctx);
         return;
     }
-    m_pCachedBitmap->Clear(0xFFFFFFFF);
+    pBitmap->Clear(0xFFFFFFFF);
     FX_LPBYTE output_offsets = FX_Alloc(FX_BYTE, output_nComps);
     for (int i = 0; i < output_nComps; i ++) {
         output_offsets[i] = i;
@@ -696,23 +765,38 @@ void CPDF_DIBSource::LoadJpxBitmap()
         output_offsets[0] = 2;
         output_offsets[2] = 0;
     }
-    if (!pJpxModule->Decode(ctx, m_pCachedBitmap->GetBuffer(), m_pCachedBitmap->GetPitch(), bTranslateColor, output_offsets)) {
-        delete m_pCachedBitmap;
-        m_pCachedBitmap = NULL;
-        return;
+    FX_LPBYTE dest_buf = pBitmap->GetBuffer();
+    if (bWindow) {
+        dest_buf += window.top * pBitmap->GetPitch() + window.left * output_nComps;
     }
+    FX_BOOL bDecoded = pJpxModule->Decode(ctx, dest_buf, pBitmap->GetPitch(), bTranslateColor, output_offsets);
     FX_Free(output_offsets);
     pJpxModule->DestroyDecoder(ctx);
-    if (m_pColorSpace && m_pColorSpace->GetFamily() == PDFCS_INDEXED && m_bpc < 8) {
-        int scale = 8 - m_bpc;
+    if (!bDecoded) {
+        delete pBitmap;
+        return;
+    }
+    int src_bpc = m_pDict->GetInteger(FX_BSTRC("BitsPerComponent"));
+    if (m_pColorSpace && m_pColorSpace->GetFamily() == PDFCS_INDEXED && src_bpc > 0 && src_bpc < 8) {
+        int shift = 8 - src_bpc;
         for (FX_DWORD row = 0; row < height; row ++) {
-            FX_LPBYTE scanline = (FX_LPBYTE)m_pCachedBitmap->GetScanline(row);
+            FX_LPBYTE scanline = (FX_LPBYTE)pBitmap->GetScanline(row);
             for (FX_DWORD col = 0; col < width; col ++) {
-                *scanline = (*scanline) >> scale;
+                *scanline = (*scanline) >> shift;
                 scanline++;
             }
         }
     }
+    if (m_pCachedBitmap) {
+        delete m_pCachedBitmap;
+    }
+    m_pCachedBitmap = pBitmap;
+    m_Width = dest_width;
+    m_Height = dest_height;
+    m_JpxReduceLevel = reduce_level;
+    if (!bWindow) {
+        m_JpxWindow = FX_RECT(0, 0, 0, 0);
+    }
     m_bpc = 8;
 }
 void CPDF_DIBSource::LoadJbig2Bitmap()
@@ -1210,7 +1294,6 @@ void CPDF_DIBSource::DownSampleScanline(int line, FX_LPBYTE dest_scan, int dest_
         FXSYS_memset32(dest_scan, 0xff, dest_Bpp * clip_width);
         return;
     }
-    CFX_FixedBufGrow<FX_BYTE, 128> temp(orig_Bpp);
     if (m_bpc * m_nComponents == 1) {
         FX_DWORD set_argb = (FX_DWORD) - 1, reset_argb = 0;
         if (m_bImageMask) {
@@ -1334,69 +1417,88 @@ void CPDF_DIBSource::DownSampleScanline(int line, FX_LPBYTE dest_scan, int dest_
         }
         return;
     } else {
-        int last_src_x = -1;
-        FX_ARGB last_argb;
         FX_FLOAT orig_Not8Bpp = (FX_FLOAT)m_bpc * (FX_FLOAT)m_nComponents / 8.0f;
         FX_FLOAT unit_To8Bpc = 255.0f / ((1 << m_bpc) - 1);
+        CFX_FixedBufGrow<FX_DWORD, 128> src_xs(clip_width);
+        CFX_FixedBufGrow<int, 128> color_index(clip_width);
+        int nColors = 0;
         for (int i = 0; i < clip_width; i ++) {
             int dest_x = clip_left + i;
             FX_DWORD src_x = (bFlipX ? (dest_width - dest_x - 1) : dest_x) * (FX_INT64)src_width / dest_width;
             src_x %= src_width;
+            if (nColors == 0 || src_xs[nColors - 1] != src_x) {
+                src_xs[nColors ++] = src_x;
+            }
+            color_index[i] = nColors - 1;
+        }
+        CFX_FixedBufGrow<FX_ARGB, 128> colors(nColors);
+        CFX_FixedBufGrow<FX_BYTE, 512> src_buf(m_pColorSpace ? nColors * m_nComponents : 0);
+        CFX_FixedBufGrow<FX_BYTE, 384> rgb_buf(m_pColorSpace ? nColors * 3 : 0);
+        if (m_pColorSpace) {
+            // Gather the sampled pixels and convert them in one call, so that the color space
+            // can use its lookup table for the whole image.
+            for (int k = 0; k < nColors; k ++) {
+                FX_DWORD src_x = src_xs[k];
+                FX_LPCBYTE pSrcPixel = NULL;
+                if (m_bpc % 8 == 0) {
+                    pSrcPixel = pSrcLine + src_x * orig_Bpp;
+                } else {
+                    pSrcPixel = pSrcLine + (int)(src_x * orig_Not8Bpp);
+                }
+                FX_LPBYTE pColor = src_buf + k * m_nComponents;
+                if (!m_bDefaultDecode) {
+                    for (FX_DWORD i = 0; i < m_nComponents; i ++) {
+                        int color_value = (int)((m_pCompData[i].m_DecodeMin + m_pCompData[i].m_DecodeStep * (FX_FLOAT)pSrcPixel[i]) * 255.0f + 0.5f);
+                        pColor[i] = color_value > 255 ? 255 : (color_value < 0 ? 0 : color_value);
+                    }
+                } else if (m_bpc < 8) {
+                    int src_bit_pos = 0;
+                    if (src_x % 2) {
+                        src_bit_pos = 4;
+                    }
+                    for (FX_DWORD i = 0; i < m_nComponents; i ++) {
+                        pColor[i] = (FX_BYTE)(_GetBits8(pSrcPixel, src_bit_pos, m_bpc) * unit_To8Bpc);
+                        src_bit_pos += m_bpc;
+                    }
+                } else {
+                    FXSYS_memcpy32(pColor, pSrcPixel, m_nComponents);
+                }
+            }
+            m_pColorSpace->TranslateImageLine(rgb_buf, src_buf, nColors, m_Width, m_Height, m_bLoadMask && m_GroupFamily == PDFCS_DEVICECMYK && m_Family == PDFCS_DEVICECMYK);
+        }
+        for (int k = 0; k < nColors; k ++) {
+            FX_DWORD src_x = src_xs[k];
             FX_LPCBYTE pSrcPixel = NULL;
             if (m_bpc % 8 == 0) {
                 pSrcPixel = pSrcLine + src_x * orig_Bpp;
             } else {
                 pSrcPixel = pSrcLine + (int)(src_x * orig_Not8Bpp);
             }
-            FX_LPBYTE pDestPixel = dest_scan + i * dest_Bpp;
             FX_ARGB argb;
-            if (src_x == last_src_x) {
-                argb = last_argb;
+            if (m_pColorSpace) {
+                FX_LPBYTE color = rgb_buf + k * 3;
+                argb = FXARGB_MAKE(0xff, color[2], color[1], color[0]);
             } else {
-                if (m_pColorSpace) {
-                    FX_BYTE color[4];
-                    if (!m_bDefaultDecode) {
-                        for (int i = 0; i < orig_Bpp; i ++) {
-                            int color_value = (int)((m_pCompData[i].m_DecodeMin + m_pCompData[i].m_DecodeStep * (FX_FLOAT)pSrcPixel[i]) * 255.0f + 0.5f);
-                            temp[i] = color_value > 255 ? 255 : (color_value < 0 ? 0 : color_value);
-                        }
-                        m_pColorSpace->TranslateImageLine(color, temp, 1, 0, 0, m_bLoadMask && m_GroupFamily == PDFCS_DEVICECMYK && m_Family == PDFCS_DEVICECMYK);
-                    } else {
-                        if (m_bpc < 8) {
-                            int src_bit_pos = 0;
-                            if (src_x % 2) {
-                                src_bit_pos = 4;
-                            }
-                            int value = (1 << m_bpc)  - 1;
-                            for (FX_DWORD i = 0; i < m_nComponents; i ++) {
-                                temp[i] = (FX_BYTE)(_GetBits8(pSrcPixel, src_bit_pos, m_bpc) * unit_To8Bpc);
-                                src_bit_pos += m_bpc;
-                            }
-                            m_pColorSpace->TranslateImageLine(color, temp, 1, 0, 0, m_bLoadMask && m_GroupFamily == PDFCS_DEVICECMYK && m_Family == PDFCS_DEVICECMYK);
-                        } else {
-                            m_pColorSpace->TranslateImageLine(color, pSrcPixel, 1, 0, 0, m_bLoadMask && m_GroupFamily == PDFCS_DEVICECMYK && m_Family == PDFCS_DEVICECMYK);
-                        }
-                    }
-                    argb = FXARGB_MAKE(0xff, color[2], color[1], color[0]);
-                } else {
-                    argb = FXARGB_MAKE(0xff, pSrcPixel[2], pSrcPixel[1], pSrcPixel[0]);
-                }
-                if (m_bColorKey) {
-                    int alpha = 0xff;
-                    if (m_nComponents == 3 && m_bpc == 8) {
-                        alpha = (pSrcPixel[0] < m_pCompData[0].m_ColorKeyMin ||
-                                 pSrcPixel[0] > m_pCompData[0].m_ColorKeyMax ||
-                                 pSrcPixel[1] < m_pCompData[1].m_ColorKeyMin ||
-                                 pSrcPixel[1] > m_pCompData[1].m_ColorKeyMax ||
-                                 pSrcPixel[2] < m_pCompData[2].m_ColorKeyMin ||
-                                 pSrcPixel[2] > m_pCompData[2].m_ColorKeyMax) ? 0xff : 0;
-                    }
-                    argb &= 0xffffff;
-                    argb |= alpha << 24;
+                argb = FXARGB_MAKE(0xff, pSrcPixel[2], pSrcPixel[1], pSrcPixel[0]);
+            }
+            if (m_bColorKey) {
+                int alpha = 0xff;
+                if (m_nComponents == 3 && m_bpc == 8) {
+                    alpha = (pSrcPixel[0] < m_pCompData[0].m_ColorKeyMin ||
+                             pSrcPixel[0] > m_pCompData[0].m_ColorKeyMax ||
+                             pSrcPixel[1] < m_pCompData[1].m_ColorKeyMin ||
+                             pSrcPixel[1] > m_pCompData[1].m_ColorKeyMax ||
+                             pSrcPixel[2] < m_pCompData[2].m_ColorKeyMin ||
+                             pSrcPixel[2] > m_pCompData[2].m_ColorKeyMax) ? 0xff : 0;
                 }
-                last_src_x = src_x;
-                last_argb = argb;
+                argb &= 0xffffff;
+                argb |= alpha << 24;
             }
+            colors[k] = argb;
+        }
+        for (int i = 0; i < clip_width; i ++) {
+            FX_ARGB argb = colors[color_index[i]];
+            FX_LPBYTE pDestPixel = dest_scan + i * dest_Bpp;
             if (dest_Bpp == 4) {
                 *(FX_DWORD*)pDestPixel = FXARGB_TODIB(argb);
             } else {
@@ -1433,7 +1535,7 @@ CPDF_ProgressiveImageLoaderHandle::~CPDF_ProgressiveImageLoaderHandle()
     m_pCache = NULL;
     m_pImage = NULL;
 }
-FX_BOOL CPDF_ProgressiveImageLoaderHandle::Start(CPDF_ImageLoader* pImageLoader, const CPDF_ImageObject* pImage, CPDF_PageRenderCache* pCache, FX_BOOL bStdCS, FX_DWORD GroupFamily, FX_BOOL bLoadMask, CPDF_RenderStatus* pRenderStatus, FX_INT32 nDownsampleWidth, FX_INT32 nDownsampleHeight)
+FX_BOOL CPDF_ProgressiveImageLoaderHandle::Start(CPDF_ImageLoader* pImageLoader, const CPDF_ImageObject* pImage, CPDF_PageRenderCache* pCache, FX_BOOL bStdCS, FX_DWORD GroupFamily, FX_BOOL bLoadMask, CPDF_RenderStatus* pRenderStatus, FX_INT32 nDownsampleWidth, FX_INT32 nDownsampleHeight, const FX_RECT* pJpxWindow)
 {
     m_pImageLoader = pImageLoader;
     m_pCache = pCache;
@@ -1442,7 +1544,7 @@ FX_BOOL CPDF_ProgressiveImageLoaderHandle::Start(CPDF_ImageLoader* pImageLoader,
     m_nDownsampleHeight = nDownsampleHeight;
     FX_BOOL ret;
     if (pCache) {
-        ret = pCache->StartGetCachedBitmap(pImage->m_pImage->GetStream(), bStdCS, GroupFamily, bLoadMask, pRenderStatus, m_nDownsampleWidth, m_nDownsampleHeight);
+        ret = pCache->StartGetCachedBitmap(pImage->m_pImage->GetStream(), bStdCS, GroupFamily, bLoadMask, pRenderStatus, m_nDownsampleWidth, m_nDownsampleHeight, pJpxWindow);
         if (ret == FALSE) {
             m_pImageLoader->m_bCached = TRUE;
             m_pImageLoader->m_pBitmap = pCache->m_pCurImageCache->DetachBitmap();
@@ -1496,13 +1598,13 @@ FX_BOOL CPDF_ImageLoader::Load(const CPDF_ImageObject* pImage, CPDF_PageRenderCa
     }
     return FALSE;
 }
-FX_BOOL CPDF_ImageLoader::StartLoadImage(const CPDF_ImageObject* pImage, CPDF_PageRenderCache* pCache, FX_LPVOID& LoadHandle, FX_BOOL bStdCS, FX_DWORD GroupFamily, FX_BOOL bLoadMask, CPDF_RenderStatus* pRenderStatus, FX_INT32 nDownsampleWidth, FX_INT32 nDownsampleHeight)
+FX_BOOL CPDF_ImageLoader::StartLoadImage(const CPDF_ImageObject* pImage, CPDF_PageRenderCache* pCache, FX_LPVOID& LoadHandle, FX_BOOL bStdCS, FX_DWORD GroupFamily, FX_BOOL bLoadMask, CPDF_RenderStatus* pRenderStatus, FX_INT32 nDownsampleWidth, FX_INT32 nDownsampleHeight, const FX_RECT* pJpxWindow)
 {
     m_nDownsampleWidth = nDownsampleWidth;
     m_nDownsampleHeight = nDownsampleHeight;
     CPDF_ProgressiveImageLoaderHandle* pLoaderHandle = NULL;
     pLoaderHandle =	FX_NEW CPDF_ProgressiveImageLoaderHandle;
-    FX_BOOL ret = pLoaderHandle->Start(this, pImage, pCache, bStdCS, GroupFamily, bLoadMask, pRenderStatus, m_nDownsampleWidth, m_nDownsampleHeight);
+    FX_BOOL ret = pLoaderHandle->Start(this, pImage, pCache, bStdCS, GroupFamily, bLoadMask, pRenderStatus, m_nDownsampleWidth, m_nDownsampleHeight, pJpxWindow);
     LoadHandle = pLoaderHandle;
     return ret;
 }
@@ -0,0 +1,504 @@
+// Copyright 2014 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+ 
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#include "../../../include/fpdfapi/fpdf_render.h"
+#include "../../../include/fpdfapi/fpdf_module.h"
+#include "../../../include/fxge/fx_ge.h"
+#include "../../../include/fdrm/fx_crypt.h"
+#include "../fpdf_page/pageint.h"
+#include "render_int.h"
+#define FPDF_PAGECACHE_MAGIC		0x43505846
+#define FPDF_PAGECACHE_VERSION		2
+#define FPDF_PAGECACHE_EXT			".fxpc"
+#define FPDF_PAGECACHE_KEYLEN		64
+typedef struct {
+    FX_DWORD	m_Magic;
+    FX_DWORD	m_Version;
+    FX_DWORD	m_Width;
+    FX_DWORD	m_Height;
+    FX_DWORD	m_Pitch;
+    FX_DWORD	m_Format;
+    FX_DWORD	m_CompSize;
+} FPDF_PAGECACHE_HEADER;
+static const FX_LPCSTR g_PageDigestSkipKeys[] = {
+    "Parent", "P", "Dest", "A", "AA", "IRT", "Popup", "Thumb", "B", "Metadata", "PieceInfo", "StructParents"
+};
+struct CPDF_PageDigest {
+    FX_BYTE				m_Context[128];
+    CFX_MapPtrToPtr		m_Visited;
+    FX_DWORD			m_nVisited;
+    void				Update(FX_LPCVOID pData, FX_DWORD size)
+    {
+        CRYPT_SHA256Update(m_Context, (FX_LPCBYTE)pData, size);
+    }
+    void				UpdateString(FX_BSTR str)
+    {
+        FX_DWORD len = str.GetLength();
+        Update(&len, sizeof(FX_DWORD));
+        Update(str.GetPtr(), len);
+    }
+    void				UpdateObject(CPDF_Object* pObj, int level);
+};
+static FX_BOOL _IsDigestSkipKey(FX_BSTR key)
+{
+    for (int i = 0; i < (int)(sizeof(g_PageDigestSkipKeys) / sizeof(FX_LPCSTR)); i ++) {
+        if (key == g_PageDigestSkipKeys[i]) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+void CPDF_PageDigest::UpdateObject(CPDF_Object* pObj, int level)
+{
+    if (pObj && pObj->GetType() == PDFOBJ_REFERENCE) {
+        pObj = pObj->GetDirect();
+    }
+    FX_BYTE type = pObj ? (FX_BYTE)pObj->GetType() : 0;
+    Update(&type, 1);
+    if (pObj == NULL || level > 64) {
+        return;
+    }
+    if (pObj->GetType() == PDFOBJ_ARRAY || pObj->GetType() == PDFOBJ_DICTIONARY || pObj->GetType() == PDFOBJ_STREAM) {
+        FX_LPVOID index = NULL;
+        if (m_Visited.Lookup(pObj, index)) {
+            Update(&index, sizeof(FX_LPVOID));
+            return;
+        }
+        m_Visited.SetAt(pObj, (FX_LPVOID)(FX_UINTPTR)++m_nVisited);
+    }
+    switch (pObj->GetType()) {
+        case PDFOBJ_BOOLEAN:
+        case PDFOBJ_NUMBER:
+        case PDFOBJ_STRING:
+        case PDFOBJ_NAME:
+            UpdateString(pObj->GetString());
+            break;
+        case PDFOBJ_ARRAY: {
+                CPDF_Array* pArray = (CPDF_Array*)pObj;
+                FX_DWORD count = pArray->GetCount();
+                Update(&count, sizeof(FX_DWORD));
+                for (FX_DWORD i = 0; i < count; i ++) {
+                    UpdateObject(pArray->GetElement(i), level + 1);
+                }
+                break;
+            }
+        case PDFOBJ_DICTIONARY: {
+                CPDF_Dictionary* pDict = (CPDF_Dictionary*)pObj;
+                FX_POSITION pos = pDict->GetStartPos();
+                while (pos) {
+                    CFX_ByteString key;
+                    CPDF_Object* pValue = pDict->GetNextElement(pos, key);
+                    if (_IsDigestSkipKey(key)) {
+                        continue;
+                    }
+                    UpdateString(key);
+                    UpdateObject(pValue, level + 1);
+                }
+                break;
+            }
+        case PDFOBJ_STREAM: {
+                CPDF_Stream* pStream = (CPDF_Stream*)pObj;
+                UpdateObject(pStream->GetDict(), level + 1);
+                FX_DWORD size = pStream->GetRawSize();
+                Update(&size, sizeof(FX_DWORD));
+                FX_BYTE buf[4096];
+                for (FX_DWORD offset = 0; offset < size; offset += sizeof(buf)) {
+                    FX_DWORD block = size - offset > sizeof(buf) ? sizeof(buf) : size - offset;
+                    if (!pStream->ReadRawData(offset, buf, block)) {
+                        break;
+                    }
+                    Update(buf, block);
+                }
+                break;
+            }
+    }
+}
+static int g_PageDigestModuleId;
+struct CPDF_PageDigestMemo {
+    FX_BYTE				m_Digest[32];
+    FX_DWORD			m_MoveGeneration;
+};
+static void _FreePageDigestMemo(FX_LPVOID pData)
+{
+    FX_Free(pData);
+}
+static void _GetPageContentDigest(CPDF_Page* pPage, FX_BYTE digest[32])
+{
+    CPDF_PageDigestMemo* pMemo = (CPDF_PageDigestMemo*)pPage->GetPrivateData(&g_PageDigestModuleId);
+    if (pMemo && pMemo->m_MoveGeneration == pPage->GetMoveGeneration()) {
+        FXSYS_memcpy32(digest, pMemo->m_Digest, 32);
+        return;
+    }
+    CPDF_PageDigest content;
+    content.m_nVisited = 0;
+    CRYPT_SHA256Start(content.m_Context);
+    content.UpdateObject(pPage->m_pFormDict, 0);
+    content.UpdateObject(pPage->GetPageAttr(FX_BSTRC("Resources")), 0);
+    CPDF_Dictionary* pRoot = pPage->m_pDocument->GetRoot();
+    content.UpdateObject(pRoot ? pRoot->GetElement(FX_BSTRC("OCProperties")) : NULL, 0);
+    IPDF_DocParser* pParser = pPage->m_pDocument->GetParser();
+    content.UpdateObject(pParser ? pParser->GetEncryptDict() : NULL, 0);
+    content.UpdateObject(pParser ? pParser->GetIDArray() : NULL, 0);
+    CRYPT_SHA256Finish(content.m_Context, digest);
+    pMemo = FX_Alloc(CPDF_PageDigestMemo, 1);
+    if (pMemo == NULL) {
+        return;
+    }
+    FXSYS_memcpy32(pMemo->m_Digest, digest, 32);
+    pMemo->m_MoveGeneration = pPage->GetMoveGeneration();
+    pPage->SetPrivateData(&g_PageDigestModuleId, pMemo, _FreePageDigestMemo);
+}
+void IPDF_PageImageCache::InvalidatePage(CPDF_Page* pPage)
+{
+    if (pPage) {
+        pPage->RemovePrivateData(&g_PageDigestModuleId);
+    }
+}
+FX_BOOL IPDF_PageImageCache::GetUniformBackdrop(const CFX_DIBitmap* pBitmap, const FX_RECT& rect, FX_DWORD& backdrop)
+{
+    if (pBitmap == NULL || pBitmap->GetBuffer() == NULL || pBitmap->GetBPP() < 8 || pBitmap->GetPalette() ||
+            rect.IsEmpty() || rect.left < 0 || rect.top < 0 || rect.right > pBitmap->GetWidth() || rect.bottom > pBitmap->GetHeight()) {
+        return FALSE;
+    }
+    int Bpp = pBitmap->GetBPP() / 8;
+    FX_LPCBYTE pFirst = pBitmap->GetScanline(rect.top) + rect.left * Bpp;
+    for (int col = 1; col < rect.Width(); col ++) {
+        if (FXSYS_memcmp32(pFirst + col * Bpp, pFirst, Bpp)) {
+            return FALSE;
+        }
+    }
+    for (int row = rect.top + 1; row < rect.bottom; row ++) {
+        if (FXSYS_memcmp32(pBitmap->GetScanline(row) + rect.left * Bpp, pFirst, rect.Width() * Bpp)) {
+            return FALSE;
+        }
+    }
+    backdrop = 0;
+    FXSYS_memcpy32(&backdrop, pFirst, Bpp);
+    return TRUE;
+}
+IPDF_PageImageCache* IPDF_PageImageCache::Create(FX_BSTR cache_dir)
+{
+    if (cache_dir.IsEmpty()) {
+        return NULL;
+    }
+    void* handle = FX_OpenFolder(CFX_ByteString(cache_dir));
+    if (handle == NULL) {
+        return NULL;
+    }
+    FX_CloseFolder(handle);
+    CPDF_DiskPageImageCache* pCache = FX_NEW CPDF_DiskPageImageCache(cache_dir);
+    if (pCache == NULL) {
+        return NULL;
+    }
+    pCache->LoadIndex();
+    return pCache;
+}
+CPDF_DiskPageImageCache::CPDF_DiskPageImageCache(FX_BSTR cache_dir)
+{
+    m_CacheDir = cache_dir;
+    FX_CHAR sep = (FX_CHAR)FX_GetFolderSeparator();
+    if (m_CacheDir.GetAt(m_CacheDir.GetLength() - 1) != sep) {
+        m_CacheDir += sep;
+    }
+    m_TotalSize = 0;
+    m_dwLimit = 0;
+    m_dwTime = 0;
+    m_nTempSeq = 0;
+}
+CPDF_DiskPageImageCache::~CPDF_DiskPageImageCache()
+{
+    FX_POSITION pos = m_Entries.GetStartPosition();
+    while (pos) {
+        CFX_ByteString key;
+        void* value;
+        m_Entries.GetNextAssoc(pos, key, value);
+        delete (CPDF_PageImageCacheEntry*)value;
+    }
+    m_Entries.RemoveAll();
+}
+CFX_ByteString CPDF_DiskPageImageCache::GetFilePath(const CFX_ByteString& key) const
+{
+    return m_CacheDir + key + FX_BSTRC(FPDF_PAGECACHE_EXT);
+}
+void CPDF_DiskPageImageCache::LoadIndex()
+{
+    void* handle = FX_OpenFolder(m_CacheDir);
+    if (handle == NULL) {
+        return;
+    }
+    CFX_ByteString filename;
+    FX_BOOL bFolder;
+    while (FX_GetNextFile(handle, filename, bFolder)) {
+        if (bFolder || filename.GetLength() != FPDF_PAGECACHE_KEYLEN + sizeof(FPDF_PAGECACHE_EXT) - 1 ||
+                filename.Right(sizeof(FPDF_PAGECACHE_EXT) - 1) != FX_BSTRC(FPDF_PAGECACHE_EXT)) {
+            continue;
+        }
+        FX_HFILE hFile = FX_File_Open(m_CacheDir + filename, FX_FILEMODE_ReadOnly);
+        if (hFile == NULL) {
+            continue;
+        }
+        FX_FILESIZE size = FX_File_GetSize(hFile);
+        FX_File_Close(hFile);
+        UpdateEntry(filename.Left(FPDF_PAGECACHE_KEYLEN), (FX_DWORD)size);
+    }
+    FX_CloseFolder(handle);
+}
+void CPDF_DiskPageImageCache::UpdateEntry(const CFX_ByteString& key, FX_DWORD size)
+{
+    CFX_CSLock lock(&m_Lock);
+    CPDF_PageImageCacheEntry* pEntry = NULL;
+    if (m_Entries.Lookup(key, (void*&)pEntry)) {
+        m_TotalSize -= pEntry->m_dwSize;
+    } else {
+        pEntry = FX_NEW CPDF_PageImageCacheEntry;
+        if (pEntry == NULL) {
+            return;
+        }
+        m_Entries.SetAt(key, pEntry);
+    }
+    pEntry->m_dwSize = size;
+    pEntry->m_dwTime = ++m_dwTime;
+    m_TotalSize += size;
+}
+void CPDF_DiskPageImageCache::RemoveEntry(const CFX_ByteString& key)
+{
+    CFX_CSLock lock(&m_Lock);
+    CPDF_PageImageCacheEntry* pEntry = NULL;
+    if (!m_Entries.Lookup(key, (void*&)pEntry)) {
+        return;
+    }
+    m_TotalSize -= pEntry->m_dwSize;
+    m_Entries.RemoveKey(key);
+    delete pEntry;
+}
+struct PAGECACHE_LRUINFO {
+    FX_DWORD			time;
+    CFX_ByteString*		pKey;
+};
+extern "C" {
+    static int _ComparePageCacheTime(const void* data1, const void* data2)
+    {
+        FX_DWORD time1 = ((PAGECACHE_LRUINFO*)data1)->time, time2 = ((PAGECACHE_LRUINFO*)data2)->time;
+        return time1 < time2 ? -1 : (time1 > time2 ? 1 : 0);
+    }
+};
+void CPDF_DiskPageImageCache::Shrink()
+{
+    CFX_CSLock lock(&m_Lock);
+    if (m_dwLimit == 0 || m_TotalSize <= (FX_FILESIZE)m_dwLimit) {
+        return;
+    }
+    int nCount = m_Entries.GetCount();
+    PAGECACHE_LRUINFO* pInfo = FX_Alloc(PAGECACHE_LRUINFO, nCount);
+    CFX_ByteString* pKeys = FX_NEW CFX_ByteString[nCount];
+    if (pInfo == NULL || pKeys == NULL) {
+        if (pInfo) {
+            FX_Free(pInfo);
+        }
+        if (pKeys) {
+            delete[] pKeys;
+        }
+        return;
+    }
+    int i = 0;
+    FX_POSITION pos = m_Entries.GetStartPosition();
+    while (pos) {
+        void* value;
+        m_Entries.GetNextAssoc(pos, pKeys[i], value);
+        pInfo[i].time = ((CPDF_PageImageCacheEntry*)value)->m_dwTime;
+        pInfo[i].pKey = &pKeys[i];
+        i ++;
+    }
+    FXSYS_qsort(pInfo, nCount, sizeof(PAGECACHE_LRUINFO), _ComparePageCacheTime);
+    for (i = 0; i < nCount && m_TotalSize > (FX_FILESIZE)m_dwLimit; i ++) {
+        FX_File_Delete(GetFilePath(*pInfo[i].pKey));
+        RemoveEntry(*pInfo[i].pKey);
+    }
+    FX_Free(pInfo);
+    delete[] pKeys;
+}
+void CPDF_DiskPageImageCache::SetCacheLimit(FX_DWORD limit)
+{
+    m_dwLimit = limit;
+    Shrink();
+}
+// The key digests the page dictionary graph together with the document-level inputs of its
+// rendering (optional content configuration, encryption), the target size, rotation, flags, pixel
+// format and backdrop. The graph digest reads every stream, so it is remembered on the page until
+// the page is edited (see InvalidatePage) or a page object moves.
+FX_BOOL CPDF_DiskPageImageCache::GetPageKey(CPDF_Page* pPage, int size_x, int size_y, int rotate, FX_DWORD flags,
+        FXDIB_Format format, FX_DWORD backdrop, CFX_ByteString& key)
+{
+    if (pPage == NULL || pPage->m_pFormDict == NULL || size_x <= 0 || size_y <= 0) {
+        return FALSE;
+    }
+    FX_BYTE content[32];
+    _GetPageContentDigest(pPage, content);
+    FX_BYTE context[128];
+    CRYPT_SHA256Start(context);
+    FX_DWORD params[8] = {FPDF_PAGECACHE_MAGIC, FPDF_PAGECACHE_VERSION, (FX_DWORD)size_x, (FX_DWORD)size_y, (FX_DWORD)rotate, flags,
+                          (FX_DWORD)format, backdrop
+                         };
+    CRYPT_SHA256Update(context, (FX_LPCBYTE)params, sizeof(params));
+    CFX_FloatRect bbox = pPage->GetPageBBox();
+    CRYPT_SHA256Update(context, (FX_LPCBYTE)&bbox, sizeof(CFX_FloatRect));
+    const CFX_AffineMatrix& matrix = pPage->GetPageMatrix();
+    CRYPT_SHA256Update(context, (FX_LPCBYTE)&matrix, sizeof(CFX_AffineMatrix));
+    CRYPT_SHA256Update(context, content, 32);
+    FX_BYTE result[32];
+    CRYPT_SHA256Finish(context, result);
+    static const FX_CHAR hex[] = "0123456789abcdef";
+    FX_LPSTR pBuf = key.GetBuffer(FPDF_PAGECACHE_KEYLEN);
+    for (int i = 0; i < 32; i ++) {
+        pBuf[i * 2] = hex[result[i] >> 4];
+        pBuf[i * 2 + 1] = hex[result[i] & 0x0f];
+    }
+    key.ReleaseBuffer(FPDF_PAGECACHE_KEYLEN);
+    return TRUE;
+}
+CFX_DIBitmap* CPDF_DiskPageImageCache::LoadPageImage(const CFX_ByteString& key)
+{
+    FX_HFILE hFile = FX_File_Open(GetFilePath(key), FX_FILEMODE_ReadOnly);
+    if (hFile == NULL) {
+        RemoveEntry(key);
+        return NULL;
+    }
+    FX_DWORD file_size = (FX_DWORD)FX_File_GetSize(hFile);
+    FPDF_PAGECACHE_HEADER header;
+    FX_LPBYTE pCompBuf = NULL;
+    if (FX_File_ReadPos(hFile, &header, sizeof(header), 0) == sizeof(header) &&
+            header.m_Magic == FPDF_PAGECACHE_MAGIC && header.m_Version == FPDF_PAGECACHE_VERSION &&
+            (header.m_Format == FXDIB_Argb || header.m_Format == FXDIB_Rgb || header.m_Format == FXDIB_Rgb32) &&
+            header.m_CompSize == file_size - sizeof(header)) {
+        pCompBuf = FX_Alloc(FX_BYTE, header.m_CompSize);
+        if (pCompBuf && FX_File_ReadPos(hFile, pCompBuf, header.m_CompSize, sizeof(header)) != header.m_CompSize) {
+            FX_Free(pCompBuf);
+            pCompBuf = NULL;
+        }
+    }
+    FX_File_Close(hFile);
+    if (pCompBuf == NULL) {
+        RemoveEntry(key);
+        return NULL;
+    }
+    FX_LPBYTE pDataBuf = NULL;
+    FX_DWORD data_size = 0;
+    FlateDecode(pCompBuf, header.m_CompSize, pDataBuf, data_size);
+    FX_Free(pCompBuf);
+    CFX_DIBitmap* pBitmap = NULL;
+    if (pDataBuf && data_size == header.m_Pitch * header.m_Height) {
+        pBitmap = FX_NEW CFX_DIBitmap;
+        if (pBitmap && (!pBitmap->Create(header.m_Width, header.m_Height, (FXDIB_Format)header.m_Format) ||
+                        (FX_DWORD)pBitmap->GetPitch() != header.m_Pitch)) {
+            delete pBitmap;
+            pBitmap = NULL;
+        }
+        if (pBitmap) {
+            FXSYS_memcpy32(pBitmap->GetBuffer(), pDataBuf, data_size);
+        }
+    }
+    if (pDataBuf) {
+        FX_Free(pDataBuf);
+    }
+    if (pBitmap == NULL) {
+        RemoveEntry(key);
+        return NULL;
+    }
+    UpdateEntry(key, file_size);
+    return pBitmap;
+}
+void CPDF_DiskPageImageCache::StorePageImage(const CFX_ByteString& key, const CFX_DIBitmap* pBitmap)
+{
+    if (pBitmap == NULL || pBitmap->GetBuffer() == NULL) {
+        return;
+    }
+    FXDIB_Format format = pBitmap->GetFormat();
+    if (format != FXDIB_Argb && format != FXDIB_Rgb && format != FXDIB_Rgb32) {
+        return;
+    }
+    FPDF_PAGECACHE_HEADER header;
+    header.m_Magic = FPDF_PAGECACHE_MAGIC;
+    header.m_Version = FPDF_PAGECACHE_VERSION;
+    header.m_Width = pBitmap->GetWidth();
+    header.m_Height = pBitmap->GetHeight();
+    header.m_Pitch = pBitmap->GetPitch();
+    header.m_Format = format;
+    FX_LPBYTE pCompBuf = NULL;
+    FX_DWORD comp_size = 0;
+    FlateEncode(pBitmap->GetBuffer(), header.m_Pitch * header.m_Height, pCompBuf, comp_size);
+    if (pCompBuf == NULL) {
+        return;
+    }
+    header.m_CompSize = comp_size;
+    if (m_dwLimit && sizeof(header) + comp_size > m_dwLimit) {
+        FX_Free(pCompBuf);
+        return;
+    }
+    // Other processes may write the same key at the same time, so the temporary name carries a
+    // random part and is created exclusively.
+    CFX_ByteString temp_path;
+    FX_HFILE hFile = NULL;
+    for (int retry = 0; retry < 8 && hFile == NULL; retry ++) {
+        FX_DWORD random;
+        FX_Random_GenerateMT(&random, 1);
+        temp_path.Format("%s%s.%08x%d.tmp", (FX_LPCSTR)m_CacheDir, (FX_LPCSTR)key, random, (int)FX_AtomicIncrement(&m_nTempSeq));
+        hFile = FX_File_Open(temp_path, FX_FILEMODE_Write | FX_FILEMODE_Exclusive);
+    }
+    if (hFile == NULL) {
+        FX_Free(pCompBuf);
+        return;
+    }
+    FX_BOOL bWritten = FX_File_Write(hFile, &header, sizeof(header)) == sizeof(header) &&
+                       FX_File_Write(hFile, pCompBuf, comp_size) == comp_size;
+    FX_File_Close(hFile);
+    FX_Free(pCompBuf);
+    if (!bWritten || !FX_File_Move(temp_path, GetFilePath(key))) {
+        FX_File_Delete(temp_path);
+        return;
+    }
+    UpdateEntry(key, sizeof(header) + comp_size);
+    Shrink();
+}
+void CPDF_DiskPageImageCache::OutputPage(CFX_RenderDevice* pDevice, CPDF_Page* pPage,
+        int pos_x, int pos_y, int size_x, int size_y, int rotate)
+{
+    CFX_DIBitmap* pTarget = pDevice->GetBitmap();
+    FX_RECT rect(pos_x, pos_y, pos_x + size_x, pos_y + size_y);
+    FX_DWORD backdrop = 0;
+    CFX_ByteString key;
+    FX_BOOL bCache = GetUniformBackdrop(pTarget, rect, backdrop) &&
+                     GetPageKey(pPage, size_x, size_y, rotate, 0, pTarget->GetFormat(), backdrop, key);
+    if (bCache) {
+        CFX_DIBitmap* pBitmap = LoadPageImage(key);
+        if (pBitmap && pBitmap->GetWidth() == size_x && pBitmap->GetHeight() == size_y && pBitmap->GetFormat() == pTarget->GetFormat()) {
+            pTarget->TransferBitmap(pos_x, pos_y, size_x, size_y, pBitmap, 0, 0);
+            delete pBitmap;
+            return;
+        }
+        if (pBitmap) {
+            delete pBitmap;
+        }
+    }
+    if (!pPage->IsParsed()) {
+        pPage->ParseContent();
+    }
+    CFX_AffineMatrix matrix;
+    pPage->GetDisplayMatrix(matrix, pos_x, pos_y, size_x, size_y, rotate);
+    pDevice->SaveState();
+    pDevice->SetClip_Rect(&rect);
+    CPDF_RenderContext context;
+    context.Create(pPage);
+    context.AppendObjectList(pPage, &matrix);
+    context.Render(pDevice);
+    pDevice->RestoreState();
+    if (bCache) {
+        CFX_DIBitmap* pBitmap = pTarget->Clone(&rect);
+        if (pBitmap) {
+            StorePageImage(key, pBitmap);
+            delete pBitmap;
+        }
+    }
+}
@@ -72,12 +72,16 @@ static void _DrawAxialShading(CFX_DIBitmap* pBitmap, CFX_AffineMatrix* pObject2B
     }
     int pitch = pBitmap->GetPitch();
     int Bpp = pBitmap->GetBPP() / 8;
+    // The axis parameter is an affine function of the device position, so each row is
+    // walked with a constant per-column step instead of transforming every pixel.
+    FX_FLOAT scale_step = FXSYS_Div(FXSYS_Mul(matrix.a, x_span) + FXSYS_Mul(matrix.b, y_span), axis_len_square);
     for (int row = 0; row < height; row ++) {
         FX_DWORD* dib_buf = (FX_DWORD*)(pBitmap->GetBuffer() + row * pitch);
+        FX_FLOAT x = 0, y = (FX_FLOAT)row;
+        matrix.Transform(x, y);
+        FX_FLOAT scale_start = FXSYS_Div(FXSYS_Mul(x - start_x, x_span) + FXSYS_Mul(y - start_y, y_span), axis_len_square);
         for (int column = 0; column < width; column ++) {
-            FX_FLOAT x = (FX_FLOAT)column, y = (FX_FLOAT)row;
-            matrix.Transform(x, y);
-            FX_FLOAT scale = FXSYS_Div(FXSYS_Mul(x - start_x, x_span) + FXSYS_Mul(y - start_y, y_span), axis_len_square);
+            FX_FLOAT scale = scale_start + scale_step * column;
             int index = (FX_INT32)(scale * (SHADING_STEPS - 1));
             if (index < 0) {
                 if (!bStartExtend) {
@@ -164,11 +168,13 @@ static void _DrawRadialShading(CFX_DIBitmap* pBitmap, CFX_AffineMatrix* pObject2
             bDecreasing = TRUE;
         }
     }
+    FX_FLOAT inverse_2a = a == 0 ? 0 : FXSYS_Div(1.0f, 2 * a);
     for (int row = 0; row < height; row ++) {
         FX_DWORD* dib_buf = (FX_DWORD*)(pBitmap->GetBuffer() + row * pitch);
+        FX_FLOAT row_x = 0, row_y = (FX_FLOAT)row;
+        matrix.Transform(row_x, row_y);
         for (int column = 0; column < width; column ++) {
-            FX_FLOAT x = (FX_FLOAT)column, y = (FX_FLOAT)row;
-            matrix.Transform(x, y);
+            FX_FLOAT x = row_x + matrix.a * column, y = row_y + matrix.b * column;
             FX_FLOAT b = -2 * (FXSYS_Mul(x - start_x, end_x - start_x) + FXSYS_Mul(y - start_y, end_y - start_y) +
                                FXSYS_Mul(start_r, end_r - start_r));
             FX_FLOAT c = FXSYS_Mul(x - start_x, x - start_x) + FXSYS_Mul(y - start_y, y - start_y) -
@@ -184,11 +190,11 @@ static void _DrawRadialShading(CFX_DIBitmap* pBitmap, CFX_AffineMatrix* pObject2
                 FX_FLOAT root = FXSYS_sqrt(b2_4ac);
                 FX_FLOAT s1, s2;
                 if (a > 0) {
-                    s1 = FXSYS_Div(-b - root, 2 * a);
-                    s2 = FXSYS_Div(-b + root, 2 * a);
+                    s1 = FXSYS_Mul(-b - root, inverse_2a);
+                    s2 = FXSYS_Mul(-b + root, inverse_2a);
                 } else {
-                    s2 = FXSYS_Div(-b - root, 2 * a);
-                    s1 = FXSYS_Div(-b + root, 2 * a);
+                    s2 = FXSYS_Mul(-b - root, inverse_2a);
+                    s1 = FXSYS_Mul(-b + root, inverse_2a);
                 }
                 if (bDecreasing) {
                     if (s1 >= 0 || bStartExtend) {
@@ -224,6 +230,171 @@ static void _DrawRadialShading(CFX_DIBitmap* pBitmap, CFX_AffineMatrix* pObject2
         }
     }
 }
+// Evaluates a function-based shading at device pixels. Rows are processed in bands of
+// FUNCSHADING_CELL pixels with the color computed exactly on the cell corners. A cell is
+// probed at its center and edge midpoints; it is filled by bilinear interpolation only when
+// every probe is within FUNCSHADING_TOLERANCE of the interpolated color and no two neighbouring
+// samples of the resulting 3x3 grid differ by more than FUNCSHADING_MAX_STEP. Otherwise the
+// cell is split into quadrants that reuse the probes as corners, and cells too small to probe
+// are evaluated per pixel, so any edge or ridge a probe lands on is refined down to pixels.
+// Cells that touch the outside of the domain are evaluated per pixel.
+#define FUNCSHADING_CELL		8
+#define FUNCSHADING_TOLERANCE	(1.0f / 255)
+#define FUNCSHADING_MAX_STEP	(32.0f / 255)
+class CPDF_FuncShadingSampler
+{
+public:
+    CPDF_FuncShadingSampler(const CFX_AffineMatrix& matrix, FX_FLOAT xmin, FX_FLOAT xmax, FX_FLOAT ymin, FX_FLOAT ymax,
+                            CPDF_Function** pFuncs, int nFuncs, CPDF_ColorSpace* pCS, FX_FLOAT* pResults)
+        : m_Matrix(matrix), m_XMin(xmin), m_XMax(xmax), m_YMin(ymin), m_YMax(ymax),
+          m_pFuncs(pFuncs), m_nFuncs(nFuncs), m_pCS(pCS), m_pResults(pResults)
+    {
+    }
+    FX_BOOL				Sample(int column, int row, FX_FLOAT* rgb) const
+    {
+        FX_FLOAT x = (FX_FLOAT)column, y = (FX_FLOAT)row;
+        m_Matrix.Transform(x, y);
+        if (x < m_XMin || x > m_XMax || y < m_YMin || y > m_YMax) {
+            return FALSE;
+        }
+        FX_FLOAT input[2];
+        int offset = 0;
+        input[0] = x;
+        input[1] = y;
+        for (int j = 0; j < m_nFuncs; j ++) {
+            if (m_pFuncs[j]) {
+                int nresults;
+                if (m_pFuncs[j]->Call(input, 2, m_pResults + offset, nresults)) {
+                    offset += nresults;
+                }
+            }
+        }
+        m_pCS->GetRGB(m_pResults, rgb[0], rgb[1], rgb[2]);
+        return TRUE;
+    }
+    CFX_AffineMatrix	m_Matrix;
+    FX_FLOAT			m_XMin, m_XMax, m_YMin, m_YMax;
+    CPDF_Function**		m_pFuncs;
+    int					m_nFuncs;
+    CPDF_ColorSpace*	m_pCS;
+    FX_FLOAT*			m_pResults;
+};
+static FX_BOOL _IsFuncShadingStepSmall(const FX_FLOAT* rgb1, const FX_FLOAT* rgb2)
+{
+    for (int i = 0; i < 3; i ++) {
+        if (FXSYS_fabs(rgb1[i] - rgb2[i]) > FUNCSHADING_MAX_STEP) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+static void _FillFuncShadingCell(CFX_DIBitmap* pBitmap, const CPDF_FuncShadingSampler& sampler, int alpha,
+                                 int left, int top, int right, int bottom, const FX_FLOAT* corners[4], const FX_BOOL* valid)
+{
+    int pitch = pBitmap->GetPitch();
+    int cell_width = right - left, cell_height = bottom - top;
+    if (valid[0] && valid[1] && valid[2] && valid[3] && cell_width > 2 && cell_height > 2) {
+        int mid_x = (left + right) / 2, mid_y = (top + bottom) / 2;
+        FX_FLOAT fx = (FX_FLOAT)(mid_x - left) / cell_width, fy = (FX_FLOAT)(mid_y - top) / cell_height;
+        FX_FLOAT center[3], top_mid[3], bottom_mid[3], left_mid[3], right_mid[3];
+        FX_BOOL center_valid = sampler.Sample(mid_x, mid_y, center);
+        FX_BOOL top_valid = sampler.Sample(mid_x, top, top_mid);
+        FX_BOOL bottom_valid = sampler.Sample(mid_x, bottom, bottom_mid);
+        FX_BOOL left_valid = sampler.Sample(left, mid_y, left_mid);
+        FX_BOOL right_valid = sampler.Sample(right, mid_y, right_mid);
+        FX_BOOL bInterpolate = center_valid && top_valid && bottom_valid && left_valid && right_valid;
+        for (int i = 0; bInterpolate && i < 3; i ++) {
+            FX_FLOAT top_value = corners[0][i] + (corners[1][i] - corners[0][i]) * fx;
+            FX_FLOAT bottom_value = corners[2][i] + (corners[3][i] - corners[2][i]) * fx;
+            FX_FLOAT left_value = corners[0][i] + (corners[2][i] - corners[0][i]) * fy;
+            FX_FLOAT right_value = corners[1][i] + (corners[3][i] - corners[1][i]) * fy;
+            FX_FLOAT center_value = top_value + (bottom_value - top_value) * fy;
+            if (FXSYS_fabs(center[i] - center_value) > FUNCSHADING_TOLERANCE ||
+                    FXSYS_fabs(top_mid[i] - top_value) > FUNCSHADING_TOLERANCE ||
+                    FXSYS_fabs(bottom_mid[i] - bottom_value) > FUNCSHADING_TOLERANCE ||
+                    FXSYS_fabs(left_mid[i] - left_value) > FUNCSHADING_TOLERANCE ||
+                    FXSYS_fabs(right_mid[i] - right_value) > FUNCSHADING_TOLERANCE) {
+                bInterpolate = FALSE;
+            }
+        }
+        if (bInterpolate) {
+            bInterpolate = _IsFuncShadingStepSmall(corners[0], top_mid) && _IsFuncShadingStepSmall(top_mid, corners[1]) &&
+                           _IsFuncShadingStepSmall(left_mid, center) && _IsFuncShadingStepSmall(center, right_mid) &&
+                           _IsFuncShadingStepSmall(corners[2], bottom_mid) && _IsFuncShadingStepSmall(bottom_mid, corners[3]) &&
+                           _IsFuncShadingStepSmall(corners[0], left_mid) && _IsFuncShadingStepSmall(left_mid, corners[2]) &&
+                           _IsFuncShadingStepSmall(top_mid, center) && _IsFuncShadingStepSmall(center, bottom_mid) &&
+                           _IsFuncShadingStepSmall(corners[1], right_mid) && _IsFuncShadingStepSmall(right_mid, corners[3]);
+        }
+        if (!bInterpolate) {
+            const FX_FLOAT* sub_corners[4];
+            FX_BOOL sub_valid[4];
+            sub_corners[0] = corners[0];
+            sub_corners[1] = top_mid;
+            sub_corners[2] = left_mid;
+            sub_corners[3] = center;
+            sub_valid[0] = valid[0];
+            sub_valid[1] = top_valid;
+            sub_valid[2] = left_valid;
+            sub_valid[3] = center_valid;
+            _FillFuncShadingCell(pBitmap, sampler, alpha, left, top, mid_x, mid_y, sub_corners, sub_valid);
+            sub_corners[0] = top_mid;
+            sub_corners[1] = corners[1];
+            sub_corners[2] = center;
+            sub_corners[3] = right_mid;
+            sub_valid[0] = top_valid;
+            sub_valid[1] = valid[1];
+            sub_valid[2] = center_valid;
+            sub_valid[3] = right_valid;
+            _FillFuncShadingCell(pBitmap, sampler, alpha, mid_x, top, right, mid_y, sub_corners, sub_valid);
+            sub_corners[0] = left_mid;
+            sub_corners[1] = center;
+            sub_corners[2] = corners[2];
+            sub_corners[3] = bottom_mid;
+            sub_valid[0] = left_valid;
+            sub_valid[1] = center_valid;
+            sub_valid[2] = valid[2];
+            sub_valid[3] = bottom_valid;
+            _FillFuncShadingCell(pBitmap, sampler, alpha, left, mid_y, mid_x, bottom, sub_corners, sub_valid);
+            sub_corners[0] = center;
+            sub_corners[1] = right_mid;
+            sub_corners[2] = bottom_mid;
+            sub_corners[3] = corners[3];
+            sub_valid[0] = center_valid;
+            sub_valid[1] = right_valid;
+            sub_valid[2] = bottom_valid;
+            sub_valid[3] = valid[3];
+            _FillFuncShadingCell(pBitmap, sampler, alpha, mid_x, mid_y, right, bottom, sub_corners, sub_valid);
+            return;
+        }
+        for (int row = top; row < bottom; row ++) {
+            FX_DWORD* dib_buf = (FX_DWORD*)(pBitmap->GetBuffer() + row * pitch);
+            FX_FLOAT fy = (FX_FLOAT)(row - top) / cell_height;
+            FX_FLOAT row_left[3], row_step[3];
+            for (int i = 0; i < 3; i ++) {
+                row_left[i] = corners[0][i] + (corners[2][i] - corners[0][i]) * fy;
+                FX_FLOAT row_right = corners[1][i] + (corners[3][i] - corners[1][i]) * fy;
+                row_step[i] = (row_right - row_left[i]) / cell_width;
+            }
+            for (int column = left; column < right; column ++) {
+                int offset = column - left;
+                FX_FLOAT R = row_left[0] + row_step[0] * offset;
+                FX_FLOAT G = row_left[1] + row_step[1] * offset;
+                FX_FLOAT B = row_left[2] + row_step[2] * offset;
+                dib_buf[column] = FXARGB_TODIB(FXARGB_MAKE(alpha, (FX_INT32)(R * 255), (FX_INT32)(G * 255), (FX_INT32)(B * 255)));
+            }
+        }
+        return;
+    }
+    for (int row = top; row < bottom; row ++) {
+        FX_DWORD* dib_buf = (FX_DWORD*)(pBitmap->GetBuffer() + row * pitch);
+        for (int column = left; column < right; column ++) {
+            FX_FLOAT rgb[3];
+            if (sampler.Sample(column, row, rgb)) {
+                dib_buf[column] = FXARGB_TODIB(FXARGB_MAKE(alpha, (FX_INT32)(rgb[0] * 255), (FX_INT32)(rgb[1] * 255), (FX_INT32)(rgb[2] * 255)));
+            }
+        }
+    }
+}
 static void _DrawFuncShading(CFX_DIBitmap* pBitmap, CFX_AffineMatrix* pObject2Bitmap,
                              CPDF_Dictionary* pDict, CPDF_Function** pFuncs, int nFuncs,
                              CPDF_ColorSpace* pCS, int alpha)
@@ -258,31 +429,41 @@ static void _DrawFuncShading(CFX_DIBitmap* pBitmap, CFX_AffineMatrix* pObject2Bi
     CFX_FixedBufGrow<FX_FLOAT, 16> result_array(total_results);
     FX_FLOAT* pResults = result_array;
     FXSYS_memset32(pResults, 0, total_results * sizeof(FX_FLOAT));
-    for (int row = 0; row < height; row ++) {
-        FX_DWORD* dib_buf = (FX_DWORD*)(pBitmap->GetBuffer() + row * pitch);
-        for (int column = 0; column < width; column ++) {
-            FX_FLOAT x = (FX_FLOAT)column, y = (FX_FLOAT)row;
-            matrix.Transform(x, y);
-            if (x < xmin || x > xmax || y < ymin || y > ymax) {
-                continue;
-            }
-            FX_FLOAT input[2];
-            int offset = 0;
-            input[0] = x;
-            input[1] = y;
-            for (int j = 0; j < nFuncs; j ++) {
-                if (pFuncs[j]) {
-                    int nresults;
-                    if (pFuncs[j]->Call(input, 2, pResults + offset, nresults)) {
-                        offset += nresults;
-                    }
-                }
-            }
-            FX_FLOAT R, G, B;
-            pCS->GetRGB(pResults, R, G, B);
-            dib_buf[column] = FXARGB_TODIB(FXARGB_MAKE(alpha, (FX_INT32)(R * 255), (FX_INT32)(G * 255), (FX_INT32)(B * 255)));
-        }
+    if (width <= 0 || height <= 0) {
+        return;
     }
+    CPDF_FuncShadingSampler sampler(matrix, xmin, xmax, ymin, ymax, pFuncs, nFuncs, pCS, pResults);
+    int nCells = (width + FUNCSHADING_CELL - 1) / FUNCSHADING_CELL;
+    FX_FLOAT* pColorBuf = FX_Alloc(FX_FLOAT, (nCells + 1) * 3 * 2);
+    FX_BOOL* pValidBuf = FX_Alloc(FX_BOOL, (nCells + 1) * 2);
+    FX_FLOAT* pTopColors = pColorBuf;
+    FX_FLOAT* pBottomColors = pColorBuf + (nCells + 1) * 3;
+    FX_BOOL* pTopValid = pValidBuf;
+    FX_BOOL* pBottomValid = pValidBuf + nCells + 1;
+    for (int i = 0; i <= nCells; i ++) {
+        pTopValid[i] = sampler.Sample(FX_MIN(i * FUNCSHADING_CELL, width), 0, pTopColors + i * 3);
+    }
+    for (int top = 0; top < height; top += FUNCSHADING_CELL) {
+        int bottom = FX_MIN(top + FUNCSHADING_CELL, height);
+        for (int i = 0; i <= nCells; i ++) {
+            pBottomValid[i] = sampler.Sample(FX_MIN(i * FUNCSHADING_CELL, width), bottom, pBottomColors + i * 3);
+        }
+        for (int i = 0; i < nCells; i ++) {
+            int left = i * FUNCSHADING_CELL;
+            int right = FX_MIN(left + FUNCSHADING_CELL, width);
+            const FX_FLOAT* corners[4] = {pTopColors + i * 3, pTopColors + i * 3 + 3, pBottomColors + i * 3, pBottomColors + i * 3 + 3};
+            FX_BOOL valid[4] = {pTopValid[i], pTopValid[i + 1], pBottomValid[i], pBottomValid[i + 1]};
+            _FillFuncShadingCell(pBitmap, sampler, alpha, left, top, right, bottom, corners, valid);
+        }
+        FX_FLOAT* pColors = pTopColors;
+        pTopColors = pBottomColors;
+        pBottomColors = pColors;
+        FX_BOOL* pValid = pTopValid;
+        pTopValid = pBottomValid;
+        pBottomValid = pValid;
+    }
+    FX_Free(pColorBuf);
+    FX_Free(pValidBuf);
 }
 FX_BOOL _GetScanlineIntersect(int y, FX_FLOAT x1, FX_FLOAT y1, FX_FLOAT x2, FX_FLOAT y2, FX_FLOAT& x)
 {
@@ -23,6 +23,7 @@ CPDF_Type3Cache::~CPDF_Type3Cache()
 }
 CFX_GlyphBitmap* CPDF_Type3Cache::LoadGlyph(FX_DWORD charcode, const CFX_AffineMatrix* pMatrix, FX_FLOAT retinaScaleX, FX_FLOAT retinaScaleY)
 {
+    CFX_CSLock lock(m_pFont->m_pDocument->GetLock());
     _CPDF_UniqueKeyGen keygen;
     keygen.Generate(4, FXSYS_round(pMatrix->a * 10000), FXSYS_round(pMatrix->b * 10000),
                     FXSYS_round(pMatrix->c * 10000), FXSYS_round(pMatrix->d * 10000));
@@ -191,7 +191,7 @@ public:
 
     FX_BOOL					Load(const CPDF_ImageObject* pImage, CPDF_PageRenderCache* pCache, FX_BOOL bStdCS = FALSE, FX_DWORD GroupFamily = 0, FX_BOOL bLoadMask = FALSE, CPDF_RenderStatus* pRenderStatus = NULL);
 
-    FX_BOOL					StartLoadImage(const CPDF_ImageObject* pImage, CPDF_PageRenderCache* pCache, FX_LPVOID& LoadHandle, FX_BOOL bStdCS = FALSE, FX_DWORD GroupFamily = 0, FX_BOOL bLoadMask = FALSE, CPDF_RenderStatus* pRenderStatus = NULL, FX_INT32 nDownsampleWidth = 0, FX_INT32 nDownsampleHeight = 0);
+    FX_BOOL					StartLoadImage(const CPDF_ImageObject* pImage, CPDF_PageRenderCache* pCache, FX_LPVOID& LoadHandle, FX_BOOL bStdCS = FALSE, FX_DWORD GroupFamily = 0, FX_BOOL bLoadMask = FALSE, CPDF_RenderStatus* pRenderStatus = NULL, FX_INT32 nDownsampleWidth = 0, FX_INT32 nDownsampleHeight = 0, const FX_RECT* pJpxWindow = NULL);
     FX_BOOL					Continue(FX_LPVOID LoadHandle, IFX_Pause* pPause);
     ~CPDF_ImageLoader();
     CFX_DIBSource*			m_pBitmap;
@@ -208,7 +208,7 @@ public:
     CPDF_ProgressiveImageLoaderHandle();
     ~CPDF_ProgressiveImageLoaderHandle();
 
-    FX_BOOL			Start(CPDF_ImageLoader* pImageLoader, const CPDF_ImageObject* pImage, CPDF_PageRenderCache* pCache, FX_BOOL bStdCS = FALSE, FX_DWORD GroupFamily = 0, FX_BOOL bLoadMask = FALSE, CPDF_RenderStatus* pRenderStatus = NULL, FX_INT32 nDownsampleWidth = 0, FX_INT32 nDownsampleHeight = 0);
+    FX_BOOL			Start(CPDF_ImageLoader* pImageLoader, const CPDF_ImageObject* pImage, CPDF_PageRenderCache* pCache, FX_BOOL bStdCS = FALSE, FX_DWORD GroupFamily = 0, FX_BOOL bLoadMask = FALSE, CPDF_RenderStatus* pRenderStatus = NULL, FX_INT32 nDownsampleWidth = 0, FX_INT32 nDownsampleHeight = 0, const FX_RECT* pJpxWindow = NULL);
     FX_BOOL			Continue(IFX_Pause* pPause);
 protected:
     CPDF_ImageLoader*	m_pImageLoader;
@@ -330,7 +330,8 @@ public:
     void				Reset(const CFX_DIBitmap* pBitmap);
     FX_BOOL				GetCachedBitmap(CFX_DIBSource*& pBitmap, CFX_DIBSource*& pMask, FX_DWORD& MatteColor, CPDF_Dictionary* pPageResources,
                                         FX_BOOL bStdCS = FALSE, FX_DWORD GroupFamily = 0, FX_BOOL bLoadMask = FALSE,
-                                        CPDF_RenderStatus* pRenderStatus = NULL, FX_INT32 downsampleWidth = 0, FX_INT32 downsampleHeight = 0);
+                                        CPDF_RenderStatus* pRenderStatus = NULL, FX_INT32 downsampleWidth = 0, FX_INT32 downsampleHeight = 0,
+                                        const FX_RECT* pJpxWindow = NULL);
     FX_DWORD			EstimateSize() const
     {
         return m_dwCacheSize;
@@ -351,7 +352,8 @@ public:
 public:
     int					StartGetCachedBitmap(CPDF_Dictionary* pFormResources, CPDF_Dictionary* pPageResources,
             FX_BOOL bStdCS = FALSE, FX_DWORD GroupFamily = 0,
-            FX_BOOL bLoadMask = FALSE, CPDF_RenderStatus* pRenderStatus = NULL, FX_INT32 downsampleWidth = 0, FX_INT32 downsampleHeight = 0);
+            FX_BOOL bLoadMask = FALSE, CPDF_RenderStatus* pRenderStatus = NULL, FX_INT32 downsampleWidth = 0, FX_INT32 downsampleHeight = 0,
+            const FX_RECT* pJpxWindow = NULL);
     int					Continue(IFX_Pause* pPause);
     int 				ContinueGetCachedBitmap();
     CFX_DIBSource*		DetachBitmap();
@@ -366,7 +368,10 @@ protected:
     CFX_DIBSource*		m_pCachedBitmap;
     CFX_DIBSource*		m_pCachedMask;
     FX_DWORD			m_dwCacheSize;
+    int					m_JpxReduceLevel;
+    FX_RECT				m_JpxWindow;
     void	CalcSize();
+    void	ReleaseReducedBitmap(int reduce_level, const FX_RECT* pJpxWindow);
 };
 typedef struct {
     FX_FLOAT			m_DecodeMin;
@@ -402,6 +407,7 @@ public:
     int					ContinueLoadMaskDIB(IFX_Pause* pPause);
     int					ContinueToLoadMask();
     CPDF_DIBSource*		DetachMask();
+    static int			GetJpxReduceLevel(const CPDF_Stream* pStream, int dest_width, int dest_height);
     CPDF_DIBSource*		m_pMask;
     FX_DWORD			m_MatteColor;
     FX_LPVOID			m_pJbig2Context;
@@ -410,6 +416,12 @@ public:
     int					m_Status;
     CPDF_Object*		m_pMaskStream;
     FX_BOOL				m_bHasMask;
+    // JPEG2000 images are decoded at 1/2^m_JpxReduceLevel of full resolution. Set before loading,
+    // updated to the level actually decoded.
+    int					m_JpxReduceLevel;
+    // Part of a JPEG2000 image to decode, in full resolution pixels; empty for the whole image.
+    // Pixels outside it are left white. Updated to empty if the whole image was decoded.
+    FX_RECT				m_JpxWindow;
 protected:
     FX_BOOL				LoadColorInfo(CPDF_Dictionary* pFormResources, CPDF_Dictionary* pPageResources);
     CPDF_DIBSource*		LoadMask(FX_DWORD& MatteColor);
@@ -455,6 +467,38 @@ public:
     FX_LPCBYTE				m_RampG;
     FX_LPCBYTE				m_RampB;
 };
+class CPDF_PageImageCacheEntry : public CFX_Object
+{
+public:
+    FX_DWORD				m_dwSize;
+    FX_DWORD				m_dwTime;
+};
+class CPDF_DiskPageImageCache : public IPDF_PageImageCache, public CFX_Object
+{
+public:
+    CPDF_DiskPageImageCache(FX_BSTR cache_dir);
+    ~CPDF_DiskPageImageCache();
+    void					LoadIndex();
+    virtual void			OutputPage(CFX_RenderDevice* pDevice, CPDF_Page* pPage,
+                                       int pos_x, int pos_y, int size_x, int size_y, int rotate);
+    virtual void			SetCacheLimit(FX_DWORD limit);
+    virtual FX_BOOL			GetPageKey(CPDF_Page* pPage, int size_x, int size_y, int rotate, FX_DWORD flags,
+                                       FXDIB_Format format, FX_DWORD backdrop, CFX_ByteString& key);
+    virtual CFX_DIBitmap*	LoadPageImage(const CFX_ByteString& key);
+    virtual void			StorePageImage(const CFX_ByteString& key, const CFX_DIBitmap* pBitmap);
+protected:
+    CFX_ByteString			GetFilePath(const CFX_ByteString& key) const;
+    void					UpdateEntry(const CFX_ByteString& key, FX_DWORD size);
+    void					RemoveEntry(const CFX_ByteString& key);
+    void					Shrink();
+    CFX_ByteString			m_CacheDir;
+    CFX_MapByteStringToPtr	m_Entries;
+    FX_FILESIZE				m_TotalSize;
+    FX_DWORD				m_dwLimit;
+    FX_DWORD				m_dwTime;
+    long volatile			m_nTempSeq;
+    CFX_Mutex				m_Lock;
+};
 struct _CPDF_UniqueKeyGen {
     void		Generate(int count, ...);
     FX_CHAR		m_Key[128];
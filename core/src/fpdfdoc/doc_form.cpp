@@ -29,6 +29,7 @@ FX_BOOL			NeedPDFEncodeForFieldTree(CPDF_Dictionary* pFieldDict, int nLevel = 0)
 void			EncodeFieldName(const CFX_WideString& csName, CFX_ByteString& csT);
 void			UpdateEncodeFieldName(CPDF_Dictionary* pFieldDict, int nLevel = 0);
 const int nMaxRecursion = 32;
+const int nMinChildMapSize = 16;
 class _CFieldNameExtractor : public CFX_Object
 {
 public:
@@ -60,8 +61,16 @@ public:
     struct _Node : public CFX_Object {
         _Node *parent;
         CFX_PtrArray children;
+        CFX_MapByteStringToPtr *child_map;
         CFX_WideString short_name;
         CPDF_FormField *field_ptr;
+        _Node() : parent(NULL), child_map(NULL), field_ptr(NULL) {}
+        ~_Node()
+        {
+            if (child_map) {
+                delete child_map;
+            }
+        }
         int CountFields(int nLevel = 0)
         {
             if (nLevel > nMaxRecursion) {
@@ -99,6 +108,19 @@ public:
             int fields_to_go = index;
             return GetField(&fields_to_go);
         }
+        void GetFields(CFX_PtrArray& fields, int nLevel = 0)
+        {
+            if (nLevel > nMaxRecursion) {
+                return;
+            }
+            if (field_ptr) {
+                fields.Add(field_ptr);
+                return;
+            }
+            for (int i = 0; i < children.GetSize(); i ++) {
+                ((_Node *)children.GetAt(i))->GetFields(fields, nLevel + 1);
+            }
+        }
     };
     CFieldTree();
     ~CFieldTree();
@@ -110,12 +132,24 @@ public:
     _Node * AddChild(_Node *pParent, const CFX_WideString &short_name, CPDF_FormField *field_ptr);
     void RemoveNode(_Node *pNode, int nLevel = 0);
     _Node *_Lookup(_Node *pParent, const CFX_WideString &short_name);
+    void _BuildChildMap(_Node *pParent);
+    int CountFields();
+    CPDF_FormField *GetFieldAt(int index);
     _Node m_Root;
+protected:
+    void _CacheFields();
+    CFX_PtrArray m_FieldArray;
+    FX_BOOL m_bFieldArrayValid;
 };
+static CFX_ByteStringC _GetNodeKey(const CFX_WideString &short_name)
+{
+    return CFX_ByteStringC((FX_LPCBYTE)(FX_LPCWSTR)short_name, short_name.GetLength() * sizeof(FX_WCHAR));
+}
 CFieldTree::CFieldTree()
 {
     m_Root.parent = NULL;
     m_Root.field_ptr = NULL;
+    m_bFieldArrayValid = FALSE;
 }
 CFieldTree::~CFieldTree()
 {
@@ -134,8 +168,32 @@ CFieldTree::_Node *CFieldTree::AddChild(_Node *pParent, const CFX_WideString &sh
     pNode->short_name = short_name;
     pNode->field_ptr = field_ptr;
     pParent->children.Add(pNode);
+    int nChildren = pParent->children.GetSize();
+    if (nChildren >= nMinChildMapSize && (nChildren & (nChildren - 1)) == 0) {
+        _BuildChildMap(pParent);
+    } else if (pParent->child_map) {
+        pParent->child_map->SetAt(_GetNodeKey(pNode->short_name), pNode);
+    }
+    m_bFieldArrayValid = FALSE;
     return pNode;
 }
+void CFieldTree::_BuildChildMap(_Node *pParent)
+{
+    if (pParent->child_map == NULL) {
+        pParent->child_map = FX_NEW CFX_MapByteStringToPtr;
+        if (pParent->child_map == NULL) {
+            return;
+        }
+    } else {
+        pParent->child_map->RemoveAll();
+    }
+    CFX_PtrArray& ptr_array = pParent->children;
+    pParent->child_map->InitHashTable(ptr_array.GetSize() * 2 + 1);
+    for (int i = 0; i < ptr_array.GetSize(); i ++) {
+        _Node *pNode = (_Node *)ptr_array[i];
+        pParent->child_map->SetAt(_GetNodeKey(pNode->short_name), pNode);
+    }
+}
 void CFieldTree::RemoveNode(_Node *pNode, int nLevel)
 {
     if (pNode == NULL) {
@@ -157,6 +215,11 @@ CFieldTree::_Node *CFieldTree::_Lookup(_Node *pParent, const CFX_WideString &sho
     if (pParent == NULL) {
         return NULL;
     }
+    if (pParent->child_map) {
+        void* pNode = NULL;
+        pParent->child_map->Lookup(_GetNodeKey(short_name), pNode);
+        return (_Node *)pNode;
+    }
     CFX_PtrArray& ptr_array = pParent->children;
     for (int i = 0; i < ptr_array.GetSize(); i ++) {
         _Node *pNode = (_Node *)ptr_array[i];
@@ -174,6 +237,36 @@ void CFieldTree::RemoveAll()
         _Node *pNode = (_Node *)ptr_array[i];
         RemoveNode(pNode);
     }
+    ptr_array.RemoveAll();
+    if (m_Root.child_map) {
+        delete m_Root.child_map;
+        m_Root.child_map = NULL;
+    }
+    m_FieldArray.RemoveAll();
+    m_bFieldArrayValid = FALSE;
+}
+void CFieldTree::_CacheFields()
+{
+    m_FieldArray.RemoveAll();
+    m_Root.GetFields(m_FieldArray);
+    m_bFieldArrayValid = TRUE;
+}
+int CFieldTree::CountFields()
+{
+    if (!m_bFieldArrayValid) {
+        _CacheFields();
+    }
+    return m_FieldArray.GetSize();
+}
+CPDF_FormField *CFieldTree::GetFieldAt(int index)
+{
+    if (!m_bFieldArrayValid) {
+        _CacheFields();
+    }
+    if (index < 0 || index >= m_FieldArray.GetSize()) {
+        return NULL;
+    }
+    return (CPDF_FormField *)m_FieldArray.GetAt(index);
 }
 void CFieldTree::SetField(const CFX_WideString &full_name, CPDF_FormField *field_ptr)
 {
@@ -196,6 +289,7 @@ void CFieldTree::SetField(const CFX_WideString &full_name, CPDF_FormField *field
     }
     if (pNode != &m_Root) {
         pNode->field_ptr = field_ptr;
+        m_bFieldArrayValid = FALSE;
     }
 }
 CPDF_FormField *CFieldTree::GetField(const CFX_WideString &full_name)
@@ -240,6 +334,10 @@ CPDF_FormField *CFieldTree::RemoveField(const CFX_WideString & full_name)
                 break;
             }
         }
+        if (pLast->child_map) {
+            pLast->child_map->RemoveKey(_GetNodeKey(pNode->short_name));
+        }
+        m_bFieldArrayValid = FALSE;
         CPDF_FormField *pField = pNode->field_ptr;
         RemoveNode(pNode);
         return pField;
@@ -294,9 +392,9 @@ CPDF_InterForm::~CPDF_InterForm()
         delete (CPDF_FormControl*)value;
     }
     if (m_pFieldTree != NULL) {
-        int nCount = m_pFieldTree->m_Root.CountFields();
+        int nCount = m_pFieldTree->CountFields();
         for (int i = 0; i < nCount; i++) {
-            CPDF_FormField *pField = m_pFieldTree->m_Root.GetField(i);
+            CPDF_FormField *pField = m_pFieldTree->GetFieldAt(i);
             delete pField;
         }
         delete m_pFieldTree;
@@ -655,9 +753,9 @@ FX_BOOL CPDF_InterForm::ValidateFieldName(CFX_WideString& csNewFieldName, int iT
                 break;
             }
         }
-        FX_DWORD dwCount = m_pFieldTree->m_Root.CountFields();
+        FX_DWORD dwCount = m_pFieldTree->CountFields();
         for (FX_DWORD m = 0; m < dwCount; m ++) {
-            CPDF_FormField* pField = m_pFieldTree->m_Root.GetField(m);
+            CPDF_FormField* pField = m_pFieldTree->GetFieldAt(m);
             if (pField == NULL) {
                 continue;
             }
@@ -756,7 +854,7 @@ int CPDF_InterForm::CompareFieldName(const CFX_WideString& name1, const CFX_Wide
 FX_DWORD CPDF_InterForm::CountFields(const CFX_WideString &csFieldName)
 {
     if (csFieldName.IsEmpty()) {
-        return (FX_DWORD)m_pFieldTree->m_Root.CountFields();
+        return (FX_DWORD)m_pFieldTree->CountFields();
     }
     CFieldTree::_Node *pNode = m_pFieldTree->FindNode(csFieldName);
     if (pNode == NULL) {
@@ -767,7 +865,7 @@ FX_DWORD CPDF_InterForm::CountFields(const CFX_WideString &csFieldName)
 CPDF_FormField* CPDF_InterForm::GetField(FX_DWORD index, const CFX_WideString &csFieldName)
 {
     if (csFieldName == L"") {
-        return m_pFieldTree->m_Root.GetField(index);
+        return m_pFieldTree->GetFieldAt(index);
     }
     CFieldTree::_Node *pNode = m_pFieldTree->FindNode(csFieldName);
     if (pNode == NULL) {
@@ -778,9 +876,9 @@ CPDF_FormField* CPDF_InterForm::GetField(FX_DWORD index, const CFX_WideString &c
 void CPDF_InterForm::GetAllFieldNames(CFX_WideStringArray& allFieldNames)
 {
     allFieldNames.RemoveAll();
-    int nCount = m_pFieldTree->m_Root.CountFields();
+    int nCount = m_pFieldTree->CountFields();
     for (int i = 0; i < nCount; i ++) {
-        CPDF_FormField *pField = m_pFieldTree->m_Root.GetField(i);
+        CPDF_FormField *pField = m_pFieldTree->GetFieldAt(i);
         if (pField) {
             CFX_WideString full_name = GetFullName(pField->GetFieldDict());
             allFieldNames.Add(full_name);
@@ -792,9 +890,9 @@ FX_BOOL CPDF_InterForm::IsValidFormField(const void* pField)
     if (pField == NULL) {
         return FALSE;
     }
-    int nCount = m_pFieldTree->m_Root.CountFields();
+    int nCount = m_pFieldTree->CountFields();
     for (int i = 0; i < nCount; i++) {
-        CPDF_FormField *pFormField = m_pFieldTree->m_Root.GetField(i);
+        CPDF_FormField *pFormField = m_pFieldTree->GetFieldAt(i);
         if (pField == pFormField) {
             return TRUE;
         }
@@ -1173,9 +1271,9 @@ FX_BOOL CPDF_InterForm::ResetForm(const CFX_PtrArray& fields, FX_BOOL bIncludeOr
             return FALSE;
         }
     }
-    int nCount = m_pFieldTree->m_Root.CountFields();
+    int nCount = m_pFieldTree->CountFields();
     for (int i = 0; i < nCount; i++) {
-        CPDF_FormField* pField = m_pFieldTree->m_Root.GetField(i);
+        CPDF_FormField* pField = m_pFieldTree->GetFieldAt(i);
         if (pField == NULL) {
             continue;
         }
@@ -1204,9 +1302,9 @@ FX_BOOL CPDF_InterForm::ResetForm(FX_BOOL bNotify)
             return FALSE;
         }
     }
-    int nCount = m_pFieldTree->m_Root.CountFields();
+    int nCount = m_pFieldTree->CountFields();
     for (int i = 0; i < nCount; i++) {
-        CPDF_FormField* pField = m_pFieldTree->m_Root.GetField(i);
+        CPDF_FormField* pField = m_pFieldTree->GetFieldAt(i);
         if (pField == NULL) {
             continue;
         }
@@ -1227,9 +1325,9 @@ void CPDF_InterForm::ReloadForm()
         delete pControl;
     }
     m_ControlMap.RemoveAll();
-    int nCount = m_pFieldTree->m_Root.CountFields();
+    int nCount = m_pFieldTree->CountFields();
     for (int k = 0; k < nCount; k ++) {
-        CPDF_FormField* pField = m_pFieldTree->m_Root.GetField(k);
+        CPDF_FormField* pField = m_pFieldTree->GetFieldAt(k);
         delete pField;
     }
     m_pFieldTree->RemoveAll();
@@ -1381,9 +1479,9 @@ CPDF_FormControl* CPDF_InterForm::AddControl(const CPDF_FormField* pField, const
 }
 CPDF_FormField* CPDF_InterForm::CheckRequiredFields(const CFX_PtrArray *fields, FX_BOOL bIncludeOrExclude) const
 {
-    int nCount = m_pFieldTree->m_Root.CountFields();
+    int nCount = m_pFieldTree->CountFields();
     for (int i = 0; i < nCount; i++) {
-        CPDF_FormField* pField = m_pFieldTree->m_Root.GetField(i);
+        CPDF_FormField* pField = m_pFieldTree->GetFieldAt(i);
         if (pField == NULL) {
             continue;
         }
@@ -1411,9 +1509,9 @@ CPDF_FormField* CPDF_InterForm::CheckRequiredFields(const CFX_PtrArray *fields,
 CFDF_Document* CPDF_InterForm::ExportToFDF(FX_WSTR pdf_path, FX_BOOL bSimpleFileSpec) const
 {
     CFX_PtrArray fields;
-    int nCount = m_pFieldTree->m_Root.CountFields();
+    int nCount = m_pFieldTree->CountFields();
     for (int i = 0; i < nCount; i ++) {
-        CPDF_FormField* pField = m_pFieldTree->m_Root.GetField(i);
+        CPDF_FormField* pField = m_pFieldTree->GetFieldAt(i);
         fields.Add(pField);
     }
     return ExportToFDF(pdf_path, fields, TRUE, bSimpleFileSpec);
@@ -1442,9 +1540,9 @@ CFDF_Document* CPDF_InterForm::ExportToFDF(FX_WSTR pdf_path, CFX_PtrArray& field
         return NULL;
     }
     pMainDict->SetAt("Fields", pFields);
-    int nCount = m_pFieldTree->m_Root.CountFields();
+    int nCount = m_pFieldTree->CountFields();
     for (int i = 0; i < nCount; i ++) {
-        CPDF_FormField* pField = m_pFieldTree->m_Root.GetField(i);
+        CPDF_FormField* pField = m_pFieldTree->GetFieldAt(i);
         if (pField == NULL || pField->GetType() == CPDF_FormField::PushButton) {
             continue;
         }
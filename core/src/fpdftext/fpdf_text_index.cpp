@@ -0,0 +1,414 @@
+// Copyright 2014 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+ 
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#include "../../include/fpdfapi/fpdf_pageobj.h"
+#include "../../include/fpdftext/fpdf_text.h"
+#include "../../include/fpdfapi/fpdf_page.h"
+#include "text_int.h"
+#define PDFTEXT_INDEX_MAGIC			0x58444954
+#define PDFTEXT_INDEX_VERSION		1
+#define PDFTEXT_INDEX_PAGEBREAK		L'\n'
+#define PDFTEXT_INDEX_NOCHAR		((FX_DWORD) - 1)
+// The index keeps the text of all added pages in one string, with every run of white space
+// reduced to a single blank and the pages separated by a line feed, so that a search string
+// normalized the same way never spans two pages. m_CharPos maps each position of that string
+// back to a char index of its page, and m_Suffixes lists the positions that do not start with
+// white space in the order of the case-folded text following them, so all occurrences of a
+// string are found by two binary searches.
+IPDF_TextIndex* IPDF_TextIndex::CreateTextIndex()
+{
+    return FX_NEW CPDF_TextIndex;
+}
+static FX_BOOL _IsTextIndexSpace(FX_WCHAR ch)
+{
+    return ch == L' ' || ch == L'\t' || ch == L'\r' || ch == L'\n' || ch == 160 || ch == 0;
+}
+CPDF_TextIndex::CPDF_TextIndex()
+{
+}
+FX_BOOL CPDF_TextIndex::AddPage(int page_index, const IPDF_TextPage* pTextPage)
+{
+    if (!pTextPage || !pTextPage->IsParsered()) {
+        return FALSE;
+    }
+    CFX_WideString text = pTextPage->GetPageText();
+    int nChars = pTextPage->CountChars();
+    m_PageIndex.Add(page_index);
+    m_PageStart.Add(m_Text.GetLength() + m_TextBuf.GetLength());
+    m_CharStart.Add(m_Chars.GetSize());
+    CPDF_TextObject* pLastObj = NULL;
+    FX_DWORD run = 0;
+    FX_BOOL bSpace = TRUE;
+    for (int i = 0; i < nChars; i ++) {
+        FPDF_CHAR_INFO info;
+        pTextPage->GetCharInfo(i, info);
+        PDFTEXT_INDEXCHAR item;
+        item.m_Left = info.m_CharBox.left;
+        item.m_Bottom = info.m_CharBox.bottom;
+        item.m_Right = info.m_CharBox.right;
+        item.m_Top = info.m_CharBox.top;
+        item.m_Run = PDFTEXT_INDEX_NOCHAR;
+        if (info.m_Flag != CHAR_GENERATED && info.m_CharBox.Width() >= 0.01f && info.m_CharBox.Height() >= 0.01f) {
+            if (info.m_pTextObj != pLastObj) {
+                pLastObj = info.m_pTextObj;
+                run ++;
+            }
+            item.m_Run = run;
+        }
+        m_Chars.Add(item);
+        int textIndex = pTextPage->TextIndexFromCharIndex(i);
+        if (textIndex < 0 || textIndex >= text.GetLength()) {
+            continue;
+        }
+        FX_WCHAR ch = text.GetAt(textIndex);
+        if (_IsTextIndexSpace(ch)) {
+            if (!bSpace) {
+                m_TextBuf.AppendChar(L' ');
+                m_CharPos.Add(PDFTEXT_INDEX_NOCHAR);
+                bSpace = TRUE;
+            }
+            continue;
+        }
+        m_TextBuf.AppendChar(ch);
+        m_CharPos.Add(i);
+        bSpace = FALSE;
+    }
+    m_TextBuf.AppendChar(PDFTEXT_INDEX_PAGEBREAK);
+    m_CharPos.Add(PDFTEXT_INDEX_NOCHAR);
+    return TRUE;
+}
+void CPDF_TextIndex::FinishIndex()
+{
+    m_Text += m_TextBuf.GetWideString();
+    m_TextBuf.Clear();
+    m_Folded = m_Text;
+    m_Folded.MakeLower();
+    BuildSuffixArray();
+}
+typedef struct {
+    FX_DWORD			m_Rank;
+    FX_DWORD			m_NextRank;
+    FX_DWORD			m_Pos;
+} PDFTEXT_SUFFIXSORT;
+extern "C" {
+    static int _CompareSuffixSort(const void* p1, const void* p2)
+    {
+        const PDFTEXT_SUFFIXSORT* pItem1 = (const PDFTEXT_SUFFIXSORT*)p1;
+        const PDFTEXT_SUFFIXSORT* pItem2 = (const PDFTEXT_SUFFIXSORT*)p2;
+        if (pItem1->m_Rank != pItem2->m_Rank) {
+            return pItem1->m_Rank < pItem2->m_Rank ? -1 : 1;
+        }
+        if (pItem1->m_NextRank != pItem2->m_NextRank) {
+            return pItem1->m_NextRank < pItem2->m_NextRank ? -1 : 1;
+        }
+        return 0;
+    }
+    static int _CompareDWord(const void* p1, const void* p2)
+    {
+        FX_DWORD v1 = *(const FX_DWORD*)p1, v2 = *(const FX_DWORD*)p2;
+        return v1 < v2 ? -1 : (v1 > v2 ? 1 : 0);
+    }
+};
+// Prefix doubling: after the pass with step k, suffixes are ordered by their first 2k chars and
+// equal ranks mean equal prefixes. The end of the text ranks below every char.
+void CPDF_TextIndex::BuildSuffixArray()
+{
+    m_Suffixes.RemoveAll();
+    int nLength = m_Folded.GetLength();
+    if (nLength == 0) {
+        return;
+    }
+    FX_LPCWSTR text = m_Folded;
+    FX_DWORD* pRanks = FX_Alloc(FX_DWORD, nLength);
+    PDFTEXT_SUFFIXSORT* pItems = FX_Alloc(PDFTEXT_SUFFIXSORT, nLength);
+    if (!pRanks || !pItems) {
+        if (pRanks) {
+            FX_Free(pRanks);
+        }
+        if (pItems) {
+            FX_Free(pItems);
+        }
+        return;
+    }
+    for (int i = 0; i < nLength; i ++) {
+        pRanks[i] = (FX_DWORD)text[i] + 1;
+    }
+    for (int step = 1; ; step *= 2) {
+        for (int i = 0; i < nLength; i ++) {
+            pItems[i].m_Rank = pRanks[i];
+            pItems[i].m_NextRank = i + step < nLength ? pRanks[i + step] : 0;
+            pItems[i].m_Pos = i;
+        }
+        FXSYS_qsort(pItems, nLength, sizeof(PDFTEXT_SUFFIXSORT), _CompareSuffixSort);
+        FX_DWORD rank = 1;
+        pRanks[pItems[0].m_Pos] = rank;
+        for (int i = 1; i < nLength; i ++) {
+            if (_CompareSuffixSort(pItems + i - 1, pItems + i)) {
+                rank ++;
+            }
+            pRanks[pItems[i].m_Pos] = rank;
+        }
+        if (rank == (FX_DWORD)nLength || step >= nLength) {
+            break;
+        }
+    }
+    for (int i = 0; i < nLength; i ++) {
+        if (!_IsTextIndexSpace(text[pItems[i].m_Pos])) {
+            m_Suffixes.Add(pItems[i].m_Pos);
+        }
+    }
+    FX_Free(pItems);
+    FX_Free(pRanks);
+}
+int CPDF_TextIndex::CompareSuffix(FX_DWORD pos, const CFX_WideString& folded) const
+{
+    FX_LPCWSTR text = m_Folded;
+    FX_DWORD nLength = m_Folded.GetLength();
+    int len = folded.GetLength();
+    for (int i = 0; i < len; i ++) {
+        if (pos + i >= nLength) {
+            return -1;
+        }
+        FX_DWORD ch1 = (FX_DWORD)text[pos + i];
+        FX_DWORD ch2 = (FX_DWORD)folded.GetAt(i);
+        if (ch1 != ch2) {
+            return ch1 < ch2 ? -1 : 1;
+        }
+    }
+    return 0;
+}
+int CPDF_TextIndex::FindPage(FX_DWORD pos) const
+{
+    int low = 0, high = m_PageStart.GetSize() - 1;
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if (m_PageStart[mid] <= pos) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+int CPDF_TextIndex::FindAll(const CFX_WideString& findwhat, int flags, CFX_TextIndexHitArray& hits) const
+{
+    hits.RemoveAll();
+    CFX_WideString query;
+    FX_BOOL bSpace = TRUE;
+    for (int i = 0; i < findwhat.GetLength(); i ++) {
+        FX_WCHAR ch = findwhat.GetAt(i);
+        if (_IsTextIndexSpace(ch)) {
+            if (!bSpace) {
+                query += L' ';
+                bSpace = TRUE;
+            }
+            continue;
+        }
+        query += ch;
+        bSpace = FALSE;
+    }
+    query.TrimRight(L' ');
+    int len = query.GetLength();
+    int nSuffixes = m_Suffixes.GetSize();
+    if (len == 0 || nSuffixes == 0) {
+        return 0;
+    }
+    CFX_WideString folded = query;
+    folded.MakeLower();
+    int low = 0, high = nSuffixes;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (CompareSuffix(m_Suffixes[mid], folded) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    int first = low;
+    high = nSuffixes;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (CompareSuffix(m_Suffixes[mid], folded) <= 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    int nMatches = low - first;
+    if (nMatches <= 0) {
+        return 0;
+    }
+    CFX_DWordArray positions;
+    if (!positions.SetSize(nMatches)) {
+        return 0;
+    }
+    FXSYS_memcpy32(positions.GetData(), m_Suffixes.GetData() + first, nMatches * sizeof(FX_DWORD));
+    FXSYS_qsort(positions.GetData(), nMatches, sizeof(FX_DWORD), _CompareDWord);
+    FX_BOOL bMatchCase = flags & FPDFTEXT_MATCHCASE;
+    FX_BOOL bMatchWholeWord = flags & FPDFTEXT_MATCHWHOLEWORD;
+    FX_BOOL bConsecutive = flags & FPDFTEXT_CONSECUTIVE;
+    FX_LPCWSTR text = m_Text;
+    FX_DWORD nextStart = 0;
+    for (int i = 0; i < nMatches; i ++) {
+        FX_DWORD pos = positions[i];
+        if (!bConsecutive && pos < nextStart) {
+            continue;
+        }
+        if (bMatchCase && FXSYS_memcmp32(text + pos, (FX_LPCWSTR)query, len * sizeof(FX_WCHAR))) {
+            continue;
+        }
+        if (bMatchWholeWord && !CPDF_TextPageFind::IsMatchWholeWord(m_Folded, pos, pos + len - 1)) {
+            continue;
+        }
+        FX_DWORD start = m_CharPos[pos];
+        FX_DWORD end = m_CharPos[pos + len - 1];
+        if (start == PDFTEXT_INDEX_NOCHAR || end == PDFTEXT_INDEX_NOCHAR || end < start) {
+            continue;
+        }
+        FPDF_TEXTINDEX_HIT hit;
+        hit.m_PageIndex = m_PageIndex[FindPage(pos)];
+        hit.m_CharIndex = start;
+        hit.m_CharCount = end - start + 1;
+        hits.Add(hit);
+        nextStart = pos + len;
+    }
+    return hits.GetSize();
+}
+// Same rectangles as CPDF_TextPage::GetRectArray: generated and empty chars are skipped and
+// one rectangle is produced per run of chars from the same text object.
+void CPDF_TextIndex::GetHitRects(const FPDF_TEXTINDEX_HIT& hit, CFX_RectArray& rects) const
+{
+    int nPages = m_PageIndex.GetSize();
+    int page = 0;
+    while (page < nPages && (int)m_PageIndex[page] != hit.m_PageIndex) {
+        page ++;
+    }
+    if (page == nPages || hit.m_CharIndex < 0 || hit.m_CharCount <= 0) {
+        return;
+    }
+    int begin = m_CharStart[page];
+    int end = page + 1 < nPages ? (int)m_CharStart[page + 1] : m_Chars.GetSize();
+    int start = begin + hit.m_CharIndex;
+    int stop = start + hit.m_CharCount;
+    if (stop > end) {
+        stop = end;
+    }
+    CFX_FloatRect rect;
+    FX_DWORD run = PDFTEXT_INDEX_NOCHAR;
+    for (int i = start; i < stop; i ++) {
+        const PDFTEXT_INDEXCHAR& item = m_Chars[i];
+        if (item.m_Run == PDFTEXT_INDEX_NOCHAR) {
+            continue;
+        }
+        CFX_FloatRect box(item.m_Left, item.m_Bottom, item.m_Right, item.m_Top);
+        box.Normalize();
+        if (run == item.m_Run) {
+            rect.Union(box);
+            continue;
+        }
+        if (run != PDFTEXT_INDEX_NOCHAR) {
+            rects.Add(rect);
+        }
+        rect = box;
+        run = item.m_Run;
+    }
+    if (run != PDFTEXT_INDEX_NOCHAR) {
+        rects.Add(rect);
+    }
+}
+template <class TYPE>
+static void _SaveIndexArray(CFX_ArchiveSaver& saver, const CFX_ArrayTemplate<TYPE>& array)
+{
+    saver << array.GetSize();
+    saver.Write(array.GetData(), array.GetSize() * sizeof(TYPE));
+}
+template <class TYPE>
+static FX_BOOL _LoadIndexArray(CFX_ArchiveLoader& loader, FX_DWORD size, CFX_ArrayTemplate<TYPE>& array)
+{
+    int count = -1;
+    loader >> count;
+    if (count < 0 || (FX_DWORD)count > size / sizeof(TYPE) || !array.SetSize(count)) {
+        return FALSE;
+    }
+    return count == 0 || loader.Read(array.GetData(), count * sizeof(TYPE));
+}
+void CPDF_TextIndex::Save(CFX_ArchiveSaver& saver) const
+{
+    saver << (FX_DWORD)PDFTEXT_INDEX_MAGIC << (FX_DWORD)PDFTEXT_INDEX_VERSION << (FX_DWORD)sizeof(FX_WCHAR);
+    saver << m_DocumentKey;
+    _SaveIndexArray(saver, m_PageIndex);
+    _SaveIndexArray(saver, m_PageStart);
+    _SaveIndexArray(saver, m_CharStart);
+    _SaveIndexArray(saver, m_Chars);
+    _SaveIndexArray(saver, m_CharPos);
+    _SaveIndexArray(saver, m_Suffixes);
+    int nLength = m_Text.GetLength();
+    saver << nLength;
+    saver.Write((FX_LPCWSTR)m_Text, nLength * sizeof(FX_WCHAR));
+}
+FX_BOOL CPDF_TextIndex::Load(FX_LPCBYTE pData, FX_DWORD size)
+{
+    CFX_ArchiveLoader loader(pData, size);
+    FX_DWORD magic = 0, version = 0, charsize = 0;
+    loader >> magic >> version >> charsize;
+    if (magic != PDFTEXT_INDEX_MAGIC || version != PDFTEXT_INDEX_VERSION || charsize != sizeof(FX_WCHAR)) {
+        return FALSE;
+    }
+    loader >> m_DocumentKey;
+    int nLength = -1;
+    FX_BOOL bValid = _LoadIndexArray(loader, size, m_PageIndex) && _LoadIndexArray(loader, size, m_PageStart) &&
+                     _LoadIndexArray(loader, size, m_CharStart) && _LoadIndexArray(loader, size, m_Chars) &&
+                     _LoadIndexArray(loader, size, m_CharPos) && _LoadIndexArray(loader, size, m_Suffixes);
+    if (bValid) {
+        loader >> nLength;
+        bValid = nLength >= 0 && (FX_DWORD)nLength <= size / sizeof(FX_WCHAR);
+    }
+    if (bValid && nLength) {
+        FX_LPWSTR buffer = m_Text.GetBuffer(nLength);
+        bValid = buffer && loader.Read(buffer, nLength * sizeof(FX_WCHAR));
+        m_Text.ReleaseBuffer(bValid ? nLength : 0);
+    }
+    int nPages = m_PageIndex.GetSize();
+    bValid = bValid && loader.IsEOF() && m_CharPos.GetSize() == nLength &&
+             m_PageStart.GetSize() == nPages && m_CharStart.GetSize() == nPages &&
+             (nPages ? m_PageStart[0] == 0 && m_CharStart[0] == 0 : nLength == 0 && m_Chars.GetSize() == 0);
+    for (int i = 0; bValid && i < nPages; i ++) {
+        if (m_PageStart[i] >= (FX_DWORD)nLength || (int)m_CharStart[i] > m_Chars.GetSize() ||
+                (i && (m_PageStart[i] < m_PageStart[i - 1] || m_CharStart[i] < m_CharStart[i - 1]))) {
+            bValid = FALSE;
+        }
+    }
+    for (int i = 0; bValid && i < nPages; i ++) {
+        FX_DWORD end = i + 1 < nPages ? m_PageStart[i + 1] : (FX_DWORD)nLength;
+        FX_DWORD nPageChars = (i + 1 < nPages ? m_CharStart[i + 1] : (FX_DWORD)m_Chars.GetSize()) - m_CharStart[i];
+        for (FX_DWORD pos = m_PageStart[i]; pos < end; pos ++) {
+            if (m_CharPos[pos] != PDFTEXT_INDEX_NOCHAR && m_CharPos[pos] >= nPageChars) {
+                bValid = FALSE;
+                break;
+            }
+        }
+    }
+    for (int i = 0; bValid && i < m_Suffixes.GetSize(); i ++) {
+        if (m_Suffixes[i] >= (FX_DWORD)nLength) {
+            bValid = FALSE;
+        }
+    }
+    if (!bValid) {
+        m_DocumentKey.Empty();
+        m_PageIndex.RemoveAll();
+        m_PageStart.RemoveAll();
+        m_CharStart.RemoveAll();
+        m_Chars.RemoveAll();
+        m_CharPos.RemoveAll();
+        m_Suffixes.RemoveAll();
+        m_Text.Empty();
+        m_Folded.Empty();
+        return FALSE;
+    }
+    m_Folded = m_Text;
+    m_Folded.MakeLower();
+    return TRUE;
+}
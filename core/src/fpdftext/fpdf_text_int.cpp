@@ -48,6 +48,14 @@ IPDF_TextPage*	IPDF_TextPage::CreateTextPage(const CPDF_PageObjects* pObjs, int
     CPDF_TextPage* pTextPage = FX_NEW CPDF_TextPage(pObjs, flags);
     return	pTextPage;
 }
+IPDF_TextPage* IPDF_TextPage::CreateTextOnlyPage(CPDF_Document* pDoc, CPDF_Dictionary* pPageDict, int flags)
+{
+    if (pDoc == NULL || pPageDict == NULL) {
+        return NULL;
+    }
+    CPDF_TextPage* pTextPage = FX_NEW CPDF_TextPage(pDoc, pPageDict, flags);
+    return pTextPage;
+}
 IPDF_TextPageFind*	IPDF_TextPageFind::CreatePageFind(const IPDF_TextPage* pTextPage)
 {
     if (!pTextPage) {
@@ -76,6 +84,7 @@ CPDF_TextPage::CPDF_TextPage(const CPDF_Page* pPage, int flags)
       m_CurlineRect(0, 0, 0, 0)
 {
     m_pPage = pPage;
+    m_pOwnedPage = NULL;
     m_parserflag = flags;
     m_TextBuf.EstimateSize(0, 10240);
     pPage->GetDisplayMatrix(m_DisplayMatrix, 0, 0, (int) pPage->GetPageWidth(), (int)pPage->GetPageHeight(), 0);
@@ -90,10 +99,26 @@ CPDF_TextPage::CPDF_TextPage(const CPDF_Page* pPage, CPDFText_ParseOptions Parse
     , m_ParseOptions(ParserOptions)
 {
     m_pPage = pPage;
+    m_pOwnedPage = NULL;
     m_parserflag = 0;
     m_TextBuf.EstimateSize(0, 10240);
     pPage->GetDisplayMatrix(m_DisplayMatrix, 0, 0, (int) pPage->GetPageWidth(), (int)pPage->GetPageHeight(), 0);
 }
+CPDF_TextPage::CPDF_TextPage(CPDF_Document* pDoc, CPDF_Dictionary* pPageDict, int flags)
+    : m_pPreTextObj(NULL),
+      m_IsParsered(FALSE),
+      m_charList(512),
+      m_TempCharList(50),
+      m_TextlineDir(-1),
+      m_CurlineRect(0, 0, 0, 0)
+{
+    m_pOwnedPage = FX_NEW CPDF_Page;
+    m_pOwnedPage->Load(pDoc, pPageDict);
+    m_pPage = m_pOwnedPage;
+    m_parserflag = flags;
+    m_TextBuf.EstimateSize(0, 10240);
+    m_pOwnedPage->GetDisplayMatrix(m_DisplayMatrix, 0, 0, (int)m_pOwnedPage->GetPageWidth(), (int)m_pOwnedPage->GetPageHeight(), 0);
+}
 CPDF_TextPage::CPDF_TextPage(const CPDF_PageObjects* pPage, int flags)
     : m_pPreTextObj(NULL),
       m_IsParsered(FALSE),
@@ -103,11 +128,18 @@ CPDF_TextPage::CPDF_TextPage(const CPDF_PageObjects* pPage, int flags)
       m_CurlineRect(0, 0, 0, 0)
 {
     m_pPage = pPage;
+    m_pOwnedPage = NULL;
     m_parserflag = flags;
     m_TextBuf.EstimateSize(0, 10240);
     CFX_FloatRect pageRect = pPage->CalcBoundingBox();
     m_DisplayMatrix = CFX_AffineMatrix(1, 0, 0, -1, pageRect.right, pageRect.top);
 }
+CPDF_TextPage::~CPDF_TextPage()
+{
+    if (m_pOwnedPage) {
+        delete m_pOwnedPage;
+    }
+}
 void CPDF_TextPage::NormalizeObjects(FX_BOOL bNormalize)
 {
     m_ParseOptions.m_bNormalizeObjs = bNormalize;
@@ -141,6 +173,11 @@ FX_BOOL CPDF_TextPage::ParseTextPage()
         m_IsParsered = FALSE;
         return FALSE;
     }
+    if (m_pOwnedPage && !m_pOwnedPage->IsParsed()) {
+        CPDF_ParseOptions options;
+        options.m_bTextOnly = TRUE;
+        m_pOwnedPage->ParseContent(&options);
+    }
     m_IsParsered = FALSE;
     m_TextBuf.Clear();
     m_charList.RemoveAll();
@@ -55,13 +55,14 @@ public:
     CPDF_TextPage(const CPDF_Page* pPage, int flags = 0);
     CPDF_TextPage(const CPDF_PageObjects* pPage, int flags = 0);
     CPDF_TextPage(const CPDF_Page* pPage, CPDFText_ParseOptions ParserOptions);
+    CPDF_TextPage(CPDF_Document* pDoc, CPDF_Dictionary* pPageDict, int flags = 0);
     virtual FX_BOOL					ParseTextPage();
     virtual void					NormalizeObjects(FX_BOOL bNormalize);
     virtual	FX_BOOL					IsParsered() const
     {
         return m_IsParsered;
     }
-    virtual ~CPDF_TextPage() {};
+    virtual ~CPDF_TextPage();
 public:
     virtual int CharIndexFromTextIndex(int TextIndex)const ;
     virtual int TextIndexFromCharIndex(int CharIndex)const;
@@ -119,6 +120,7 @@ protected:
     CPDFText_ParseOptions			m_ParseOptions;
     CFX_WordArray					m_CharIndex;
     const CPDF_PageObjects*			m_pPage;
+    CPDF_Page*						m_pOwnedPage;
     PAGECHAR_InfoArray				m_charList;
     CFX_WideTextBuf					m_TextBuf;
     PAGECHAR_InfoArray				m_TempCharList;
@@ -148,9 +150,9 @@ public:
     virtual void					GetRectArray(CFX_RectArray& rects) const;
     virtual int						GetCurOrder() const;
     virtual int						GetMatchedCount()const;
+    static FX_BOOL					IsMatchWholeWord(CFX_WideString csPageText, int startPos, int endPos);
 protected:
     void							ExtractFindWhat(CFX_WideString findwhat);
-    FX_BOOL							IsMatchWholeWord(CFX_WideString csPageText, int startPos, int endPos);
     FX_BOOL							ExtractSubString(CFX_WideString& rString, FX_LPCWSTR lpszFullString,
             int iSubString, FX_WCHAR chSep);
     CFX_WideString					MakeReverse(const CFX_WideString str);
@@ -209,6 +211,48 @@ private:
     CFX_WideString					m_strPageText;
     FX_BOOL							m_IsParserd;
 };
+typedef struct {
+    FX_FLOAT			m_Left;
+    FX_FLOAT			m_Bottom;
+    FX_FLOAT			m_Right;
+    FX_FLOAT			m_Top;
+    FX_DWORD			m_Run;
+} PDFTEXT_INDEXCHAR;
+class CPDF_TextIndex: public IPDF_TextIndex
+{
+public:
+    CPDF_TextIndex();
+    virtual							~CPDF_TextIndex() {};
+    virtual void					SetDocumentKey(FX_BSTR key)
+    {
+        m_DocumentKey = key;
+    }
+    virtual CFX_ByteString			GetDocumentKey() const
+    {
+        return m_DocumentKey;
+    }
+    virtual FX_BOOL					AddPage(int page_index, const IPDF_TextPage* pTextPage);
+    virtual void					FinishIndex();
+    virtual int						FindAll(const CFX_WideString& findwhat, int flags, CFX_TextIndexHitArray& hits) const;
+    virtual void					GetHitRects(const FPDF_TEXTINDEX_HIT& hit, CFX_RectArray& rects) const;
+    virtual void					Save(CFX_ArchiveSaver& saver) const;
+    virtual FX_BOOL					Load(FX_LPCBYTE pData, FX_DWORD size);
+protected:
+    void							BuildSuffixArray();
+    int								CompareSuffix(FX_DWORD pos, const CFX_WideString& folded) const;
+    int								FindPage(FX_DWORD pos) const;
+private:
+    CFX_ByteString					m_DocumentKey;
+    CFX_WideTextBuf					m_TextBuf;
+    CFX_WideString					m_Text;
+    CFX_WideString					m_Folded;
+    CFX_DWordArray					m_CharPos;
+    CFX_DWordArray					m_PageIndex;
+    CFX_DWordArray					m_PageStart;
+    CFX_DWordArray					m_CharStart;
+    CFX_ArrayTemplate<PDFTEXT_INDEXCHAR>	m_Chars;
+    CFX_DWordArray					m_Suffixes;
+};
 FX_STRSIZE FX_Unicode_GetNormalization(FX_WCHAR wch, FX_LPWSTR pDst);
 void NormalizeString(CFX_WideString& str);
 void NormalizeCompositeChar(FX_WCHAR wChar, CFX_WideString& sDest);
@@ -176,6 +176,7 @@ public:
 protected:
     CFX_MapByteStringToPtr		m_MapTranform;
     CFX_MapByteStringToPtr		m_MapProfile;
+    CFX_Mutex					m_Lock;
     typedef enum {
         Icc_CLASS_INPUT = 0,
         Icc_CLASS_OUTPUT,
@@ -189,10 +190,14 @@ class CCodec_JpxModule : public ICodec_JpxModule
 public:
     CCodec_JpxModule();
     void*		CreateDecoder(FX_LPCBYTE src_buf, FX_DWORD src_size, FX_BOOL useColorSpace = FALSE);
+    FX_BOOL		SetDecodeParams(FX_LPVOID ctx, int& reduce_level, FX_RECT* pClip = NULL);
     void		GetImageInfo(FX_LPVOID ctx, FX_DWORD& width, FX_DWORD& height,
                              FX_DWORD& codestream_nComps, FX_DWORD& output_nComps);
     FX_BOOL		Decode(void* ctx, FX_LPBYTE dest_data, int pitch, FX_BOOL bTranslateColor, FX_LPBYTE offsets);
     void		DestroyDecoder(void* ctx);
+    void		SetThreadCount(int nThreads);
+protected:
+    int			m_nThreads;
 };
 #include "../jbig2/JBig2_Context.h"
 class CPDF_Jbig2Interface : public CFX_Object, public CJBig2_Module
@@ -35,6 +35,10 @@ void CCodec_ModuleMgr::InitJpxDecoder()
 void CCodec_ModuleMgr::InitIccDecoder()
 {
 }
+void CCodec_ModuleMgr::SetJpxDecodeThreadCount(int nThreads)
+{
+    m_pJpxModule->SetThreadCount(nThreads > 0 ? nThreads : FX_Thread_GetProcessorCount());
+}
 CCodec_ScanlineDecoder::CCodec_ScanlineDecoder()
 {
     m_NextLine = -1;
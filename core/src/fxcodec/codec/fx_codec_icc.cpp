@@ -103,17 +103,18 @@ void* IccLib_CreateTransform(const unsigned char* pSrcProfileData, unsigned int
         cmsCloseProfile(dstProfile);
         return NULL;
     }
+    FX_DWORD dwFlags = FX_IsThreadSafeMode() ? cmsFLAGS_NOCACHE : 0;
     switch(dstCS) {
         case cmsSigGrayData:
-            hTransform = cmsCreateTransform(srcProfile, srcFormat, dstProfile, TYPE_GRAY_8, intent, 0);
+            hTransform = cmsCreateTransform(srcProfile, srcFormat, dstProfile, TYPE_GRAY_8, intent, dwFlags);
             break;
         case cmsSigRgbData:
-            hTransform = cmsCreateTransform(srcProfile, srcFormat, dstProfile, TYPE_BGR_8, intent, 0);
+            hTransform = cmsCreateTransform(srcProfile, srcFormat, dstProfile, TYPE_BGR_8, intent, dwFlags);
             break;
         case cmsSigCmykData:
             hTransform = cmsCreateTransform(srcProfile, srcFormat, dstProfile,
                                             T_DOSWAP(dwDstFormat) ? TYPE_KYMC_8 : TYPE_CMYK_8,
-                                            intent, 0);
+                                            intent, dwFlags);
             break;
         default:
             break;
@@ -447,6 +448,7 @@ FX_LPVOID CCodec_IccModule::CreateTransform(ICodec_IccModule::IccParam* pInputPa
         ICodec_IccModule::IccParam* pProofParam,
         FX_DWORD dwIntent, FX_DWORD dwFlag, FX_DWORD dwPrfIntent, FX_DWORD dwPrfFlag)
 {
+    CFX_CSLock lock(&m_Lock);
     CLcmsCmm* pCmm = NULL;
     ASSERT(pInputParam && pOutputParam);
     CFX_ByteStringKey key;
@@ -20,6 +20,25 @@ static void fx_info_callback(const char *msg, void *client_data)
 {
     (void)client_data;
 }
+typedef struct {
+    opj_job_fn	job_fn;
+    FX_LPBYTE	jobs;
+    OPJ_UINT32	job_size;
+} FX_OPJ_JOBS;
+static void fx_opj_job_proc(FX_LPVOID pParam, int index)
+{
+    FX_OPJ_JOBS* pJobs = (FX_OPJ_JOBS*)pParam;
+    pJobs->job_fn(pJobs->jobs + index * pJobs->job_size);
+}
+static void fx_opj_parallel_run(opj_job_fn job_fn, void* jobs, OPJ_UINT32 job_size, OPJ_UINT32 nb_jobs, void* user_data)
+{
+    (void)user_data;
+    FX_OPJ_JOBS params;
+    params.job_fn = job_fn;
+    params.jobs = (FX_LPBYTE)jobs;
+    params.job_size = job_size;
+    FX_Parallel_Run(fx_opj_job_proc, &params, (int)nb_jobs, (int)nb_jobs);
+}
 typedef struct {
     const unsigned char* src_data;
     int					 src_size;
@@ -555,16 +574,25 @@ public:
     CJPX_Decoder();
     ~CJPX_Decoder();
     FX_BOOL	Init(const unsigned char* src_data, int src_size);
+    FX_BOOL	SetDecodeParams(int& reduce_level, FX_RECT* pClip);
     void	GetInfo(FX_DWORD& width, FX_DWORD& height, FX_DWORD& codestream_nComps, FX_DWORD& output_nComps);
     FX_BOOL	Decode(FX_LPBYTE dest_buf, int pitch, FX_BOOL bTranslateColor, FX_LPBYTE offsets);
+    FX_BOOL	DecodeImage();
     FX_LPCBYTE m_SrcData;
     int m_SrcSize;
+    decodeData m_SrcStream;
     opj_image_t *image;
     opj_codec_t* l_codec;
     opj_stream_t *l_stream;
     FX_BOOL m_useColorSpace;
+    FX_BOOL m_bParamsSet;
+    FX_BOOL m_bDecoded;
+    FX_DWORD m_OutputWidth;
+    FX_DWORD m_OutputHeight;
+    int m_nThreads;
 };
-CJPX_Decoder::CJPX_Decoder(): image(NULL), l_codec(NULL), l_stream(NULL), m_useColorSpace(FALSE)
+CJPX_Decoder::CJPX_Decoder(): image(NULL), l_codec(NULL), l_stream(NULL), m_useColorSpace(FALSE),
+    m_bParamsSet(FALSE), m_bDecoded(FALSE), m_OutputWidth(0), m_OutputHeight(0), m_nThreads(1)
 {
 }
 CJPX_Decoder::~CJPX_Decoder()
@@ -586,11 +614,10 @@ FX_BOOL CJPX_Decoder::Init(const unsigned char* src_data, int src_size)
         image = NULL;
         m_SrcData = src_data;
         m_SrcSize = src_size;
-        decodeData srcData;
-        srcData.offset  = 0;
-        srcData.src_size = src_size;
-        srcData.src_data = src_data;
-        l_stream = fx_opj_stream_create_memory_stream(&srcData, OPJ_J2K_STREAM_CHUNK_SIZE, 1);
+        m_SrcStream.offset  = 0;
+        m_SrcStream.src_size = src_size;
+        m_SrcStream.src_data = src_data;
+        l_stream = fx_opj_stream_create_memory_stream(&m_SrcStream, OPJ_J2K_STREAM_CHUNK_SIZE, 1);
         if (l_stream == NULL) {
             return FALSE;
         }
@@ -612,6 +639,9 @@ FX_BOOL CJPX_Decoder::Init(const unsigned char* src_data, int src_size)
         if ( !opj_setup_decoder(l_codec, &parameters) ) {
             return FALSE;
         }
+        if (m_nThreads > 1) {
+            opj_set_parallel_handler(l_codec, fx_opj_parallel_run, m_nThreads, NULL);
+        }
         if(! opj_read_header(l_stream, l_codec, &image)) {
             image = NULL;
             return FALSE;
@@ -621,23 +651,100 @@ FX_BOOL CJPX_Decoder::Init(const unsigned char* src_data, int src_size)
         } else {
             image->useColorSpace = 0;
         }
-        if (!parameters.nb_tile_to_decode) {
-            if (!opj_set_decode_area(l_codec, image, parameters.DA_x0,
-                                     parameters.DA_y0, parameters.DA_x1, parameters.DA_y1)) {
-                opj_image_destroy(image);
-                image = NULL;
+        m_OutputWidth = image->x1;
+        m_OutputHeight = image->y1;
+    } catch (...) {
+        return FALSE;
+    }
+    return TRUE;
+}
+FX_BOOL CJPX_Decoder::SetDecodeParams(int& reduce_level, FX_RECT* pClip)
+{
+    if (m_bParamsSet || m_bDecoded || !image) {
+        return FALSE;
+    }
+    try {
+        if (reduce_level < 0) {
+            reduce_level = 0;
+        }
+        if (reduce_level > 0) {
+            opj_codestream_info_v2_t* pInfo = opj_get_cstr_info(l_codec);
+            if (pInfo == NULL) {
                 return FALSE;
             }
-            if (!(opj_decode(l_codec, l_stream, image) && opj_end_decompress(l_codec,	l_stream))) {
-                opj_image_destroy(image);
-                image = NULL;
-                return FALSE;
+            for (FX_DWORD i = 0; i < pInfo->nbcomps; i ++) {
+                int max_level = (int)pInfo->m_default_tile_info.tccp_info[i].numresolutions - 1;
+                if (reduce_level > max_level) {
+                    reduce_level = max_level > 0 ? max_level : 0;
+                }
             }
-        } else {
-            if (!opj_get_decoded_tile(l_codec, l_stream, image, parameters.tile_index)) {
+            opj_destroy_cstr_info(&pInfo);
+        }
+        opj_set_decoded_resolution_factor(l_codec, reduce_level);
+        for (FX_DWORD i = 0; i < image->numcomps; i ++) {
+            image->comps[i].factor = reduce_level;
+        }
+        int x0 = image->x0, y0 = image->y0, x1 = image->x1, y1 = image->y1;
+        if (pClip) {
+            x0 = image->x0 + pClip->left;
+            y0 = image->y0 + pClip->top;
+            x1 = image->x0 + pClip->right;
+            y1 = image->y0 + pClip->bottom;
+            if (x0 < (int)image->x0) {
+                x0 = image->x0;
+            }
+            if (y0 < (int)image->y0) {
+                y0 = image->y0;
+            }
+            if (x1 > (int)image->x1) {
+                x1 = image->x1;
+            }
+            if (y1 > (int)image->y1) {
+                y1 = image->y1;
+            }
+            if (x0 >= x1 || y0 >= y1) {
                 return FALSE;
             }
         }
+        int scale = 1 << reduce_level;
+        int origin_x = (image->x0 + scale - 1) / scale, origin_y = (image->y0 + scale - 1) / scale;
+        if (!opj_set_decode_area(l_codec, image, x0, y0, x1, y1)) {
+            return FALSE;
+        }
+        m_OutputWidth = (x1 + scale - 1) / scale - (x0 + scale - 1) / scale;
+        m_OutputHeight = (y1 + scale - 1) / scale - (y0 + scale - 1) / scale;
+        if (pClip) {
+            pClip->left = (x0 + scale - 1) / scale - origin_x;
+            pClip->top = (y0 + scale - 1) / scale - origin_y;
+            pClip->right = pClip->left + m_OutputWidth;
+            pClip->bottom = pClip->top + m_OutputHeight;
+        }
+        m_bParamsSet = TRUE;
+    } catch (...) {
+        return FALSE;
+    }
+    return TRUE;
+}
+FX_BOOL CJPX_Decoder::DecodeImage()
+{
+    if (m_bDecoded) {
+        return image != NULL;
+    }
+    m_bDecoded = TRUE;
+    if (!image) {
+        return FALSE;
+    }
+    try {
+        if (!m_bParamsSet && !opj_set_decode_area(l_codec, image, 0, 0, 0, 0)) {
+            opj_image_destroy(image);
+            image = NULL;
+            return FALSE;
+        }
+        if (!(opj_decode(l_codec, l_stream, image) && opj_end_decompress(l_codec,	l_stream))) {
+            opj_image_destroy(image);
+            image = NULL;
+            return FALSE;
+        }
         opj_stream_destroy(l_stream);
         l_stream = NULL;
         if( image->color_space != OPJ_CLRSPC_SYCC
@@ -655,18 +762,23 @@ FX_BOOL CJPX_Decoder::Init(const unsigned char* src_data, int src_size)
             image->icc_profile_buf = NULL;
             image->icc_profile_len = 0;
         }
-        if(!image) {
-            return FALSE;
-        }
     } catch (...) {
+        if (image) {
+            opj_image_destroy(image);
+            image = NULL;
+        }
         return FALSE;
     }
     return TRUE;
 }
 void CJPX_Decoder::GetInfo(FX_DWORD& width, FX_DWORD& height, FX_DWORD& codestream_nComps, FX_DWORD& output_nComps)
 {
-    width = (FX_DWORD)image->x1;
-    height = (FX_DWORD)image->y1;
+    if (!DecodeImage()) {
+        width = height = codestream_nComps = output_nComps = 0;
+        return;
+    }
+    width = m_OutputWidth;
+    height = m_OutputHeight;
     output_nComps = codestream_nComps = (FX_DWORD)image->numcomps;
 }
 FX_BOOL CJPX_Decoder::Decode(FX_LPBYTE dest_buf, int pitch, FX_BOOL bTranslateColor, FX_LPBYTE offsets)
@@ -676,14 +788,19 @@ FX_BOOL CJPX_Decoder::Decode(FX_LPBYTE dest_buf, int pitch, FX_BOOL bTranslateCo
     int i, wid, hei, row, col, channel, src;
     FX_BOOL flag;
     FX_LPBYTE pChannel, pScanline, pPixel;
+    if (!DecodeImage()) {
+        return FALSE;
+    }
     try {
-        if(image->comps[0].w != image->x1 || image->comps[0].h != image->y1) {
+        if(image->comps[0].w != m_OutputWidth || image->comps[0].h != m_OutputHeight) {
             return FALSE;
         }
         if(pitch < (int)(image->comps[0].w * 8 * image->numcomps + 31) >> 5 << 2) {
             return FALSE;
         }
-        FXSYS_memset8(dest_buf, 0xff, image->y1 * pitch);
+        for (FX_DWORD y = 0; y < image->comps[0].h; y ++) {
+            FXSYS_memset8(dest_buf + y * pitch, 0xff, image->comps[0].w * image->numcomps);
+        }
         channel_bufs = FX_Alloc(FX_BYTE*, image->numcomps);
         if (channel_bufs == NULL) {
             return FALSE;
@@ -767,6 +884,7 @@ void initialize_significance_luts();
 void initialize_sign_lut();
 CCodec_JpxModule::CCodec_JpxModule()
 {
+    m_nThreads = 1;
 }
 void* CCodec_JpxModule::CreateDecoder(FX_LPCBYTE src_buf, FX_DWORD src_size , FX_BOOL useColorSpace)
 {
@@ -775,12 +893,18 @@ void* CCodec_JpxModule::CreateDecoder(FX_LPCBYTE src_buf, FX_DWORD src_size , FX
         return NULL;
     }
     pDecoder->m_useColorSpace = useColorSpace;
+    pDecoder->m_nThreads = m_nThreads;
     if (!pDecoder->Init(src_buf, src_size)) {
         delete pDecoder;
         return NULL;
     }
     return pDecoder;
 }
+FX_BOOL CCodec_JpxModule::SetDecodeParams(FX_LPVOID ctx, int& reduce_level, FX_RECT* pClip)
+{
+    CJPX_Decoder* pDecoder = (CJPX_Decoder*)ctx;
+    return pDecoder->SetDecodeParams(reduce_level, pClip);
+}
 void CCodec_JpxModule::GetImageInfo(FX_LPVOID ctx, FX_DWORD& width, FX_DWORD& height,
                                     FX_DWORD& codestream_nComps, FX_DWORD& output_nComps)
 {
@@ -792,6 +916,10 @@ FX_BOOL CCodec_JpxModule::Decode(void* ctx, FX_LPBYTE dest_data, int pitch, FX_B
     CJPX_Decoder* pDecoder = (CJPX_Decoder*)ctx;
     return pDecoder->Decode(dest_data, pitch, bTranslateColor, offsets);
 }
+void CCodec_JpxModule::SetThreadCount(int nThreads)
+{
+    m_nThreads = nThreads > 0 ? nThreads : 1;
+}
 void CCodec_JpxModule::DestroyDecoder(void* ctx)
 {
     CJPX_Decoder* pDecoder = (CJPX_Decoder*)ctx;
@@ -85,6 +85,31 @@ Virtual function type for wavelet transform in 1-D
 */
 typedef void (*DWT1DFN)(opj_dwt_t* v);
 
+/**
+One band of rows or columns of a resolution level, transformed by a single job
+*/
+typedef struct opj_dwt_decode_job {
+	/** scratch buffer and band geometry for the 5-3 transform */
+	opj_dwt_t h;
+	/** scratch buffer and band geometry for the 9-7 transform */
+	opj_v4dwt_t v4;
+	DWT1DFN dwt_1D;
+	/** tile component data */
+	void* data;
+	/** tile component width and sample count */
+	OPJ_UINT32 w;
+	OPJ_UINT32 bufsize;
+	/** size of the resolution level */
+	OPJ_UINT32 rw;
+	OPJ_UINT32 rh;
+	/** rows or columns [min_j, max_j) to transform */
+	OPJ_UINT32 min_j;
+	OPJ_UINT32 max_j;
+} opj_dwt_decode_job_t;
+
+/* Resolution levels smaller than this are transformed on the calling thread */
+#define OPJ_DWT_PARALLEL_MIN_SAMPLES (256 * 256)
+
 /** @name Local static functions */
 /*@{*/
 
@@ -124,7 +149,24 @@ static void opj_dwt_encode_stepsize(OPJ_INT32 stepsize, OPJ_INT32 numbps, opj_st
 /**
 Inverse wavelet transform in 2-D.
 */
-static OPJ_BOOL opj_dwt_decode_tile(opj_tcd_tilecomp_t* tilec, OPJ_UINT32 i, DWT1DFN fn);
+static OPJ_BOOL opj_dwt_decode_tile(opj_tcd_tilecomp_t* tilec, OPJ_UINT32 i, DWT1DFN fn, const opj_parallel_t * p_parallel);
+/**
+Allocate the jobs of an inverse transform, each with its own scratch buffer
+*/
+static opj_dwt_decode_job_t* opj_dwt_create_jobs(opj_tcd_tilecomp_t* tilec, OPJ_UINT32 nb_jobs, OPJ_UINT32 mr, OPJ_BOOL real);
+static void opj_dwt_destroy_jobs(opj_dwt_decode_job_t* jobs, OPJ_UINT32 nb_jobs);
+/**
+Number of jobs each parallel step is split into
+*/
+static OPJ_UINT32 opj_dwt_max_jobs(const opj_parallel_t * p_parallel);
+/**
+Split count rows or columns into nb_jobs bands aligned to step and run fn on them
+*/
+static void opj_dwt_decode_pass(const opj_parallel_t * p_parallel, opj_job_fn fn, opj_dwt_decode_job_t* jobs, OPJ_UINT32 nb_jobs, OPJ_UINT32 count, OPJ_UINT32 step);
+static void opj_dwt_decode_h_job(void* p_job);
+static void opj_dwt_decode_v_job(void* p_job);
+static void opj_v4dwt_decode_h_job(void* p_job);
+static void opj_v4dwt_decode_v_job(void* p_job);
 
 static OPJ_BOOL opj_dwt_encode_procedure(	opj_tcd_tilecomp_t * tilec,
 										    void (*p_function)(OPJ_INT32 *, OPJ_INT32,OPJ_INT32,OPJ_INT32) );
@@ -471,8 +513,8 @@ OPJ_BOOL opj_dwt_encode(opj_tcd_tilecomp_t * tilec)
 /* <summary>                            */
 /* Inverse 5-3 wavelet transform in 2-D. */
 /* </summary>                           */
-OPJ_BOOL opj_dwt_decode(opj_tcd_tilecomp_t* tilec, OPJ_UINT32 numres) {
-	return opj_dwt_decode_tile(tilec, numres, &opj_dwt_decode_1);
+OPJ_BOOL opj_dwt_decode(opj_tcd_tilecomp_t* tilec, OPJ_UINT32 numres, const opj_parallel_t * p_parallel) {
+	return opj_dwt_decode_tile(tilec, numres, &opj_dwt_decode_1, p_parallel);
 }
 
 
@@ -557,59 +599,149 @@ OPJ_UINT32 opj_dwt_max_resolution(opj_tcd_resolution_t* restrict r, OPJ_UINT32 i
 /* <summary>                            */
 /* Inverse wavelet transform in 2-D.     */
 /* </summary>                           */
-OPJ_BOOL opj_dwt_decode_tile(opj_tcd_tilecomp_t* tilec, OPJ_UINT32 numres, DWT1DFN dwt_1D) {
-	opj_dwt_t h;
-	opj_dwt_t v;
+OPJ_BOOL opj_dwt_decode_tile(opj_tcd_tilecomp_t* tilec, OPJ_UINT32 numres, DWT1DFN dwt_1D, const opj_parallel_t * p_parallel) {
+	opj_dwt_decode_job_t* jobs;
+	OPJ_UINT32 max_jobs = opj_dwt_max_jobs(p_parallel);
+	OPJ_UINT32 i;
 
 	opj_tcd_resolution_t* tr = tilec->resolutions;
 
 	OPJ_UINT32 rw = (OPJ_UINT32)(tr->x1 - tr->x0);	/* width of the resolution level computed */
 	OPJ_UINT32 rh = (OPJ_UINT32)(tr->y1 - tr->y0);	/* height of the resolution level computed */
 
-	OPJ_UINT32 w = (OPJ_UINT32)(tilec->x1 - tilec->x0);
-
-	h.mem = (OPJ_INT32*)
-	opj_aligned_malloc(opj_dwt_max_resolution(tr, numres) * sizeof(OPJ_INT32));
-	if (! h.mem){
+	jobs = opj_dwt_create_jobs(tilec, max_jobs, opj_dwt_max_resolution(tr, numres), OPJ_FALSE);
+	if (! jobs){
 		return OPJ_FALSE;
 	}
-
-	v.mem = h.mem;
+	for (i = 0; i < max_jobs; ++i) {
+		jobs[i].dwt_1D = dwt_1D;
+	}
 
 	while( --numres) {
-		OPJ_INT32 * restrict tiledp = tilec->data;
-		OPJ_UINT32 j;
+		OPJ_INT32 h_sn = (OPJ_INT32)rw;
+		OPJ_INT32 v_sn = (OPJ_INT32)rh;
+		OPJ_UINT32 nb_jobs;
 
 		++tr;
-		h.sn = (OPJ_INT32)rw;
-		v.sn = (OPJ_INT32)rh;
 
 		rw = (OPJ_UINT32)(tr->x1 - tr->x0);
 		rh = (OPJ_UINT32)(tr->y1 - tr->y0);
+		nb_jobs = rw * rh >= OPJ_DWT_PARALLEL_MIN_SAMPLES ? max_jobs : 1;
+
+		for (i = 0; i < nb_jobs; ++i) {
+			jobs[i].rw = rw;
+			jobs[i].rh = rh;
+			jobs[i].h.sn = h_sn;
+			jobs[i].h.dn = (OPJ_INT32)(rw - (OPJ_UINT32)h_sn);
+			jobs[i].h.cas = tr->x0 % 2;
+		}
+		opj_dwt_decode_pass(p_parallel, opj_dwt_decode_h_job, jobs, nb_jobs, rh, 1);
+
+		for (i = 0; i < nb_jobs; ++i) {
+			jobs[i].h.sn = v_sn;
+			jobs[i].h.dn = (OPJ_INT32)(rh - (OPJ_UINT32)v_sn);
+			jobs[i].h.cas = tr->y0 % 2;
+		}
+		opj_dwt_decode_pass(p_parallel, opj_dwt_decode_v_job, jobs, nb_jobs, rw, 1);
+	}
+	opj_dwt_destroy_jobs(jobs, max_jobs);
+	return OPJ_TRUE;
+}
 
-		h.dn = (OPJ_INT32)(rw - (OPJ_UINT32)h.sn);
-		h.cas = tr->x0 % 2;
+void opj_dwt_decode_h_job(void* p_job) {
+	opj_dwt_decode_job_t* job = (opj_dwt_decode_job_t*) p_job;
+	OPJ_INT32 * restrict tiledp = (OPJ_INT32*) job->data;
+	OPJ_UINT32 w = job->w;
+	OPJ_UINT32 j;
 
-		for(j = 0; j < rh; ++j) {
-			opj_dwt_interleave_h(&h, &tiledp[j*w]);
-			(dwt_1D)(&h);
-			memcpy(&tiledp[j*w], h.mem, rw * sizeof(OPJ_INT32));
+	for(j = job->min_j; j < job->max_j; ++j) {
+		opj_dwt_interleave_h(&job->h, &tiledp[j*w]);
+		(job->dwt_1D)(&job->h);
+		memcpy(&tiledp[j*w], job->h.mem, job->rw * sizeof(OPJ_INT32));
+	}
+}
+
+void opj_dwt_decode_v_job(void* p_job) {
+	opj_dwt_decode_job_t* job = (opj_dwt_decode_job_t*) p_job;
+	OPJ_INT32 * restrict tiledp = (OPJ_INT32*) job->data;
+	OPJ_UINT32 w = job->w;
+	OPJ_UINT32 j;
+
+	for(j = job->min_j; j < job->max_j; ++j){
+		OPJ_UINT32 k;
+		opj_dwt_interleave_v(&job->h, &tiledp[j], (OPJ_INT32)w);
+		(job->dwt_1D)(&job->h);
+		for(k = 0; k < job->rh; ++k) {
+			tiledp[k * w + j] = job->h.mem[k];
 		}
+	}
+}
+
+OPJ_UINT32 opj_dwt_max_jobs(const opj_parallel_t * p_parallel) {
+	if (! p_parallel || ! p_parallel->m_run || p_parallel->m_nb_threads < 2) {
+		return 1;
+	}
+	return p_parallel->m_nb_threads;
+}
 
-		v.dn = (OPJ_INT32)(rh - (OPJ_UINT32)v.sn);
-		v.cas = tr->y0 % 2;
+opj_dwt_decode_job_t* opj_dwt_create_jobs(opj_tcd_tilecomp_t* tilec, OPJ_UINT32 nb_jobs, OPJ_UINT32 mr, OPJ_BOOL real) {
+	opj_dwt_decode_job_t* jobs = (opj_dwt_decode_job_t*) opj_calloc(nb_jobs, sizeof(opj_dwt_decode_job_t));
+	OPJ_UINT32 i;
 
-		for(j = 0; j < rw; ++j){
-			OPJ_UINT32 k;
-			opj_dwt_interleave_v(&v, &tiledp[j], (OPJ_INT32)w);
-			(dwt_1D)(&v);
-			for(k = 0; k < rh; ++k) {
-				tiledp[k * w + j] = v.mem[k];
+	if (! jobs) {
+		return 00;
+	}
+	for (i = 0; i < nb_jobs; ++i) {
+		if (real) {
+			jobs[i].v4.wavelet = (opj_v4_t*) opj_aligned_malloc((mr + 5) * sizeof(opj_v4_t));
+			if (! jobs[i].v4.wavelet) {
+				opj_dwt_destroy_jobs(jobs, nb_jobs);
+				return 00;
+			}
+		} else {
+			jobs[i].h.mem = (OPJ_INT32*) opj_aligned_malloc(mr * sizeof(OPJ_INT32));
+			if (! jobs[i].h.mem) {
+				opj_dwt_destroy_jobs(jobs, nb_jobs);
+				return 00;
 			}
 		}
+		jobs[i].data = tilec->data;
+		jobs[i].w = (OPJ_UINT32)(tilec->x1 - tilec->x0);
+		jobs[i].bufsize = (OPJ_UINT32)((tilec->x1 - tilec->x0) * (tilec->y1 - tilec->y0));
 	}
-	opj_aligned_free(h.mem);
-	return OPJ_TRUE;
+	return jobs;
+}
+
+void opj_dwt_destroy_jobs(opj_dwt_decode_job_t* jobs, OPJ_UINT32 nb_jobs) {
+	OPJ_UINT32 i;
+
+	for (i = 0; i < nb_jobs; ++i) {
+		if (jobs[i].h.mem) {
+			opj_aligned_free(jobs[i].h.mem);
+		}
+		if (jobs[i].v4.wavelet) {
+			opj_aligned_free(jobs[i].v4.wavelet);
+		}
+	}
+	opj_free(jobs);
+}
+
+void opj_dwt_decode_pass(const opj_parallel_t * p_parallel, opj_job_fn fn, opj_dwt_decode_job_t* jobs, OPJ_UINT32 nb_jobs, OPJ_UINT32 count, OPJ_UINT32 step) {
+	OPJ_UINT32 per_job, i;
+
+	if (nb_jobs < 2) {
+		jobs[0].min_j = 0;
+		jobs[0].max_j = count;
+		fn(&jobs[0]);
+		return;
+	}
+	per_job = (count + nb_jobs - 1) / nb_jobs;
+	per_job = (per_job + step - 1) / step * step;
+	for (i = 0; i < nb_jobs; ++i) {
+		jobs[i].min_j = opj_uint_min(i * per_job, count);
+		jobs[i].max_j = opj_uint_min(jobs[i].min_j + per_job, count);
+	}
+	p_parallel->m_run(fn, jobs, (OPJ_UINT32)sizeof(opj_dwt_decode_job_t), nb_jobs, p_parallel->m_user_data);
 }
 
 void opj_v4dwt_interleave_h(opj_v4dwt_t* restrict w, OPJ_FLOAT32* restrict a, OPJ_INT32 x, OPJ_INT32 size){
@@ -829,97 +961,129 @@ void opj_v4dwt_decode(opj_v4dwt_t* restrict dwt)
 /* <summary>                             */
 /* Inverse 9-7 wavelet transform in 2-D. */
 /* </summary>                            */
-OPJ_BOOL opj_dwt_decode_real(opj_tcd_tilecomp_t* restrict tilec, OPJ_UINT32 numres)
+OPJ_BOOL opj_dwt_decode_real(opj_tcd_tilecomp_t* restrict tilec, OPJ_UINT32 numres, const opj_parallel_t * p_parallel)
 {
-	opj_v4dwt_t h;
-	opj_v4dwt_t v;
+	opj_dwt_decode_job_t* jobs;
+	OPJ_UINT32 max_jobs = opj_dwt_max_jobs(p_parallel);
+	OPJ_UINT32 i;
 
 	opj_tcd_resolution_t* res = tilec->resolutions;
 
 	OPJ_UINT32 rw = (OPJ_UINT32)(res->x1 - res->x0);	/* width of the resolution level computed */
 	OPJ_UINT32 rh = (OPJ_UINT32)(res->y1 - res->y0);	/* height of the resolution level computed */
 
-	OPJ_UINT32 w = (OPJ_UINT32)(tilec->x1 - tilec->x0);
-
-	h.wavelet = (opj_v4_t*) opj_aligned_malloc((opj_dwt_max_resolution(res, numres)+5) * sizeof(opj_v4_t));
-	v.wavelet = h.wavelet;
+	jobs = opj_dwt_create_jobs(tilec, max_jobs, opj_dwt_max_resolution(res, numres), OPJ_TRUE);
+	if (! jobs) {
+		return OPJ_FALSE;
+	}
 
 	while( --numres) {
-		OPJ_FLOAT32 * restrict aj = (OPJ_FLOAT32*) tilec->data;
-		OPJ_UINT32 bufsize = (OPJ_UINT32)((tilec->x1 - tilec->x0) * (tilec->y1 - tilec->y0));
-		OPJ_INT32 j;
-
-		h.sn = (OPJ_INT32)rw;
-		v.sn = (OPJ_INT32)rh;
+		OPJ_INT32 h_sn = (OPJ_INT32)rw;
+		OPJ_INT32 v_sn = (OPJ_INT32)rh;
+		OPJ_UINT32 nb_jobs;
 
 		++res;
 
 		rw = (OPJ_UINT32)(res->x1 - res->x0);	/* width of the resolution level computed */
 		rh = (OPJ_UINT32)(res->y1 - res->y0);	/* height of the resolution level computed */
-
-		h.dn = (OPJ_INT32)(rw - (OPJ_UINT32)h.sn);
-		h.cas = res->x0 % 2;
-
-		for(j = (OPJ_INT32)rh; j > 3; j -= 4) {
-			OPJ_INT32 k;
-			opj_v4dwt_interleave_h(&h, aj, (OPJ_INT32)w, (OPJ_INT32)bufsize);
-			opj_v4dwt_decode(&h);
-
-			for(k = (OPJ_INT32)rw; --k >= 0;){
-				aj[k               ] = h.wavelet[k].f[0];
-				aj[k+(OPJ_INT32)w  ] = h.wavelet[k].f[1];
-				aj[k+(OPJ_INT32)w*2] = h.wavelet[k].f[2];
-				aj[k+(OPJ_INT32)w*3] = h.wavelet[k].f[3];
-			}
-
-			aj += w*4;
-			bufsize -= w*4;
+		nb_jobs = rw * rh >= OPJ_DWT_PARALLEL_MIN_SAMPLES ? max_jobs : 1;
+
+		for (i = 0; i < nb_jobs; ++i) {
+			jobs[i].rw = rw;
+			jobs[i].rh = rh;
+			jobs[i].v4.sn = h_sn;
+			jobs[i].v4.dn = (OPJ_INT32)(rw - (OPJ_UINT32)h_sn);
+			jobs[i].v4.cas = res->x0 % 2;
 		}
+		/* Rows are transformed four at a time, so bands start on a multiple of four */
+		opj_dwt_decode_pass(p_parallel, opj_v4dwt_decode_h_job, jobs, nb_jobs, rh, 4);
 
-		if (rh & 0x03) {
-			OPJ_INT32 k;
-			j = rh & 0x03;
-			opj_v4dwt_interleave_h(&h, aj, (OPJ_INT32)w, (OPJ_INT32)bufsize);
-			opj_v4dwt_decode(&h);
-			for(k = (OPJ_INT32)rw; --k >= 0;){
-				switch(j) {
-					case 3: aj[k+(OPJ_INT32)w*2] = h.wavelet[k].f[2];
-					case 2: aj[k+(OPJ_INT32)w  ] = h.wavelet[k].f[1];
-					case 1: aj[k               ] = h.wavelet[k].f[0];
-				}
-			}
+		for (i = 0; i < nb_jobs; ++i) {
+			jobs[i].v4.sn = v_sn;
+			jobs[i].v4.dn = (OPJ_INT32)(rh - (OPJ_UINT32)v_sn);
+			jobs[i].v4.cas = res->y0 % 2;
 		}
+		opj_dwt_decode_pass(p_parallel, opj_v4dwt_decode_v_job, jobs, nb_jobs, rw, 4);
+	}
 
-		v.dn = (OPJ_INT32)(rh - (OPJ_UINT32)v.sn);
-		v.cas = res->y0 % 2;
+	opj_dwt_destroy_jobs(jobs, max_jobs);
+	return OPJ_TRUE;
+}
 
-		aj = (OPJ_FLOAT32*) tilec->data;
-		for(j = (OPJ_INT32)rw; j > 3; j -= 4){
-			OPJ_UINT32 k;
+void opj_v4dwt_decode_h_job(void* p_job)
+{
+	opj_dwt_decode_job_t* job = (opj_dwt_decode_job_t*) p_job;
+	opj_v4dwt_t h = job->v4;
+	OPJ_UINT32 w = job->w;
+	OPJ_UINT32 rw = job->rw;
+	OPJ_UINT32 rh = job->max_j - job->min_j;
+	OPJ_FLOAT32 * restrict aj = (OPJ_FLOAT32*) job->data + job->min_j * w;
+	OPJ_UINT32 bufsize = job->bufsize - job->min_j * w;
+	OPJ_INT32 j;
+
+	for(j = (OPJ_INT32)rh; j > 3; j -= 4) {
+		OPJ_INT32 k;
+		opj_v4dwt_interleave_h(&h, aj, (OPJ_INT32)w, (OPJ_INT32)bufsize);
+		opj_v4dwt_decode(&h);
+
+		for(k = (OPJ_INT32)rw; --k >= 0;){
+			aj[k               ] = h.wavelet[k].f[0];
+			aj[k+(OPJ_INT32)w  ] = h.wavelet[k].f[1];
+			aj[k+(OPJ_INT32)w*2] = h.wavelet[k].f[2];
+			aj[k+(OPJ_INT32)w*3] = h.wavelet[k].f[3];
+		}
 
-			opj_v4dwt_interleave_v(&v, aj, (OPJ_INT32)w, 4);
-			opj_v4dwt_decode(&v);
+		aj += w*4;
+		bufsize -= w*4;
+	}
 
-			for(k = 0; k < rh; ++k){
-				memcpy(&aj[k*w], &v.wavelet[k], 4 * sizeof(OPJ_FLOAT32));
+	if (rh & 0x03) {
+		OPJ_INT32 k;
+		j = rh & 0x03;
+		opj_v4dwt_interleave_h(&h, aj, (OPJ_INT32)w, (OPJ_INT32)bufsize);
+		opj_v4dwt_decode(&h);
+		for(k = (OPJ_INT32)rw; --k >= 0;){
+			switch(j) {
+				case 3: aj[k+(OPJ_INT32)w*2] = h.wavelet[k].f[2];
+				case 2: aj[k+(OPJ_INT32)w  ] = h.wavelet[k].f[1];
+				case 1: aj[k               ] = h.wavelet[k].f[0];
 			}
-			aj += 4;
 		}
+	}
+}
+
+void opj_v4dwt_decode_v_job(void* p_job)
+{
+	opj_dwt_decode_job_t* job = (opj_dwt_decode_job_t*) p_job;
+	opj_v4dwt_t v = job->v4;
+	OPJ_UINT32 w = job->w;
+	OPJ_UINT32 rw = job->max_j - job->min_j;
+	OPJ_UINT32 rh = job->rh;
+	OPJ_FLOAT32 * restrict aj = (OPJ_FLOAT32*) job->data + job->min_j;
+	OPJ_INT32 j;
+
+	for(j = (OPJ_INT32)rw; j > 3; j -= 4){
+		OPJ_UINT32 k;
+
+		opj_v4dwt_interleave_v(&v, aj, (OPJ_INT32)w, 4);
+		opj_v4dwt_decode(&v);
+
+		for(k = 0; k < rh; ++k){
+			memcpy(&aj[k*w], &v.wavelet[k], 4 * sizeof(OPJ_FLOAT32));
+		}
+		aj += 4;
+	}
 
-		if (rw & 0x03){
-			OPJ_UINT32 k;
+	if (rw & 0x03){
+		OPJ_UINT32 k;
 
-			j = rw & 0x03;
+		j = rw & 0x03;
 
-			opj_v4dwt_interleave_v(&v, aj, (OPJ_INT32)w, j);
-			opj_v4dwt_decode(&v);
+		opj_v4dwt_interleave_v(&v, aj, (OPJ_INT32)w, j);
+		opj_v4dwt_decode(&v);
 
-			for(k = 0; k < rh; ++k){
-				memcpy(&aj[k*w], &v.wavelet[k], (size_t)j * sizeof(OPJ_FLOAT32));
-			}
+		for(k = 0; k < rh; ++k){
+			memcpy(&aj[k*w], &v.wavelet[k], (size_t)j * sizeof(OPJ_FLOAT32));
 		}
 	}
-
-	opj_aligned_free(h.wavelet);
-	return OPJ_TRUE;
 }
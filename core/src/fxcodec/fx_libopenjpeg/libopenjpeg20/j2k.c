@@ -9511,6 +9511,20 @@ OPJ_BOOL opj_j2k_set_decoded_resolution_factor(opj_j2k_t *p_j2k,
         return OPJ_FALSE;
 }
 
+OPJ_BOOL opj_j2k_set_parallel_handler(opj_j2k_t *p_j2k,
+                                      opj_parallel_run_fn p_run_fn,
+                                      OPJ_UINT32 p_nb_threads,
+                                      void * p_user_data)
+{
+        opj_parallel_t * l_parallel = &(p_j2k->m_cp.m_specific_param.m_dec.m_parallel);
+
+        l_parallel->m_run = p_run_fn;
+        l_parallel->m_user_data = p_user_data;
+        l_parallel->m_nb_threads = p_run_fn ? p_nb_threads : 1;
+
+        return OPJ_TRUE;
+}
+
 OPJ_BOOL opj_j2k_encode(opj_j2k_t * p_j2k,
                         opj_stream_private_t *p_stream,
                         opj_event_mgr_t * p_manager )
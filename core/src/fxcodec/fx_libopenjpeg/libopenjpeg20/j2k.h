@@ -325,12 +325,28 @@ typedef struct opj_encoding_param
 }
 opj_encoding_param_t;
 
+/**
+ * Parallel job runner set with opj_set_parallel_handler
+ */
+typedef struct opj_parallel
+{
+	/** job runner, NULL to decode on the calling thread */
+	opj_parallel_run_fn m_run;
+	/** client data passed to m_run */
+	void * m_user_data;
+	/** number of jobs to split each parallel step into */
+	OPJ_UINT32 m_nb_threads;
+}
+opj_parallel_t;
+
 typedef struct opj_decoding_param
 {
 	/** if != 0, then original dimension divided by 2^(reduce); if == 0 or not used, image is decoded to the full resolution */
 	OPJ_UINT32 m_reduce;
 	/** if != 0, then only the first "layer" layers are decoded; if == 0 or not used, all the quality layers are decoded */
 	OPJ_UINT32 m_layer;
+	/** parallel job runner for tier-1 decoding and the inverse DWT */
+	opj_parallel_t m_parallel;
 }
 opj_decoding_param_t;
 
@@ -791,6 +807,11 @@ OPJ_BOOL opj_j2k_set_decoded_resolution_factor(opj_j2k_t *p_j2k,
                                                OPJ_UINT32 res_factor,
                                                opj_event_mgr_t * p_manager);
 
+OPJ_BOOL opj_j2k_set_parallel_handler(opj_j2k_t *p_j2k,
+                                      opj_parallel_run_fn p_run_fn,
+                                      OPJ_UINT32 p_nb_threads,
+                                      void * p_user_data);
+
 
 /**
  * Writes a tile.
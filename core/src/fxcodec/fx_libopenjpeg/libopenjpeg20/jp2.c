@@ -2643,6 +2643,14 @@ OPJ_BOOL opj_jp2_set_decoded_resolution_factor(opj_jp2_t *p_jp2,
 	return opj_j2k_set_decoded_resolution_factor(p_jp2->j2k, res_factor, p_manager);
 }
 
+OPJ_BOOL opj_jp2_set_parallel_handler(opj_jp2_t *p_jp2,
+                                      opj_parallel_run_fn p_run_fn,
+                                      OPJ_UINT32 p_nb_threads,
+                                      void * p_user_data)
+{
+	return opj_j2k_set_parallel_handler(p_jp2->j2k, p_run_fn, p_nb_threads, p_user_data);
+}
+
 /* JPIP specific */
 
 #ifdef USE_JPIP
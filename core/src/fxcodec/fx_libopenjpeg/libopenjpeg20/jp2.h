@@ -456,6 +456,11 @@ OPJ_BOOL opj_jp2_set_decoded_resolution_factor(opj_jp2_t *p_jp2,
                                                OPJ_UINT32 res_factor, 
                                                opj_event_mgr_t * p_manager);
 
+OPJ_BOOL opj_jp2_set_parallel_handler(opj_jp2_t *p_jp2,
+                                      opj_parallel_run_fn p_run_fn,
+                                      OPJ_UINT32 p_nb_threads,
+                                      void * p_user_data);
+
 
 /* TODO MSD: clean these 3 functions */
 /**
@@ -240,6 +240,12 @@ opj_codec_t* OPJ_CALLCONV opj_create_decompress(OPJ_CODEC_FORMAT p_format)
 									OPJ_UINT32 res_factor,
 									struct opj_event_mgr * p_manager)) opj_j2k_set_decoded_resolution_factor;
 
+			l_codec->m_codec_data.m_decompression.opj_set_parallel_handler = 
+                    (OPJ_BOOL (*) ( void * p_codec,
+									opj_parallel_run_fn p_run_fn,
+									OPJ_UINT32 p_nb_threads,
+									void * p_user_data)) opj_j2k_set_parallel_handler;
+
 			l_codec->m_codec = opj_j2k_create_decompress();
 
 			if (! l_codec->m_codec) {
@@ -316,6 +322,12 @@ opj_codec_t* OPJ_CALLCONV opj_create_decompress(OPJ_CODEC_FORMAT p_format)
 						    		OPJ_UINT32 res_factor,
 							    	opj_event_mgr_t * p_manager)) opj_jp2_set_decoded_resolution_factor;
 
+			l_codec->m_codec_data.m_decompression.opj_set_parallel_handler = 
+                    (OPJ_BOOL (*) ( void * p_codec,
+						    		opj_parallel_run_fn p_run_fn,
+						    		OPJ_UINT32 p_nb_threads,
+							    	void * p_user_data)) opj_jp2_set_parallel_handler;
+
 			l_codec->m_codec = opj_jp2_create(OPJ_TRUE);
 
 			if (! l_codec->m_codec) {
@@ -535,6 +547,23 @@ OPJ_BOOL OPJ_CALLCONV opj_set_decoded_resolution_factor(opj_codec_t *p_codec,
 	return OPJ_TRUE;
 }
 
+OPJ_BOOL OPJ_CALLCONV opj_set_parallel_handler(opj_codec_t *p_codec,
+												opj_parallel_run_fn p_run_fn,
+												OPJ_UINT32 p_nb_threads,
+												void *p_user_data)
+{
+	opj_codec_private_t * l_codec = (opj_codec_private_t *) p_codec;
+
+	if ( !l_codec || !l_codec->is_decompressor ){
+		return OPJ_FALSE;
+	}
+
+	return l_codec->m_codec_data.m_decompression.opj_set_parallel_handler(l_codec->m_codec,
+																			p_run_fn,
+																			p_nb_threads,
+																			p_user_data);
+}
+
 /* ---------------------------------------------------------------------- */
 /* COMPRESSION FUNCTIONS*/
 
@@ -251,6 +251,19 @@ typedef enum CODEC_FORMAT {
  * */
 typedef void (*opj_msg_callback) (const char *msg, void *client_data);
 
+/**
+ * Job function prototype for parallel decoding
+ * @param p_job             The job to run
+ * */
+typedef void (*opj_job_fn) (void * p_job);
+
+/**
+ * Parallel job runner prototype. Runs p_job_fn on each of the p_nb_jobs jobs stored
+ * p_job_size bytes apart in p_jobs, possibly on several threads, and returns when all
+ * of them are done.
+ * */
+typedef void (*opj_parallel_run_fn) (opj_job_fn p_job_fn, void * p_jobs, OPJ_UINT32 p_job_size, OPJ_UINT32 p_nb_jobs, void * p_user_data);
+
 /* 
 ==========================================================
    codec typedef definitions
@@ -1266,6 +1279,17 @@ OPJ_API OPJ_BOOL OPJ_CALLCONV opj_get_decoded_tile(	opj_codec_t *p_codec,
  */
 OPJ_API OPJ_BOOL OPJ_CALLCONV opj_set_decoded_resolution_factor(opj_codec_t *p_codec, OPJ_UINT32 res_factor);
 
+/**
+ * Set a job runner used to decode code-blocks and run the inverse DWT in parallel
+ * @param	p_codec			the jpeg2000 codec.
+ * @param	p_run_fn		job runner, or NULL to decode on the calling thread
+ * @param	p_nb_threads	number of jobs to split each step into
+ * @param	p_user_data		passed through to p_run_fn
+ *
+ * @return					true if success, otherwise false
+ */
+OPJ_API OPJ_BOOL OPJ_CALLCONV opj_set_parallel_handler(opj_codec_t *p_codec, opj_parallel_run_fn p_run_fn, OPJ_UINT32 p_nb_threads, void *p_user_data);
+
 /**
  * Writes a tile with the given data.
  *
@@ -113,6 +113,12 @@ typedef struct opj_codec_private
             OPJ_BOOL (*opj_set_decoded_resolution_factor) ( void * p_codec,
                                                             OPJ_UINT32 res_factor,
                                                             opj_event_mgr_t * p_manager);
+
+            /** Set the parallel job runner */
+            OPJ_BOOL (*opj_set_parallel_handler) ( void * p_codec,
+                                                   opj_parallel_run_fn p_run_fn,
+                                                   OPJ_UINT32 p_nb_threads,
+                                                   void * p_user_data);
         } m_decompression;
 
         /**
@@ -1264,6 +1264,19 @@ OPJ_BOOL opj_t1_decode_cblks(   opj_t1_t* t1,
                             opj_tcd_tilecomp_t* tilec,
                             opj_tccp_t* tccp
                             )
+{
+	OPJ_UINT32 l_cblk_index = 0;
+
+	return opj_t1_decode_cblks_part(t1, tilec, tccp, &l_cblk_index, 0, 1);
+}
+
+OPJ_BOOL opj_t1_decode_cblks_part(  opj_t1_t* t1,
+                                    opj_tcd_tilecomp_t* tilec,
+                                    opj_tccp_t* tccp,
+                                    OPJ_UINT32* p_cblk_index,
+                                    OPJ_UINT32 p_part,
+                                    OPJ_UINT32 p_nb_parts
+                                    )
 {
 	OPJ_UINT32 resno, bandno, precno, cblkno;
 	OPJ_UINT32 tile_w = (OPJ_UINT32)(tilec->x1 - tilec->x0);
@@ -1285,6 +1298,10 @@ OPJ_BOOL opj_t1_decode_cblks(   opj_t1_t* t1,
 					OPJ_INT32 x, y;
 					OPJ_UINT32 i, j;
 
+					if ((*p_cblk_index)++ % p_nb_parts != p_part) {
+						continue;
+					}
+
                     if (OPJ_FALSE == opj_t1_decode_cblk(
                                             t1,
                                             cblk,
@@ -140,6 +140,23 @@ OPJ_BOOL opj_t1_decode_cblks(   opj_t1_t* t1,
                                 opj_tcd_tilecomp_t* tilec,
                                 opj_tccp_t* tccp);
 
+/**
+Decode one part of the code-blocks of a tile. Code-blocks are numbered in decoding order
+starting from *p_cblk_index, and those whose number modulo p_nb_parts is p_part are decoded.
+@param t1 T1 handle
+@param tilec The tile to decode
+@param tccp Tile coding parameters
+@param p_cblk_index Running code-block counter, updated on return
+@param p_part Index of the part to decode
+@param p_nb_parts Number of parts
+*/
+OPJ_BOOL opj_t1_decode_cblks_part(  opj_t1_t* t1,
+                                    opj_tcd_tilecomp_t* tilec,
+                                    opj_tccp_t* tccp,
+                                    OPJ_UINT32* p_cblk_index,
+                                    OPJ_UINT32 p_part,
+                                    OPJ_UINT32 p_nb_parts);
+
 
 
 /**
@@ -139,6 +139,10 @@ static OPJ_BOOL opj_tcd_t2_decode ( opj_tcd_t *p_tcd,
 
 static OPJ_BOOL opj_tcd_t1_decode (opj_tcd_t *p_tcd);
 
+static OPJ_BOOL opj_tcd_t1_decode_part (opj_tcd_t *p_tcd, OPJ_UINT32 p_part, OPJ_UINT32 p_nb_parts);
+
+static void opj_tcd_t1_decode_job (void * p_job);
+
 static OPJ_BOOL opj_tcd_dwt_decode (opj_tcd_t *p_tcd);
 
 static OPJ_BOOL opj_tcd_mct_decode (opj_tcd_t *p_tcd);
@@ -1500,9 +1504,68 @@ OPJ_BOOL opj_tcd_t2_decode (opj_tcd_t *p_tcd,
         return OPJ_TRUE;
 }
 
+/* Tiles smaller than this are decoded on the calling thread */
+#define OPJ_TCD_PARALLEL_MIN_SAMPLES (128 * 128)
+
+typedef struct opj_tcd_t1_job
+{
+        opj_tcd_t * m_tcd;
+        OPJ_UINT32 m_part;
+        OPJ_UINT32 m_nb_parts;
+        OPJ_BOOL m_result;
+}
+opj_tcd_t1_job_t;
+
 OPJ_BOOL opj_tcd_t1_decode ( opj_tcd_t *p_tcd )
+{
+        const opj_parallel_t * l_parallel = &(p_tcd->cp->m_specific_param.m_dec.m_parallel);
+        opj_tcd_tilecomp_t* l_tile_comp = p_tcd->tcd_image->tiles->comps;
+        opj_tcd_t1_job_t * l_jobs;
+        OPJ_UINT32 l_nb_jobs, i;
+        OPJ_BOOL l_result = OPJ_TRUE;
+
+        if (! l_parallel->m_run || l_parallel->m_nb_threads < 2 ||
+                (OPJ_UINT32)(l_tile_comp->x1 - l_tile_comp->x0) * (OPJ_UINT32)(l_tile_comp->y1 - l_tile_comp->y0) < OPJ_TCD_PARALLEL_MIN_SAMPLES) {
+                return opj_tcd_t1_decode_part(p_tcd, 0, 1);
+        }
+
+        /* Each job decodes every l_nb_jobs-th code-block of the tile with its own T1 handle;
+           code-blocks write to disjoint areas of the tile component data. */
+        l_nb_jobs = l_parallel->m_nb_threads;
+        l_jobs = (opj_tcd_t1_job_t *) opj_malloc(l_nb_jobs * sizeof(opj_tcd_t1_job_t));
+        if (! l_jobs) {
+                return opj_tcd_t1_decode_part(p_tcd, 0, 1);
+        }
+        for (i = 0; i < l_nb_jobs; ++i) {
+                l_jobs[i].m_tcd = p_tcd;
+                l_jobs[i].m_part = i;
+                l_jobs[i].m_nb_parts = l_nb_jobs;
+                l_jobs[i].m_result = OPJ_FALSE;
+        }
+
+        l_parallel->m_run(opj_tcd_t1_decode_job, l_jobs, (OPJ_UINT32)sizeof(opj_tcd_t1_job_t), l_nb_jobs, l_parallel->m_user_data);
+
+        for (i = 0; i < l_nb_jobs; ++i) {
+                if (! l_jobs[i].m_result) {
+                        l_result = OPJ_FALSE;
+                }
+        }
+        opj_free(l_jobs);
+
+        return l_result;
+}
+
+void opj_tcd_t1_decode_job (void * p_job)
+{
+        opj_tcd_t1_job_t * l_job = (opj_tcd_t1_job_t *) p_job;
+
+        l_job->m_result = opj_tcd_t1_decode_part(l_job->m_tcd, l_job->m_part, l_job->m_nb_parts);
+}
+
+OPJ_BOOL opj_tcd_t1_decode_part ( opj_tcd_t *p_tcd, OPJ_UINT32 p_part, OPJ_UINT32 p_nb_parts )
 {
         OPJ_UINT32 compno;
+        OPJ_UINT32 l_cblk_index = 0;
         opj_t1_t * l_t1;
         opj_tcd_tile_t * l_tile = p_tcd->tcd_image->tiles;
         opj_tcd_tilecomp_t* l_tile_comp = l_tile->comps;
@@ -1516,7 +1579,7 @@ OPJ_BOOL opj_tcd_t1_decode ( opj_tcd_t *p_tcd )
 
         for (compno = 0; compno < l_tile->numcomps; ++compno) {
                 /* The +3 is headroom required by the vectorized DWT */
-                if (OPJ_FALSE == opj_t1_decode_cblks(l_t1, l_tile_comp, l_tccp)) {
+                if (OPJ_FALSE == opj_t1_decode_cblks_part(l_t1, l_tile_comp, l_tccp, &l_cblk_index, p_part, p_nb_parts)) {
                         opj_t1_destroy(l_t1);
                         return OPJ_FALSE;
                 }
@@ -1537,6 +1600,7 @@ OPJ_BOOL opj_tcd_dwt_decode ( opj_tcd_t *p_tcd )
         opj_tcd_tilecomp_t * l_tile_comp = l_tile->comps;
         opj_tccp_t * l_tccp = p_tcd->tcp->tccps;
         opj_image_comp_t * l_img_comp = p_tcd->image->comps;
+        const opj_parallel_t * l_parallel = &(p_tcd->cp->m_specific_param.m_dec.m_parallel);
 
         for (compno = 0; compno < l_tile->numcomps; compno++) {
                 /*
@@ -1553,12 +1617,12 @@ OPJ_BOOL opj_tcd_dwt_decode ( opj_tcd_t *p_tcd )
                 */
 
                 if (l_tccp->qmfbid == 1) {
-                        if (! opj_dwt_decode(l_tile_comp, l_img_comp->resno_decoded+1)) {
+                        if (! opj_dwt_decode(l_tile_comp, l_img_comp->resno_decoded+1, l_parallel)) {
                                 return OPJ_FALSE;
                         }
                 }
                 else {
-                        if (! opj_dwt_decode_real(l_tile_comp, l_img_comp->resno_decoded+1)) {
+                        if (! opj_dwt_decode_real(l_tile_comp, l_img_comp->resno_decoded+1, l_parallel)) {
                                 return OPJ_FALSE;
                         }
                 }
@@ -117,6 +117,8 @@ build_ycc_rgb_table (j_decompress_ptr cinfo)
  * offset required on that side.
  */
 
+#ifndef JPEG_SSE2_SUPPORTED
+
 METHODDEF(void)
 ycc_rgb_convert (j_decompress_ptr cinfo,
 		 JSAMPIMAGE input_buf, JDIMENSION input_row,
@@ -157,6 +159,107 @@ ycc_rgb_convert (j_decompress_ptr cinfo,
   }
 }
 
+#else /* JPEG_SSE2_SUPPORTED */
+
+/*
+ * SSE2 version of ycc_rgb_convert, 16 pixels at a time.  With cb and cr
+ * the inputs less CENTERJSAMPLE, the table lookups above are equal to
+ *	R: y + cr + ((26345 * cr + ONE_HALF) >> 16)
+ *	G: y - cr + ((18734 * cr - 22554 * cb + ONE_HALF) >> 16)
+ *	B: y + 2 * cb + ((-14942 * cb + ONE_HALF) >> 16)
+ * i.e. FIX(1.40200), -FIX(0.71414) and FIX(1.77200) split into a multiple
+ * of 2^16 plus a 16-bit remainder, so pmaddwd gives exact results.
+ * Range limiting is a saturating pack.  Leftover pixels use the tables.
+ */
+
+#include <emmintrin.h>
+
+#define PAIR16(a,b)  _mm_set_epi16((short) (b), (short) (a), (short) (b), \
+				   (short) (a), (short) (b), (short) (a), \
+				   (short) (b), (short) (a))
+
+LOCAL(__m128i)
+ycc_term_sse2 (__m128i crcb_lo, __m128i crcb_hi, __m128i coefs)
+{
+  __m128i half = _mm_set1_epi32(ONE_HALF);
+  __m128i lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(crcb_lo, coefs), half), SCALEBITS);
+  __m128i hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(crcb_hi, coefs), half), SCALEBITS);
+  return _mm_packs_epi32(lo, hi);
+}
+
+METHODDEF(void)
+ycc_rgb_convert (j_decompress_ptr cinfo,
+		 JSAMPIMAGE input_buf, JDIMENSION input_row,
+		 JSAMPARRAY output_buf, int num_rows)
+{
+  my_cconvert_ptr cconvert = (my_cconvert_ptr) cinfo->cconvert;
+  register int y, cb, cr;
+  register JSAMPROW outptr;
+  register JSAMPROW inptr0, inptr1, inptr2;
+  register JDIMENSION col;
+  JDIMENSION num_cols = cinfo->output_width;
+  register JSAMPLE * range_limit = cinfo->sample_range_limit;
+  register int * Crrtab = cconvert->Cr_r_tab;
+  register int * Cbbtab = cconvert->Cb_b_tab;
+  register INT32 * Crgtab = cconvert->Cr_g_tab;
+  register INT32 * Cbgtab = cconvert->Cb_g_tab;
+  JSAMPLE red[16], green[16], blue[16];
+  __m128i zero = _mm_setzero_si128();
+  __m128i center = _mm_set1_epi16(CENTERJSAMPLE);
+  __m128i yv, cbv, crv, xb, xr, crcb_lo, crcb_hi;
+  __m128i r[2], g[2], b[2];
+  int half, i;
+  SHIFT_TEMPS
+
+  while (--num_rows >= 0) {
+    inptr0 = input_buf[0][input_row];
+    inptr1 = input_buf[1][input_row];
+    inptr2 = input_buf[2][input_row];
+    input_row++;
+    outptr = *output_buf++;
+    for (col = 0; col + 16 <= num_cols; col += 16) {
+      for (half = 0; half < 2; half++) {
+	yv = _mm_loadl_epi64((const __m128i *) (inptr0 + col + half * 8));
+	cbv = _mm_loadl_epi64((const __m128i *) (inptr1 + col + half * 8));
+	crv = _mm_loadl_epi64((const __m128i *) (inptr2 + col + half * 8));
+	yv = _mm_unpacklo_epi8(yv, zero);
+	xb = _mm_sub_epi16(_mm_unpacklo_epi8(cbv, zero), center);
+	xr = _mm_sub_epi16(_mm_unpacklo_epi8(crv, zero), center);
+	crcb_lo = _mm_unpacklo_epi16(xr, xb);
+	crcb_hi = _mm_unpackhi_epi16(xr, xb);
+	r[half] = _mm_add_epi16(_mm_add_epi16(yv, xr),
+		    ycc_term_sse2(crcb_lo, crcb_hi, PAIR16(26345, 0)));
+	g[half] = _mm_add_epi16(_mm_sub_epi16(yv, xr),
+		    ycc_term_sse2(crcb_lo, crcb_hi, PAIR16(18734, -22554)));
+	b[half] = _mm_add_epi16(_mm_add_epi16(yv, _mm_add_epi16(xb, xb)),
+		    ycc_term_sse2(crcb_lo, crcb_hi, PAIR16(0, -14942)));
+      }
+      _mm_storeu_si128((__m128i *) red, _mm_packus_epi16(r[0], r[1]));
+      _mm_storeu_si128((__m128i *) green, _mm_packus_epi16(g[0], g[1]));
+      _mm_storeu_si128((__m128i *) blue, _mm_packus_epi16(b[0], b[1]));
+      for (i = 0; i < 16; i++) {
+	outptr[RGB_RED] = red[i];
+	outptr[RGB_GREEN] = green[i];
+	outptr[RGB_BLUE] = blue[i];
+	outptr += RGB_PIXELSIZE;
+      }
+    }
+    for (; col < num_cols; col++) {
+      y  = GETJSAMPLE(inptr0[col]);
+      cb = GETJSAMPLE(inptr1[col]);
+      cr = GETJSAMPLE(inptr2[col]);
+      outptr[RGB_RED] =   range_limit[y + Crrtab[cr]];
+      outptr[RGB_GREEN] = range_limit[y +
+			      ((int) RIGHT_SHIFT(Cbgtab[cb] + Crgtab[cr],
+						 SCALEBITS))];
+      outptr[RGB_BLUE] =  range_limit[y + Cbbtab[cb]];
+      outptr += RGB_PIXELSIZE;
+    }
+  }
+}
+
+#endif /* JPEG_SSE2_SUPPORTED */
+
 
 /**************** Cases other than YCbCr -> RGB **************/
 
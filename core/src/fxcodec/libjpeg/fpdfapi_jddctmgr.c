@@ -118,7 +118,11 @@ start_pass (j_decompress_ptr cinfo)
       switch (cinfo->dct_method) {
 #ifdef DCT_ISLOW_SUPPORTED
       case JDCT_ISLOW:
+#ifdef JPEG_SSE2_SUPPORTED
+	method_ptr = jpeg_idct_islow_sse2;
+#else
 	method_ptr = jpeg_idct_islow;
+#endif
 	method = JDCT_ISLOW;
 	break;
 #endif
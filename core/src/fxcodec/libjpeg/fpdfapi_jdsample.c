@@ -301,6 +301,8 @@ h2v2_upsample (j_decompress_ptr cinfo, jpeg_component_info * compptr,
  * alternate pixel locations (a simple ordered dither pattern).
  */
 
+#ifndef JPEG_SSE2_SUPPORTED
+
 METHODDEF(void)
 h2v1_fancy_upsample (j_decompress_ptr cinfo, jpeg_component_info * compptr,
 		     JSAMPARRAY input_data, JSAMPARRAY * output_data_ptr)
@@ -391,6 +393,135 @@ h2v2_fancy_upsample (j_decompress_ptr cinfo, jpeg_component_info * compptr,
   }
 }
 
+#else /* JPEG_SSE2_SUPPORTED */
+
+/*
+ * SSE2 versions of the two fancy upsamplers.  Eight input columns are
+ * handled per step, reading the neighbouring columns with unaligned loads;
+ * the first column and any columns whose right neighbour group would run
+ * past the row are done with the portable formulas.  Results are identical.
+ */
+
+#include <emmintrin.h>
+
+METHODDEF(void)
+h2v1_fancy_upsample_sse2 (j_decompress_ptr cinfo, jpeg_component_info * compptr,
+			  JSAMPARRAY input_data, JSAMPARRAY * output_data_ptr)
+{
+  JSAMPARRAY output_data = *output_data_ptr;
+  JSAMPROW inptr, outptr;
+  JDIMENSION width = compptr->downsampled_width;
+  JDIMENSION col;
+  int invalue, inrow;
+  __m128i zero = _mm_setzero_si128();
+  __m128i one = _mm_set1_epi16(1);
+  __m128i two = _mm_set1_epi16(2);
+  __m128i prev, cur, next, even, odd;
+
+  for (inrow = 0; inrow < cinfo->max_v_samp_factor; inrow++) {
+    inptr = input_data[inrow];
+    outptr = output_data[inrow];
+    /* Special case for first column */
+    invalue = GETJSAMPLE(inptr[0]);
+    outptr[0] = (JSAMPLE) invalue;
+    outptr[1] = (JSAMPLE) ((invalue * 3 + GETJSAMPLE(inptr[1]) + 2) >> 2);
+
+    for (col = 1; col + 9 <= width; col += 8) {
+      prev = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (inptr + col - 1)), zero);
+      cur = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (inptr + col)), zero);
+      next = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (inptr + col + 1)), zero);
+      cur = _mm_add_epi16(cur, _mm_add_epi16(cur, cur));
+      even = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(cur, prev), one), 2);
+      odd = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(cur, next), two), 2);
+      _mm_storeu_si128((__m128i *) (outptr + col * 2),
+		       _mm_packus_epi16(_mm_unpacklo_epi16(even, odd),
+					_mm_unpackhi_epi16(even, odd)));
+    }
+
+    for (; col < width - 1; col++) {
+      invalue = GETJSAMPLE(inptr[col]) * 3;
+      outptr[col * 2] = (JSAMPLE) ((invalue + GETJSAMPLE(inptr[col - 1]) + 1) >> 2);
+      outptr[col * 2 + 1] = (JSAMPLE) ((invalue + GETJSAMPLE(inptr[col + 1]) + 2) >> 2);
+    }
+
+    /* Special case for last column */
+    invalue = GETJSAMPLE(inptr[col]);
+    outptr[col * 2] = (JSAMPLE) ((invalue * 3 + GETJSAMPLE(inptr[col - 1]) + 1) >> 2);
+    outptr[col * 2 + 1] = (JSAMPLE) invalue;
+  }
+}
+
+METHODDEF(void)
+h2v2_fancy_upsample_sse2 (j_decompress_ptr cinfo, jpeg_component_info * compptr,
+			  JSAMPARRAY input_data, JSAMPARRAY * output_data_ptr)
+{
+  JSAMPARRAY output_data = *output_data_ptr;
+  JSAMPROW inptr0, inptr1, outptr;
+  JDIMENSION width = compptr->downsampled_width;
+  JDIMENSION col;
+  int thiscolsum, lastcolsum, nextcolsum;
+  int inrow, outrow, v;
+  __m128i zero = _mm_setzero_si128();
+  __m128i seven = _mm_set1_epi16(7);
+  __m128i eight = _mm_set1_epi16(8);
+  __m128i prev, cur, next, even, odd;
+
+#define COLSUM(offset)  _mm_add_epi16( \
+	_mm_mullo_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64( \
+	  (const __m128i *) (inptr0 + (offset))), zero), _mm_set1_epi16(3)), \
+	_mm_unpacklo_epi8(_mm_loadl_epi64( \
+	  (const __m128i *) (inptr1 + (offset))), zero))
+
+  inrow = outrow = 0;
+  while (outrow < cinfo->max_v_samp_factor) {
+    for (v = 0; v < 2; v++) {
+      /* inptr0 points to nearest input row, inptr1 points to next nearest */
+      inptr0 = input_data[inrow];
+      if (v == 0)		/* next nearest is row above */
+	inptr1 = input_data[inrow-1];
+      else			/* next nearest is row below */
+	inptr1 = input_data[inrow+1];
+      outptr = output_data[outrow++];
+
+      /* Special case for first column */
+      thiscolsum = GETJSAMPLE(inptr0[0]) * 3 + GETJSAMPLE(inptr1[0]);
+      nextcolsum = GETJSAMPLE(inptr0[1]) * 3 + GETJSAMPLE(inptr1[1]);
+      outptr[0] = (JSAMPLE) ((thiscolsum * 4 + 8) >> 4);
+      outptr[1] = (JSAMPLE) ((thiscolsum * 3 + nextcolsum + 7) >> 4);
+
+      for (col = 1; col + 9 <= width; col += 8) {
+	prev = COLSUM(col - 1);
+	cur = COLSUM(col);
+	next = COLSUM(col + 1);
+	cur = _mm_add_epi16(cur, _mm_add_epi16(cur, cur));
+	even = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(cur, prev), eight), 4);
+	odd = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(cur, next), seven), 4);
+	_mm_storeu_si128((__m128i *) (outptr + col * 2),
+			 _mm_packus_epi16(_mm_unpacklo_epi16(even, odd),
+					  _mm_unpackhi_epi16(even, odd)));
+      }
+
+      lastcolsum = GETJSAMPLE(inptr0[col - 1]) * 3 + GETJSAMPLE(inptr1[col - 1]);
+      thiscolsum = GETJSAMPLE(inptr0[col]) * 3 + GETJSAMPLE(inptr1[col]);
+      for (; col < width - 1; col++) {
+	nextcolsum = GETJSAMPLE(inptr0[col + 1]) * 3 + GETJSAMPLE(inptr1[col + 1]);
+	outptr[col * 2] = (JSAMPLE) ((thiscolsum * 3 + lastcolsum + 8) >> 4);
+	outptr[col * 2 + 1] = (JSAMPLE) ((thiscolsum * 3 + nextcolsum + 7) >> 4);
+	lastcolsum = thiscolsum; thiscolsum = nextcolsum;
+      }
+
+      /* Special case for last column */
+      outptr[col * 2] = (JSAMPLE) ((thiscolsum * 3 + lastcolsum + 8) >> 4);
+      outptr[col * 2 + 1] = (JSAMPLE) ((thiscolsum * 4 + 7) >> 4);
+    }
+    inrow++;
+  }
+
+#undef COLSUM
+}
+
+#endif /* JPEG_SSE2_SUPPORTED */
+
 
 /*
  * Module initialization routine for upsampling.
@@ -449,14 +580,22 @@ jinit_upsampler (j_decompress_ptr cinfo)
 	       v_in_group == v_out_group) {
       /* Special cases for 2h1v upsampling */
       if (do_fancy && compptr->downsampled_width > 2)
+#ifdef JPEG_SSE2_SUPPORTED
+	upsample->methods[ci] = h2v1_fancy_upsample_sse2;
+#else
 	upsample->methods[ci] = h2v1_fancy_upsample;
+#endif
       else
 	upsample->methods[ci] = h2v1_upsample;
     } else if (h_in_group * 2 == h_out_group &&
 	       v_in_group * 2 == v_out_group) {
       /* Special cases for 2h2v upsampling */
       if (do_fancy && compptr->downsampled_width > 2) {
+#ifdef JPEG_SSE2_SUPPORTED
+	upsample->methods[ci] = h2v2_fancy_upsample_sse2;
+#else
 	upsample->methods[ci] = h2v2_fancy_upsample;
+#endif
 	upsample->pub.need_context_rows = TRUE;
       } else
 	upsample->methods[ci] = h2v2_upsample;
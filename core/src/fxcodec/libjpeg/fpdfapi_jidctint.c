@@ -387,6 +387,212 @@ jpeg_idct_islow (j_decompress_ptr cinfo, jpeg_component_info * compptr,
   }
 }
 
+
+#ifdef JPEG_SSE2_SUPPORTED
+
+/*
+ * SSE2 version of jpeg_idct_islow.  All eight columns (then rows) are
+ * transformed at once, with the multiplies done by pmaddwd on pairs of
+ * 16-bit inputs.  The products are exact and the 32-bit sums wrap exactly
+ * like the INT32 arithmetic above, so the output is bit-identical to the
+ * portable code provided every dequantized coefficient and every pass 1
+ * output fits in 16 bits.  That always holds for sane data; blocks that
+ * do not qualify are handed to jpeg_idct_islow.
+ * The zero-AC shortcuts above give the same results as the full
+ * computation, so they are not needed here.
+ */
+
+#include <emmintrin.h>
+
+#define PAIR16(a,b)  _mm_set_epi16((short) (b), (short) (a), (short) (b), \
+				   (short) (a), (short) (b), (short) (a), \
+				   (short) (b), (short) (a))
+
+/* 1-D IDCT of eight vectors of 16-bit inputs; the 32-bit results, not yet
+ * descaled, are returned as low and high halves.
+ */
+
+LOCAL(void)
+idct_1d_sse2 (const __m128i * in, __m128i * out_lo, __m128i * out_hi)
+{
+  __m128i p04, p26, p73, p51, p71, p53;
+  __m128i tmp0, tmp1, tmp2, tmp3, tmp10, tmp11, tmp12, tmp13;
+  __m128i z3, z4, t0, t1, t2, t3;
+  int half;
+
+  for (half = 0; half < 2; half++) {
+    if (half == 0) {
+      p04 = _mm_unpacklo_epi16(in[0], in[4]);
+      p26 = _mm_unpacklo_epi16(in[2], in[6]);
+      p73 = _mm_unpacklo_epi16(in[7], in[3]);
+      p51 = _mm_unpacklo_epi16(in[5], in[1]);
+      p71 = _mm_unpacklo_epi16(in[7], in[1]);
+      p53 = _mm_unpacklo_epi16(in[5], in[3]);
+    } else {
+      p04 = _mm_unpackhi_epi16(in[0], in[4]);
+      p26 = _mm_unpackhi_epi16(in[2], in[6]);
+      p73 = _mm_unpackhi_epi16(in[7], in[3]);
+      p51 = _mm_unpackhi_epi16(in[5], in[1]);
+      p71 = _mm_unpackhi_epi16(in[7], in[1]);
+      p53 = _mm_unpackhi_epi16(in[5], in[3]);
+    }
+
+    /* Even part */
+    tmp2 = _mm_madd_epi16(p26, PAIR16(FIX_0_541196100,
+				      FIX_0_541196100 - FIX_1_847759065));
+    tmp3 = _mm_madd_epi16(p26, PAIR16(FIX_0_541196100 + FIX_0_765366865,
+				      FIX_0_541196100));
+    tmp0 = _mm_madd_epi16(p04, PAIR16(ONE << CONST_BITS, ONE << CONST_BITS));
+    tmp1 = _mm_madd_epi16(p04, PAIR16(ONE << CONST_BITS, -(ONE << CONST_BITS)));
+
+    tmp10 = _mm_add_epi32(tmp0, tmp3);
+    tmp13 = _mm_sub_epi32(tmp0, tmp3);
+    tmp11 = _mm_add_epi32(tmp1, tmp2);
+    tmp12 = _mm_sub_epi32(tmp1, tmp2);
+
+    /* Odd part, with z1, z2 and z5 folded into the pair constants */
+    z3 = _mm_add_epi32(
+	   _mm_madd_epi16(p73, PAIR16(FIX_1_175875602 - FIX_1_961570560,
+				      FIX_1_175875602 - FIX_1_961570560)),
+	   _mm_madd_epi16(p51, PAIR16(FIX_1_175875602, FIX_1_175875602)));
+    z4 = _mm_add_epi32(
+	   _mm_madd_epi16(p73, PAIR16(FIX_1_175875602, FIX_1_175875602)),
+	   _mm_madd_epi16(p51, PAIR16(FIX_1_175875602 - FIX_0_390180644,
+				      FIX_1_175875602 - FIX_0_390180644)));
+
+    t0 = _mm_add_epi32(_mm_madd_epi16(p71,
+	   PAIR16(FIX_0_298631336 - FIX_0_899976223, - FIX_0_899976223)), z3);
+    t3 = _mm_add_epi32(_mm_madd_epi16(p71,
+	   PAIR16(- FIX_0_899976223, FIX_1_501321110 - FIX_0_899976223)), z4);
+    t1 = _mm_add_epi32(_mm_madd_epi16(p53,
+	   PAIR16(FIX_2_053119869 - FIX_2_562915447, - FIX_2_562915447)), z4);
+    t2 = _mm_add_epi32(_mm_madd_epi16(p53,
+	   PAIR16(- FIX_2_562915447, FIX_3_072711026 - FIX_2_562915447)), z3);
+
+    out_lo[0] = _mm_add_epi32(tmp10, t3);
+    out_lo[7] = _mm_sub_epi32(tmp10, t3);
+    out_lo[1] = _mm_add_epi32(tmp11, t2);
+    out_lo[6] = _mm_sub_epi32(tmp11, t2);
+    out_lo[2] = _mm_add_epi32(tmp12, t1);
+    out_lo[5] = _mm_sub_epi32(tmp12, t1);
+    out_lo[3] = _mm_add_epi32(tmp13, t0);
+    out_lo[4] = _mm_sub_epi32(tmp13, t0);
+    out_lo = out_hi;
+  }
+}
+
+/* Transpose an 8x8 matrix of 16-bit values held one row per vector. */
+
+LOCAL(void)
+transpose_8x8_sse2 (__m128i * m)
+{
+  __m128i a0, a1, a2, a3, a4, a5, a6, a7;
+  __m128i b0, b1, b2, b3, b4, b5, b6, b7;
+
+  a0 = _mm_unpacklo_epi16(m[0], m[1]);
+  a1 = _mm_unpackhi_epi16(m[0], m[1]);
+  a2 = _mm_unpacklo_epi16(m[2], m[3]);
+  a3 = _mm_unpackhi_epi16(m[2], m[3]);
+  a4 = _mm_unpacklo_epi16(m[4], m[5]);
+  a5 = _mm_unpackhi_epi16(m[4], m[5]);
+  a6 = _mm_unpacklo_epi16(m[6], m[7]);
+  a7 = _mm_unpackhi_epi16(m[6], m[7]);
+
+  b0 = _mm_unpacklo_epi32(a0, a2);
+  b1 = _mm_unpackhi_epi32(a0, a2);
+  b2 = _mm_unpacklo_epi32(a1, a3);
+  b3 = _mm_unpackhi_epi32(a1, a3);
+  b4 = _mm_unpacklo_epi32(a4, a6);
+  b5 = _mm_unpackhi_epi32(a4, a6);
+  b6 = _mm_unpacklo_epi32(a5, a7);
+  b7 = _mm_unpackhi_epi32(a5, a7);
+
+  m[0] = _mm_unpacklo_epi64(b0, b4);
+  m[1] = _mm_unpackhi_epi64(b0, b4);
+  m[2] = _mm_unpacklo_epi64(b1, b5);
+  m[3] = _mm_unpackhi_epi64(b1, b5);
+  m[4] = _mm_unpacklo_epi64(b2, b6);
+  m[5] = _mm_unpackhi_epi64(b2, b6);
+  m[6] = _mm_unpacklo_epi64(b3, b7);
+  m[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+
+GLOBAL(void)
+jpeg_idct_islow_sse2 (j_decompress_ptr cinfo, jpeg_component_info * compptr,
+		      JCOEFPTR coef_block,
+		      JSAMPARRAY output_buf, JDIMENSION output_col)
+{
+  ISLOW_MULT_TYPE * quantptr = (ISLOW_MULT_TYPE *) compptr->dct_table;
+  __m128i data[DCTSIZE], out_lo[DCTSIZE], out_hi[DCTSIZE];
+  __m128i lo, hi, qlo, qhi, quant;
+  __m128i qbits = _mm_setzero_si128();
+  __m128i overflow = _mm_setzero_si128();
+  __m128i round, bias;
+  int i;
+
+  /* Dequantize.  The quantizer must fit in 15 bits and the product in 16. */
+  for (i = 0; i < DCTSIZE; i++) {
+    qlo = _mm_loadu_si128((const __m128i *) (quantptr + i * DCTSIZE));
+    qhi = _mm_loadu_si128((const __m128i *) (quantptr + i * DCTSIZE + 4));
+    qbits = _mm_or_si128(qbits, _mm_or_si128(qlo, qhi));
+    quant = _mm_packs_epi32(qlo, qhi);
+    data[i] = _mm_loadu_si128((const __m128i *) (coef_block + i * DCTSIZE));
+    lo = _mm_mullo_epi16(data[i], quant);
+    hi = _mm_mulhi_epi16(data[i], quant);
+    overflow = _mm_or_si128(overflow,
+			    _mm_xor_si128(hi, _mm_srai_epi16(lo, 15)));
+    data[i] = lo;
+  }
+  overflow = _mm_or_si128(overflow, _mm_srli_epi32(qbits, 15));
+  if (_mm_movemask_epi8(_mm_cmpeq_epi32(overflow, _mm_setzero_si128())) != 0xFFFF) {
+    jpeg_idct_islow(cinfo, compptr, coef_block, output_buf, output_col);
+    return;
+  }
+
+  /* Pass 1: process columns, descale to 16 bits. */
+  idct_1d_sse2(data, out_lo, out_hi);
+  round = _mm_set1_epi32(ONE << (CONST_BITS-PASS1_BITS-1));
+  bias = _mm_set1_epi32(32768);
+  for (i = 0; i < DCTSIZE; i++) {
+    lo = _mm_srai_epi32(_mm_add_epi32(out_lo[i], round), CONST_BITS-PASS1_BITS);
+    hi = _mm_srai_epi32(_mm_add_epi32(out_hi[i], round), CONST_BITS-PASS1_BITS);
+    overflow = _mm_or_si128(overflow,
+			    _mm_or_si128(_mm_srli_epi32(_mm_add_epi32(lo, bias), 16),
+					 _mm_srli_epi32(_mm_add_epi32(hi, bias), 16)));
+    data[i] = _mm_packs_epi32(lo, hi);
+  }
+  if (_mm_movemask_epi8(_mm_cmpeq_epi32(overflow, _mm_setzero_si128())) != 0xFFFF) {
+    jpeg_idct_islow(cinfo, compptr, coef_block, output_buf, output_col);
+    return;
+  }
+
+  /* Pass 2: process rows.  The range limit table maps the low 10 bits of
+   * the descaled value, taken as signed, to CENTERJSAMPLE + value clamped
+   * to 0..MAXJSAMPLE; do the same with shifts and a saturating pack.
+   */
+  transpose_8x8_sse2(data);
+  idct_1d_sse2(data, out_lo, out_hi);
+  round = _mm_set1_epi32(ONE << (CONST_BITS+PASS1_BITS+3-1));
+  bias = _mm_set1_epi16(CENTERJSAMPLE);
+  for (i = 0; i < DCTSIZE; i++) {
+    lo = _mm_srai_epi32(_mm_add_epi32(out_lo[i], round), CONST_BITS+PASS1_BITS+3);
+    hi = _mm_srai_epi32(_mm_add_epi32(out_hi[i], round), CONST_BITS+PASS1_BITS+3);
+    lo = _mm_srai_epi32(_mm_slli_epi32(lo, 22), 22);
+    hi = _mm_srai_epi32(_mm_slli_epi32(hi, 22), 22);
+    data[i] = _mm_add_epi16(_mm_packs_epi32(lo, hi), bias);
+  }
+  transpose_8x8_sse2(data);
+  for (i = 0; i < DCTSIZE; i += 2) {
+    lo = _mm_packus_epi16(data[i], data[i+1]);
+    _mm_storel_epi64((__m128i *) (output_buf[i] + output_col), lo);
+    _mm_storel_epi64((__m128i *) (output_buf[i+1] + output_col),
+		     _mm_srli_si128(lo, 8));
+  }
+}
+
+#endif /* JPEG_SSE2_SUPPORTED */
+
 #endif /* DCT_ISLOW_SUPPORTED */
 
 #endif //_FX_JPEG_TURBO_
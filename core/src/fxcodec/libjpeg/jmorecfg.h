@@ -373,4 +373,18 @@ typedef int boolean;
 #endif
 #endif
 
+
+/* Define JPEG_SSE2_SUPPORTED to use the SSE2 versions of the inverse DCT,
+ * fancy upsampling and YCbCr->RGB conversion.  They produce exactly the
+ * same output as the portable code.  SSE2 is part of every x86-64 CPU,
+ * so it is enabled whenever the compiler targets it; define NO_JPEG_SSE2
+ * to force the portable code.
+ */
+
+#if BITS_IN_JSAMPLE == 8 && !defined(NO_JPEG_SSE2)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JPEG_SSE2_SUPPORTED
+#endif
+#endif
+
 #endif /* JPEG_INTERNAL_OPTIONS */
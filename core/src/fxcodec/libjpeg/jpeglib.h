@@ -57,6 +57,7 @@
 #define jpeg_idct_float FOXIT_PREFIX(jpeg_idct_float)
 #define jpeg_idct_ifast FOXIT_PREFIX(jpeg_idct_ifast)
 #define jpeg_idct_islow FOXIT_PREFIX(jpeg_idct_islow)
+#define jpeg_idct_islow_sse2 FOXIT_PREFIX(jpeg_idct_islow_sse2)
 #define jpeg_input_complete FOXIT_PREFIX(jpeg_input_complete)
 #define jpeg_make_d_derived_tbl FOXIT_PREFIX(jpeg_make_d_derived_tbl)
 #define jpeg_mem_available FOXIT_PREFIX(jpeg_mem_available)
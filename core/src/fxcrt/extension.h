@@ -23,6 +23,10 @@ public:
     virtual size_t		WritePos(const void* pBuffer, size_t szBuffer, FX_FILESIZE pos) = 0;
     virtual FX_BOOL		Flush() = 0;
     virtual FX_BOOL		Truncate(FX_FILESIZE szFile) = 0;
+    virtual FX_LPCBYTE	GetMappedData() const
+    {
+        return NULL;
+    }
 };
 IFXCRT_FileAccess*	FXCRT_FileAccess_Create(IFX_Allocator* pAllocator = NULL);
 class CFX_CRTFileStream : public IFX_FileStream, public CFX_Object
@@ -83,6 +87,7 @@ public:
     }
     virtual FX_BOOL				ReadBlock(void* buffer, FX_FILESIZE offset, size_t size)
     {
+        CFX_CSLock lock(&m_Lock);
         if (m_bUseRange) {
             if (offset + size > (size_t)GetSize()) {
                 return FALSE;
@@ -93,6 +98,7 @@ public:
     }
     virtual size_t				ReadBlock(void* buffer, size_t size)
     {
+        CFX_CSLock lock(&m_Lock);
         if (m_bUseRange) {
             FX_FILESIZE availSize = m_nOffset + m_nSize - m_pFile->GetPosition();
             if ((size_t)availSize < size) {
@@ -112,12 +118,21 @@ public:
     {
         return m_pFile->Flush();
     }
+    virtual FX_LPCBYTE			GetMappedData()
+    {
+        FX_LPCBYTE pData = m_pFile->GetMappedData();
+        if (pData && m_bUseRange) {
+            pData += m_nOffset;
+        }
+        return pData;
+    }
     IFX_Allocator*		m_pAllocator;
     IFXCRT_FileAccess*	m_pFile;
     FX_DWORD			m_dwCount;
     FX_BOOL				m_bUseRange;
     FX_FILESIZE			m_nOffset;
     FX_FILESIZE			m_nSize;
+    CFX_Mutex			m_Lock;
 };
 #define FX_MEMSTREAM_BlockSize		(64 * 1024)
 #define FX_MEMSTREAM_Consecutive	0x01
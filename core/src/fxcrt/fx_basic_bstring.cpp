@@ -63,8 +63,7 @@ static void FX_ReleaseString(CFX_StringData* pData)
     if (pData == NULL) {
         return;
     }
-    pData->m_nRefs --;
-    if (pData->m_nRefs <= 0) {
+    if (FX_AtomicDecrement(&pData->m_nRefs) <= 0) {
         FX_Free(pData);
     }
 }
@@ -73,8 +72,7 @@ CFX_ByteString::~CFX_ByteString()
     if (m_pData == NULL) {
         return;
     }
-    m_pData->m_nRefs --;
-    if (m_pData->m_nRefs < 1) {
+    if (FX_AtomicDecrement(&m_pData->m_nRefs) < 1) {
         FX_Free(m_pData);
     }
 }
@@ -118,7 +116,7 @@ CFX_ByteString::CFX_ByteString(const CFX_ByteString& stringSrc)
     }
     if (stringSrc.m_pData->m_nRefs >= 0) {
         m_pData = stringSrc.m_pData;
-        m_pData->m_nRefs ++;
+        FX_AtomicIncrement(&m_pData->m_nRefs);
     } else {
         m_pData = NULL;
         *this = stringSrc;
@@ -179,7 +177,7 @@ const CFX_ByteString& CFX_ByteString::operator=(const CFX_ByteString& stringSrc)
         Empty();
         m_pData = stringSrc.m_pData;
         if (m_pData) {
-            m_pData->m_nRefs ++;
+            FX_AtomicIncrement(&m_pData->m_nRefs);
         }
     }
     return *this;
@@ -253,9 +251,7 @@ void CFX_ByteString::Empty()
     if (m_pData == NULL) {
         return;
     }
-    if (m_pData->m_nRefs > 1) {
-        m_pData->m_nRefs --;
-    } else {
+    if (FX_AtomicDecrement(&m_pData->m_nRefs) < 1) {
         FX_Free(m_pData);
     }
     m_pData = NULL;
@@ -303,12 +299,12 @@ void CFX_ByteString::CopyBeforeWrite()
         return;
     }
     CFX_StringData* pData = m_pData;
-    m_pData->m_nRefs --;
     FX_STRSIZE nDataLength = pData->m_nDataLength;
     m_pData = FX_AllocString(nDataLength);
     if (m_pData != NULL) {
         FXSYS_memcpy32(m_pData->m_String, pData->m_String, (nDataLength + 1) * sizeof(char));
     }
+    FX_ReleaseString(pData);
 }
 void CFX_ByteString::AllocBeforeWrite(FX_STRSIZE nLen)
 {
@@ -377,8 +373,7 @@ FX_LPSTR CFX_ByteString::GetBuffer(FX_STRSIZE nMinBufLength)
     }
     FXSYS_memcpy32(m_pData->m_String, pOldData->m_String, (nOldLen + 1)*sizeof(char));
     m_pData->m_nDataLength = nOldLen;
-    pOldData->m_nRefs --;
-    if (pOldData->m_nRefs <= 0) {
+    if (FX_AtomicDecrement(&pOldData->m_nRefs) <= 0) {
         FX_Free(pOldData);
     }
     return m_pData->m_String;
@@ -437,8 +437,21 @@ static CFX_ByteStringC _CompactStringGet(_CompactString* pCompact)
 }
 #define CMAP_ALLOC_STEP		8
 #define CMAP_INDEX_SIZE		8
+#define CMAP_HASH_THRESHOLD	8
+#define CMAP_HASH_DELETED	0xffffffff
+static FX_DWORD _CMapHashKey(FX_LPCBYTE pStr, int len)
+{
+    FX_DWORD dwHash = 2166136261u;
+    for (int i = 0; i < len; i ++) {
+        dwHash = (dwHash ^ pStr[i]) * 16777619u;
+    }
+    return dwHash;
+}
 CFX_CMapByteStringToPtr::CFX_CMapByteStringToPtr(IFX_Allocator* pAllocator)
     : m_Buffer(sizeof(_CompactString) + sizeof(void*), CMAP_ALLOC_STEP, CMAP_INDEX_SIZE, pAllocator)
+    , m_pHashIndex(NULL)
+    , m_nHashSize(0)
+    , m_nHashUsed(0)
 {
 }
 CFX_CMapByteStringToPtr::~CFX_CMapByteStringToPtr()
@@ -453,6 +466,89 @@ void CFX_CMapByteStringToPtr::RemoveAll()
         _CompactStringRelease(pAllocator, (_CompactString*)m_Buffer.GetAt(i));
     }
     m_Buffer.RemoveAll();
+    FreeHashIndex();
+}
+void CFX_CMapByteStringToPtr::FreeHashIndex()
+{
+    if (m_pHashIndex) {
+        FX_Allocator_Free(m_Buffer.m_pAllocator, m_pHashIndex);
+        m_pHashIndex = NULL;
+    }
+    m_nHashSize = 0;
+    m_nHashUsed = 0;
+}
+void CFX_CMapByteStringToPtr::BuildHashIndex()
+{
+    FreeHashIndex();
+    int size = m_Buffer.GetSize();
+    int hash_size = 16;
+    while (hash_size < size * 2) {
+        hash_size *= 2;
+    }
+    m_pHashIndex = FX_Allocator_Alloc(m_Buffer.m_pAllocator, FX_DWORD, hash_size);
+    if (!m_pHashIndex) {
+        return;
+    }
+    FXSYS_memset32(m_pHashIndex, 0, hash_size * sizeof(FX_DWORD));
+    m_nHashSize = hash_size;
+    for (int i = 0; i < size; i ++) {
+        _CompactString* pKey = (_CompactString*)m_Buffer.GetAt(i);
+        if (pKey->m_CompactLen == 0xfe) {
+            continue;
+        }
+        CFX_ByteStringC key = _CompactStringGet(pKey);
+        if (!LookupIndex(key)) {
+            HashIndexInsert(key, i);
+        }
+    }
+}
+void* CFX_CMapByteStringToPtr::LookupIndex(FX_BSTR key) const
+{
+    int key_len = key.GetLength();
+    FX_DWORD mask = m_nHashSize - 1;
+    FX_DWORD slot = _CMapHashKey(key.GetPtr(), key_len) & mask;
+    while (m_pHashIndex[slot]) {
+        if (m_pHashIndex[slot] != CMAP_HASH_DELETED) {
+            _CompactString* pKey = (_CompactString*)m_Buffer.GetAt(m_pHashIndex[slot] - 1);
+            if (_CompactStringSame(pKey, key.GetPtr(), key_len)) {
+                return pKey;
+            }
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+void CFX_CMapByteStringToPtr::HashIndexInsert(FX_BSTR key, int index)
+{
+    if ((m_nHashUsed + 1) * 4 > m_nHashSize * 3) {
+        BuildHashIndex();
+        return;
+    }
+    FX_DWORD mask = m_nHashSize - 1;
+    FX_DWORD slot = _CMapHashKey(key.GetPtr(), key.GetLength()) & mask;
+    while (m_pHashIndex[slot] && m_pHashIndex[slot] != CMAP_HASH_DELETED) {
+        slot = (slot + 1) & mask;
+    }
+    if (!m_pHashIndex[slot]) {
+        m_nHashUsed ++;
+    }
+    m_pHashIndex[slot] = index + 1;
+}
+void CFX_CMapByteStringToPtr::HashIndexRemove(FX_BSTR key)
+{
+    int key_len = key.GetLength();
+    FX_DWORD mask = m_nHashSize - 1;
+    FX_DWORD slot = _CMapHashKey(key.GetPtr(), key_len) & mask;
+    while (m_pHashIndex[slot]) {
+        if (m_pHashIndex[slot] != CMAP_HASH_DELETED) {
+            _CompactString* pKey = (_CompactString*)m_Buffer.GetAt(m_pHashIndex[slot] - 1);
+            if (_CompactStringSame(pKey, key.GetPtr(), key_len)) {
+                m_pHashIndex[slot] = CMAP_HASH_DELETED;
+                return;
+            }
+        }
+        slot = (slot + 1) & mask;
+    }
 }
 FX_POSITION CFX_CMapByteStringToPtr::GetStartPosition() const
 {
@@ -513,7 +609,7 @@ FX_BOOL _CMapLookupCallback(void* param, void* pData)
 }
 FX_BOOL CFX_CMapByteStringToPtr::Lookup(FX_BSTR key, void*& rValue) const
 {
-    void* p = m_Buffer.Iterate(_CMapLookupCallback, (void*)&key);
+    void* p = m_pHashIndex ? LookupIndex(key) : m_Buffer.Iterate(_CMapLookupCallback, (void*)&key);
     if (!p) {
         return FALSE;
     }
@@ -525,13 +621,21 @@ void CFX_CMapByteStringToPtr::SetAt(FX_BSTR key, void* value)
     ASSERT(value != NULL);
     int index, key_len = key.GetLength();
     int size = m_Buffer.GetSize();
-    for (index = 0; index < size; index ++) {
-        _CompactString* pKey = (_CompactString*)m_Buffer.GetAt(index);
-        if (!_CompactStringSame(pKey, (FX_LPCBYTE)key, key_len)) {
-            continue;
+    if (m_pHashIndex) {
+        _CompactString* pKey = (_CompactString*)LookupIndex(key);
+        if (pKey) {
+            *(void**)(pKey + 1) = value;
+            return;
+        }
+    } else {
+        for (index = 0; index < size; index ++) {
+            _CompactString* pKey = (_CompactString*)m_Buffer.GetAt(index);
+            if (!_CompactStringSame(pKey, (FX_LPCBYTE)key, key_len)) {
+                continue;
+            }
+            *(void**)(pKey + 1) = value;
+            return;
         }
-        *(void**)(pKey + 1) = value;
-        return;
     }
     IFX_Allocator* pAllocator = m_Buffer.m_pAllocator;
     for (index = 0; index < size; index ++) {
@@ -539,20 +643,38 @@ void CFX_CMapByteStringToPtr::SetAt(FX_BSTR key, void* value)
         if (pKey->m_CompactLen) {
             continue;
         }
+        if (m_pHashIndex) {
+            HashIndexRemove(CFX_ByteStringC());
+        }
         _CompactStringStore(pAllocator, pKey, (FX_LPCBYTE)key, key_len);
         *(void**)(pKey + 1) = value;
+        if (m_pHashIndex) {
+            HashIndexInsert(key, index);
+        }
         return;
     }
     _CompactString* pKey = (_CompactString*)m_Buffer.Add();
     _CompactStringStore(pAllocator, pKey, (FX_LPCBYTE)key, key_len);
     *(void**)(pKey + 1) = value;
+    if (m_pHashIndex) {
+        HashIndexInsert(key, size);
+    } else if (size + 1 >= CMAP_HASH_THRESHOLD) {
+        BuildHashIndex();
+    }
 }
 void CFX_CMapByteStringToPtr::AddValue(FX_BSTR key, void* value)
 {
     ASSERT(value != NULL);
+    int index = m_Buffer.GetSize();
+    FX_BOOL bIndexed = m_pHashIndex && !LookupIndex(key);
     _CompactString* pKey = (_CompactString*)m_Buffer.Add();
     _CompactStringStore(m_Buffer.m_pAllocator, pKey, (FX_LPCBYTE)key, key.GetLength());
     *(void**)(pKey + 1) = value;
+    if (bIndexed) {
+        HashIndexInsert(key, index);
+    } else if (!m_pHashIndex && index + 1 >= CMAP_HASH_THRESHOLD) {
+        BuildHashIndex();
+    }
 }
 void CFX_CMapByteStringToPtr::RemoveKey(FX_BSTR key)
 {
@@ -564,8 +686,21 @@ void CFX_CMapByteStringToPtr::RemoveKey(FX_BSTR key)
         if (!_CompactStringSame(pKey, (FX_LPCBYTE)key, key_len)) {
             continue;
         }
+        if (m_pHashIndex) {
+            HashIndexRemove(key);
+        }
         _CompactStringRelease(pAllocator, pKey);
         pKey->m_CompactLen = 0xfe;
+        if (!m_pHashIndex) {
+            return;
+        }
+        for (index ++; index < size; index ++) {
+            pKey = (_CompactString*)m_Buffer.GetAt(index);
+            if (_CompactStringSame(pKey, (FX_LPCBYTE)key, key_len)) {
+                HashIndexInsert(key, index);
+                break;
+            }
+        }
         return;
     }
 }
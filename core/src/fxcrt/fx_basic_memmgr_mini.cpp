@@ -37,35 +37,47 @@ void FXMEM_SetConfig(const FX_MEMCONFIG* memConfig)
 {
     g_MemConfig = *memConfig;
 }
+static CFX_Mutex g_FixedMgrLock;
+static CFX_Mutex* FixedMgr_GetLock()
+{
+    return &g_FixedMgrLock;
+}
 #ifdef __cplusplus
 extern "C" {
 #endif
 static void* FixedAlloc(FXMEM_SystemMgr* pMgr, size_t size, int flags)
 {
+    CFX_CSLock lock(FixedMgr_GetLock());
     return ((CFXMEM_FixedMgr*)pMgr->user)->Alloc(size);
 }
 static void* FixedAllocDebug(FXMEM_SystemMgr* pMgr, size_t size, int flags, FX_LPCSTR file, int line)
 {
+    CFX_CSLock lock(FixedMgr_GetLock());
     return ((CFXMEM_FixedMgr*)pMgr->user)->Alloc(size);
 }
 static void* FixedRealloc(FXMEM_SystemMgr* pMgr, void* pointer, size_t size, int flags)
 {
+    CFX_CSLock lock(FixedMgr_GetLock());
     return ((CFXMEM_FixedMgr*)pMgr->user)->Realloc(pointer, size);
 }
 static void* FixedReallocDebug(FXMEM_SystemMgr* pMgr, void* pointer, size_t size, int flags, FX_LPCSTR file, int line)
 {
+    CFX_CSLock lock(FixedMgr_GetLock());
     return ((CFXMEM_FixedMgr*)pMgr->user)->Realloc(pointer, size);
 }
 static void  FixedFree(FXMEM_SystemMgr* pMgr, void* pointer, int flags)
 {
+    CFX_CSLock lock(FixedMgr_GetLock());
     ((CFXMEM_FixedMgr*)pMgr->user)->Free(pointer);
 }
 static void  FixedPurge(FXMEM_SystemMgr* pMgr)
 {
+    CFX_CSLock lock(FixedMgr_GetLock());
     ((CFXMEM_FixedMgr*)pMgr->user)->Purge();
 }
 static void FixedCollectAll(FXMEM_SystemMgr* pMgr)
 {
+    CFX_CSLock lock(FixedMgr_GetLock());
     ((CFXMEM_FixedMgr*)pMgr->user)->FreeAll();
 }
 #define FIXEDMEM_MINIMUMSIZE	(1024 * 1024 * 8)
@@ -442,3 +442,32 @@ FX_WCHAR FX_GetFolderSeparator()
     return '/';
 #endif
 }
+FX_BOOL FX_GetFileStamp(FX_LPCSTR path, FX_DWORD& dwSize, FX_DWORD& dwModified)
+{
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+    WIN32_FILE_ATTRIBUTE_DATA data;
+#ifndef _WIN32_WCE
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data)) {
+        return FALSE;
+    }
+#else
+    if (!GetFileAttributesExW(CFX_WideString::FromLocal(path), GetFileExInfoStandard, &data)) {
+        return FALSE;
+    }
+#endif
+    if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+        return FALSE;
+    }
+    dwSize = data.nFileSizeLow;
+    FX_UINT64 time = ((FX_UINT64)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+    dwModified = (FX_DWORD)(time / 10000000);
+#else
+    struct stat info;
+    if (stat(path, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return FALSE;
+    }
+    dwSize = (FX_DWORD)info.st_size;
+    dwModified = (FX_DWORD)info.st_mtime;
+#endif
+    return TRUE;
+}
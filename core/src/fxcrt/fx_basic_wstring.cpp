@@ -25,8 +25,7 @@ static void FX_ReleaseStringW(CFX_StringDataW* pData)
     if (pData == NULL) {
         return;
     }
-    pData->m_nRefs --;
-    if (pData->m_nRefs <= 0) {
+    if (FX_AtomicDecrement(&pData->m_nRefs) <= 0) {
         FX_Free(pData);
     }
 }
@@ -35,8 +34,7 @@ CFX_WideString::~CFX_WideString()
     if (m_pData == NULL) {
         return;
     }
-    m_pData->m_nRefs --;
-    if (m_pData->m_nRefs < 1) {
+    if (FX_AtomicDecrement(&m_pData->m_nRefs) < 1) {
         FX_Free(m_pData);
     }
 }
@@ -63,7 +61,7 @@ CFX_WideString::CFX_WideString(const CFX_WideString& stringSrc)
     }
     if (stringSrc.m_pData->m_nRefs >= 0) {
         m_pData = stringSrc.m_pData;
-        m_pData->m_nRefs ++;
+        FX_AtomicIncrement(&m_pData->m_nRefs);
     } else {
         m_pData = NULL;
         *this = stringSrc;
@@ -149,7 +147,7 @@ const CFX_WideString& CFX_WideString::operator=(const CFX_WideString& stringSrc)
         Empty();
         m_pData = stringSrc.m_pData;
         if (m_pData) {
-            m_pData->m_nRefs ++;
+            FX_AtomicIncrement(&m_pData->m_nRefs);
         }
     }
     return *this;
@@ -231,9 +229,7 @@ void CFX_WideString::Empty()
     if (m_pData == NULL) {
         return;
     }
-    if (m_pData->m_nRefs > 1) {
-        m_pData->m_nRefs --;
-    } else {
+    if (FX_AtomicDecrement(&m_pData->m_nRefs) < 1) {
         FX_Free(m_pData);
     }
     m_pData = NULL;
@@ -279,12 +275,12 @@ void CFX_WideString::CopyBeforeWrite()
         return;
     }
     CFX_StringDataW* pData = m_pData;
-    m_pData->m_nRefs --;
     FX_STRSIZE nDataLength = pData->m_nDataLength;
     m_pData = FX_AllocStringW(nDataLength);
     if (m_pData != NULL) {
         FXSYS_memcpy32(m_pData->m_String, pData->m_String, (nDataLength + 1) * sizeof(FX_WCHAR));
     }
+    FX_ReleaseStringW(pData);
 }
 void CFX_WideString::AllocBeforeWrite(FX_STRSIZE nLen)
 {
@@ -373,8 +369,7 @@ FX_LPWSTR CFX_WideString::GetBuffer(FX_STRSIZE nMinBufLength)
     }
     FXSYS_memcpy32(m_pData->m_String, pOldData->m_String, (nOldLen + 1)*sizeof(FX_WCHAR));
     m_pData->m_nDataLength = nOldLen;
-    pOldData->m_nRefs --;
-    if (pOldData->m_nRefs <= 0) {
+    if (FX_AtomicDecrement(&pOldData->m_nRefs) <= 0) {
         FX_Free(pOldData);
     }
     return m_pData->m_String;
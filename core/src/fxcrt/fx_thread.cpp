@@ -0,0 +1,336 @@
+// Copyright 2014 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+ 
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#include "../../include/fxcrt/fx_basic.h"
+#if _FXM_PLATFORM_ != _FXM_PLATFORM_WINDOWS_
+#include <unistd.h>
+#endif
+FX_BOOL g_bFXThreadSafeMode = FALSE;
+void FX_SetThreadSafeMode(FX_BOOL bEnable)
+{
+    g_bFXThreadSafeMode = bEnable;
+}
+struct FX_THREADDATA {
+    FX_THREAD_PROC		m_pProc;
+    FX_LPVOID			m_pParam;
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+    HANDLE				m_hThread;
+#else
+    pthread_t			m_hThread;
+#endif
+};
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+static DWORD WINAPI _FX_ThreadProc(LPVOID pParam)
+{
+    FX_THREADDATA* pData = (FX_THREADDATA*)pParam;
+    pData->m_pProc(pData->m_pParam);
+    return 0;
+}
+#else
+static void* _FX_ThreadProc(void* pParam)
+{
+    FX_THREADDATA* pData = (FX_THREADDATA*)pParam;
+    pData->m_pProc(pData->m_pParam);
+    return NULL;
+}
+#endif
+FX_LPVOID FX_Thread_Create(FX_THREAD_PROC pProc, FX_LPVOID pParam)
+{
+    FX_THREADDATA* pData = FX_Alloc(FX_THREADDATA, 1);
+    if (pData == NULL) {
+        return NULL;
+    }
+    pData->m_pProc = pProc;
+    pData->m_pParam = pParam;
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+    pData->m_hThread = CreateThread(NULL, 0, _FX_ThreadProc, pData, 0, NULL);
+    if (pData->m_hThread == NULL) {
+        FX_Free(pData);
+        return NULL;
+    }
+#else
+    if (pthread_create(&pData->m_hThread, NULL, _FX_ThreadProc, pData) != 0) {
+        FX_Free(pData);
+        return NULL;
+    }
+#endif
+    return pData;
+}
+void FX_Thread_Join(FX_LPVOID hThread)
+{
+    FX_THREADDATA* pData = (FX_THREADDATA*)hThread;
+    if (pData == NULL) {
+        return;
+    }
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+    WaitForSingleObject(pData->m_hThread, INFINITE);
+    CloseHandle(pData->m_hThread);
+#else
+    pthread_join(pData->m_hThread, NULL);
+#endif
+    FX_Free(pData);
+}
+int FX_Thread_GetProcessorCount()
+{
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+#define FX_PARALLEL_MAX_WORKERS		63
+class CFX_ParallelPool
+{
+public:
+    CFX_ParallelPool();
+    void			Run(FX_PARALLEL_PROC pProc, FX_LPVOID pParam, int nJobs, int nThreads);
+    void			WorkerLoop();
+protected:
+    FX_BOOL			StartWorker();
+    void			RunJobs();
+    void			Lock();
+    void			Unlock();
+    void			WakeWorkers(int count);
+    void			WaitForWork();
+    void			SignalDone();
+    void			WaitForDone();
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+    CRITICAL_SECTION	m_Lock;
+    HANDLE			m_hWork;
+    HANDLE			m_hDone;
+#else
+    pthread_mutex_t	m_Lock;
+    pthread_cond_t	m_Work;
+    pthread_cond_t	m_Done;
+    int				m_nWakeups;
+#endif
+    FX_BOOL			m_bBusy;
+    int				m_nWorkers;
+    FX_PARALLEL_PROC	m_pProc;
+    FX_LPVOID		m_pParam;
+    int				m_nJobs;
+    int				m_NextJob;
+    int				m_nPending;
+};
+static CFX_ParallelPool g_ParallelPool;
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+static DWORD WINAPI _FX_ParallelWorkerProc(LPVOID pParam)
+{
+    ((CFX_ParallelPool*)pParam)->WorkerLoop();
+    return 0;
+}
+CFX_ParallelPool::CFX_ParallelPool()
+{
+    InitializeCriticalSection(&m_Lock);
+    m_hWork = CreateSemaphore(NULL, 0, 0x7fffffff, NULL);
+    m_hDone = CreateEvent(NULL, FALSE, FALSE, NULL);
+    m_bBusy = FALSE;
+    m_nWorkers = 0;
+    m_pProc = NULL;
+    m_pParam = NULL;
+    m_nJobs = m_NextJob = m_nPending = 0;
+}
+FX_BOOL CFX_ParallelPool::StartWorker()
+{
+    if (m_hWork == NULL || m_hDone == NULL) {
+        return FALSE;
+    }
+    HANDLE hThread = CreateThread(NULL, 0, _FX_ParallelWorkerProc, this, 0, NULL);
+    if (hThread == NULL) {
+        return FALSE;
+    }
+    CloseHandle(hThread);
+    return TRUE;
+}
+void CFX_ParallelPool::Lock()
+{
+    EnterCriticalSection(&m_Lock);
+}
+void CFX_ParallelPool::Unlock()
+{
+    LeaveCriticalSection(&m_Lock);
+}
+void CFX_ParallelPool::WakeWorkers(int count)
+{
+    ReleaseSemaphore(m_hWork, count, NULL);
+}
+void CFX_ParallelPool::WaitForWork()
+{
+    Unlock();
+    WaitForSingleObject(m_hWork, INFINITE);
+    Lock();
+}
+void CFX_ParallelPool::SignalDone()
+{
+    SetEvent(m_hDone);
+}
+void CFX_ParallelPool::WaitForDone()
+{
+    Unlock();
+    WaitForSingleObject(m_hDone, INFINITE);
+    Lock();
+}
+#else
+static void* _FX_ParallelWorkerProc(void* pParam)
+{
+    ((CFX_ParallelPool*)pParam)->WorkerLoop();
+    return NULL;
+}
+CFX_ParallelPool::CFX_ParallelPool()
+{
+    pthread_mutex_init(&m_Lock, NULL);
+    pthread_cond_init(&m_Work, NULL);
+    pthread_cond_init(&m_Done, NULL);
+    m_nWakeups = 0;
+    m_bBusy = FALSE;
+    m_nWorkers = 0;
+    m_pProc = NULL;
+    m_pParam = NULL;
+    m_nJobs = m_NextJob = m_nPending = 0;
+}
+FX_BOOL CFX_ParallelPool::StartWorker()
+{
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, _FX_ParallelWorkerProc, this) != 0) {
+        return FALSE;
+    }
+    pthread_detach(thread);
+    return TRUE;
+}
+void CFX_ParallelPool::Lock()
+{
+    pthread_mutex_lock(&m_Lock);
+}
+void CFX_ParallelPool::Unlock()
+{
+    pthread_mutex_unlock(&m_Lock);
+}
+void CFX_ParallelPool::WakeWorkers(int count)
+{
+    m_nWakeups += count;
+    pthread_cond_broadcast(&m_Work);
+}
+void CFX_ParallelPool::WaitForWork()
+{
+    while (m_nWakeups == 0) {
+        pthread_cond_wait(&m_Work, &m_Lock);
+    }
+    m_nWakeups --;
+}
+void CFX_ParallelPool::SignalDone()
+{
+    pthread_cond_signal(&m_Done);
+}
+void CFX_ParallelPool::WaitForDone()
+{
+    pthread_cond_wait(&m_Done, &m_Lock);
+}
+#endif
+void CFX_ParallelPool::RunJobs()
+{
+    while (m_NextJob < m_nJobs) {
+        FX_PARALLEL_PROC pProc = m_pProc;
+        FX_LPVOID pParam = m_pParam;
+        int index = m_NextJob ++;
+        Unlock();
+        pProc(pParam, index);
+        Lock();
+        if (-- m_nPending == 0) {
+            SignalDone();
+        }
+    }
+}
+void CFX_ParallelPool::WorkerLoop()
+{
+    Lock();
+    while (1) {
+        WaitForWork();
+        RunJobs();
+    }
+}
+void CFX_ParallelPool::Run(FX_PARALLEL_PROC pProc, FX_LPVOID pParam, int nJobs, int nThreads)
+{
+    if (nThreads > nJobs) {
+        nThreads = nJobs;
+    }
+    if (nThreads > FX_PARALLEL_MAX_WORKERS + 1) {
+        nThreads = FX_PARALLEL_MAX_WORKERS + 1;
+    }
+    if (nThreads > 1) {
+        Lock();
+        if (!m_bBusy) {
+            m_bBusy = TRUE;
+            while (m_nWorkers < nThreads - 1 && StartWorker()) {
+                m_nWorkers ++;
+            }
+            m_pProc = pProc;
+            m_pParam = pParam;
+            m_nJobs = m_nPending = nJobs;
+            m_NextJob = 0;
+            WakeWorkers((nThreads - 1) < m_nWorkers ? nThreads - 1 : m_nWorkers);
+            RunJobs();
+            while (m_nPending) {
+                WaitForDone();
+            }
+            m_pProc = NULL;
+            m_pParam = NULL;
+            m_nJobs = m_NextJob = 0;
+            m_bBusy = FALSE;
+            Unlock();
+            return;
+        }
+        Unlock();
+    }
+    for (int i = 0; i < nJobs; i ++) {
+        pProc(pParam, i);
+    }
+}
+void FX_Parallel_Run(FX_PARALLEL_PROC pProc, FX_LPVOID pParam, int nJobs, int nThreads)
+{
+    g_ParallelPool.Run(pProc, pParam, nJobs, nThreads);
+}
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+CFX_Mutex::CFX_Mutex()
+{
+    InitializeCriticalSection(&m_Handle);
+}
+CFX_Mutex::~CFX_Mutex()
+{
+    DeleteCriticalSection(&m_Handle);
+}
+void CFX_Mutex::LockHandle()
+{
+    EnterCriticalSection(&m_Handle);
+}
+void CFX_Mutex::UnlockHandle()
+{
+    LeaveCriticalSection(&m_Handle);
+}
+#else
+CFX_Mutex::CFX_Mutex()
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&m_Handle, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+CFX_Mutex::~CFX_Mutex()
+{
+    pthread_mutex_destroy(&m_Handle);
+}
+void CFX_Mutex::LockHandle()
+{
+    pthread_mutex_lock(&m_Handle);
+}
+void CFX_Mutex::UnlockHandle()
+{
+    pthread_mutex_unlock(&m_Handle);
+}
+#endif
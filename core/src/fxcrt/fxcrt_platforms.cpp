@@ -48,6 +48,9 @@ FX_BOOL CFXCRT_FileAccess_CRT::Open(FX_BSTR fileName, FX_DWORD dwMode)
     if (m_hFile) {
         return FALSE;
     }
+    if ((dwMode & FX_FILEMODE_Exclusive) && FX_File_Exist(fileName)) {
+        return FALSE;
+    }
     CFX_ByteString strMode;
     FXCRT_GetFileModeString(dwMode, strMode);
     m_hFile = FXSYS_fopen(fileName.GetCStr(), (FX_LPCSTR)strMode);
@@ -58,6 +61,9 @@ FX_BOOL CFXCRT_FileAccess_CRT::Open(FX_WSTR fileName, FX_DWORD dwMode)
     if (m_hFile) {
         return FALSE;
     }
+    if ((dwMode & FX_FILEMODE_Exclusive) && FX_File_Exist(fileName)) {
+        return FALSE;
+    }
     CFX_WideString strMode;
     FXCRT_GetFileModeString(dwMode, strMode);
     m_hFile = FXSYS_wfopen(fileName.GetPtr(), (FX_LPCWSTR)strMode);
@@ -194,7 +200,7 @@ FX_BOOL FX_File_Copy(FX_WSTR fileNameSrc, FX_WSTR fileNameDst)
 }
 FX_BOOL FX_File_Move(FX_BSTR fileNameSrc, FX_BSTR fileNameDst)
 {
-    return rename(fileNameSrc.GetCStr(), fileNameDst.GetCStr());
+    return rename(fileNameSrc.GetCStr(), fileNameDst.GetCStr()) == 0;
 }
 FX_BOOL FX_File_Move(FX_WSTR fileNameSrc, FX_WSTR fileNameDst)
 {
@@ -7,6 +7,7 @@
 #include "../../include/fxcrt/fx_ext.h"
 #include "fxcrt_posix.h"
 #if _FXM_PLATFORM_ == _FXM_PLATFORM_LINUX_ || _FXM_PLATFORM_ == _FXM_PLATFORM_APPLE_ || _FXM_PLATFORM_ == _FXM_PLATFORM_ANDROID_
+#include <sys/mman.h>
 IFXCRT_FileAccess* FXCRT_FileAccess_Create(IFX_Allocator* pAllocator)
 {
     if (pAllocator) {
@@ -26,11 +27,17 @@ void FXCRT_Posix_GetFileMode(FX_DWORD dwModes, FX_INT32 &nFlags, FX_INT32 &nMask
         if (dwModes & FX_FILEMODE_Truncate) {
             nFlags |= O_TRUNC;
         }
+        if (dwModes & FX_FILEMODE_Exclusive) {
+            nFlags |= O_EXCL;
+        }
         nMasks = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
     }
 }
 CFXCRT_FileAccess_Posix::CFXCRT_FileAccess_Posix()
     : m_nFD(-1)
+    , m_pMapping(NULL)
+    , m_nMapSize(0)
+    , m_nMapPos(0)
 {
 }
 CFXCRT_FileAccess_Posix::~CFXCRT_FileAccess_Posix()
@@ -45,7 +52,21 @@ FX_BOOL CFXCRT_FileAccess_Posix::Open(FX_BSTR fileName, FX_DWORD dwMode)
     FX_INT32 nFlags, nMasks;
     FXCRT_Posix_GetFileMode(dwMode, nFlags, nMasks);
     m_nFD = open(fileName.GetCStr(), nFlags, nMasks);
-    return m_nFD > -1;
+    if (m_nFD < 0) {
+        return FALSE;
+    }
+    if ((dwMode & FX_FILEMODE_ReadOnly) && (dwMode & FX_FILEMODE_MemoryMapped)) {
+        FX_FILESIZE size = GetSize();
+        if (size > 0 && (FX_FILESIZE)(size_t)size == size) {
+            void* pMapping = mmap(NULL, (size_t)size, PROT_READ, MAP_SHARED, m_nFD, 0);
+            if (pMapping != MAP_FAILED) {
+                m_pMapping = (FX_LPBYTE)pMapping;
+                m_nMapSize = size;
+                m_nMapPos = 0;
+            }
+        }
+    }
+    return TRUE;
 }
 FX_BOOL CFXCRT_FileAccess_Posix::Open(FX_WSTR fileName, FX_DWORD dwMode)
 {
@@ -53,6 +74,12 @@ FX_BOOL CFXCRT_FileAccess_Posix::Open(FX_WSTR fileName, FX_DWORD dwMode)
 }
 void CFXCRT_FileAccess_Posix::Close()
 {
+    if (m_pMapping) {
+        munmap(m_pMapping, (size_t)m_nMapSize);
+        m_pMapping = NULL;
+        m_nMapSize = 0;
+        m_nMapPos = 0;
+    }
     if (m_nFD < 0) {
         return;
     }
@@ -69,6 +96,9 @@ void CFXCRT_FileAccess_Posix::Release(IFX_Allocator* pAllocator)
 }
 FX_FILESIZE CFXCRT_FileAccess_Posix::GetSize() const
 {
+    if (m_pMapping) {
+        return m_nMapSize;
+    }
     if (m_nFD < 0) {
         return 0;
     }
@@ -79,6 +109,9 @@ FX_FILESIZE CFXCRT_FileAccess_Posix::GetSize() const
 }
 FX_FILESIZE CFXCRT_FileAccess_Posix::GetPosition() const
 {
+    if (m_pMapping) {
+        return m_nMapPos;
+    }
     if (m_nFD < 0) {
         return (FX_FILESIZE) - 1;
     }
@@ -86,6 +119,13 @@ FX_FILESIZE CFXCRT_FileAccess_Posix::GetPosition() const
 }
 FX_FILESIZE CFXCRT_FileAccess_Posix::SetPosition(FX_FILESIZE pos)
 {
+    if (m_pMapping) {
+        if (pos < 0) {
+            return (FX_FILESIZE) - 1;
+        }
+        m_nMapPos = pos;
+        return m_nMapPos;
+    }
     if (m_nFD < 0) {
         return (FX_FILESIZE) - 1;
     }
@@ -93,6 +133,17 @@ FX_FILESIZE CFXCRT_FileAccess_Posix::SetPosition(FX_FILESIZE pos)
 }
 size_t CFXCRT_FileAccess_Posix::Read(void* pBuffer, size_t szBuffer)
 {
+    if (m_pMapping) {
+        if (m_nMapPos >= m_nMapSize) {
+            return 0;
+        }
+        if ((FX_FILESIZE)szBuffer > m_nMapSize - m_nMapPos) {
+            szBuffer = (size_t)(m_nMapSize - m_nMapPos);
+        }
+        FXSYS_memcpy32(pBuffer, m_pMapping + m_nMapPos, szBuffer);
+        m_nMapPos += szBuffer;
+        return szBuffer;
+    }
     if (m_nFD < 0) {
         return 0;
     }
@@ -100,7 +151,7 @@ size_t CFXCRT_FileAccess_Posix::Read(void* pBuffer, size_t szBuffer)
 }
 size_t CFXCRT_FileAccess_Posix::Write(const void* pBuffer, size_t szBuffer)
 {
-    if (m_nFD < 0) {
+    if (m_nFD < 0 || m_pMapping) {
         return 0;
     }
     return write(m_nFD, pBuffer, szBuffer);
@@ -120,7 +171,7 @@ size_t CFXCRT_FileAccess_Posix::ReadPos(void* pBuffer, size_t szBuffer, FX_FILES
 }
 size_t CFXCRT_FileAccess_Posix::WritePos(const void* pBuffer, size_t szBuffer, FX_FILESIZE pos)
 {
-    if (m_nFD < 0) {
+    if (m_nFD < 0 || m_pMapping) {
         return 0;
     }
     if (SetPosition(pos) == (FX_FILESIZE) - 1) {
@@ -137,7 +188,7 @@ FX_BOOL CFXCRT_FileAccess_Posix::Flush()
 }
 FX_BOOL CFXCRT_FileAccess_Posix::Truncate(FX_FILESIZE szFile)
 {
-    if (m_nFD < 0) {
+    if (m_nFD < 0 || m_pMapping) {
         return FALSE;
     }
     return !ftruncate(m_nFD, szFile);
@@ -192,7 +243,7 @@ FX_BOOL FX_File_Copy(FX_WSTR fileNameSrc, FX_WSTR fileNameDst)
 }
 FX_BOOL FX_File_Move(FX_BSTR fileNameSrc, FX_BSTR fileNameDst)
 {
-    return rename(fileNameSrc.GetCStr(), fileNameDst.GetCStr());
+    return rename(fileNameSrc.GetCStr(), fileNameDst.GetCStr()) == 0;
 }
 FX_BOOL FX_File_Move(FX_WSTR fileNameSrc, FX_WSTR fileNameDst)
 {
@@ -26,8 +26,15 @@ public:
     virtual size_t		WritePos(const void* pBuffer, size_t szBuffer, FX_FILESIZE pos);
     virtual FX_BOOL		Flush();
     virtual FX_BOOL		Truncate(FX_FILESIZE szFile);
+    virtual FX_LPCBYTE	GetMappedData() const
+    {
+        return m_pMapping;
+    }
 protected:
     FX_INT32	m_nFD;
+    FX_LPBYTE	m_pMapping;
+    FX_FILESIZE	m_nMapSize;
+    FX_FILESIZE	m_nMapPos;
 };
 #endif
 #endif
@@ -37,7 +37,11 @@ void FXCRT_Windows_GetFileMode(FX_DWORD dwMode, FX_DWORD &dwAccess, FX_DWORD &dw
     dwShare = FILE_SHARE_READ | FILE_SHARE_WRITE;
     if (!(dwMode & FX_FILEMODE_ReadOnly)) {
         dwAccess |= GENERIC_WRITE;
-        dwCreation = (dwMode & FX_FILEMODE_Truncate) ? CREATE_ALWAYS : OPEN_ALWAYS;
+        if (dwMode & FX_FILEMODE_Exclusive) {
+            dwCreation = CREATE_NEW;
+        } else {
+            dwCreation = (dwMode & FX_FILEMODE_Truncate) ? CREATE_ALWAYS : OPEN_ALWAYS;
+        }
     } else {
         dwCreation = OPEN_EXISTING;
     }
@@ -213,10 +217,10 @@ FX_BOOL FX_File_Copy(FX_WSTR fileNameSrc, FX_WSTR fileNameDst)
 }
 FX_BOOL FX_File_Move(FX_BSTR fileNameSrc, FX_BSTR fileNameDst)
 {
-    return ::MoveFileA(fileNameSrc.GetCStr(), fileNameDst.GetCStr());
+    return ::MoveFileExA(fileNameSrc.GetCStr(), fileNameDst.GetCStr(), MOVEFILE_REPLACE_EXISTING);
 }
 FX_BOOL FX_File_Move(FX_WSTR fileNameSrc, FX_WSTR fileNameDst)
 {
-    return ::MoveFileW((LPCWSTR)fileNameSrc.GetPtr(), (LPCWSTR)fileNameDst.GetPtr());
+    return ::MoveFileExW((LPCWSTR)fileNameSrc.GetPtr(), (LPCWSTR)fileNameDst.GetPtr(), MOVEFILE_REPLACE_EXISTING);
 }
 #endif
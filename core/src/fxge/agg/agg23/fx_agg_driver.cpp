@@ -297,11 +297,85 @@ void CFX_AggDeviceDriver::RestoreState(FX_BOOL bKeepSaved)
         m_pClipRgn = pSavedClip;
     }
 }
+class CFX_ClipSpanBuilder
+{
+public:
+    CFX_ClipSpanBuilder(CFX_ClipSpans* pSpans) : m_pSpans(pSpans), m_bPartialCover(FALSE) {}
+    void prepare(unsigned) {}
+    template<class Scanline> void render(const Scanline& sl)
+    {
+        if (m_bPartialCover) {
+            return;
+        }
+        int y = sl.y();
+        unsigned num_spans = sl.num_spans();
+        typename Scanline::const_iterator span = sl.begin();
+        while (1) {
+            int x = span->x;
+            int run_start = -1;
+            for (int i = 0; i < span->len; i ++) {
+                FX_BYTE cover = span->covers[i];
+                if (cover == 255) {
+                    if (run_start < 0) {
+                        run_start = i;
+                    }
+                    continue;
+                }
+                if (cover) {
+                    m_bPartialCover = TRUE;
+                    return;
+                }
+                if (run_start >= 0) {
+                    m_pSpans->AddRun(y, x + run_start, x + i);
+                    run_start = -1;
+                }
+            }
+            if (run_start >= 0) {
+                m_pSpans->AddRun(y, x + run_start, x + span->len);
+            }
+            if(--num_spans == 0) {
+                break;
+            }
+            ++span;
+        }
+    }
+    CFX_ClipSpans*	m_pSpans;
+    FX_BOOL			m_bPartialCover;
+};
 void CFX_AggDeviceDriver::SetClipMask(agg::rasterizer_scanline_aa& rasterizer)
 {
     FX_RECT path_rect(rasterizer.min_x(), rasterizer.min_y(),
                       rasterizer.max_x() + 1, rasterizer.max_y() + 1);
     path_rect.Intersect(m_pClipRgn->GetBox());
+    if (path_rect.IsEmpty()) {
+        m_pClipRgn->IntersectRect(path_rect);
+        return;
+    }
+    FX_BOOL bNoSmooth = (m_FillFlags & FXFILL_NOPATHSMOOTH) != 0;
+    agg::scanline_u8 scanline;
+    CFX_ClipSpansRef spans;
+    CFX_ClipSpans* pSpans = spans.New();
+    if (pSpans && !pSpans->Create(path_rect.top, path_rect.Height())) {
+        pSpans = NULL;
+    }
+    // The path is swept once. Fully covered runs are collected as spans until the first
+    // partially covered pixel; from that scanline on the path is rendered into a mask.
+    CFX_ClipSpanBuilder builder(pSpans);
+    FX_BOOL bSweep = rasterizer.rewind_scanlines();
+    if (bSweep) {
+        scanline.reset(rasterizer.min_x(), rasterizer.max_x());
+        while (pSpans && rasterizer.sweep_scanline(scanline, bNoSmooth)) {
+            builder.render(scanline);
+            if (builder.m_bPartialCover) {
+                break;
+            }
+        }
+    }
+    if (pSpans && !builder.m_bPartialCover) {
+        pSpans->Finish();
+        m_pClipRgn->IntersectSpans(path_rect, spans);
+        return;
+    }
     CFX_DIBitmapRef mask;
     CFX_DIBitmap* pThisLayer = mask.New();
     if (!pThisLayer) {
@@ -314,8 +388,27 @@ void CFX_AggDeviceDriver::SetClipMask(agg::rasterizer_scanline_aa& rasterizer)
     agg::renderer_base<agg::pixfmt_gray8> base_buf(pixel_buf);
     agg::renderer_scanline_aa_offset<agg::renderer_base<agg::pixfmt_gray8> > final_render(base_buf, path_rect.left, path_rect.top);
     final_render.color(agg::gray8(255));
-    agg::scanline_u8 scanline;
-    agg::render_scanlines(rasterizer, scanline, final_render, (m_FillFlags & FXFILL_NOPATHSMOOTH) != 0);
+    if (builder.m_bPartialCover) {
+        pSpans->Finish();
+        for (int row = path_rect.top; row < path_rect.bottom; row ++) {
+            const int* pRuns;
+            int nRuns = pSpans->GetRowRuns(row, pRuns);
+            FX_LPBYTE dest_scan = pThisLayer->GetBuffer() + (row - path_rect.top) * pThisLayer->GetPitch();
+            for (int i = 0; i < nRuns; i ++) {
+                int left = FX_MAX(pRuns[i * 2], path_rect.left);
+                int right = FX_MIN(pRuns[i * 2 + 1], path_rect.right);
+                if (left < right) {
+                    FXSYS_memset8(dest_scan + left - path_rect.left, 0xff, right - left);
+                }
+            }
+        }
+        final_render.render(scanline);
+    }
+    if (bSweep) {
+        while (rasterizer.sweep_scanline(scanline, bNoSmooth)) {
+            final_render.render(scanline);
+        }
+    }
     m_pClipRgn->IntersectMaskF(path_rect.left, path_rect.top, mask);
 }
 FX_BOOL CFX_AggDeviceDriver::SetClip_PathFill(const CFX_PathData* pPathData,
@@ -383,6 +476,7 @@ private:
     CFX_DIBitmap* m_pOriDevice;
     FX_RECT		m_ClipBox;
     const CFX_DIBitmap*	m_pClipMask;
+    const CFX_ClipSpans*	m_pClipSpans;
     CFX_DIBitmap*	m_pDevice;
     const CFX_ClipRgn* m_pClipRgn;
     void (CFX_Renderer::*composite_span)(FX_LPBYTE, int, int, int, FX_LPBYTE, int, int, FX_LPBYTE, FX_LPBYTE);
@@ -566,7 +660,7 @@ public:
                         *dest_scan1 |= 1 << (7 - (col + span_left) % 8);
                     }
                 }
-                dest_scan1 = dest_scan + (span_left % 8 + col - col_start + 1) / 8;
+                dest_scan1 = dest_scan + (span_left % 8 + col + 1) / 8;
             }
         }
     }
@@ -579,7 +673,6 @@ public:
         ASSERT(!m_pDevice->IsCmykImage());
         int col_start = span_left < clip_left ? clip_left - span_left : 0;
         int col_end = (span_left + span_len) < clip_right ? span_len : (clip_right - span_left);
-        dest_scan += col_start / 8;
         int index = 0;
         if (m_pDevice->GetPalette() == NULL) {
             index = ((FX_BYTE)m_Color == 0xff) ? 1 : 0;
@@ -589,7 +682,7 @@ public:
                     index = i;
                 }
         }
-        FX_LPBYTE dest_scan1 = dest_scan;
+        FX_LPBYTE dest_scan1 = dest_scan + (span_left % 8 + col_start) / 8;
         for (int col = col_start; col < col_end; col ++) {
             int src_alpha;
             if (clip_scan) {
@@ -970,6 +1063,14 @@ public:
         }
         int Bpp = m_pDevice->GetBPP() / 8;
         FX_BOOL bDestAlpha = m_pDevice->HasAlpha() || m_pDevice->IsAlphaMask();
+        const int* pClipRuns = NULL;
+        int nClipRuns = 0;
+        if (m_pClipSpans) {
+            nClipRuns = m_pClipSpans->GetRowRuns(y, pClipRuns);
+            if (nClipRuns == 0) {
+                return;
+            }
+        }
         unsigned num_spans = sl.num_spans();
         typename Scanline::const_iterator span = sl.begin();
         while (1) {
@@ -990,7 +1091,20 @@ public:
             if (m_pClipMask) {
                 clip_pos = m_pClipMask->GetBuffer() + (y - m_ClipBox.top) * m_pClipMask->GetPitch() + x - m_ClipBox.left;
             }
-            if (ori_pos) {
+            if (m_pClipSpans) {
+                for (int i = 0; i < nClipRuns; i ++) {
+                    int clip_left = FX_MAX(pClipRuns[i * 2], m_ClipBox.left);
+                    int clip_right = FX_MIN(pClipRuns[i * 2 + 1], m_ClipBox.right);
+                    if (clip_right <= x || clip_left >= x + span->len || clip_left >= clip_right) {
+                        continue;
+                    }
+                    if (ori_pos) {
+                        CompositeSpan(dest_pos, ori_pos, Bpp, bDestAlpha, x, span->len, span->covers, clip_left, clip_right, NULL);
+                    } else {
+                        (this->*composite_span)(dest_pos, Bpp, x, span->len, span->covers, clip_left, clip_right, NULL, dest_extra_alpha_pos);
+                    }
+                }
+            } else if (ori_pos) {
                 CompositeSpan(dest_pos, ori_pos, Bpp, bDestAlpha, x, span->len, span->covers, m_ClipBox.left, m_ClipBox.right, clip_pos);
             } else {
                 (this->*composite_span)(dest_pos, Bpp, x, span->len, span->covers, m_ClipBox.left, m_ClipBox.right, clip_pos, dest_extra_alpha_pos);
@@ -1018,9 +1132,13 @@ public:
             m_ClipBox.bottom = m_pDevice->GetHeight();
         }
         m_pClipMask = NULL;
+        m_pClipSpans = NULL;
         if (m_pClipRgn && m_pClipRgn->GetType() == CFX_ClipRgn::MaskF) {
             m_pClipMask = m_pClipRgn->GetMask();
         }
+        if (m_pClipRgn && m_pClipRgn->GetType() == CFX_ClipRgn::SpansI) {
+            m_pClipSpans = m_pClipRgn->GetSpans();
+        }
         m_bFullCover = bFullCover;
         FX_BOOL bObjectCMYK = FXGETFLAG_COLORTYPE(alpha_flag);
         FX_BOOL bDeviceCMYK = pDevice->IsCmykImage();
@@ -1442,6 +1560,18 @@ FX_BOOL CFX_AggDeviceDriver::SetPixel(int x, int y, FX_DWORD color, int alpha_fl
                 color = (color & 0xffffff) | (new_alpha << 24);
             }
             return _DibSetPixel(m_pBitmap, x, y, color, alpha_flag, pIccTransform);
+        } else if (m_pClipRgn->GetType() == CFX_ClipRgn::SpansI) {
+            const int* pRuns;
+            int nRuns = m_pClipRgn->GetSpans()->GetRowRuns(y, pRuns);
+            for (int i = 0; i < nRuns; i ++) {
+                if (x >= pRuns[i * 2] && x < pRuns[i * 2 + 1]) {
+                    if (m_bRgbByteOrder) {
+                        RgbByteOrderSetPixel(m_pBitmap, x, y, color);
+                        return TRUE;
+                    }
+                    return _DibSetPixel(m_pBitmap, x, y, color, alpha_flag, pIccTransform);
+                }
+            }
         }
     }
     return TRUE;
@@ -1471,6 +1601,26 @@ FX_BOOL CFX_AggDeviceDriver::FillRect(const FX_RECT* pRect, FX_DWORD fill_color,
         }
         return TRUE;
     }
+    if (m_pClipRgn->GetType() == CFX_ClipRgn::SpansI) {
+        const CFX_ClipSpans* pSpans = m_pClipRgn->GetSpans();
+        for (int row = draw_rect.top; row < draw_rect.bottom; row ++) {
+            const int* pRuns;
+            int nRuns = pSpans->GetRowRuns(row, pRuns);
+            for (int i = 0; i < nRuns; i ++) {
+                int run_left = FX_MAX(pRuns[i * 2], draw_rect.left);
+                int run_right = FX_MIN(pRuns[i * 2 + 1], draw_rect.right);
+                if (run_left >= run_right) {
+                    continue;
+                }
+                if (m_bRgbByteOrder) {
+                    RgbByteOrderCompositeRect(m_pBitmap, run_left, row, run_right - run_left, 1, fill_color);
+                } else {
+                    m_pBitmap->CompositeRect(run_left, row, run_right - run_left, 1, fill_color, alpha_flag, pIccTransform);
+                }
+            }
+        }
+        return TRUE;
+    }
     m_pBitmap->CompositeMask(draw_rect.left, draw_rect.top, draw_rect.Width(), draw_rect.Height(), (const CFX_DIBitmap*)m_pClipRgn->GetMask(),
                              fill_color, draw_rect.left - clip_rect.left, draw_rect.top - clip_rect.top, FXDIB_BLEND_NORMAL, NULL, m_bRgbByteOrder, alpha_flag, pIccTransform);
     return TRUE;
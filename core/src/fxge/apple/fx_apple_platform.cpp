@@ -133,6 +133,7 @@ FX_BOOL CFX_AggDeviceDriver::DrawDeviceText(int						 nChars,
     CGImageRef pImageCG = NULL;
     if (m_pClipRgn) {
         rect_cg = CGRectMake(m_pClipRgn->GetBox().left, m_pClipRgn->GetBox().top, m_pClipRgn->GetBox().Width(), m_pClipRgn->GetBox().Height());
+        m_pClipRgn->ConvertToMaskF();
         const CFX_DIBitmap*	pClipMask = m_pClipRgn->GetMask();
         if (pClipMask) {
             CGDataProviderRef pClipMaskDataProvider = CGDataProviderCreateWithData(NULL,
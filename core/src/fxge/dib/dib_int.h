@@ -26,6 +26,19 @@ public:
     int		base;
 };
 #define FPDF_HUGE_IMAGE_SIZE	60000000
+#define FX_STRETCH_MAX_THREADS			16
+#define FX_STRETCH_BAND_ROWS			32
+#define FX_STRETCH_PARALLEL_MIN_PIXELS	(1024 * 1024)
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define _FXDIB_SSE2_
+#endif
+#ifdef _FXDIB_SSE2_
+FX_BOOL		_FXDIB_HasSSE2();
+int			_CompositeRow_Argb2Argb_SSE2(FX_LPBYTE dest_scan, FX_LPCBYTE src_scan, int pixel_count, FX_LPCBYTE clip_scan);
+int			_CompositeRow_ByteMask2Argb_SSE2(FX_LPBYTE dest_scan, FX_LPCBYTE src_scan, int mask_alpha, int src_r, int src_g, int src_b,
+        int pixel_count, FX_LPCBYTE clip_scan);
+int			_CompositeRow_Rgb2Rgb_NoBlend_Clip_SSE2(FX_LPBYTE dest_scan, FX_LPCBYTE src_scan, int width, FX_LPCBYTE clip_scan);
+#endif
 struct PixelWeight {
     int		m_SrcStart;
     int		m_SrcEnd;
@@ -84,5 +97,9 @@ public:
     FX_BOOL	StartStretchHorz();
     FX_BOOL	ContinueStretchHorz(IFX_Pause* pPause);
     void	StretchVert();
+    void	StretchHorzRow(int src_row);
+    void	StretchVertRow(CWeightTable& table, int row, FX_LPBYTE dest_scan, FX_LPBYTE dest_scan_mask, int* pAccum);
+    void	StretchBands(CWeightTable* pTable, int first_row, int last_row, FX_LPBYTE pBand, FX_LPBYTE pMaskBand, int* pAccum);
     int		m_State;
+    int		m_nThreads;
 };
@@ -729,7 +729,15 @@ void _CompositeRow_Argb2Argb(FX_LPBYTE dest_scan, FX_LPCBYTE src_scan, int pixel
     if (dest_alpha_scan == NULL) {
         if (src_alpha_scan == NULL) {
             FX_BYTE back_alpha = 0;
-            for (int col = 0; col < pixel_count; col ++) {
+            int col = 0;
+#ifdef _FXDIB_SSE2_
+            if (blend_type == FXDIB_BLEND_NORMAL && _FXDIB_HasSSE2()) {
+                col = _CompositeRow_Argb2Argb_SSE2(dest_scan, src_scan, pixel_count, clip_scan);
+                dest_scan += col * 4;
+                src_scan += col * 4;
+            }
+#endif
+            for (; col < pixel_count; col ++) {
                 back_alpha = dest_scan[3];
                 if (back_alpha == 0) {
                     if (clip_scan) {
@@ -1344,7 +1352,15 @@ inline void _CompositeRow_Rgb2Rgb_NoBlend_NoClip(FX_LPBYTE dest_scan, FX_LPCBYTE
 }
 inline void _CompositeRow_Rgb2Rgb_NoBlend_Clip(FX_LPBYTE dest_scan, FX_LPCBYTE src_scan, int width, int dest_Bpp, int src_Bpp, FX_LPCBYTE clip_scan)
 {
-    for (int col = 0; col < width; col ++) {
+    int col = 0;
+#ifdef _FXDIB_SSE2_
+    if (dest_Bpp == 4 && src_Bpp == 4 && _FXDIB_HasSSE2()) {
+        col = _CompositeRow_Rgb2Rgb_NoBlend_Clip_SSE2(dest_scan, src_scan, width, clip_scan);
+        dest_scan += col * 4;
+        src_scan += col * 4;
+    }
+#endif
+    for (; col < width; col ++) {
         int src_alpha = clip_scan[col];
         if (src_alpha == 255) {
             dest_scan[0] = src_scan[0];
@@ -2314,7 +2330,14 @@ void _CompositeRow_1bppRgb2Rgba_NoBlend(FX_LPBYTE dest_scan, FX_LPCBYTE src_scan
 void _CompositeRow_ByteMask2Argb(FX_LPBYTE dest_scan, FX_LPCBYTE src_scan, int mask_alpha, int src_r, int src_g, int src_b, int pixel_count,
                                  int blend_type, FX_LPCBYTE clip_scan)
 {
-    for (int col = 0; col < pixel_count; col ++) {
+    int col = 0;
+#ifdef _FXDIB_SSE2_
+    if (blend_type == FXDIB_BLEND_NORMAL && _FXDIB_HasSSE2()) {
+        col = _CompositeRow_ByteMask2Argb_SSE2(dest_scan, src_scan, mask_alpha, src_r, src_g, src_b, pixel_count, clip_scan);
+        dest_scan += col * 4;
+    }
+#endif
+    for (; col < pixel_count; col ++) {
         int src_alpha;
         if (clip_scan) {
             src_alpha = mask_alpha * clip_scan[col] * src_scan[col] / 255 / 255;
@@ -4136,8 +4159,11 @@ FX_BOOL CFX_DIBitmap::CompositeBitmap(int dest_left, int dest_top, int width, in
         return TRUE;
     }
     const CFX_DIBitmap* pClipMask = NULL;
-    FX_RECT clip_box;
-    if (pClipRgn && pClipRgn->GetType() != CFX_ClipRgn::RectI) {
+    const CFX_ClipSpans* pClipSpans = NULL;
+    FX_RECT clip_box(0, 0, 0, 0);
+    if (pClipRgn && pClipRgn->GetType() == CFX_ClipRgn::SpansI) {
+        pClipSpans = pClipRgn->GetSpans();
+    } else if (pClipRgn && pClipRgn->GetType() != CFX_ClipRgn::RectI) {
         ASSERT(pClipRgn->GetType() == CFX_ClipRgn::MaskF);
         pClipMask = pClipRgn->GetMask();
         clip_box = pClipRgn->GetBox();
@@ -4164,6 +4190,27 @@ FX_BOOL CFX_DIBitmap::CompositeBitmap(int dest_left, int dest_top, int width, in
         FX_LPCBYTE src_scan = pSrcBitmap->GetScanline(src_top + row) + src_left * src_Bpp;
         FX_LPCBYTE src_scan_extra_alpha = pSrcAlphaMask ? pSrcAlphaMask->GetScanline(src_top + row) + src_left : NULL;
         FX_LPBYTE dst_scan_extra_alpha = m_pAlphaMask ? (FX_LPBYTE)m_pAlphaMask->GetScanline(dest_top + row) + dest_left : NULL;
+        if (pClipSpans) {
+            const int* pRuns;
+            int nRuns = pClipSpans->GetRowRuns(dest_top + row, pRuns);
+            for (int i = 0; i < nRuns; i ++) {
+                int offset = FX_MAX(pRuns[i * 2], dest_left) - dest_left;
+                int run_width = FX_MIN(pRuns[i * 2 + 1], dest_left + width) - dest_left - offset;
+                if (run_width <= 0) {
+                    continue;
+                }
+                FX_LPCBYTE src_run_extra_alpha = src_scan_extra_alpha ? src_scan_extra_alpha + offset : NULL;
+                FX_LPBYTE dst_run_extra_alpha = dst_scan_extra_alpha ? dst_scan_extra_alpha + offset : NULL;
+                if (bRgb) {
+                    compositor.CompositeRgbBitmapLine(dest_scan + offset * dest_Bpp, src_scan + offset * src_Bpp, run_width, NULL,
+                                                      src_run_extra_alpha, dst_run_extra_alpha);
+                } else {
+                    compositor.CompositePalBitmapLine(dest_scan + offset * dest_Bpp, src_scan + offset * src_Bpp, src_left + offset, run_width, NULL,
+                                                      src_run_extra_alpha, dst_run_extra_alpha);
+                }
+            }
+            continue;
+        }
         FX_LPCBYTE clip_scan = NULL;
         if (pClipMask) {
             clip_scan = pClipMask->m_pBuffer + (dest_top + row - clip_box.top) * pClipMask->m_Pitch + (dest_left - clip_box.left);
@@ -4197,8 +4244,11 @@ FX_BOOL CFX_DIBitmap::CompositeMask(int dest_left, int dest_top, int width, int
         return TRUE;
     }
     const CFX_DIBitmap* pClipMask = NULL;
-    FX_RECT clip_box;
-    if (pClipRgn && pClipRgn->GetType() != CFX_ClipRgn::RectI) {
+    const CFX_ClipSpans* pClipSpans = NULL;
+    FX_RECT clip_box(0, 0, 0, 0);
+    if (pClipRgn && pClipRgn->GetType() == CFX_ClipRgn::SpansI) {
+        pClipSpans = pClipRgn->GetSpans();
+    } else if (pClipRgn && pClipRgn->GetType() != CFX_ClipRgn::RectI) {
         ASSERT(pClipRgn->GetType() == CFX_ClipRgn::MaskF);
         pClipMask = pClipRgn->GetMask();
         clip_box = pClipRgn->GetBox();
@@ -4213,6 +4263,24 @@ FX_BOOL CFX_DIBitmap::CompositeMask(int dest_left, int dest_top, int width, int
         FX_LPBYTE dest_scan = m_pBuffer + (dest_top + row) * m_Pitch + dest_left * Bpp;
         FX_LPCBYTE src_scan = pMask->GetScanline(src_top + row);
         FX_LPBYTE dst_scan_extra_alpha = m_pAlphaMask ? (FX_LPBYTE)m_pAlphaMask->GetScanline(dest_top + row) + dest_left : NULL;
+        if (pClipSpans) {
+            const int* pRuns;
+            int nRuns = pClipSpans->GetRowRuns(dest_top + row, pRuns);
+            for (int i = 0; i < nRuns; i ++) {
+                int offset = FX_MAX(pRuns[i * 2], dest_left) - dest_left;
+                int run_width = FX_MIN(pRuns[i * 2 + 1], dest_left + width) - dest_left - offset;
+                if (run_width <= 0) {
+                    continue;
+                }
+                FX_LPBYTE dst_run_extra_alpha = dst_scan_extra_alpha ? dst_scan_extra_alpha + offset : NULL;
+                if (src_bpp == 1) {
+                    compositor.CompositeBitMaskLine(dest_scan + offset * Bpp, src_scan, src_left + offset, run_width, NULL, dst_run_extra_alpha);
+                } else {
+                    compositor.CompositeByteMaskLine(dest_scan + offset * Bpp, src_scan + src_left + offset, run_width, NULL, dst_run_extra_alpha);
+                }
+            }
+            continue;
+        }
         FX_LPCBYTE clip_scan = NULL;
         if (pClipMask) {
             clip_scan = pClipMask->m_pBuffer + (dest_top + row - clip_box.top) * pClipMask->m_Pitch + (dest_left - clip_box.left);
@@ -4452,7 +4520,10 @@ void CFX_BitmapComposer::Compose(CFX_DIBitmap* pDest, const CFX_ClipRgn* pClipRg
     m_BitmapAlpha = bitmap_alpha;
     m_MaskColor = mask_color;
     m_pClipMask = NULL;
-    if (pClipRgn && pClipRgn->GetType() != CFX_ClipRgn::RectI) {
+    m_pClipSpans = NULL;
+    if (pClipRgn && pClipRgn->GetType() == CFX_ClipRgn::SpansI) {
+        m_pClipSpans = pClipRgn->GetSpans();
+    } else if (pClipRgn && pClipRgn->GetType() != CFX_ClipRgn::RectI) {
         m_pClipMask = pClipRgn->GetMask();
     }
     m_bVertical = bVertical;
@@ -4467,7 +4538,8 @@ FX_BOOL CFX_BitmapComposer::SetInfo(int width, int height, FXDIB_Format src_form
 {
     m_SrcFormat = src_format;
     if (!m_Compositor.Init(m_pBitmap->GetFormat(), src_format, width, pSrcPalette, m_MaskColor, FXDIB_BLEND_NORMAL,
-                           m_pClipMask != NULL || (m_BitmapAlpha < 255), m_bRgbByteOrder, m_AlphaFlag, m_pIccTransform)) {
+                           m_pClipMask != NULL || (m_bVertical && m_pClipSpans != NULL) || (m_BitmapAlpha < 255),
+                           m_bRgbByteOrder, m_AlphaFlag, m_pIccTransform)) {
         return FALSE;
     }
     if (m_bVertical) {
@@ -4521,6 +4593,25 @@ void CFX_BitmapComposer::ComposeScanline(int line, FX_LPCBYTE scanline, FX_LPCBY
         ComposeScanlineV(line, scanline, scan_extra_alpha);
         return;
     }
+    if (m_pClipSpans) {
+        int dest_Bpp = m_pBitmap->GetBPP() / 8;
+        int src_Bpp = (m_SrcFormat & 0xff) / 8;
+        FX_LPBYTE dest_scan = (FX_LPBYTE)m_pBitmap->GetScanline(line + m_DestTop) + m_DestLeft * dest_Bpp;
+        FX_LPBYTE dest_alpha_scan = m_pBitmap->m_pAlphaMask ?
+                                    (FX_LPBYTE)m_pBitmap->m_pAlphaMask->GetScanline(line + m_DestTop) + m_DestLeft : NULL;
+        const int* pRuns;
+        int nRuns = m_pClipSpans->GetRowRuns(line + m_DestTop, pRuns);
+        for (int i = 0; i < nRuns; i ++) {
+            int offset = FX_MAX(pRuns[i * 2], m_DestLeft) - m_DestLeft;
+            int run_width = FX_MIN(pRuns[i * 2 + 1], m_DestLeft + m_DestWidth) - m_DestLeft - offset;
+            if (run_width <= 0) {
+                continue;
+            }
+            DoCompose(dest_scan + offset * dest_Bpp, scanline + offset * src_Bpp, run_width, NULL,
+                      scan_extra_alpha ? scan_extra_alpha + offset : NULL, dest_alpha_scan ? dest_alpha_scan + offset : NULL);
+        }
+        return;
+    }
     FX_LPCBYTE clip_scan = NULL;
     if (m_pClipMask)
         clip_scan = m_pClipMask->GetBuffer() + (m_DestTop + line - m_pClipRgn->GetBox().top) *
@@ -4581,6 +4672,20 @@ void CFX_BitmapComposer::ComposeScanlineV(int line, FX_LPCBYTE scanline, FX_LPCB
             clip_scan[i] = *src_clip;
             src_clip += clip_pitch;
         }
+    } else if (m_pClipSpans) {
+        clip_scan = m_pClipScanV;
+        for (i = 0; i < m_DestHeight; i ++) {
+            int row = m_bFlipY ? m_DestTop + m_DestHeight - 1 - i : m_DestTop + i;
+            const int* pRuns;
+            int nRuns = m_pClipSpans->GetRowRuns(row, pRuns);
+            clip_scan[i] = 0;
+            for (int j = 0; j < nRuns; j ++) {
+                if (dest_x >= pRuns[j * 2] && dest_x < pRuns[j * 2 + 1]) {
+                    clip_scan[i] = 0xff;
+                    break;
+                }
+            }
+        }
     }
     DoCompose(m_pScanlineV, scanline, m_DestHeight, clip_scan, scan_extra_alpha, m_pScanlineAlphaV);
     src_scan = m_pScanlineV;
@@ -0,0 +1,123 @@
+// Copyright 2014 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+ 
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#include "../../../include/fxge/fx_dib.h"
+#include "../../../include/fxge/fx_ge.h"
+#include "dib_int.h"
+#ifdef _FXDIB_SSE2_
+#include <emmintrin.h>
+#if defined(_M_IX86)
+#include <intrin.h>
+#endif
+FX_BOOL _FXDIB_HasSSE2()
+{
+#if defined(_M_IX86)
+    static int s_HasSSE2 = -1;
+    if (s_HasSSE2 < 0) {
+        int info[4];
+        __cpuid(info, 1);
+        s_HasSSE2 = (info[3] & (1 << 26)) ? 1 : 0;
+    }
+    return s_HasSSE2;
+#else
+    return TRUE;
+#endif
+}
+// The kernels below produce exactly the same bytes as the scalar loops in fx_dib_composite.cpp:
+// x / 255 is computed as (x * 0x8081) >> 23, which is exact for 0 <= x <= 65535, and the alpha
+// ratio a * 255 / b (a, b <= 255) is computed with a single precision division, whose rounding
+// error is always smaller than the distance to the next integer.
+static inline __m128i _FXDIB_Div255(__m128i x)
+{
+    return _mm_srli_epi16(_mm_mulhi_epu16(x, _mm_set1_epi16((short)0x8081)), 7);
+}
+static inline __m128i _FXDIB_LoadBytes4(FX_LPCBYTE p)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i bytes = _mm_cvtsi32_si128(p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24));
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero);
+}
+// back_alpha and src_alpha hold one value per 32-bit lane. Returns the ratio used to merge the
+// colors and stores the resulting alpha, following the scalar code: a fully transparent backdrop
+// takes the source color as is.
+static inline __m128i _FXDIB_AlphaRatio(__m128i back_alpha, __m128i src_alpha, __m128i& dest_alpha)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i v255 = _mm_set1_epi32(255);
+    dest_alpha = _mm_sub_epi32(_mm_add_epi32(back_alpha, src_alpha), _FXDIB_Div255(_mm_mullo_epi16(back_alpha, src_alpha)));
+    __m128i divisor = _mm_or_si128(dest_alpha, _mm_and_si128(_mm_cmpeq_epi32(dest_alpha, zero), _mm_set1_epi32(1)));
+    __m128i ratio = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(_mm_mullo_epi16(src_alpha, v255)), _mm_cvtepi32_ps(divisor)));
+    __m128i transparent = _mm_cmpeq_epi32(back_alpha, zero);
+    return _mm_or_si128(_mm_and_si128(transparent, v255), _mm_andnot_si128(transparent, ratio));
+}
+// Merges the B, G and R channels of four pixels: (back * (255 - ratio) + src * ratio) / 255.
+// The fourth byte of each result pixel is undefined.
+static inline __m128i _FXDIB_MergeColors(__m128i back, __m128i src, __m128i ratio)
+{
+    __m128i zero = _mm_setzero_si128();
+    ratio = _mm_or_si128(ratio, _mm_slli_epi32(ratio, 8));
+    ratio = _mm_or_si128(ratio, _mm_slli_epi32(ratio, 16));
+    __m128i inverse = _mm_sub_epi8(_mm_set1_epi8((char)0xff), ratio);
+    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(back, zero), _mm_unpacklo_epi8(inverse, zero)),
+                               _mm_mullo_epi16(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(ratio, zero)));
+    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(back, zero), _mm_unpackhi_epi8(inverse, zero)),
+                               _mm_mullo_epi16(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(ratio, zero)));
+    return _mm_packus_epi16(_FXDIB_Div255(lo), _FXDIB_Div255(hi));
+}
+int _CompositeRow_Argb2Argb_SSE2(FX_LPBYTE dest_scan, FX_LPCBYTE src_scan, int pixel_count, FX_LPCBYTE clip_scan)
+{
+    __m128i rgb_mask = _mm_set1_epi32(0x00ffffff);
+    int col = 0;
+    for (; col + 4 <= pixel_count; col += 4) {
+        __m128i back = _mm_loadu_si128((const __m128i*)(dest_scan + col * 4));
+        __m128i src = _mm_loadu_si128((const __m128i*)(src_scan + col * 4));
+        __m128i src_alpha = _mm_srli_epi32(src, 24);
+        if (clip_scan) {
+            src_alpha = _FXDIB_Div255(_mm_mullo_epi16(src_alpha, _FXDIB_LoadBytes4(clip_scan + col)));
+        }
+        __m128i dest_alpha;
+        __m128i ratio = _FXDIB_AlphaRatio(_mm_srli_epi32(back, 24), src_alpha, dest_alpha);
+        __m128i result = _mm_and_si128(_FXDIB_MergeColors(back, src, ratio), rgb_mask);
+        _mm_storeu_si128((__m128i*)(dest_scan + col * 4), _mm_or_si128(result, _mm_slli_epi32(dest_alpha, 24)));
+    }
+    return col;
+}
+int _CompositeRow_ByteMask2Argb_SSE2(FX_LPBYTE dest_scan, FX_LPCBYTE src_scan, int mask_alpha, int src_r, int src_g, int src_b,
+                                     int pixel_count, FX_LPCBYTE clip_scan)
+{
+    __m128i rgb_mask = _mm_set1_epi32(0x00ffffff);
+    __m128i src = _mm_set1_epi32((src_r << 16) | (src_g << 8) | src_b);
+    __m128i mask = _mm_set1_epi32(mask_alpha);
+    int col = 0;
+    for (; col + 4 <= pixel_count; col += 4) {
+        __m128i src_alpha = _mm_mullo_epi16(mask, _FXDIB_LoadBytes4(src_scan + col));
+        if (clip_scan) {
+            __m128 product = _mm_mul_ps(_mm_cvtepi32_ps(src_alpha), _mm_cvtepi32_ps(_FXDIB_LoadBytes4(clip_scan + col)));
+            src_alpha = _mm_cvttps_epi32(_mm_div_ps(product, _mm_set1_ps(255.0f * 255.0f)));
+        } else {
+            src_alpha = _FXDIB_Div255(src_alpha);
+        }
+        __m128i back = _mm_loadu_si128((const __m128i*)(dest_scan + col * 4));
+        __m128i dest_alpha;
+        __m128i ratio = _FXDIB_AlphaRatio(_mm_srli_epi32(back, 24), src_alpha, dest_alpha);
+        __m128i result = _mm_and_si128(_FXDIB_MergeColors(back, src, ratio), rgb_mask);
+        _mm_storeu_si128((__m128i*)(dest_scan + col * 4), _mm_or_si128(result, _mm_slli_epi32(dest_alpha, 24)));
+    }
+    return col;
+}
+int _CompositeRow_Rgb2Rgb_NoBlend_Clip_SSE2(FX_LPBYTE dest_scan, FX_LPCBYTE src_scan, int width, FX_LPCBYTE clip_scan)
+{
+    __m128i rgb_mask = _mm_set1_epi32(0x00ffffff);
+    int col = 0;
+    for (; col + 4 <= width; col += 4) {
+        __m128i back = _mm_loadu_si128((const __m128i*)(dest_scan + col * 4));
+        __m128i src = _mm_loadu_si128((const __m128i*)(src_scan + col * 4));
+        __m128i result = _mm_and_si128(_FXDIB_MergeColors(back, src, _FXDIB_LoadBytes4(clip_scan + col)), rgb_mask);
+        _mm_storeu_si128((__m128i*)(dest_scan + col * 4), _mm_or_si128(result, _mm_andnot_si128(rgb_mask, back)));
+    }
+    return col;
+}
+#endif
@@ -8,6 +8,9 @@
 #include "../../../include/fxge/fx_ge.h"
 #include "dib_int.h"
 #include <limits.h>
+#ifdef _FXDIB_SSE2_
+#include <emmintrin.h>
+#endif
 extern int SDP_Table[513];
 void CWeightTable::Calc(int dest_len, int dest_min, int dest_max, int src_len, int src_min, int src_max, int flags)
 {
@@ -192,6 +195,7 @@ CStretchEngine::CStretchEngine(IFX_ScanlineComposer* pDestBitmap, FXDIB_Format d
     m_pInterBuf = NULL;
     m_pExtraAlphaBuf = NULL;
     m_pDestMaskScanline = NULL;
+    m_nThreads = 1;
     m_DestClip = clip_rect;
     FX_DWORD size = clip_rect.Width();
     if (size && m_DestBpp > (int)(INT_MAX / size)) {
@@ -281,6 +285,14 @@ CStretchEngine::CStretchEngine(IFX_ScanlineComposer* pDestBitmap, FXDIB_Format d
             m_TransMethod = 8;
         }
     }
+    CFX_GEModule* pGEModule = CFX_GEModule::Get();
+    if (pGEModule && pGEModule->GetStretchThreadCount() > 1 &&
+            (FX_INT64)m_SrcClip.Height() * m_DestClip.Width() >= FX_STRETCH_PARALLEL_MIN_PIXELS) {
+        m_nThreads = pGEModule->GetStretchThreadCount();
+        if (m_nThreads > FX_STRETCH_MAX_THREADS) {
+            m_nThreads = FX_STRETCH_MAX_THREADS;
+        }
+    }
 }
 FX_BOOL CStretchEngine::Continue(IFX_Pause* pPause)
 {
@@ -341,6 +353,47 @@ FX_BOOL CStretchEngine::StartStretchHorz()
     return TRUE;
 }
 #define FX_STRECH_PAUSE_ROWS	10
+struct FX_STRETCH_BAND {
+    CStretchEngine*	m_pEngine;
+    CWeightTable*	m_pTable;
+    int				m_FirstRow;
+    int				m_LastRow;
+    FX_LPBYTE		m_pBand;
+    FX_LPBYTE		m_pMaskBand;
+    int*			m_pAccum;
+};
+static void _StretchBandProc(FX_LPVOID pParam, int index)
+{
+    FX_STRETCH_BAND* pBand = (FX_STRETCH_BAND*)pParam + index;
+    CStretchEngine* pEngine = pBand->m_pEngine;
+    for (int row = pBand->m_FirstRow; row < pBand->m_LastRow; row ++) {
+        if (pBand->m_pTable == NULL) {
+            pEngine->StretchHorzRow(row);
+            continue;
+        }
+        int index = row - pBand->m_FirstRow;
+        pEngine->StretchVertRow(*pBand->m_pTable, row, pBand->m_pBand + index * pEngine->m_InterPitch,
+                                pBand->m_pMaskBand ? pBand->m_pMaskBand + index * pEngine->m_ExtraMaskPitch : NULL, pBand->m_pAccum);
+    }
+}
+void CStretchEngine::StretchBands(CWeightTable* pTable, int first_row, int last_row, FX_LPBYTE pBand, FX_LPBYTE pMaskBand, int* pAccum)
+{
+    FX_STRETCH_BAND bands[FX_STRETCH_MAX_THREADS];
+    int rows_per_band = (last_row - first_row + m_nThreads - 1) / m_nThreads;
+    int nBands = 0;
+    for (int row = first_row; row < last_row; row += rows_per_band) {
+        FX_STRETCH_BAND& band = bands[nBands];
+        band.m_pEngine = this;
+        band.m_pTable = pTable;
+        band.m_FirstRow = row;
+        band.m_LastRow = row + rows_per_band < last_row ? row + rows_per_band : last_row;
+        band.m_pBand = pBand ? pBand + (row - first_row) * m_InterPitch : NULL;
+        band.m_pMaskBand = pMaskBand ? pMaskBand + (row - first_row) * m_ExtraMaskPitch : NULL;
+        band.m_pAccum = pAccum ? pAccum + nBands * m_InterPitch : NULL;
+        nBands ++;
+    }
+    FX_Parallel_Run(_StretchBandProc, bands, nBands, m_nThreads);
+}
 FX_BOOL CStretchEngine::ContinueStretchHorz(IFX_Pause* pPause)
 {
     if (!m_DestWidth) {
@@ -349,7 +402,21 @@ FX_BOOL CStretchEngine::ContinueStretchHorz(IFX_Pause* pPause)
     if (m_pSource->SkipToScanline(m_CurRow, pPause)) {
         return TRUE;
     }
-    int Bpp = m_DestBpp / 8;
+    if (m_nThreads > 1 && m_pSource->GetBuffer() && (m_pExtraAlphaBuf == NULL || m_pSource->m_pAlphaMask->GetBuffer())) {
+        int rows_per_block = m_nThreads * FX_STRETCH_BAND_ROWS;
+        while (m_CurRow < m_SrcClip.bottom) {
+            int last_row = m_CurRow + rows_per_block;
+            if (last_row > m_SrcClip.bottom) {
+                last_row = m_SrcClip.bottom;
+            }
+            StretchBands(NULL, m_CurRow, last_row, NULL, NULL, NULL);
+            m_CurRow = last_row;
+            if (m_CurRow < m_SrcClip.bottom && pPause && pPause->NeedToPauseNow()) {
+                return TRUE;
+            }
+        }
+        return FALSE;
+    }
     int rows_to_go = FX_STRECH_PAUSE_ROWS;
     for (; m_CurRow < m_SrcClip.bottom; m_CurRow ++) {
         if (rows_to_go == 0) {
@@ -359,192 +426,225 @@ FX_BOOL CStretchEngine::ContinueStretchHorz(IFX_Pause* pPause)
                 rows_to_go = FX_STRECH_PAUSE_ROWS;
             }
         }
-        FX_LPCBYTE src_scan = m_pSource->GetScanline(m_CurRow);
-        FX_LPBYTE dest_scan = m_pInterBuf + (m_CurRow - m_SrcClip.top) * m_InterPitch;
-        FX_LPCBYTE src_scan_mask = NULL;
-        FX_LPBYTE dest_scan_mask = NULL;
-        if (m_pExtraAlphaBuf) {
-            src_scan_mask = m_pSource->m_pAlphaMask->GetScanline(m_CurRow);
-            dest_scan_mask = m_pExtraAlphaBuf + (m_CurRow - m_SrcClip.top) * m_ExtraMaskPitch;
-        }
-        switch (m_TransMethod) {
-            case 1:
-            case 2: {
-                    for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
-                        PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
-                        int dest_a = 0;
-                        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
-                            int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
-                            if (src_scan[j / 8] & (1 << (7 - j % 8))) {
-                                dest_a += pixel_weight * 255;
-                            }
-                        }
-                        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-                            dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
+        StretchHorzRow(m_CurRow);
+        rows_to_go --;
+    }
+    return FALSE;
+}
+void CStretchEngine::StretchHorzRow(int src_row)
+{
+    int Bpp = m_DestBpp / 8;
+    FX_LPCBYTE src_scan = m_pSource->GetScanline(src_row);
+    FX_LPBYTE dest_scan = m_pInterBuf + (src_row - m_SrcClip.top) * m_InterPitch;
+    FX_LPCBYTE src_scan_mask = NULL;
+    FX_LPBYTE dest_scan_mask = NULL;
+    if (m_pExtraAlphaBuf) {
+        src_scan_mask = m_pSource->m_pAlphaMask->GetScanline(src_row);
+        dest_scan_mask = m_pExtraAlphaBuf + (src_row - m_SrcClip.top) * m_ExtraMaskPitch;
+    }
+    switch (m_TransMethod) {
+        case 1:
+        case 2: {
+                for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
+                    PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+                    int dest_a = 0;
+                    for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
+                        int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
+                        if (src_scan[j / 8] & (1 << (7 - j % 8))) {
+                            dest_a += pixel_weight * 255;
                         }
-                        *dest_scan++ = (FX_BYTE)(dest_a >> 16);
                     }
-                    break;
+                    if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+                        dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
+                    }
+                    *dest_scan++ = (FX_BYTE)(dest_a >> 16);
                 }
-            case 3: {
-                    for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
-                        PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
-                        int dest_a = 0;
-                        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
-                            int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
-                            dest_a += pixel_weight * src_scan[j];
-                        }
-                        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-                            dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
-                        }
-                        *dest_scan++ = (FX_BYTE)(dest_a >> 16);
+                break;
+            }
+        case 3: {
+                for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
+                    PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+                    int dest_a = 0;
+                    for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
+                        int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
+                        dest_a += pixel_weight * src_scan[j];
                     }
-                    break;
+                    if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+                        dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
+                    }
+                    *dest_scan++ = (FX_BYTE)(dest_a >> 16);
                 }
-            case 4: {
-                    for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
-                        PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
-                        int dest_a = 0, dest_r = 0;
-                        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
-                            int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
-                            pixel_weight = pixel_weight * src_scan_mask[j] / 255;
-                            dest_r += pixel_weight * src_scan[j];
-                            dest_a += pixel_weight;
-                        }
-                        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-                            dest_r = dest_r < 0 ? 0 : dest_r > 16711680 ? 16711680 : dest_r;
-                            dest_a = dest_a < 0 ? 0 : dest_a > 65536 ? 65536 : dest_a;
-                        }
-                        *dest_scan++ = (FX_BYTE)(dest_r >> 16);
-                        *dest_scan_mask++ = (FX_BYTE)((dest_a * 255) >> 16);
+                break;
+            }
+        case 4: {
+                for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
+                    PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+                    int dest_a = 0, dest_r = 0;
+                    for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
+                        int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
+                        pixel_weight = pixel_weight * src_scan_mask[j] / 255;
+                        dest_r += pixel_weight * src_scan[j];
+                        dest_a += pixel_weight;
+                    }
+                    if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+                        dest_r = dest_r < 0 ? 0 : dest_r > 16711680 ? 16711680 : dest_r;
+                        dest_a = dest_a < 0 ? 0 : dest_a > 65536 ? 65536 : dest_a;
                     }
-                    break;
+                    *dest_scan++ = (FX_BYTE)(dest_r >> 16);
+                    *dest_scan_mask++ = (FX_BYTE)((dest_a * 255) >> 16);
                 }
-            case 5: {
-                    for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
-                        PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
-                        int dest_r_y = 0, dest_g_m = 0, dest_b_c = 0, dest_k = 0;
-                        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
-                            int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
-                            unsigned long argb_cmyk = m_pSrcPalette[src_scan[j]];
-                            if (m_DestFormat == FXDIB_Rgb) {
-                                dest_r_y += pixel_weight * (FX_BYTE)(argb_cmyk >> 16);
-                                dest_g_m += pixel_weight * (FX_BYTE)(argb_cmyk >> 8);
-                                dest_b_c += pixel_weight * (FX_BYTE)argb_cmyk;
-                            } else {
-                                dest_b_c += pixel_weight * (FX_BYTE)(argb_cmyk >> 24);
-                                dest_g_m += pixel_weight * (FX_BYTE)(argb_cmyk >> 16);
-                                dest_r_y += pixel_weight * (FX_BYTE)(argb_cmyk >> 8);
-                            }
-                        }
-                        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-                            dest_r_y = dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
-                            dest_g_m = dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
-                            dest_b_c = dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
+                break;
+            }
+        case 5: {
+                for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
+                    PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+                    int dest_r_y = 0, dest_g_m = 0, dest_b_c = 0, dest_k = 0;
+                    for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
+                        int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
+                        unsigned long argb_cmyk = m_pSrcPalette[src_scan[j]];
+                        if (m_DestFormat == FXDIB_Rgb) {
+                            dest_r_y += pixel_weight * (FX_BYTE)(argb_cmyk >> 16);
+                            dest_g_m += pixel_weight * (FX_BYTE)(argb_cmyk >> 8);
+                            dest_b_c += pixel_weight * (FX_BYTE)argb_cmyk;
+                        } else {
+                            dest_b_c += pixel_weight * (FX_BYTE)(argb_cmyk >> 24);
+                            dest_g_m += pixel_weight * (FX_BYTE)(argb_cmyk >> 16);
+                            dest_r_y += pixel_weight * (FX_BYTE)(argb_cmyk >> 8);
                         }
-                        *dest_scan++ = (FX_BYTE)(dest_b_c >> 16);
-                        *dest_scan++ = (FX_BYTE)(dest_g_m >> 16);
-                        *dest_scan++ = (FX_BYTE)(dest_r_y >> 16);
                     }
-                    break;
+                    if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+                        dest_r_y = dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
+                        dest_g_m = dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
+                        dest_b_c = dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
+                    }
+                    *dest_scan++ = (FX_BYTE)(dest_b_c >> 16);
+                    *dest_scan++ = (FX_BYTE)(dest_g_m >> 16);
+                    *dest_scan++ = (FX_BYTE)(dest_r_y >> 16);
                 }
-            case 6: {
-                    for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
-                        PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
-                        int dest_a = 0, dest_r_y = 0, dest_g_m = 0, dest_b_c = 0, dest_k = 0;
-                        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
-                            int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
-                            pixel_weight = pixel_weight * src_scan_mask[j] / 255;
-                            unsigned long argb_cmyk = m_pSrcPalette[src_scan[j]];
-                            if (m_DestFormat == FXDIB_Rgba) {
-                                dest_r_y += pixel_weight * (FX_BYTE)(argb_cmyk >> 16);
-                                dest_g_m += pixel_weight * (FX_BYTE)(argb_cmyk >> 8);
-                                dest_b_c += pixel_weight * (FX_BYTE)argb_cmyk;
-                            } else {
-                                dest_b_c += pixel_weight * (FX_BYTE)(argb_cmyk >> 24);
-                                dest_g_m += pixel_weight * (FX_BYTE)(argb_cmyk >> 16);
-                                dest_r_y += pixel_weight * (FX_BYTE)(argb_cmyk >> 8);
-                            }
-                            dest_a += pixel_weight;
-                        }
-                        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-                            dest_k = dest_k < 0 ? 0 : dest_k > 16711680 ? 16711680 : dest_k;
-                            dest_b_c = dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
-                            dest_g_m = dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
-                            dest_r_y = dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
-                            dest_a = dest_a < 0 ? 0 : dest_a > 65536 ? 65536 : dest_a;
+                break;
+            }
+        case 6: {
+                for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
+                    PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+                    int dest_a = 0, dest_r_y = 0, dest_g_m = 0, dest_b_c = 0, dest_k = 0;
+                    for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
+                        int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
+                        pixel_weight = pixel_weight * src_scan_mask[j] / 255;
+                        unsigned long argb_cmyk = m_pSrcPalette[src_scan[j]];
+                        if (m_DestFormat == FXDIB_Rgba) {
+                            dest_r_y += pixel_weight * (FX_BYTE)(argb_cmyk >> 16);
+                            dest_g_m += pixel_weight * (FX_BYTE)(argb_cmyk >> 8);
+                            dest_b_c += pixel_weight * (FX_BYTE)argb_cmyk;
+                        } else {
+                            dest_b_c += pixel_weight * (FX_BYTE)(argb_cmyk >> 24);
+                            dest_g_m += pixel_weight * (FX_BYTE)(argb_cmyk >> 16);
+                            dest_r_y += pixel_weight * (FX_BYTE)(argb_cmyk >> 8);
                         }
-                        *dest_scan++ = (FX_BYTE)(dest_b_c >> 16);
-                        *dest_scan++ = (FX_BYTE)(dest_g_m >> 16);
-                        *dest_scan++ = (FX_BYTE)(dest_r_y >> 16);
-                        *dest_scan_mask++ = (FX_BYTE)((dest_a * 255) >> 16);
+                        dest_a += pixel_weight;
+                    }
+                    if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+                        dest_k = dest_k < 0 ? 0 : dest_k > 16711680 ? 16711680 : dest_k;
+                        dest_b_c = dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
+                        dest_g_m = dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
+                        dest_r_y = dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
+                        dest_a = dest_a < 0 ? 0 : dest_a > 65536 ? 65536 : dest_a;
                     }
-                    break;
+                    *dest_scan++ = (FX_BYTE)(dest_b_c >> 16);
+                    *dest_scan++ = (FX_BYTE)(dest_g_m >> 16);
+                    *dest_scan++ = (FX_BYTE)(dest_r_y >> 16);
+                    *dest_scan_mask++ = (FX_BYTE)((dest_a * 255) >> 16);
                 }
-            case 7: {
-                    for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
-                        PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
-                        int dest_r_y = 0, dest_g_m = 0, dest_b_c = 0, dest_k = 0;
-                        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
-                            int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
-                            FX_LPCBYTE src_pixel = src_scan + j * Bpp;
-                            dest_b_c += pixel_weight * (*src_pixel++);
-                            dest_g_m += pixel_weight * (*src_pixel++);
-                            dest_r_y += pixel_weight * (*src_pixel);
-                        }
-                        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-                            dest_b_c = dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
-                            dest_g_m = dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
-                            dest_r_y = dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
-                        }
-                        *dest_scan++ = (FX_BYTE)((dest_b_c) >> 16);
-                        *dest_scan++ = (FX_BYTE)((dest_g_m) >> 16);
-                        *dest_scan++ = (FX_BYTE)((dest_r_y) >> 16);
-                        dest_scan += Bpp - 3;
+                break;
+            }
+        case 7: {
+                for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
+                    PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+                    int dest_r_y = 0, dest_g_m = 0, dest_b_c = 0, dest_k = 0;
+                    for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
+                        int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
+                        FX_LPCBYTE src_pixel = src_scan + j * Bpp;
+                        dest_b_c += pixel_weight * (*src_pixel++);
+                        dest_g_m += pixel_weight * (*src_pixel++);
+                        dest_r_y += pixel_weight * (*src_pixel);
                     }
-                    break;
+                    if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+                        dest_b_c = dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
+                        dest_g_m = dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
+                        dest_r_y = dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
+                    }
+                    *dest_scan++ = (FX_BYTE)((dest_b_c) >> 16);
+                    *dest_scan++ = (FX_BYTE)((dest_g_m) >> 16);
+                    *dest_scan++ = (FX_BYTE)((dest_r_y) >> 16);
+                    dest_scan += Bpp - 3;
                 }
-            case 8: {
-                    for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
-                        PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
-                        int dest_a = 0, dest_r_y = 0, dest_g_m = 0, dest_b_c = 0, dest_k = 0;
-                        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
-                            int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
-                            FX_LPCBYTE src_pixel = src_scan + j * Bpp;
-                            if (m_DestFormat == FXDIB_Argb) {
-                                pixel_weight = pixel_weight * src_pixel[3] / 255;
-                            } else {
-                                pixel_weight = pixel_weight * src_scan_mask[j] / 255;
-                            }
-                            dest_b_c += pixel_weight * (*src_pixel++);
-                            dest_g_m += pixel_weight * (*src_pixel++);
-                            dest_r_y += pixel_weight * (*src_pixel);
-                            dest_a += pixel_weight;
-                        }
-                        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-                            dest_r_y = dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
-                            dest_g_m = dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
-                            dest_b_c = dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
-                            dest_a = dest_a < 0 ? 0 : dest_a > 65536 ? 65536 : dest_a;
-                        }
-                        *dest_scan++ = (FX_BYTE)((dest_b_c) >> 16);
-                        *dest_scan++ = (FX_BYTE)((dest_g_m) >> 16);
-                        *dest_scan++ = (FX_BYTE)((dest_r_y) >> 16);
+                break;
+            }
+        case 8: {
+                for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
+                    PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+                    int dest_a = 0, dest_r_y = 0, dest_g_m = 0, dest_b_c = 0, dest_k = 0;
+                    for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
+                        int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
+                        FX_LPCBYTE src_pixel = src_scan + j * Bpp;
                         if (m_DestFormat == FXDIB_Argb) {
-                            *dest_scan = (FX_BYTE)((dest_a * 255) >> 16);
-                        }
-                        if (dest_scan_mask) {
-                            *dest_scan_mask++ = (FX_BYTE)((dest_a * 255) >> 16);
+                            pixel_weight = pixel_weight * src_pixel[3] / 255;
+                        } else {
+                            pixel_weight = pixel_weight * src_scan_mask[j] / 255;
                         }
-                        dest_scan += Bpp - 3;
+                        dest_b_c += pixel_weight * (*src_pixel++);
+                        dest_g_m += pixel_weight * (*src_pixel++);
+                        dest_r_y += pixel_weight * (*src_pixel);
+                        dest_a += pixel_weight;
                     }
-                    break;
+                    if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+                        dest_r_y = dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
+                        dest_g_m = dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
+                        dest_b_c = dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
+                        dest_a = dest_a < 0 ? 0 : dest_a > 65536 ? 65536 : dest_a;
+                    }
+                    *dest_scan++ = (FX_BYTE)((dest_b_c) >> 16);
+                    *dest_scan++ = (FX_BYTE)((dest_g_m) >> 16);
+                    *dest_scan++ = (FX_BYTE)((dest_r_y) >> 16);
+                    if (m_DestFormat == FXDIB_Argb) {
+                        *dest_scan = (FX_BYTE)((dest_a * 255) >> 16);
+                    }
+                    if (dest_scan_mask) {
+                        *dest_scan_mask++ = (FX_BYTE)((dest_a * 255) >> 16);
+                    }
+                    dest_scan += Bpp - 3;
                 }
+                break;
+            }
+    }
+}
+#ifdef _FXDIB_SSE2_
+static void _StretchVertAccumulate(int* pAccum, int count, FX_LPCBYTE pInterBuf, int pitch, int top, PixelWeight* pPixelWeights)
+{
+    FXSYS_memset32(pAccum, 0, count * sizeof(int));
+    __m128i zero = _mm_setzero_si128();
+    for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
+        int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
+        FX_LPCBYTE src_scan = pInterBuf + (j - top) * pitch;
+        // weight * v == (weight & 127) * v + (weight >> 7) * (v << 7), where every factor fits in
+        // 16 bits, so _mm_madd_epi16 gives the exact 32-bit products of the scalar code.
+        __m128i factors = _mm_set1_epi32((int)(((FX_DWORD)(pixel_weight >> 7) << 16) | (pixel_weight & 127)));
+        int i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i bytes = _mm_loadu_si128((const __m128i*)(src_scan + i));
+            __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+            __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+            __m128i* dest = (__m128i*)(pAccum + i);
+            _mm_storeu_si128(dest, _mm_add_epi32(_mm_loadu_si128(dest), _mm_madd_epi16(_mm_unpacklo_epi16(lo, _mm_slli_epi16(lo, 7)), factors)));
+            _mm_storeu_si128(dest + 1, _mm_add_epi32(_mm_loadu_si128(dest + 1), _mm_madd_epi16(_mm_unpackhi_epi16(lo, _mm_slli_epi16(lo, 7)), factors)));
+            _mm_storeu_si128(dest + 2, _mm_add_epi32(_mm_loadu_si128(dest + 2), _mm_madd_epi16(_mm_unpacklo_epi16(hi, _mm_slli_epi16(hi, 7)), factors)));
+            _mm_storeu_si128(dest + 3, _mm_add_epi32(_mm_loadu_si128(dest + 3), _mm_madd_epi16(_mm_unpackhi_epi16(hi, _mm_slli_epi16(hi, 7)), factors)));
+        }
+        for (; i < count; i ++) {
+            pAccum[i] += pixel_weight * src_scan[i];
         }
-        rows_to_go --;
     }
-    return FALSE;
 }
+#endif
 void CStretchEngine::StretchVert()
 {
     if (m_DestHeight == 0) {
@@ -555,127 +655,195 @@ void CStretchEngine::StretchVert()
     if (table.m_pWeightTables == NULL) {
         return;
     }
+    int nThreads = m_nThreads;
+    if (m_TransMethod == 6 || m_TransMethod == 8 || (m_pDestMaskScanline && m_TransMethod != 4)) {
+        nThreads = 1;
+    }
+    int* pAccum = NULL;
+#ifdef _FXDIB_SSE2_
+    if (m_TransMethod != 4 && m_TransMethod != 6 && m_TransMethod != 8 && _FXDIB_HasSSE2()) {
+        pAccum = FX_AllocNL(int, m_InterPitch * nThreads);
+    }
+#endif
+    FX_LPBYTE pBand = NULL;
+    FX_LPBYTE pMaskBand = NULL;
+    int rows_per_block = nThreads * FX_STRETCH_BAND_ROWS;
+    if (nThreads > 1) {
+        pBand = FX_AllocNL(FX_BYTE, rows_per_block * m_InterPitch);
+        if (pBand && m_pDestMaskScanline) {
+            pMaskBand = FX_AllocNL(FX_BYTE, rows_per_block * m_ExtraMaskPitch);
+            if (pMaskBand == NULL) {
+                FX_Free(pBand);
+                pBand = NULL;
+            }
+        }
+    }
+    if (pBand) {
+        for (int i = 0; i < rows_per_block; i ++) {
+            FXSYS_memcpy32(pBand + i * m_InterPitch, m_pDestScanline, m_InterPitch);
+        }
+        for (int row = m_DestClip.top; row < m_DestClip.bottom; row += rows_per_block) {
+            int last_row = row + rows_per_block;
+            if (last_row > m_DestClip.bottom) {
+                last_row = m_DestClip.bottom;
+            }
+            StretchBands(&table, row, last_row, pBand, pMaskBand, pAccum);
+            for (int i = row; i < last_row; i ++) {
+                m_pDestBitmap->ComposeScanline(i - m_DestClip.top, pBand + (i - row) * m_InterPitch,
+                                               pMaskBand ? pMaskBand + (i - row) * m_ExtraMaskPitch : NULL);
+            }
+        }
+        FX_Free(pBand);
+        if (pMaskBand) {
+            FX_Free(pMaskBand);
+        }
+    } else {
+        for (int row = m_DestClip.top; row < m_DestClip.bottom; row ++) {
+            StretchVertRow(table, row, m_pDestScanline, m_pDestMaskScanline, pAccum);
+            m_pDestBitmap->ComposeScanline(row - m_DestClip.top, m_pDestScanline, m_pDestMaskScanline);
+        }
+    }
+    if (pAccum) {
+        FX_Free(pAccum);
+    }
+}
+void CStretchEngine::StretchVertRow(CWeightTable& table, int row, FX_LPBYTE dest_scan, FX_LPBYTE dest_sacn_mask, int* pAccum)
+{
     int DestBpp = m_DestBpp / 8;
-    for (int row = m_DestClip.top; row < m_DestClip.bottom; row ++) {
-        unsigned char* dest_scan = m_pDestScanline;
-        unsigned char* dest_sacn_mask = m_pDestMaskScanline;
-        PixelWeight* pPixelWeights = table.GetPixelWeight(row);
-        switch(m_TransMethod) {
-            case 1:
-            case 2:
-            case 3: {
-                    for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
-                        unsigned char* src_scan = m_pInterBuf + (col - m_DestClip.left) * DestBpp;
-                        int dest_a = 0;
-                        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
-                            int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
-                            dest_a += pixel_weight * src_scan[(j - m_SrcClip.top) * m_InterPitch];
-                        }
-                        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-                            dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
-                        }
-                        *dest_scan = (FX_BYTE)(dest_a >> 16);
-                        dest_scan += DestBpp;
+    PixelWeight* pPixelWeights = table.GetPixelWeight(row);
+#ifdef _FXDIB_SSE2_
+    if (pAccum) {
+        _StretchVertAccumulate(pAccum, m_DestClip.Width() * DestBpp, m_pInterBuf, m_InterPitch, m_SrcClip.top, pPixelWeights);
+        int nChannels = (m_TransMethod == 5 || m_TransMethod == 7) ? 3 : 1;
+        FX_BOOL bClamp = m_Flags & FXDIB_BICUBIC_INTERPOL;
+        for (int col = 0; col < m_DestClip.Width(); col ++) {
+            int* pPixel = pAccum + col * DestBpp;
+            for (int i = 0; i < nChannels; i ++) {
+                int value = pPixel[i];
+                if (bClamp) {
+                    value = value < 0 ? 0 : value > 16711680 ? 16711680 : value;
+                }
+                dest_scan[i] = (FX_BYTE)(value >> 16);
+            }
+            dest_scan += DestBpp;
+        }
+        return;
+    }
+#endif
+    switch(m_TransMethod) {
+        case 1:
+        case 2:
+        case 3: {
+                for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
+                    unsigned char* src_scan = m_pInterBuf + (col - m_DestClip.left) * DestBpp;
+                    int dest_a = 0;
+                    for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
+                        int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
+                        dest_a += pixel_weight * src_scan[(j - m_SrcClip.top) * m_InterPitch];
                     }
-                    break;
+                    if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+                        dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
+                    }
+                    *dest_scan = (FX_BYTE)(dest_a >> 16);
+                    dest_scan += DestBpp;
                 }
-            case 4: {
-                    for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
-                        unsigned char* src_scan = m_pInterBuf + (col - m_DestClip.left) * DestBpp;
-                        unsigned char* src_scan_mask = m_pExtraAlphaBuf + (col - m_DestClip.left);
-                        int dest_a = 0, dest_k = 0;
-                        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
-                            int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
-                            dest_k += pixel_weight * src_scan[(j - m_SrcClip.top) * m_InterPitch];
-                            dest_a += pixel_weight * src_scan_mask[(j - m_SrcClip.top) * m_ExtraMaskPitch];
-                        }
-                        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-                            dest_k = dest_k < 0 ? 0 : dest_k > 16711680 ? 16711680 : dest_k;
-                            dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
-                        }
-                        *dest_scan = (FX_BYTE)(dest_k >> 16);
-                        dest_scan += DestBpp;
-                        *dest_sacn_mask++ = (FX_BYTE)(dest_a >> 16);
+                break;
+            }
+        case 4: {
+                for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
+                    unsigned char* src_scan = m_pInterBuf + (col - m_DestClip.left) * DestBpp;
+                    unsigned char* src_scan_mask = m_pExtraAlphaBuf + (col - m_DestClip.left);
+                    int dest_a = 0, dest_k = 0;
+                    for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
+                        int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
+                        dest_k += pixel_weight * src_scan[(j - m_SrcClip.top) * m_InterPitch];
+                        dest_a += pixel_weight * src_scan_mask[(j - m_SrcClip.top) * m_ExtraMaskPitch];
+                    }
+                    if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+                        dest_k = dest_k < 0 ? 0 : dest_k > 16711680 ? 16711680 : dest_k;
+                        dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
                     }
-                    break;
+                    *dest_scan = (FX_BYTE)(dest_k >> 16);
+                    dest_scan += DestBpp;
+                    *dest_sacn_mask++ = (FX_BYTE)(dest_a >> 16);
                 }
-            case 5:
-            case 7: {
-                    for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
-                        unsigned char* src_scan = m_pInterBuf + (col - m_DestClip.left) * DestBpp;
-                        int dest_r_y = 0, dest_g_m = 0, dest_b_c = 0, dest_k = 0;
-                        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
-                            int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
-                            FX_LPCBYTE src_pixel = src_scan + (j - m_SrcClip.top) * m_InterPitch;
-                            dest_b_c += pixel_weight * (*src_pixel++);
-                            dest_g_m += pixel_weight * (*src_pixel++);
-                            dest_r_y += pixel_weight * (*src_pixel);
-                        }
-                        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-                            dest_r_y = dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
-                            dest_g_m = dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
-                            dest_b_c = dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
-                        }
-                        dest_scan[0] = (FX_BYTE)((dest_b_c) >> 16);
-                        dest_scan[1] = (FX_BYTE)((dest_g_m) >> 16);
-                        dest_scan[2] = (FX_BYTE)((dest_r_y) >> 16);
-                        dest_scan += DestBpp;
+                break;
+            }
+        case 5:
+        case 7: {
+                for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
+                    unsigned char* src_scan = m_pInterBuf + (col - m_DestClip.left) * DestBpp;
+                    int dest_r_y = 0, dest_g_m = 0, dest_b_c = 0, dest_k = 0;
+                    for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
+                        int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
+                        FX_LPCBYTE src_pixel = src_scan + (j - m_SrcClip.top) * m_InterPitch;
+                        dest_b_c += pixel_weight * (*src_pixel++);
+                        dest_g_m += pixel_weight * (*src_pixel++);
+                        dest_r_y += pixel_weight * (*src_pixel);
                     }
-                    break;
+                    if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+                        dest_r_y = dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
+                        dest_g_m = dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
+                        dest_b_c = dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
+                    }
+                    dest_scan[0] = (FX_BYTE)((dest_b_c) >> 16);
+                    dest_scan[1] = (FX_BYTE)((dest_g_m) >> 16);
+                    dest_scan[2] = (FX_BYTE)((dest_r_y) >> 16);
+                    dest_scan += DestBpp;
                 }
-            case 6:
-            case 8: {
-                    for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
-                        unsigned char* src_scan = m_pInterBuf + (col - m_DestClip.left) * DestBpp;
-                        unsigned char* src_scan_mask = NULL;
-                        if (m_DestFormat != FXDIB_Argb) {
-                            src_scan_mask = m_pExtraAlphaBuf + (col - m_DestClip.left);
-                        }
-                        int dest_a = 0, dest_k = 0, dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
-                        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
-                            int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
-                            FX_LPCBYTE src_pixel = src_scan + (j - m_SrcClip.top) * m_InterPitch;
-                            int mask_v = 255;
-                            if (src_scan_mask) {
-                                mask_v = src_scan_mask[(j - m_SrcClip.top) * m_ExtraMaskPitch];
-                            }
-                            dest_b_c += pixel_weight * (*src_pixel++);
-                            dest_g_m += pixel_weight * (*src_pixel++);
-                            dest_r_y += pixel_weight * (*src_pixel);
-                            if (m_DestFormat == FXDIB_Argb) {
-                                dest_a += pixel_weight * (*(src_pixel + 1));
-                            } else {
-                                dest_a += pixel_weight * mask_v;
-                            }
-                        }
-                        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-                            dest_r_y = dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
-                            dest_g_m = dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
-                            dest_b_c = dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
-                            dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
-                        }
-                        if (dest_a) {
-                            int r = ((FX_DWORD)dest_r_y) * 255 / dest_a;
-                            int g = ((FX_DWORD)dest_g_m) * 255 / dest_a;
-                            int b = ((FX_DWORD)dest_b_c) * 255 / dest_a;
-                            dest_scan[0] = b > 255 ? 255 : b < 0 ? 0 : b;
-                            dest_scan[1] = g > 255 ? 255 : g < 0 ? 0 : g;
-                            dest_scan[2] = r > 255 ? 255 : r < 0 ? 0 : r;
+                break;
+            }
+        case 6:
+        case 8: {
+                for (int col = m_DestClip.left; col < m_DestClip.right; col ++) {
+                    unsigned char* src_scan = m_pInterBuf + (col - m_DestClip.left) * DestBpp;
+                    unsigned char* src_scan_mask = NULL;
+                    if (m_DestFormat != FXDIB_Argb) {
+                        src_scan_mask = m_pExtraAlphaBuf + (col - m_DestClip.left);
+                    }
+                    int dest_a = 0, dest_k = 0, dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
+                    for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd; j ++) {
+                        int pixel_weight = pPixelWeights->m_Weights[j - pPixelWeights->m_SrcStart];
+                        FX_LPCBYTE src_pixel = src_scan + (j - m_SrcClip.top) * m_InterPitch;
+                        int mask_v = 255;
+                        if (src_scan_mask) {
+                            mask_v = src_scan_mask[(j - m_SrcClip.top) * m_ExtraMaskPitch];
                         }
+                        dest_b_c += pixel_weight * (*src_pixel++);
+                        dest_g_m += pixel_weight * (*src_pixel++);
+                        dest_r_y += pixel_weight * (*src_pixel);
                         if (m_DestFormat == FXDIB_Argb) {
-                            dest_scan[3] = (FX_BYTE)((dest_a) >> 16);
+                            dest_a += pixel_weight * (*(src_pixel + 1));
                         } else {
-                            *dest_sacn_mask = (FX_BYTE)((dest_a) >> 16);
-                        }
-                        dest_scan += DestBpp;
-                        if (dest_sacn_mask) {
-                            dest_sacn_mask++;
+                            dest_a += pixel_weight * mask_v;
                         }
                     }
-                    break;
+                    if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+                        dest_r_y = dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
+                        dest_g_m = dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
+                        dest_b_c = dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
+                        dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
+                    }
+                    if (dest_a) {
+                        int r = ((FX_DWORD)dest_r_y) * 255 / dest_a;
+                        int g = ((FX_DWORD)dest_g_m) * 255 / dest_a;
+                        int b = ((FX_DWORD)dest_b_c) * 255 / dest_a;
+                        dest_scan[0] = b > 255 ? 255 : b < 0 ? 0 : b;
+                        dest_scan[1] = g > 255 ? 255 : g < 0 ? 0 : g;
+                        dest_scan[2] = r > 255 ? 255 : r < 0 ? 0 : r;
+                    }
+                    if (m_DestFormat == FXDIB_Argb) {
+                        dest_scan[3] = (FX_BYTE)((dest_a) >> 16);
+                    } else {
+                        *dest_sacn_mask = (FX_BYTE)((dest_a) >> 16);
+                    }
+                    dest_scan += DestBpp;
+                    if (dest_sacn_mask) {
+                        dest_sacn_mask++;
+                    }
                 }
-        }
-        m_pDestBitmap->ComposeScanline(row - m_DestClip.top, m_pDestScanline, m_pDestMaskScanline);
+                break;
+            }
     }
 }
 CFX_ImageStretcher::CFX_ImageStretcher()
@@ -14,6 +14,8 @@ CFX_GEModule::CFX_GEModule()
     m_FTLibrary = NULL;
     m_pCodecModule = NULL;
     m_pPlatformData = NULL;
+    m_pGlyphLRUList = NULL;
+    m_nStretchThreads = 1;
 }
 CFX_GEModule::~CFX_GEModule()
 {
@@ -25,6 +27,10 @@ CFX_GEModule::~CFX_GEModule()
         delete m_pFontMgr;
     }
     m_pFontMgr = NULL;
+    if (m_pGlyphLRUList) {
+        delete m_pGlyphLRUList;
+    }
+    m_pGlyphLRUList = NULL;
     DestroyPlatform();
 }
 CFX_GEModule* CFX_GEModule::Get()
@@ -38,6 +44,7 @@ void CFX_GEModule::Create()
         return;
     }
     g_pGEModule->m_pFontMgr = FX_NEW CFX_FontMgr;
+    g_pGEModule->m_pGlyphLRUList = FX_NEW CFX_GlyphLRUList;
     g_pGEModule->InitPlatform();
     g_pGEModule->SetTextGamma(2.2f);
 }
@@ -54,11 +61,37 @@ void CFX_GEModule::Destroy()
 }
 CFX_FontCache* CFX_GEModule::GetFontCache()
 {
+    CFX_CSLock lock(&m_FontLock);
     if (m_pFontCache == NULL) {
         m_pFontCache = FX_NEW CFX_FontCache();
     }
     return m_pFontCache;
 }
+void CFX_GEModule::SetGlyphCacheLimit(size_t nBytes)
+{
+    CFX_CSLock lock(&m_FontLock);
+    m_pGlyphLRUList->m_nLimit = nBytes;
+    if (nBytes && m_pGlyphLRUList->m_nBytes > nBytes) {
+        m_pGlyphLRUList->Shrink();
+    }
+}
+void CFX_GEModule::GetGlyphCacheStats(FX_GLYPHCACHE_STATS& stats)
+{
+    CFX_CSLock lock(&m_FontLock);
+    stats.m_nHits = m_pGlyphLRUList->m_nHits;
+    stats.m_nMisses = m_pGlyphLRUList->m_nMisses;
+    stats.m_nEvictions = m_pGlyphLRUList->m_nEvictions;
+    stats.m_nGlyphs = m_pGlyphLRUList->m_nGlyphs;
+    stats.m_nBytes = m_pGlyphLRUList->m_nBytes;
+    stats.m_nLimit = m_pGlyphLRUList->m_nLimit;
+}
+void CFX_GEModule::ResetGlyphCacheStats()
+{
+    CFX_CSLock lock(&m_FontLock);
+    m_pGlyphLRUList->m_nHits = 0;
+    m_pGlyphLRUList->m_nMisses = 0;
+    m_pGlyphLRUList->m_nEvictions = 0;
+}
 void CFX_GEModule::SetTextGamma(FX_FLOAT gammaValue)
 {
     gammaValue /= 2.2f;
@@ -65,12 +65,14 @@ CFX_Font::~CFX_Font()
 }
 void CFX_Font::DeleteFace()
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     FXFT_Done_Face(m_Face);
     m_Face = NULL;
 }
 FX_BOOL CFX_Font::LoadSubst(const CFX_ByteString& face_name, FX_BOOL bTrueType, FX_DWORD flags,
                             int weight, int italic_angle, int CharsetCP, FX_BOOL bVertical)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     m_bEmbedded = FALSE;
     m_bVertical = bVertical;
     m_pSubstFont = FX_NEW CFX_SubstFont;
@@ -135,6 +137,7 @@ FX_BOOL _LoadFile(FXFT_Library library, FXFT_Face* Face, IFX_FileRead* pFile, FX
 }
 FX_BOOL CFX_Font::LoadFile(IFX_FileRead* pFile)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     m_bEmbedded = FALSE;
     FXFT_Library library;
     if (CFX_GEModule::Get()->GetFontMgr()->m_FTLibrary == NULL) {
@@ -151,6 +154,7 @@ FX_BOOL CFX_Font::LoadFile(IFX_FileRead* pFile)
 }
 int CFX_Font::GetGlyphWidth(FX_DWORD glyph_index)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     if (!m_Face) {
         return 0;
     }
@@ -184,6 +188,7 @@ static FXFT_Face FT_LoadFont(FX_LPBYTE pData, int size)
 }
 FX_BOOL CFX_Font::LoadEmbedded(FX_LPCBYTE data, FX_DWORD size)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
 #ifdef FOXIT_CHROME_BUILD
     m_pFontDataAllocation = FX_Alloc(FX_BYTE, size);
     if (!m_pFontDataAllocation) {
@@ -225,6 +230,7 @@ int CFX_Font::GetDescent() const
 }
 FX_BOOL CFX_Font::GetGlyphBBox(FX_DWORD glyph_index, FX_RECT &bbox)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     if (m_Face == NULL) {
         return FALSE;
     }
@@ -6,6 +6,7 @@
 
 #include "../../../include/fxge/fx_ge.h"
 #include "../../../include/fxge/fx_freetype.h"
+#include "../../../include/fxcrt/fx_ext.h"
 #include "text_int.h"
 #define GET_TT_SHORT(w)  (FX_WORD)(((w)[0] << 8) | (w)[1])
 #define GET_TT_LONG(w) (FX_DWORD)(((w)[0] << 24) | ((w)[1] << 16) | ((w)[2] << 8) | (w)[3])
@@ -88,6 +89,7 @@ void CFX_FontMgr::InitFTLibrary()
 }
 void CFX_FontMgr::FreeCache()
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     FX_POSITION pos = m_FaceMap.GetStartPosition();
     while(pos) {
         CFX_ByteString Key;
@@ -104,6 +106,7 @@ void CFX_FontMgr::SetSystemFontInfo(IFX_SystemFontInfo* pFontInfo)
 FXFT_Face CFX_FontMgr::FindSubstFont(const CFX_ByteString& face_name, FX_BOOL bTrueType,
                                      FX_DWORD flags, int weight, int italic_angle, int CharsetCP, CFX_SubstFont* pSubstFont)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     if (m_FTLibrary == NULL) {
         FXFT_Init_FreeType(&m_FTLibrary);
     }
@@ -120,6 +123,7 @@ FXFT_Face CFX_FontMgr::FindSubstFont(const CFX_ByteString& face_name, FX_BOOL bT
 FXFT_Face CFX_FontMgr::GetCachedFace(const CFX_ByteString& face_name,
                                      int weight, FX_BOOL bItalic, FX_LPBYTE& pFontData)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     CFX_ByteString key(face_name);
     key += ',';
     key += CFX_ByteString::FormatInteger(weight);
@@ -136,6 +140,7 @@ FXFT_Face CFX_FontMgr::GetCachedFace(const CFX_ByteString& face_name,
 FXFT_Face CFX_FontMgr::AddCachedFace(const CFX_ByteString& face_name,
                                      int weight, FX_BOOL bItalic, FX_LPBYTE pData, FX_DWORD size, int face_index)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     CTTFontDesc* pFontDesc = FX_NEW CTTFontDesc;
     if (!pFontDesc) {
         return NULL;
@@ -317,6 +322,7 @@ int GetTTCIndex(FX_LPCBYTE pFontData, FX_DWORD ttc_size, FX_DWORD font_offset)
 FXFT_Face CFX_FontMgr::GetCachedTTCFace(int ttc_size, FX_DWORD checksum,
                                         int font_offset, FX_LPBYTE& pFontData)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     CFX_ByteString key;
     key.Format("%d:%d", ttc_size, checksum);
     CTTFontDesc* pFontDesc = NULL;
@@ -335,6 +341,7 @@ FXFT_Face CFX_FontMgr::GetCachedTTCFace(int ttc_size, FX_DWORD checksum,
 FXFT_Face CFX_FontMgr::AddCachedTTCFace(int ttc_size, FX_DWORD checksum,
                                         FX_LPBYTE pData, FX_DWORD size, int font_offset)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     CFX_ByteString key;
     key.Format("%d:%d", ttc_size, checksum);
     CTTFontDesc* pFontDesc = FX_NEW CTTFontDesc;
@@ -355,6 +362,7 @@ FXFT_Face CFX_FontMgr::AddCachedTTCFace(int ttc_size, FX_DWORD checksum,
 }
 FXFT_Face CFX_FontMgr::GetFixedFace(FX_LPCBYTE pData, FX_DWORD size, int face_index)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     FXFT_Library library;
     if (m_FTLibrary == NULL) {
         FXFT_Init_FreeType(&m_FTLibrary);
@@ -373,6 +381,7 @@ FXFT_Face CFX_FontMgr::GetFixedFace(FX_LPCBYTE pData, FX_DWORD size, int face_in
 }
 FXFT_Face CFX_FontMgr::GetFileFace(FX_LPCSTR filename, int face_index)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     FXFT_Library library;
     if (m_FTLibrary == NULL) {
         FXFT_Init_FreeType(&m_FTLibrary);
@@ -391,6 +400,7 @@ FXFT_Face CFX_FontMgr::GetFileFace(FX_LPCSTR filename, int face_index)
 }
 void CFX_FontMgr::ReleaseFace(FXFT_Face face)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     if (face == NULL) {
         return;
     }
@@ -1328,6 +1338,10 @@ IFX_SystemFontInfo* IFX_SystemFontInfo::CreateDefault()
 #if !defined(_FPDFAPI_MINI_)
 CFX_FolderFontInfo::CFX_FolderFontInfo()
 {
+    m_pMapper = NULL;
+    m_pIndexSaver = NULL;
+    m_nIndexEntries = 0;
+    m_bIndexChanged = FALSE;
 }
 CFX_FolderFontInfo::~CFX_FolderFontInfo()
 {
@@ -1347,12 +1361,149 @@ void CFX_FolderFontInfo::Release()
 {
     delete this;
 }
+#define FX_FONTINDEX_MAGIC		0x49464646
+#define FX_FONTINDEX_VERSION	1
 FX_BOOL CFX_FolderFontInfo::EnumFontList(CFX_FontMapper* pMapper)
 {
     m_pMapper = pMapper;
+    const CFX_ByteString& index = CFX_GEModule::Get()->GetFontIndexFile();
+    if (!index.IsEmpty()) {
+        LoadIndex(index);
+        m_pIndexSaver = FX_NEW CFX_ArchiveSaver;
+    }
+    if (m_pIndexSaver) {
+        *m_pIndexSaver << (FX_DWORD)FX_FONTINDEX_MAGIC << (FX_DWORD)FX_FONTINDEX_VERSION;
+    }
     for (int i = 0; i < m_PathList.GetSize(); i ++) {
         ScanPath(m_PathList[i]);
     }
+    if (m_pIndexSaver) {
+        *m_pIndexSaver << (FX_BYTE)0 << (FX_DWORD)FX_FONTINDEX_MAGIC;
+        if (m_bIndexChanged || m_nIndexEntries != m_IndexMap.GetCount()) {
+            SaveIndex(index);
+        }
+        delete m_pIndexSaver;
+        m_pIndexSaver = NULL;
+    }
+    FX_POSITION pos = m_IndexMap.GetStartPosition();
+    while (pos) {
+        CFX_ByteString key;
+        FX_LPVOID value;
+        m_IndexMap.GetNextAssoc(pos, key, value);
+        delete (CFontIndexEntry*)value;
+    }
+    m_IndexMap.RemoveAll();
+    return TRUE;
+}
+// The index file holds one entry per font file: the path, the size and modification time it was
+// scanned at, and the faces found in it. A file whose size and time still match is reported from
+// the index without being opened. The trailing magic number rejects truncated or partly written
+// files, in which case every file is scanned again.
+void CFX_FolderFontInfo::LoadIndex(FX_BSTR filename)
+{
+    FXSYS_FILE* pFile = FXSYS_fopen(CFX_ByteString(filename), "rb");
+    if (pFile == NULL) {
+        return;
+    }
+    FXSYS_fseek(pFile, 0, FXSYS_SEEK_END);
+    FX_DWORD size = FXSYS_ftell(pFile);
+    FXSYS_fseek(pFile, 0, FXSYS_SEEK_SET);
+    CFX_ByteString data = _FPDF_ReadStringFromFile(pFile, size);
+    FXSYS_fclose(pFile);
+    CFX_ArchiveLoader loader(data, data.GetLength());
+    FX_DWORD magic = 0, version = 0;
+    loader >> magic >> version;
+    if (magic != FX_FONTINDEX_MAGIC || version != FX_FONTINDEX_VERSION) {
+        return;
+    }
+    while (!loader.IsEOF()) {
+        FX_BYTE tag = 0;
+        loader >> tag;
+        if (tag == 0) {
+            break;
+        }
+        CFX_ByteString path;
+        CFontIndexEntry* pEntry = FX_NEW CFontIndexEntry;
+        if (!pEntry) {
+            break;
+        }
+        pEntry->m_FileSize = 0;
+        pEntry->m_ModTime = 0;
+        loader >> path >> pEntry->m_FileSize >> pEntry->m_ModTime >> pEntry->m_Faces;
+        FX_LPVOID p;
+        if (m_IndexMap.Lookup(path, p)) {
+            delete (CFontIndexEntry*)p;
+        }
+        m_IndexMap.SetAt(path, pEntry);
+    }
+    magic = 0;
+    loader >> magic;
+    if (magic == FX_FONTINDEX_MAGIC && loader.IsEOF()) {
+        return;
+    }
+    FX_POSITION pos = m_IndexMap.GetStartPosition();
+    while (pos) {
+        CFX_ByteString key;
+        FX_LPVOID value;
+        m_IndexMap.GetNextAssoc(pos, key, value);
+        delete (CFontIndexEntry*)value;
+    }
+    m_IndexMap.RemoveAll();
+}
+void CFX_FolderFontInfo::SaveIndex(FX_BSTR filename)
+{
+    // Write to a unique file next to the index and rename it over the index, so that another
+    // process never reads a partially written index.
+    CFX_ByteString temp_path;
+    FX_HFILE hFile = NULL;
+    for (int retry = 0; retry < 8 && hFile == NULL; retry ++) {
+        FX_DWORD random;
+        FX_Random_GenerateMT(&random, 1);
+        temp_path.Format("%s.%08x.tmp", (FX_LPCSTR)CFX_ByteString(filename), random);
+        hFile = FX_File_Open(temp_path, FX_FILEMODE_Write | FX_FILEMODE_Exclusive);
+    }
+    if (hFile == NULL) {
+        return;
+    }
+    size_t size = (size_t)m_pIndexSaver->GetLength();
+    FX_BOOL bWritten = FX_File_Write(hFile, m_pIndexSaver->GetBuffer(), size) == size;
+    FX_File_Close(hFile);
+    if (!bWritten || !FX_File_Move(temp_path, filename)) {
+        FX_File_Delete(temp_path);
+    }
+}
+void CFX_FolderFontInfo::WriteIndexEntry(FX_BSTR path, FX_DWORD filesize, FX_DWORD modtime, FX_BSTR faces)
+{
+    *m_pIndexSaver << (FX_BYTE)1 << path << filesize << modtime << faces;
+}
+FX_BOOL CFX_FolderFontInfo::ReportIndexedFile(CFX_ByteString& path, FX_DWORD filesize, FX_DWORD modtime)
+{
+    FX_LPVOID p;
+    if (!m_IndexMap.Lookup(path, p)) {
+        return FALSE;
+    }
+    CFontIndexEntry* pEntry = (CFontIndexEntry*)p;
+    if (pEntry->m_FileSize != filesize || pEntry->m_ModTime != modtime) {
+        return FALSE;
+    }
+    CFX_ArchiveLoader loader(pEntry->m_Faces, pEntry->m_Faces.GetLength());
+    int nFaces = 0;
+    loader >> nFaces;
+    for (int i = 0; i < nFaces && !loader.IsEOF(); i ++) {
+        CFontFaceInfo* pInfo = FX_NEW CFontFaceInfo;
+        if (!pInfo) {
+            break;
+        }
+        pInfo->m_FilePath = path;
+        pInfo->m_FileSize = filesize;
+        pInfo->m_FontOffset = 0;
+        pInfo->m_Styles = 0;
+        pInfo->m_Charsets = 0;
+        loader >> pInfo->m_FaceName >> pInfo->m_FontTables >> pInfo->m_FontOffset >> pInfo->m_Styles >> pInfo->m_Charsets;
+        ReportFace(pInfo);
+    }
+    WriteIndexEntry(path, filesize, modtime, pEntry->m_Faces);
+    m_nIndexEntries ++;
     return TRUE;
 }
 void CFX_FolderFontInfo::ScanPath(CFX_ByteString& path)
@@ -1392,6 +1543,11 @@ void CFX_FolderFontInfo::ScanPath(CFX_ByteString& path)
 }
 void CFX_FolderFontInfo::ScanFile(CFX_ByteString& path)
 {
+    FX_DWORD stampsize = 0, modtime = 0;
+    FX_BOOL bIndexed = m_pIndexSaver && FX_GetFileStamp(path, stampsize, modtime);
+    if (bIndexed && ReportIndexedFile(path, stampsize, modtime)) {
+        return;
+    }
     FXSYS_FILE* pFile = FXSYS_fopen(path, "rb");
     if (pFile == NULL) {
         return;
@@ -1401,6 +1557,7 @@ void CFX_FolderFontInfo::ScanFile(CFX_ByteString& path)
     FX_BYTE buffer[16];
     FXSYS_fseek(pFile, 0, FXSYS_SEEK_SET);
     size_t readCnt = FXSYS_fread(buffer, 12, 1, pFile);
+    CFX_PtrArray faces;
     if (GET_TT_LONG(buffer) == 0x74746366) {
         FX_DWORD nFaces = GET_TT_LONG(buffer + 8);
         FX_LPBYTE offsets = FX_Alloc(FX_BYTE, nFaces * 4);
@@ -1411,20 +1568,40 @@ void CFX_FolderFontInfo::ScanFile(CFX_ByteString& path)
         readCnt = FXSYS_fread(offsets, nFaces * 4, 1, pFile);
         for (FX_DWORD i = 0; i < nFaces; i ++) {
             FX_LPBYTE p = offsets + i * 4;
-            ReportFace(path, pFile, filesize, GET_TT_LONG(p));
+            CFontFaceInfo* pInfo = LoadFace(path, pFile, filesize, GET_TT_LONG(p));
+            if (pInfo) {
+                faces.Add(pInfo);
+            }
         }
         FX_Free(offsets);
     } else {
-        ReportFace(path, pFile, filesize, 0);
+        CFontFaceInfo* pInfo = LoadFace(path, pFile, filesize, 0);
+        if (pInfo) {
+            faces.Add(pInfo);
+        }
     }
     FXSYS_fclose(pFile);
+    if (bIndexed) {
+        CFX_ArchiveSaver saver;
+        saver << faces.GetSize();
+        for (int i = 0; i < faces.GetSize(); i ++) {
+            CFontFaceInfo* pInfo = (CFontFaceInfo*)faces[i];
+            saver << pInfo->m_FaceName << pInfo->m_FontTables << pInfo->m_FontOffset << pInfo->m_Styles << pInfo->m_Charsets;
+        }
+        WriteIndexEntry(path, stampsize, modtime, CFX_ByteStringC(saver.GetBuffer(), (FX_STRSIZE)saver.GetLength()));
+        m_nIndexEntries ++;
+        m_bIndexChanged = TRUE;
+    }
+    for (int i = 0; i < faces.GetSize(); i ++) {
+        ReportFace((CFontFaceInfo*)faces[i]);
+    }
 }
-void CFX_FolderFontInfo::ReportFace(CFX_ByteString& path, FXSYS_FILE* pFile, FX_DWORD filesize, FX_DWORD offset)
+CFontFaceInfo* CFX_FolderFontInfo::LoadFace(CFX_ByteString& path, FXSYS_FILE* pFile, FX_DWORD filesize, FX_DWORD offset)
 {
     FXSYS_fseek(pFile, offset, FXSYS_SEEK_SET);
     char buffer[16];
     if (!FXSYS_fread(buffer, 12, 1, pFile)) {
-        return;
+        return NULL;
     }
     FX_DWORD nTables = GET_TT_SHORT(buffer + 4);
     CFX_ByteString tables = _FPDF_ReadStringFromFile(pFile, nTables * 16);
@@ -1434,13 +1611,9 @@ void CFX_FolderFontInfo::ReportFace(CFX_ByteString& path, FXSYS_FILE* pFile, FX_
     if (style != "Regular") {
         facename += " " + style;
     }
-    FX_LPVOID p;
-    if (m_FontList.Lookup(facename, p)) {
-        return;
-    }
     CFontFaceInfo* pInfo = FX_NEW CFontFaceInfo;
     if (!pInfo) {
-        return;
+        return NULL;
     }
     pInfo->m_FilePath = path;
     pInfo->m_FaceName = facename;
@@ -1453,27 +1626,21 @@ void CFX_FolderFontInfo::ReportFace(CFX_ByteString& path, FXSYS_FILE* pFile, FX_
         FX_LPCBYTE p = (FX_LPCBYTE)os2 + 78;
         FX_DWORD codepages = GET_TT_LONG(p);
         if (codepages & (1 << 17)) {
-            m_pMapper->AddInstalledFont(facename, FXFONT_SHIFTJIS_CHARSET);
             pInfo->m_Charsets |= CHARSET_FLAG_SHIFTJIS;
         }
         if (codepages & (1 << 18)) {
-            m_pMapper->AddInstalledFont(facename, FXFONT_GB2312_CHARSET);
             pInfo->m_Charsets |= CHARSET_FLAG_GB;
         }
         if (codepages & (1 << 20)) {
-            m_pMapper->AddInstalledFont(facename, FXFONT_CHINESEBIG5_CHARSET);
             pInfo->m_Charsets |= CHARSET_FLAG_BIG5;
         }
         if ((codepages & (1 << 19)) || (codepages & (1 << 21))) {
-            m_pMapper->AddInstalledFont(facename, FXFONT_HANGEUL_CHARSET);
             pInfo->m_Charsets |= CHARSET_FLAG_KOREAN;
         }
         if (codepages & (1 << 31)) {
-            m_pMapper->AddInstalledFont(facename, FXFONT_SYMBOL_CHARSET);
             pInfo->m_Charsets |= CHARSET_FLAG_SYMBOL;
         }
     }
-    m_pMapper->AddInstalledFont(facename, FXFONT_ANSI_CHARSET);
     pInfo->m_Charsets |= CHARSET_FLAG_ANSI;
     pInfo->m_Styles = 0;
     if (style.Find(FX_BSTRC("Bold")) > -1) {
@@ -1485,6 +1652,34 @@ void CFX_FolderFontInfo::ReportFace(CFX_ByteString& path, FXSYS_FILE* pFile, FX_
     if (facename.Find(FX_BSTRC("Serif")) > -1) {
         pInfo->m_Styles |= FXFONT_SERIF;
     }
+    return pInfo;
+}
+void CFX_FolderFontInfo::ReportFace(CFontFaceInfo* pInfo)
+{
+    FX_LPVOID p;
+    if (m_FontList.Lookup(pInfo->m_FaceName, p)) {
+        delete pInfo;
+        return;
+    }
+    const CFX_ByteString& facename = pInfo->m_FaceName;
+    if (pInfo->m_Charsets & CHARSET_FLAG_SHIFTJIS) {
+        m_pMapper->AddInstalledFont(facename, FXFONT_SHIFTJIS_CHARSET);
+    }
+    if (pInfo->m_Charsets & CHARSET_FLAG_GB) {
+        m_pMapper->AddInstalledFont(facename, FXFONT_GB2312_CHARSET);
+    }
+    if (pInfo->m_Charsets & CHARSET_FLAG_BIG5) {
+        m_pMapper->AddInstalledFont(facename, FXFONT_CHINESEBIG5_CHARSET);
+    }
+    if (pInfo->m_Charsets & CHARSET_FLAG_KOREAN) {
+        m_pMapper->AddInstalledFont(facename, FXFONT_HANGEUL_CHARSET);
+    }
+    if (pInfo->m_Charsets & CHARSET_FLAG_SYMBOL) {
+        m_pMapper->AddInstalledFont(facename, FXFONT_SYMBOL_CHARSET);
+    }
+    if (pInfo->m_Charsets & CHARSET_FLAG_ANSI) {
+        m_pMapper->AddInstalledFont(facename, FXFONT_ANSI_CHARSET);
+    }
     m_FontList.SetAt(facename, pInfo);
 }
 void* CFX_FolderFontInfo::MapFont(int weight, FX_BOOL bItalic, int charset, int pitch_family, FX_LPCSTR family, FX_BOOL& bExact)
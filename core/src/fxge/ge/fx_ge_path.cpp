@@ -6,6 +6,75 @@
 
 #include "../../../include/fxcrt/fx_basic.h"
 #include "../../../include/fxge/fx_ge.h"
+CFX_ClipSpans::CFX_ClipSpans()
+{
+    m_Top = m_Height = 0;
+    m_pRowStart = NULL;
+    m_pRuns = NULL;
+    m_nRuns = m_nAlloc = 0;
+}
+CFX_ClipSpans::~CFX_ClipSpans()
+{
+    if (m_pRowStart) {
+        FX_Free(m_pRowStart);
+    }
+    if (m_pRuns) {
+        FX_Free(m_pRuns);
+    }
+}
+FX_BOOL CFX_ClipSpans::Create(int top, int height)
+{
+    m_Top = top;
+    m_Height = height;
+    m_pRowStart = FX_Alloc(int, height + 1);
+    if (!m_pRowStart) {
+        return FALSE;
+    }
+    FXSYS_memset32(m_pRowStart, 0, (height + 1) * sizeof(int));
+    return TRUE;
+}
+void CFX_ClipSpans::AddRun(int row, int left, int right)
+{
+    int index = row - m_Top;
+    if (index < 0 || index >= m_Height || left >= right) {
+        return;
+    }
+    if (m_pRowStart[index + 1] && m_pRuns[m_nRuns * 2 - 1] >= left) {
+        if (m_pRuns[m_nRuns * 2 - 1] < right) {
+            m_pRuns[m_nRuns * 2 - 1] = right;
+        }
+        return;
+    }
+    if (m_nRuns == m_nAlloc) {
+        int new_alloc = m_nAlloc ? m_nAlloc * 2 : m_Height + 16;
+        int* pNewRuns = m_pRuns ? FX_Realloc(int, m_pRuns, new_alloc * 2) : FX_Alloc(int, new_alloc * 2);
+        if (!pNewRuns) {
+            return;
+        }
+        m_pRuns = pNewRuns;
+        m_nAlloc = new_alloc;
+    }
+    m_pRuns[m_nRuns * 2] = left;
+    m_pRuns[m_nRuns * 2 + 1] = right;
+    m_nRuns ++;
+    m_pRowStart[index + 1] ++;
+}
+void CFX_ClipSpans::Finish()
+{
+    for (int i = 0; i < m_Height; i ++) {
+        m_pRowStart[i + 1] += m_pRowStart[i];
+    }
+}
+int CFX_ClipSpans::GetRowRuns(int row, const int*& pRuns) const
+{
+    int index = row - m_Top;
+    if (index < 0 || index >= m_Height) {
+        pRuns = NULL;
+        return 0;
+    }
+    pRuns = m_pRuns + m_pRowStart[index] * 2;
+    return m_pRowStart[index + 1] - m_pRowStart[index];
+}
 CFX_ClipRgn::CFX_ClipRgn(int width, int height)
 {
     m_Type = RectI;
@@ -23,6 +92,7 @@ CFX_ClipRgn::CFX_ClipRgn(const CFX_ClipRgn& src)
     m_Type = src.m_Type;
     m_Box = src.m_Box;
     m_Mask = src.m_Mask;
+    m_Spans = src.m_Spans;
 }
 CFX_ClipRgn::~CFX_ClipRgn()
 {
@@ -32,6 +102,7 @@ void CFX_ClipRgn::Reset(const FX_RECT& rect)
     m_Type = RectI;
     m_Box = rect;
     m_Mask.SetNull();
+    m_Spans.SetNull();
 }
 void CFX_ClipRgn::IntersectRect(const FX_RECT& rect)
 {
@@ -43,6 +114,14 @@ void CFX_ClipRgn::IntersectRect(const FX_RECT& rect)
         IntersectMaskRect(rect, m_Box, m_Mask);
         return;
     }
+    if (m_Type == SpansI) {
+        m_Box.Intersect(rect);
+        if (m_Box.IsEmpty()) {
+            m_Type = RectI;
+            m_Spans.SetNull();
+        }
+        return;
+    }
 }
 void CFX_ClipRgn::IntersectMaskRect(FX_RECT rect, FX_RECT mask_rect, CFX_DIBitmapRef Mask)
 {
@@ -79,12 +158,13 @@ void CFX_ClipRgn::IntersectMaskF(int left, int top, CFX_DIBitmapRef Mask)
         IntersectMaskRect(m_Box, mask_box, Mask);
         return;
     }
-    if (m_Type == MaskF) {
+    if (m_Type == MaskF || m_Type == SpansI) {
         FX_RECT new_box = m_Box;
         new_box.Intersect(mask_box);
         if (new_box.IsEmpty()) {
             m_Type = RectI;
             m_Mask.SetNull();
+            m_Spans.SetNull();
             m_Box = new_box;
             return;
         }
@@ -94,6 +174,28 @@ void CFX_ClipRgn::IntersectMaskF(int left, int top, CFX_DIBitmapRef Mask)
             return;
         }
         new_dib->Create(new_box.Width(), new_box.Height(), FXDIB_8bppMask);
+        if (m_Type == SpansI) {
+            new_dib->Clear(0);
+            const CFX_ClipSpans* pSpans = m_Spans;
+            for (int row = new_box.top; row < new_box.bottom; row ++) {
+                FX_LPBYTE mask_scan = mask_dib->GetBuffer() + (row - top) * mask_dib->GetPitch();
+                FX_LPBYTE new_scan = new_dib->GetBuffer() + (row - new_box.top) * new_dib->GetPitch();
+                const int* pRuns;
+                int nRuns = pSpans->GetRowRuns(row, pRuns);
+                for (int i = 0; i < nRuns; i ++) {
+                    int run_left = FX_MAX(pRuns[i * 2], new_box.left);
+                    int run_right = FX_MIN(pRuns[i * 2 + 1], new_box.right);
+                    if (run_left < run_right) {
+                        FXSYS_memcpy32(new_scan + run_left - new_box.left, mask_scan + run_left - left, run_right - run_left);
+                    }
+                }
+            }
+            m_Type = MaskF;
+            m_Spans.SetNull();
+            m_Box = new_box;
+            m_Mask = new_mask;
+            return;
+        }
         const CFX_DIBitmap* old_dib = m_Mask;
         for (int row = new_box.top; row < new_box.bottom; row ++) {
             FX_LPBYTE old_scan = old_dib->GetBuffer() + (row - m_Box.top) * old_dib->GetPitch();
@@ -109,6 +211,109 @@ void CFX_ClipRgn::IntersectMaskF(int left, int top, CFX_DIBitmapRef Mask)
     }
     ASSERT(FALSE);
 }
+void CFX_ClipRgn::IntersectSpans(const FX_RECT& span_box, CFX_ClipSpansRef Spans)
+{
+    FX_RECT new_box = m_Box;
+    new_box.Intersect(span_box);
+    if (new_box.IsEmpty()) {
+        m_Type = RectI;
+        m_Mask.SetNull();
+        m_Spans.SetNull();
+        m_Box = new_box;
+        return;
+    }
+    if (m_Type == RectI) {
+        m_Type = SpansI;
+        m_Box = new_box;
+        m_Spans = Spans;
+        return;
+    }
+    const CFX_ClipSpans* pSpans = Spans;
+    if (m_Type == MaskF) {
+        CFX_DIBitmapRef new_mask;
+        CFX_DIBitmap* new_dib = new_mask.New();
+        if (!new_dib) {
+            return;
+        }
+        new_dib->Create(new_box.Width(), new_box.Height(), FXDIB_8bppMask);
+        new_dib->Clear(0);
+        const CFX_DIBitmap* old_dib = m_Mask;
+        for (int row = new_box.top; row < new_box.bottom; row ++) {
+            FX_LPBYTE old_scan = old_dib->GetBuffer() + (row - m_Box.top) * old_dib->GetPitch();
+            FX_LPBYTE new_scan = new_dib->GetBuffer() + (row - new_box.top) * new_dib->GetPitch();
+            const int* pRuns;
+            int nRuns = pSpans->GetRowRuns(row, pRuns);
+            for (int i = 0; i < nRuns; i ++) {
+                int run_left = FX_MAX(pRuns[i * 2], new_box.left);
+                int run_right = FX_MIN(pRuns[i * 2 + 1], new_box.right);
+                if (run_left < run_right) {
+                    FXSYS_memcpy32(new_scan + run_left - new_box.left, old_scan + run_left - m_Box.left, run_right - run_left);
+                }
+            }
+        }
+        m_Box = new_box;
+        m_Mask = new_mask;
+        return;
+    }
+    if (m_Type == SpansI) {
+        const CFX_ClipSpans* pOldSpans = m_Spans;
+        CFX_ClipSpansRef new_spans;
+        CFX_ClipSpans* pNewSpans = new_spans.New();
+        if (!pNewSpans || !pNewSpans->Create(new_box.top, new_box.Height())) {
+            return;
+        }
+        for (int row = new_box.top; row < new_box.bottom; row ++) {
+            const int *pRuns1, *pRuns2;
+            int nRuns1 = pOldSpans->GetRowRuns(row, pRuns1);
+            int nRuns2 = pSpans->GetRowRuns(row, pRuns2);
+            int i = 0, j = 0;
+            while (i < nRuns1 && j < nRuns2) {
+                int run_left = FX_MAX(FX_MAX(pRuns1[i * 2], pRuns2[j * 2]), new_box.left);
+                int run_right = FX_MIN(FX_MIN(pRuns1[i * 2 + 1], pRuns2[j * 2 + 1]), new_box.right);
+                pNewSpans->AddRun(row, run_left, run_right);
+                if (pRuns1[i * 2 + 1] < pRuns2[j * 2 + 1]) {
+                    i ++;
+                } else {
+                    j ++;
+                }
+            }
+        }
+        pNewSpans->Finish();
+        m_Box = new_box;
+        m_Spans = new_spans;
+        return;
+    }
+    ASSERT(FALSE);
+}
+FX_BOOL CFX_ClipRgn::ConvertToMaskF()
+{
+    if (m_Type != SpansI) {
+        return TRUE;
+    }
+    CFX_DIBitmapRef new_mask;
+    CFX_DIBitmap* new_dib = new_mask.New();
+    if (!new_dib || !new_dib->Create(m_Box.Width(), m_Box.Height(), FXDIB_8bppMask)) {
+        return FALSE;
+    }
+    new_dib->Clear(0);
+    const CFX_ClipSpans* pSpans = m_Spans;
+    for (int row = m_Box.top; row < m_Box.bottom; row ++) {
+        FX_LPBYTE new_scan = new_dib->GetBuffer() + (row - m_Box.top) * new_dib->GetPitch();
+        const int* pRuns;
+        int nRuns = pSpans->GetRowRuns(row, pRuns);
+        for (int i = 0; i < nRuns; i ++) {
+            int run_left = FX_MAX(pRuns[i * 2], m_Box.left);
+            int run_right = FX_MIN(pRuns[i * 2 + 1], m_Box.right);
+            if (run_left < run_right) {
+                FXSYS_memset8(new_scan + run_left - m_Box.left, 0xff, run_right - run_left);
+            }
+        }
+    }
+    m_Type = MaskF;
+    m_Mask = new_mask;
+    m_Spans.SetNull();
+    return TRUE;
+}
 CFX_PathData::CFX_PathData()
 {
     m_PointCount = m_AllocCount = 0;
@@ -998,12 +998,14 @@ CFX_FontCache::~CFX_FontCache()
 }
 CFX_FaceCache* CFX_FontCache::GetCachedFace(CFX_Font* pFont)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     FX_BOOL bExternal = pFont->GetFace() == NULL;
     void* face = bExternal ? pFont->GetSubstFont()->m_ExtHandle : pFont->GetFace();
     CFX_FTCacheMap& map =  bExternal ? m_ExtFaceMap : m_FTFaceMap;
     CFX_CountedFaceCache* counted_face_cache = NULL;
     if (map.Lookup((FXFT_Face)face, counted_face_cache)) {
         counted_face_cache->m_nCount++;
+        counted_face_cache->m_Obj->m_nUsers++;
         return counted_face_cache->m_Obj;
     }
     CFX_FaceCache* face_cache = NULL;
@@ -1021,11 +1023,13 @@ CFX_FaceCache* CFX_FontCache::GetCachedFace(CFX_Font* pFont)
     }
     counted_face_cache->m_nCount = 2;
     counted_face_cache->m_Obj = face_cache;
+    face_cache->m_nUsers = 1;
     map.SetAt((FXFT_Face)face, counted_face_cache);
     return face_cache;
 }
 void CFX_FontCache::ReleaseCachedFace(CFX_Font* pFont)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     FX_BOOL bExternal = pFont->GetFace() == NULL;
     void* face = bExternal ? pFont->GetSubstFont()->m_ExtHandle : pFont->GetFace();
     CFX_FTCacheMap& map =  bExternal ? m_ExtFaceMap : m_FTFaceMap;
@@ -1036,9 +1040,17 @@ void CFX_FontCache::ReleaseCachedFace(CFX_Font* pFont)
     if (counted_face_cache->m_nCount > 1) {
         counted_face_cache->m_nCount--;
     }
+    if (counted_face_cache->m_Obj->m_nUsers) {
+        counted_face_cache->m_Obj->m_nUsers--;
+    }
+    CFX_GlyphLRUList* pLRUList = CFX_GEModule::Get()->GetGlyphLRUList();
+    if (pLRUList->m_nLimit && pLRUList->m_nBytes > pLRUList->m_nLimit) {
+        pLRUList->Shrink();
+    }
 }
 void CFX_FontCache::FreeCache(FX_BOOL bRelease)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     {
         FX_POSITION pos;
         pos = m_FTFaceMap.GetStartPosition();
@@ -1069,15 +1081,21 @@ CFX_FaceCache::CFX_FaceCache(FXFT_Face face)
 {
     m_Face = face;
     m_pBitmap = NULL;
+    m_nUsers = 0;
+    m_pLastSizeCache = NULL;
 }
 CFX_FaceCache::~CFX_FaceCache()
 {
     FX_POSITION pos = m_SizeMap.GetStartPosition();
-    CFX_ByteString Key;
+    FX_LPVOID Key;
     CFX_SizeGlyphCache* pSizeCache = NULL;
     while(pos) {
         m_SizeMap.GetNextAssoc( pos, Key, (void*&)pSizeCache);
-        delete pSizeCache;
+        while (pSizeCache) {
+            CFX_SizeGlyphCache* pNext = pSizeCache->m_pNextSize;
+            delete pSizeCache;
+            pSizeCache = pNext;
+        }
     }
     m_SizeMap.RemoveAll();
     pos = m_PathMap.GetStartPosition();
@@ -1097,117 +1115,230 @@ void CFX_FaceCache::InitPlatform()
 {
 }
 #endif
-CFX_GlyphBitmap* CFX_FaceCache::LookUpGlyphBitmap(CFX_Font* pFont, const CFX_AffineMatrix* pMatrix,
-        CFX_ByteStringC& FaceGlyphsKey, FX_DWORD glyph_index, FX_BOOL bFontStyle,
-        int dest_width, int anti_alias)
+static void _GenerateGlyphSizeKey(FX_GLYPHSIZE_KEY& key, CFX_Font* pFont, const CFX_AffineMatrix* pMatrix,
+                                  int dest_width, int anti_alias, FX_BOOL bNativeText)
 {
-    CFX_SizeGlyphCache* pSizeCache = NULL;
-    if (!m_SizeMap.Lookup(FaceGlyphsKey, (void*&)pSizeCache)) {
-        pSizeCache = FX_NEW CFX_SizeGlyphCache;
+    FXSYS_memset32(&key, 0, sizeof(FX_GLYPHSIZE_KEY));
+    key.m_Matrix[0] = (int)(pMatrix->a * 10000);
+    key.m_Matrix[1] = (int)(pMatrix->b * 10000);
+    key.m_Matrix[2] = (int)(pMatrix->c * 10000);
+    key.m_Matrix[3] = (int)(pMatrix->d * 10000);
+    key.m_DestWidth = dest_width;
+    key.m_AntiAlias = anti_alias;
+    if (pFont->GetSubstFont()) {
+        key.m_Weight = pFont->GetSubstFont()->m_Weight;
+        key.m_ItalicAngle = pFont->GetSubstFont()->m_ItalicAngle;
+        key.m_Flags |= FXGLYPHKEY_SUBST;
+        if (pFont->IsVertical()) {
+            key.m_Flags |= FXGLYPHKEY_VERTICAL;
+        }
+    }
+    if (bNativeText) {
+        key.m_Flags |= FXGLYPHKEY_NATIVETEXT;
+    }
+}
+CFX_SizeGlyphCache* CFX_FaceCache::GetSizeCache(const FX_GLYPHSIZE_KEY& SizeKey, FX_BOOL bCreate)
+{
+    if (m_pLastSizeCache && FXSYS_memcmp32(&m_pLastSizeCache->m_Key, &SizeKey, sizeof(FX_GLYPHSIZE_KEY)) == 0) {
+        return m_pLastSizeCache;
+    }
+    const int* pValues = (const int*)&SizeKey;
+    FX_DWORD hash = 0;
+    for (int i = 0; i < (int)(sizeof(FX_GLYPHSIZE_KEY) / sizeof(int)); i ++) {
+        hash = hash * 31 + (FX_DWORD)pValues[i];
+    }
+    CFX_SizeGlyphCache* pFirst = NULL;
+    m_SizeMap.Lookup((FX_LPVOID)(FX_UINTPTR)hash, (void*&)pFirst);
+    CFX_SizeGlyphCache* pSizeCache = pFirst;
+    while (pSizeCache && FXSYS_memcmp32(&pSizeCache->m_Key, &SizeKey, sizeof(FX_GLYPHSIZE_KEY))) {
+        pSizeCache = pSizeCache->m_pNextSize;
+    }
+    if (pSizeCache == NULL) {
+        if (!bCreate) {
+            return NULL;
+        }
+        pSizeCache = FX_NEW CFX_SizeGlyphCache(this, SizeKey);
         if (pSizeCache == NULL)	{
             return NULL;
         }
-        m_SizeMap.SetAt(FaceGlyphsKey, pSizeCache);
+        pSizeCache->m_pNextSize = pFirst;
+        m_SizeMap.SetAt((FX_LPVOID)(FX_UINTPTR)hash, pSizeCache);
+    }
+    m_pLastSizeCache = pSizeCache;
+    return pSizeCache;
+}
+CFX_GlyphBitmap* CFX_FaceCache::LookUpGlyphBitmap(CFX_Font* pFont, const CFX_AffineMatrix* pMatrix,
+        const FX_GLYPHSIZE_KEY& SizeKey, FX_DWORD glyph_index, FX_BOOL bFontStyle,
+        int dest_width, int anti_alias)
+{
+    CFX_SizeGlyphCache* pSizeCache = GetSizeCache(SizeKey, TRUE);
+    if (pSizeCache == NULL)	{
+        return NULL;
     }
-    CFX_GlyphBitmap* pGlyphBitmap = NULL;
-    if (pSizeCache->m_GlyphMap.Lookup((FX_LPVOID)(FX_UINTPTR)glyph_index, (void*&)pGlyphBitmap)) {
+    CFX_GlyphBitmap* pGlyphBitmap = pSizeCache->Lookup(glyph_index);
+    if (pGlyphBitmap) {
         return pGlyphBitmap;
     }
     pGlyphBitmap = RenderGlyph(pFont, glyph_index, bFontStyle, pMatrix, dest_width, anti_alias);
     if (pGlyphBitmap == NULL)	{
         return NULL;
     }
-    pSizeCache->m_GlyphMap.SetAt((FX_LPVOID)(FX_UINTPTR)glyph_index, pGlyphBitmap);
+    pSizeCache->Insert(glyph_index, pGlyphBitmap);
     return pGlyphBitmap;
 }
 const CFX_GlyphBitmap* CFX_FaceCache::LoadGlyphBitmap(CFX_Font* pFont, FX_DWORD glyph_index, FX_BOOL bFontStyle, const CFX_AffineMatrix* pMatrix,
         int dest_width, int anti_alias, int& text_flags)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     if (glyph_index == (FX_DWORD) - 1) {
         return NULL;
     }
-    _CFX_UniqueKeyGen keygen;
+    FX_GLYPHSIZE_KEY SizeKey;
 #if ((_FXM_PLATFORM_  != _FXM_PLATFORM_APPLE_)|| defined(_FPDFAPI_MINI_))
-    if (pFont->GetSubstFont())
-        keygen.Generate(9, (int)(pMatrix->a * 10000), (int)(pMatrix->b * 10000),
-                        (int)(pMatrix->c * 10000), (int)(pMatrix->d * 10000), dest_width, anti_alias,
-                        pFont->GetSubstFont()->m_Weight, pFont->GetSubstFont()->m_ItalicAngle, pFont->IsVertical());
-    else
-        keygen.Generate(6, (int)(pMatrix->a * 10000), (int)(pMatrix->b * 10000),
-                        (int)(pMatrix->c * 10000), (int)(pMatrix->d * 10000), dest_width, anti_alias);
+    _GenerateGlyphSizeKey(SizeKey, pFont, pMatrix, dest_width, anti_alias, FALSE);
+    return LookUpGlyphBitmap(pFont, pMatrix, SizeKey, glyph_index, bFontStyle, dest_width, anti_alias);
 #else
     if (text_flags & FXTEXT_NO_NATIVETEXT) {
-        if (pFont->GetSubstFont())
-            keygen.Generate(9, (int)(pMatrix->a * 10000), (int)(pMatrix->b * 10000),
-                            (int)(pMatrix->c * 10000), (int)(pMatrix->d * 10000), dest_width, anti_alias,
-                            pFont->GetSubstFont()->m_Weight, pFont->GetSubstFont()->m_ItalicAngle, pFont->IsVertical());
-        else
-            keygen.Generate(6, (int)(pMatrix->a * 10000), (int)(pMatrix->b * 10000),
-                            (int)(pMatrix->c * 10000), (int)(pMatrix->d * 10000), dest_width, anti_alias);
-    } else {
-        if (pFont->GetSubstFont())
-            keygen.Generate(10, (int)(pMatrix->a * 10000), (int)(pMatrix->b * 10000),
-                            (int)(pMatrix->c * 10000), (int)(pMatrix->d * 10000), dest_width, anti_alias,
-                            pFont->GetSubstFont()->m_Weight, pFont->GetSubstFont()->m_ItalicAngle, pFont->IsVertical(), 3);
-        else
-            keygen.Generate(7, (int)(pMatrix->a * 10000), (int)(pMatrix->b * 10000),
-                            (int)(pMatrix->c * 10000), (int)(pMatrix->d * 10000), dest_width, anti_alias, 3);
-    }
-#endif
-    CFX_ByteStringC FaceGlyphsKey(keygen.m_Key, keygen.m_KeyLen);
-#if ((_FXM_PLATFORM_  != _FXM_PLATFORM_APPLE_)|| defined(_FPDFAPI_MINI_))
-    return LookUpGlyphBitmap(pFont, pMatrix, FaceGlyphsKey, glyph_index, bFontStyle, dest_width, anti_alias);
-#else
-    if (text_flags & FXTEXT_NO_NATIVETEXT) {
-        return LookUpGlyphBitmap(pFont, pMatrix, FaceGlyphsKey, glyph_index, bFontStyle, dest_width, anti_alias);
+        _GenerateGlyphSizeKey(SizeKey, pFont, pMatrix, dest_width, anti_alias, FALSE);
+        return LookUpGlyphBitmap(pFont, pMatrix, SizeKey, glyph_index, bFontStyle, dest_width, anti_alias);
     } else {
+        _GenerateGlyphSizeKey(SizeKey, pFont, pMatrix, dest_width, anti_alias, TRUE);
         CFX_GlyphBitmap* pGlyphBitmap;
-        CFX_SizeGlyphCache* pSizeCache = NULL;
-        if (m_SizeMap.Lookup(FaceGlyphsKey, (void*&)pSizeCache)) {
-            if (pSizeCache->m_GlyphMap.Lookup((FX_LPVOID)(FX_UINTPTR)glyph_index, (void*&)pGlyphBitmap)) {
+        CFX_SizeGlyphCache* pSizeCache = GetSizeCache(SizeKey, FALSE);
+        if (pSizeCache) {
+            pGlyphBitmap = pSizeCache->Lookup(glyph_index);
+            if (pGlyphBitmap) {
                 return pGlyphBitmap;
             }
             pGlyphBitmap = RenderGlyph_Nativetext(pFont, glyph_index, pMatrix, dest_width, anti_alias);
             if (pGlyphBitmap) {
-                pSizeCache->m_GlyphMap.SetAt((FX_LPVOID)(FX_UINTPTR)glyph_index, pGlyphBitmap);
+                pSizeCache->Insert(glyph_index, pGlyphBitmap);
                 return pGlyphBitmap;
             }
         } else {
             pGlyphBitmap = RenderGlyph_Nativetext(pFont, glyph_index, pMatrix, dest_width, anti_alias);
             if (pGlyphBitmap) {
-                pSizeCache = FX_NEW CFX_SizeGlyphCache;
+                pSizeCache = GetSizeCache(SizeKey, TRUE);
                 if (pSizeCache == NULL)	{
                     return NULL;
                 }
-                m_SizeMap.SetAt(FaceGlyphsKey, pSizeCache);
-                pSizeCache->m_GlyphMap.SetAt((FX_LPVOID)(FX_UINTPTR)glyph_index, pGlyphBitmap);
+                pSizeCache->Insert(glyph_index, pGlyphBitmap);
                 return pGlyphBitmap;
             }
         }
-        if (pFont->GetSubstFont())
-            keygen.Generate(9, (int)(pMatrix->a * 10000), (int)(pMatrix->b * 10000),
-                            (int)(pMatrix->c * 10000), (int)(pMatrix->d * 10000), dest_width, anti_alias,
-                            pFont->GetSubstFont()->m_Weight, pFont->GetSubstFont()->m_ItalicAngle, pFont->IsVertical());
-        else
-            keygen.Generate(6, (int)(pMatrix->a * 10000), (int)(pMatrix->b * 10000),
-                            (int)(pMatrix->c * 10000), (int)(pMatrix->d * 10000), dest_width, anti_alias);
-        CFX_ByteStringC FaceGlyphsKey(keygen.m_Key, keygen.m_KeyLen);
+        _GenerateGlyphSizeKey(SizeKey, pFont, pMatrix, dest_width, anti_alias, FALSE);
         text_flags |= FXTEXT_NO_NATIVETEXT;
-        return LookUpGlyphBitmap(pFont, pMatrix, FaceGlyphsKey, glyph_index, bFontStyle, dest_width, anti_alias);
+        return LookUpGlyphBitmap(pFont, pMatrix, SizeKey, glyph_index, bFontStyle, dest_width, anti_alias);
     }
 #endif
 }
 CFX_SizeGlyphCache::~CFX_SizeGlyphCache()
 {
+    CFX_GlyphLRUList* pLRUList = CFX_GEModule::Get()->GetGlyphLRUList();
     FX_POSITION pos = m_GlyphMap.GetStartPosition();
     FX_LPVOID Key;
-    CFX_GlyphBitmap* pGlyphBitmap = NULL;
+    CFX_GlyphCacheEntry* pEntry = NULL;
     while(pos) {
-        m_GlyphMap.GetNextAssoc(pos, Key, (void*&)pGlyphBitmap);
-        delete pGlyphBitmap;
+        m_GlyphMap.GetNextAssoc(pos, Key, (void*&)pEntry);
+        pLRUList->Remove(pEntry);
+        delete pEntry->m_pGlyph;
+        delete pEntry;
     }
     m_GlyphMap.RemoveAll();
 }
+CFX_GlyphBitmap* CFX_SizeGlyphCache::Lookup(FX_DWORD glyph_index)
+{
+    CFX_GlyphLRUList* pLRUList = CFX_GEModule::Get()->GetGlyphLRUList();
+    CFX_GlyphCacheEntry* pEntry = NULL;
+    if (!m_GlyphMap.Lookup((FX_LPVOID)(FX_UINTPTR)glyph_index, (void*&)pEntry)) {
+        pLRUList->m_nMisses ++;
+        return NULL;
+    }
+    pLRUList->m_nHits ++;
+    pLRUList->Touch(pEntry);
+    return pEntry->m_pGlyph;
+}
+void CFX_SizeGlyphCache::Insert(FX_DWORD glyph_index, CFX_GlyphBitmap* pGlyph)
+{
+    CFX_GlyphCacheEntry* pEntry = FX_NEW CFX_GlyphCacheEntry;
+    if (pEntry == NULL) {
+        return;
+    }
+    pEntry->m_pGlyph = pGlyph;
+    pEntry->m_pSizeCache = this;
+    pEntry->m_GlyphIndex = glyph_index;
+    pEntry->m_nBytes = sizeof(CFX_GlyphBitmap) + pGlyph->m_Bitmap.GetPitch() * pGlyph->m_Bitmap.GetHeight();
+    m_GlyphMap.SetAt((FX_LPVOID)(FX_UINTPTR)glyph_index, pEntry);
+    CFX_GEModule::Get()->GetGlyphLRUList()->Add(pEntry);
+}
+void CFX_SizeGlyphCache::Evict(CFX_GlyphCacheEntry* pEntry)
+{
+    m_GlyphMap.RemoveKey((FX_LPVOID)(FX_UINTPTR)pEntry->m_GlyphIndex);
+    delete pEntry->m_pGlyph;
+    delete pEntry;
+}
+CFX_GlyphLRUList::CFX_GlyphLRUList()
+{
+    m_pHead = NULL;
+    m_pTail = NULL;
+    m_nLimit = 0;
+    m_nBytes = 0;
+    m_nGlyphs = 0;
+    m_nHits = 0;
+    m_nMisses = 0;
+    m_nEvictions = 0;
+}
+void CFX_GlyphLRUList::Add(CFX_GlyphCacheEntry* pEntry)
+{
+    pEntry->m_pPrev = NULL;
+    pEntry->m_pNext = m_pHead;
+    if (m_pHead) {
+        m_pHead->m_pPrev = pEntry;
+    } else {
+        m_pTail = pEntry;
+    }
+    m_pHead = pEntry;
+    m_nBytes += pEntry->m_nBytes;
+    m_nGlyphs ++;
+}
+void CFX_GlyphLRUList::Remove(CFX_GlyphCacheEntry* pEntry)
+{
+    if (pEntry->m_pPrev) {
+        pEntry->m_pPrev->m_pNext = pEntry->m_pNext;
+    } else {
+        m_pHead = pEntry->m_pNext;
+    }
+    if (pEntry->m_pNext) {
+        pEntry->m_pNext->m_pPrev = pEntry->m_pPrev;
+    } else {
+        m_pTail = pEntry->m_pPrev;
+    }
+    pEntry->m_pPrev = pEntry->m_pNext = NULL;
+    m_nBytes -= pEntry->m_nBytes;
+    m_nGlyphs --;
+}
+void CFX_GlyphLRUList::Touch(CFX_GlyphCacheEntry* pEntry)
+{
+    if (pEntry == m_pHead) {
+        return;
+    }
+    Remove(pEntry);
+    Add(pEntry);
+}
+void CFX_GlyphLRUList::Shrink()
+{
+    CFX_GlyphCacheEntry* pEntry = m_pTail;
+    while (pEntry && m_nBytes > m_nLimit) {
+        CFX_GlyphCacheEntry* pPrev = pEntry->m_pPrev;
+        CFX_SizeGlyphCache* pSizeCache = pEntry->m_pSizeCache;
+        if (!pSizeCache->m_pFaceCache->IsInUse()) {
+            Remove(pEntry);
+            pSizeCache->Evict(pEntry);
+            m_nEvictions ++;
+        }
+        pEntry = pPrev;
+    }
+}
 #if defined(_FPDFAPI_MINI_)
 #define CONTRAST_RAMP_STEP	16
 #else
@@ -1568,6 +1699,7 @@ FX_BOOL OutputGlyph(void* dib, int x, int y, CFX_Font* pFont, double font_size,
 }
 const CFX_PathData* CFX_FaceCache::LoadGlyphPath(CFX_Font* pFont, FX_DWORD glyph_index, int dest_width)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     if (m_Face == NULL || glyph_index == (FX_DWORD) - 1) {
         return NULL;
     }
@@ -1691,6 +1823,7 @@ extern "C" {
 };
 CFX_PathData* CFX_Font::LoadGlyphPath(FX_DWORD glyph_index, int dest_width)
 {
+    CFX_CSLock lock(CFX_GEModule::Get()->GetFontLock());
     if (m_Face == NULL) {
         return NULL;
     }
@@ -1761,14 +1894,3 @@ CFX_PathData* CFX_Font::LoadGlyphPath(FX_DWORD glyph_index, int dest_width)
     FXFT_Set_Face_Internal_Flag(m_Face, transflag);
     return pPath;
 }
-void _CFX_UniqueKeyGen::Generate(int count, ...)
-{
-    va_list argList;
-    va_start(argList, count);
-    for (int i = 0; i < count; i ++) {
-        int p = va_arg(argList, int);
-        ((FX_DWORD*)m_Key)[i] = p;
-    }
-    va_end(argList);
-    m_KeyLen = count * sizeof(FX_DWORD);
-}
@@ -4,21 +4,60 @@
  
 // Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
 
-struct _CFX_UniqueKeyGen {
-    void		Generate(int count, ...);
-    FX_CHAR		m_Key[128];
-    int			m_KeyLen;
+#define FXGLYPHKEY_SUBST		1
+#define FXGLYPHKEY_VERTICAL		2
+#define FXGLYPHKEY_NATIVETEXT	4
+class CFX_GlyphCacheEntry : public CFX_Object
+{
+public:
+    CFX_GlyphBitmap*		m_pGlyph;
+    CFX_SizeGlyphCache*		m_pSizeCache;
+    FX_DWORD				m_GlyphIndex;
+    size_t					m_nBytes;
+    CFX_GlyphCacheEntry*	m_pPrev;
+    CFX_GlyphCacheEntry*	m_pNext;
 };
 class CFX_SizeGlyphCache : public CFX_Object
 {
 public:
-    CFX_SizeGlyphCache()
+    CFX_SizeGlyphCache(CFX_FaceCache* pFaceCache, const FX_GLYPHSIZE_KEY& key)
     {
+        m_pFaceCache = pFaceCache;
+        m_Key = key;
+        m_pNextSize = NULL;
         m_GlyphMap.InitHashTable(253);
     }
     ~CFX_SizeGlyphCache();
+    CFX_GlyphBitmap*		Lookup(FX_DWORD glyph_index);
+    void					Insert(FX_DWORD glyph_index, CFX_GlyphBitmap* pGlyph);
+    void					Evict(CFX_GlyphCacheEntry* pEntry);
+    CFX_FaceCache*			m_pFaceCache;
+    FX_GLYPHSIZE_KEY		m_Key;
+    // Next size cache of the same face whose key has the same hash.
+    CFX_SizeGlyphCache*		m_pNextSize;
     CFX_MapPtrToPtr			m_GlyphMap;
 };
+// Least-recently-used list of every glyph bitmap held by the face caches, shared by all
+// CFX_FontCache instances and owned by CFX_GEModule. Glyphs of a face cache that is in use
+// (between GetCachedFace and ReleaseCachedFace) are never evicted, because callers hold
+// raw pointers to them. All methods must be called with the font lock held.
+class CFX_GlyphLRUList : public CFX_Object
+{
+public:
+    CFX_GlyphLRUList();
+    void					Add(CFX_GlyphCacheEntry* pEntry);
+    void					Touch(CFX_GlyphCacheEntry* pEntry);
+    void					Remove(CFX_GlyphCacheEntry* pEntry);
+    void					Shrink();
+    CFX_GlyphCacheEntry*	m_pHead;
+    CFX_GlyphCacheEntry*	m_pTail;
+    size_t					m_nLimit;
+    size_t					m_nBytes;
+    FX_DWORD				m_nGlyphs;
+    FX_DWORD				m_nHits;
+    FX_DWORD				m_nMisses;
+    FX_DWORD				m_nEvictions;
+};
 class CTTFontDesc : public CFX_Object
 {
 public:
@@ -82,6 +121,13 @@ public:
     FX_DWORD			m_FileSize;
     CFX_ByteString		m_FontTables;
 };
+class CFontIndexEntry : public CFX_Object
+{
+public:
+    FX_DWORD			m_FileSize;
+    FX_DWORD			m_ModTime;
+    CFX_ByteString		m_Faces;
+};
 class CFontFileFaceInfo : public CFX_Object
 {
 public:
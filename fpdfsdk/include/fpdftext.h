@@ -27,6 +27,22 @@ extern "C" {
 //	
 DLLEXPORT FPDF_TEXTPAGE	STDCALL FPDFText_LoadPage(FPDF_PAGE page);
 
+// Function: FPDFText_LoadPageTextOnly
+//			Prepare information about all characters in a page, without loading the page for rendering.
+// Parameters: 
+//			document	-	Handle to document. Returned by FPDF_LoadDocument function.
+//			page_index	-	Index number of the page. 0 for the first page.
+// Return value:
+//			A handle to the text page information structure.
+//			NULL if something goes wrong.
+// Comments:
+//			The page content is parsed in text only mode: paths, images and shadings are skipped, and only
+//			the text, font and matrix state is tracked. This is much faster than FPDF_LoadPage followed by
+//			FPDFText_LoadPage when only the text is needed.
+//			Application must call FPDFText_ClosePage to release the text page information.
+//
+DLLEXPORT FPDF_TEXTPAGE	STDCALL FPDFText_LoadPageTextOnly(FPDF_DOCUMENT document, int page_index);
+
 // Function: FPDFText_ClosePage
 //			Release all resources allocated for a text page information structure.
 // Parameters: 
@@ -232,6 +248,104 @@ DLLEXPORT int STDCALL FPDFText_GetSchCount(FPDF_SCHHANDLE handle);
 //
 DLLEXPORT void STDCALL FPDFText_FindClose(FPDF_SCHHANDLE handle);
 
+// Function: FPDFText_BuildDocIndex
+//			Extract the text of all pages in a document and build a search index over it.
+// Parameters:
+//			document	-	Handle to a document. Returned by FPDF_LoadDocument function.
+// Return Value:
+//			A handle to the document search index. NULL if something goes wrong.
+// Comments:
+//			Building the index loads and parses every page once. After that, FPDFText_DocIndexFindAll
+//			searches the whole document without loading any page. The index can be stored with
+//			FPDFText_SaveDocIndex and reopened with FPDFText_LoadDocIndex.
+//			FPDFText_CloseDocIndex must be called to release the handle.
+//
+DLLEXPORT FPDF_DOCSCHHANDLE STDCALL FPDFText_BuildDocIndex(FPDF_DOCUMENT document);
+
+// Function: FPDFText_LoadDocIndex
+//			Open a search index saved by FPDFText_SaveDocIndex.
+// Parameters:
+//			document	-	Handle to the document the index was built from.
+//			data		-	Pointer to the saved index data.
+//			size		-	Size of the data, in bytes.
+// Return Value:
+//			A handle to the document search index. NULL if the data is not a valid index, or if it
+//			was built from a different document (the file identifiers, or the file data
+//			of a document without identifiers, or the page count differ).
+//
+DLLEXPORT FPDF_DOCSCHHANDLE STDCALL FPDFText_LoadDocIndex(FPDF_DOCUMENT document, const void* data, unsigned long size);
+
+// Function: FPDFText_SaveDocIndex
+//			Serialize a document search index.
+// Parameters:
+//			handle		-	A document search index handle.
+//			buffer		-	A buffer receiving the index data. Can be NULL.
+//			buflen		-	Size of the buffer, in bytes.
+// Return Value:
+//			Size of the index data, in bytes. The data is copied only if buflen is at least that large.
+//
+DLLEXPORT unsigned long STDCALL FPDFText_SaveDocIndex(FPDF_DOCSCHHANDLE handle, void* buffer, unsigned long buflen);
+
+// Function: FPDFText_DocIndexFindAll
+//			Find all occurrences of a string in the indexed document.
+// Parameters:
+//			handle		-	A document search index handle.
+//			findwhat	-	A unicode match pattern. Runs of white space match any run of white space.
+//			flags		-	Option flags, as for FPDFText_FindStart.
+// Return Value:
+//			Number of matches, in page and character order. The matches replace those of the previous call.
+//
+DLLEXPORT int STDCALL FPDFText_DocIndexFindAll(FPDF_DOCSCHHANDLE handle, FPDF_WIDESTRING findwhat, unsigned long flags);
+
+// Function: FPDFText_DocIndexGetHit
+//			Get the location of a match found by FPDFText_DocIndexFindAll.
+// Parameters:
+//			handle		-	A document search index handle.
+//			hit_index	-	Zero-based index of the match.
+//			page_index	-	Receives the zero-based page index.
+//			start_index	-	Receives the index of the first matched character, as used by FPDFText_LoadPage.
+//			count		-	Receives the number of matched characters.
+// Return Value:
+//			TRUE if hit_index is valid.
+//
+DLLEXPORT FPDF_BOOL STDCALL FPDFText_DocIndexGetHit(FPDF_DOCSCHHANDLE handle, int hit_index, int* page_index,
+													int* start_index, int* count);
+
+// Function: FPDFText_DocIndexCountHitRects
+//			Count the rectangular areas covered by a match.
+// Parameters:
+//			handle		-	A document search index handle.
+//			hit_index	-	Zero-based index of the match.
+// Return Value:
+//			Number of rectangles, the same as FPDFText_CountRects returns for the matched characters.
+//
+DLLEXPORT int STDCALL FPDFText_DocIndexCountHitRects(FPDF_DOCSCHHANDLE handle, int hit_index);
+
+// Function: FPDFText_DocIndexGetHitRect
+//			Get a rectangle covered by a match, in page coordinates.
+// Parameters:
+//			handle		-	A document search index handle.
+//			hit_index	-	Zero-based index of the match.
+//			rect_index	-	Zero-based index of the rectangle.
+//			left		-	Pointer to a double value receiving the rectangle left boundary.
+//			top			-	Pointer to a double value receiving the rectangle top boundary.
+//			right		-	Pointer to a double value receiving the rectangle right boundary.
+//			bottom		-	Pointer to a double value receiving the rectangle bottom boundary.
+// Return Value:
+//			None.
+//
+DLLEXPORT void STDCALL FPDFText_DocIndexGetHitRect(FPDF_DOCSCHHANDLE handle, int hit_index, int rect_index,
+												   double* left, double* top, double* right, double* bottom);
+
+// Function: FPDFText_CloseDocIndex
+//			Release a document search index.
+// Parameters:
+//			handle		-	A document search index handle.
+// Return Value:
+//			None.
+//
+DLLEXPORT void STDCALL FPDFText_CloseDocIndex(FPDF_DOCSCHHANDLE handle);
+
 // Function: FPDFLink_LoadWebLinks
 //			Prepare information about weblinks in a page.
 // Parameters:
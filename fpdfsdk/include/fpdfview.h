@@ -137,6 +137,93 @@ DLLEXPORT void STDCALL FPDF_InitLibrary(void* hInstance);
 //			After this function called, you should not call any PDF processing functions.
 DLLEXPORT void STDCALL FPDF_DestroyLibrary();
 
+// Function: FPDF_SetThreadSafeMode
+//			Enable or disable the thread-safe mode of the library.
+// Parameters:
+//			enable		-	True to enable the thread-safe mode.
+// Return value:
+//			None.
+// Comments:
+//			This function must be called before FPDF_InitLibrary and must not be called again
+//			until FPDF_DestroyLibrary has been called.
+//			In thread-safe mode, different pages of the same document may be loaded, parsed
+//			and rendered on different threads at the same time. Each FPDF_PAGE, and each
+//			bitmap being rendered into, must only be used by one thread at a time, and a
+//			document must not be modified or closed while other threads are using it.
+//			Custom FPDF_FILEACCESS callbacks must be safe to call from several threads.
+DLLEXPORT void STDCALL FPDF_SetThreadSafeMode(FPDF_BOOL enable);
+
+// Function: FPDF_SetGlyphCacheLimit
+//			Set the memory budget of the glyph bitmap cache shared by all documents.
+// Parameters:
+//			max_bytes	-	Maximum number of bytes used by cached glyph bitmaps. 0 means no limit.
+// Return value:
+//			None.
+// Comments:
+//			By default the cache is unlimited. When a budget is set and exceeded, the least
+//			recently used glyphs of fonts that are not currently being drawn are released.
+//			This function must be called after FPDF_InitLibrary.
+DLLEXPORT void STDCALL FPDF_SetGlyphCacheLimit(unsigned long max_bytes);
+
+// Structure for glyph cache statistics.
+typedef struct _FPDF_GLYPHCACHE_STATS {
+	unsigned long hits;			// Number of glyph lookups served from the cache.
+	unsigned long misses;		// Number of glyphs that had to be rendered.
+	unsigned long evictions;	// Number of glyphs released to stay within the budget.
+	unsigned long glyphs;		// Number of glyphs currently cached.
+	unsigned long bytes;		// Number of bytes currently used by cached glyphs.
+	unsigned long limit;		// Current budget in bytes, 0 for no limit.
+} FPDF_GLYPHCACHE_STATS;
+
+// Function: FPDF_GetGlyphCacheStats
+//			Get the statistics of the glyph bitmap cache.
+// Parameters:
+//			stats		-	Pointer to a structure receiving the statistics.
+//			reset		-	True to reset the hit, miss and eviction counters afterwards.
+// Return value:
+//			None.
+DLLEXPORT void STDCALL FPDF_GetGlyphCacheStats(FPDF_GLYPHCACHE_STATS* stats, FPDF_BOOL reset);
+
+// Function: FPDF_SetImageStretchThreads
+//			Set the number of threads used to resample large images.
+// Parameters:
+//			thread_count	-	Number of threads. 1 (the default) resamples on the calling thread,
+//								0 uses one thread per processor.
+// Return value:
+//			None.
+// Comments:
+//			Only images resampled to at least one million intermediate pixels are split into
+//			bands; the output is identical to single-threaded resampling.
+//			This function must be called after FPDF_InitLibrary.
+DLLEXPORT void STDCALL FPDF_SetImageStretchThreads(int thread_count);
+
+// Function: FPDF_SetJpxDecodeThreads
+//			Set the number of threads used to decode JPEG2000 images.
+// Parameters:
+//			thread_count	-	Number of threads. 1 (the default) decodes on the calling thread,
+//								0 uses one thread per processor.
+// Return value:
+//			None.
+// Comments:
+//			Code-blocks and the inverse wavelet transform of large tiles are split between the
+//			threads; the decoded image is identical to single-threaded decoding.
+//			This function must be called after FPDF_InitLibrary.
+DLLEXPORT void STDCALL FPDF_SetJpxDecodeThreads(int thread_count);
+
+// Function: FPDF_SetSystemFontIndexFile
+//			Set the file used to cache the list of installed system fonts.
+// Parameters:
+//			file_path	-	Path of the index file, in local encoding. It is created if it does not
+//							exist. An empty string or NULL disables the index.
+// Return value:
+//			None.
+// Comments:
+//			Only used on platforms that enumerate font folders (Linux and similar). Font files whose
+//			size and modification time are unchanged are read from the index instead of being
+//			opened and parsed, and the index is rewritten when any font was added, changed or removed.
+//			This function must be called after FPDF_InitLibrary and before the first document is loaded.
+DLLEXPORT void STDCALL FPDF_SetSystemFontIndexFile(FPDF_STRING file_path);
+
 //Policy for accessing the local machine time.
 #define FPDF_POLICY_MACHINETIME_ACCESS	0
 
@@ -162,6 +249,28 @@ DLLEXPORT void	STDCALL FPDF_SetSandBoxPolicy(FPDF_DWORD policy, FPDF_BOOL enable
 DLLEXPORT FPDF_DOCUMENT	STDCALL FPDF_LoadDocument(FPDF_STRING file_path, 
 	FPDF_BYTESTRING password);
 
+// Flags for FPDF_LoadDocumentEx
+#define FPDF_LOADDOC_MEMORYMAPPED	0x01	// Map the file into memory instead of reading it through the file API.
+
+// Function: FPDF_LoadDocumentEx
+//			Open and load a PDF document, with extra loading options.
+// Parameters: 
+//			file_path	-	Path to the PDF file (including extension).
+//			password	-	A string used as the password for PDF file. 
+//							If no password needed, empty or NULL can be used.
+//			flags		-	0 for default loading, or FPDF_LOADDOC_MEMORYMAPPED.
+// Return value:
+//			A handle to the loaded document. If failed, NULL is returned.
+// Comments:
+//			With FPDF_LOADDOC_MEMORYMAPPED the file is mapped read-only on platforms
+//			that support it, and parsing reads directly from the mapping. If the file
+//			can't be mapped, it is read the same way as FPDF_LoadDocument.
+//			The file must not be modified while the document is open.
+//			Loaded document can be closed by FPDF_CloseDocument.
+//
+DLLEXPORT FPDF_DOCUMENT	STDCALL FPDF_LoadDocumentEx(FPDF_STRING file_path, 
+	FPDF_BYTESTRING password, int flags);
+
 // Function: FPDF_LoadMemDocument
 //			Open and load a PDF document from memory.
 // Parameters: 
@@ -359,6 +468,54 @@ DLLEXPORT void STDCALL FPDF_RenderPage(HDC dc, FPDF_PAGE page, int start_x, int
 DLLEXPORT void STDCALL FPDF_RenderPageBitmap(FPDF_BITMAP bitmap, FPDF_PAGE page, int start_x, int start_y, 
 						int size_x, int size_y, int rotate, int flags);
 
+// Function: FPDF_RenderPageBitmapTiled
+//			Render contents in a page to a device independent bitmap, splitting the output into tiles
+//			that are rendered in parallel.
+// Parameters: 
+//			bitmap		-	Handle to the device independent bitmap (as the output buffer).
+//							Bitmap handle can be created by FPDFBitmap_Create function.
+//			page		-	Handle to the page. Returned by FPDF_LoadPage function.
+//			start_x		-	Left pixel position of the display area in the bitmap coordinate.
+//			start_y		-	Top pixel position of the display area in the bitmap coordinate.
+//			size_x		-	Horizontal size (in pixels) for displaying the page.
+//			size_y		-	Vertical size (in pixels) for displaying the page.
+//			rotate		-	Page orientation: 0 (normal), 1 (rotated 90 degrees clockwise),
+//								2 (rotated 180 degrees), 3 (rotated 90 degrees counter-clockwise).
+//			flags		-	0 for normal display, or combination of flags defined above.
+//			thread_count -	Number of threads rendering the tiles, including the calling thread.
+//							0 to use one thread per processor.
+// Return value:
+//			None.
+// Comments:
+//			The output is the same as FPDF_RenderPageBitmap. Tiles are rendered on several threads only
+//			when the thread-safe mode is enabled (see FPDF_SetThreadSafeMode), otherwise they are all
+//			rendered on the calling thread. The page must not be used by other threads meanwhile.
+//
+DLLEXPORT void STDCALL FPDF_RenderPageBitmapTiled(FPDF_BITMAP bitmap, FPDF_PAGE page, int start_x, int start_y, 
+						int size_x, int size_y, int rotate, int flags, int thread_count);
+
+// Function: FPDF_SetPageImageCache
+//			Enable or disable the persistent cache of rendered page images used by FPDF_RenderPageBitmap.
+// Parameters: 
+//			cache_dir	-	Path of an existing local directory holding the cache files, or NULL to
+//							disable the cache.
+//			max_bytes	-	Maximum total size of the cache files in bytes, 0 for no limit.
+// Return value:
+//			TRUE if successful, FALSE if the directory can't be opened.
+// Comments:
+//			The cache is disabled by default. When enabled, FPDF_RenderPageBitmap looks up a digest
+//			of the page contents, resources and annotations, the document's optional content and
+//			encryption settings, the size, rotation and flags, the bitmap format and the color the
+//			page area is filled with, and only renders the page when no cached image is found. A
+//			cached image is copied into the bitmap as the direct render left it.
+//			The cache is bypassed when the page area does not lie entirely inside the bitmap, when
+//			it is not filled with a single color, or when FPDF_REVERSE_BYTE_ORDER is used.
+//			Pages edited through the FPDFPage and FPDFPageObj functions are digested again.
+//			The directory may be shared by several processes. Least recently used images are
+//			removed when the size limit is exceeded.
+//			This function must not be called while other threads are rendering.
+DLLEXPORT FPDF_BOOL STDCALL FPDF_SetPageImageCache(FPDF_BYTESTRING cache_dir, unsigned long max_bytes);
+
 // Function: FPDF_ClosePage
 //			Close a loaded PDF page.
 // Parameters: 
@@ -340,6 +340,7 @@ DLLEXPORT int STDCALL FPDFPage_Flatten( FPDF_PAGE page, int nFlag)
 	{
 		return FLATTEN_FAIL;
 	}
+	IPDF_PageImageCache::InvalidatePage(pPage);
 
 	CPDF_ObjectArray ObjectArray;
 	CPDF_RectArray  RectArray;
@@ -20,6 +20,7 @@ DLLEXPORT void STDCALL FPDFPage_SetMediaBox(FPDF_PAGE page, float left, float bo
 	pMediaBoxArray->Add(FX_NEW CPDF_Number(FX_FLOAT(top)));
 	
 	pPageDict->SetAt("MediaBox", pMediaBoxArray);
+	IPDF_PageImageCache::InvalidatePage(pPage);
 }
 
 
@@ -37,6 +38,7 @@ DLLEXPORT void STDCALL FPDFPage_SetCropBox(FPDF_PAGE page, float left, float bot
 	
 	
 	pPageDict->SetAt("CropBox", pCropBoxArray);
+	IPDF_PageImageCache::InvalidatePage(pPage);
 }
 
 
@@ -95,6 +97,7 @@ DLLEXPORT FPDF_BOOL STDCALL FPDFPage_TransFormWithClip(FPDF_PAGE page, FS_MATRIX
 	
 
 	CPDF_Page* pPage = (CPDF_Page*)page;
+	IPDF_PageImageCache::InvalidatePage(pPage);
 	CPDF_Dictionary* pPageDic = pPage->m_pFormDict;
 	CPDF_Object* pContentObj = pPageDic->GetElement("Contents");
 	if(!pContentObj)
@@ -197,6 +200,7 @@ DLLEXPORT void STDCALL FPDFPageObj_TransformClipPath(FPDF_PAGEOBJECT page_object
 	if(pPageObj->m_Type != PDFPAGE_SHADING)
 		pPageObj->TransformClipPath(matrix);
 	pPageObj->TransformGeneralState(matrix);
+	pPageObj->OnMoved();
 }
 
 
@@ -259,6 +263,7 @@ DLLEXPORT void STDCALL FPDFPage_InsertClipPath(FPDF_PAGE page,FPDF_CLIPPATH clip
 	if(!page)
 		return;
 	CPDF_Page* pPage = (CPDF_Page*)page;
+	IPDF_PageImageCache::InvalidatePage(pPage);
 	CPDF_Dictionary* pPageDic = pPage->m_pFormDict;
 	CPDF_Object* pContentObj = pPageDic->GetElement("Contents");
 	if(!pContentObj)
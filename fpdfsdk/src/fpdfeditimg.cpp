@@ -31,6 +31,7 @@ DLLEXPORT FPDF_BOOL STDCALL FPDFImageObj_LoadJpegFile(FPDF_PAGE* pages, int nCou
 	{
 		CPDF_Page* pPage = (CPDF_Page*)pages[index]; 
 		pImgObj->m_pImage->ResetCache(pPage,NULL);
+		IPDF_PageImageCache::InvalidatePage(pPage);
 	}
 	pImgObj->m_pImage->SetJpegImage(pFile);
 
@@ -51,6 +52,7 @@ DLLEXPORT FPDF_BOOL STDCALL FPDFImageObj_SetMatrix	(FPDF_PAGEOBJECT image_object
 	pImgObj->m_Matrix.e = (FX_FLOAT)e;
 	pImgObj->m_Matrix.f = (FX_FLOAT)f;
 	pImgObj->CalcBoundingBox();
+	pImgObj->OnMoved();
 	return  TRUE;
 }
 
@@ -66,6 +68,7 @@ DLLEXPORT FPDF_BOOL STDCALL FPDFImageObj_SetBitmap(FPDF_PAGE* pages,int nCount,F
 	{
 		CPDF_Page* pPage = (CPDF_Page*)pages[index]; 
 		pImgObj->m_pImage->ResetCache(pPage,NULL);
+		IPDF_PageImageCache::InvalidatePage(pPage);
 	}
 	pImgObj->m_pImage->SetImage(pBmp,FALSE);
 	pImgObj->CalcBoundingBox();
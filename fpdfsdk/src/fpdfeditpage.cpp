@@ -155,6 +155,7 @@ DLLEXPORT void STDCALL FPDFPage_InsertObject(FPDF_PAGE page, FPDF_PAGEOBJECT pag
 	FX_POSITION LastPersition = pPage->GetLastObjectPosition();
 
 	pPage->InsertObject(LastPersition, pPageObj);
+	IPDF_PageImageCache::InvalidatePage(pPage);
 	switch(pPageObj->m_Type)
 	{
 	case FPDF_PAGEOBJ_PATH:
@@ -268,8 +269,10 @@ DLLEXPORT FPDF_BOOL STDCALL FPDFPage_GenerateContent(FPDF_PAGE page)
 	{
 		return FALSE;
 	}
+	pPage->BuildObjectGrid();
 	CPDF_PageContentGenerate CG(pPage);
 	CG.GenerateContent();
+	IPDF_PageImageCache::InvalidatePage(pPage);
 
 	return TRUE;
 }
@@ -312,5 +315,6 @@ DLLEXPORT void STDCALL FPDFPage_TransformAnnots(FPDF_PAGE page,
 		//To Do
 
 	}
+	IPDF_PageImageCache::InvalidatePage(pPage);
 
 }
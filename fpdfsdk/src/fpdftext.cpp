@@ -6,6 +6,7 @@
 
 #include "../include/fsdk_define.h"
 #include "../include/fpdftext.h"
+#include "../../core/include/fdrm/fx_crypt.h"
 
 #ifdef _WIN32
 #include <tchar.h>
@@ -32,6 +33,28 @@ DLLEXPORT FPDF_TEXTPAGE STDCALL FPDFText_LoadPage(FPDF_PAGE page)
 	}
 	return textpage;
 }
+DLLEXPORT FPDF_TEXTPAGE STDCALL FPDFText_LoadPageTextOnly(FPDF_DOCUMENT document, int page_index)
+{
+	if (!document) return NULL;
+	CPDF_Document* pDoc = (CPDF_Document*)document;
+	if (page_index < 0 || page_index >= pDoc->GetPageCount()) return NULL;
+	CPDF_Dictionary* pDict = pDoc->GetPage(page_index);
+	if (pDict == NULL) return NULL;
+	IPDF_TextPage* textpage=NULL;
+	try
+	{
+		CPDF_ViewerPreferences viewRef(pDoc);
+		textpage=IPDF_TextPage::CreateTextOnlyPage(pDoc,pDict,viewRef.IsDirectionR2L());
+		textpage->ParseTextPage();
+	}
+	catch (...)
+	{
+		if (textpage)
+			delete textpage;
+		return NULL;
+	}
+	return textpage;
+}
 DLLEXPORT void STDCALL FPDFText_ClosePage(FPDF_TEXTPAGE text_page)
 {
 	if (text_page){
@@ -204,6 +227,158 @@ DLLEXPORT void STDCALL FPDFText_FindClose(FPDF_SCHHANDLE handle)
 	handle=NULL;
 }
 
+class CPDF_DocTextIndex : public CFX_Object
+{
+public:
+	CPDF_DocTextIndex(IPDF_TextIndex* pIndex) : m_pIndex(pIndex), m_RectHit(-1) {}
+	~CPDF_DocTextIndex() { delete m_pIndex; }
+
+	const CFX_RectArray& GetHitRects(int hit_index)
+	{
+		if (hit_index != m_RectHit) {
+			m_Rects.RemoveAll();
+			m_RectHit = hit_index;
+			if (hit_index >= 0 && hit_index < m_Hits.GetSize())
+				m_pIndex->GetHitRects(m_Hits[hit_index], m_Rects);
+		}
+		return m_Rects;
+	}
+
+	IPDF_TextIndex*			m_pIndex;
+	CFX_TextIndexHitArray	m_Hits;
+	int						m_RectHit;
+	CFX_RectArray			m_Rects;
+};
+static CFX_ByteString _GetDocIndexKey(CPDF_Document* pDoc)
+{
+	CFX_ByteString key;
+	key.Format("%d:", pDoc->GetPageCount());
+	CPDF_Parser* pParser = (CPDF_Parser*)pDoc->GetParser();
+	CPDF_Array* pID = pParser ? pParser->GetIDArray() : NULL;
+	if (pID) {
+		key += pID->GetString(0);
+		key += pID->GetString(1);
+		return key;
+	}
+	// Without file identifiers, only the file contents tell documents apart.
+	IFX_FileRead* pFile = pParser ? pParser->GetFileAccess() : NULL;
+	if (pFile == NULL) {
+		return key;
+	}
+	FX_BYTE md5[100], digest[16], buffer[4096];
+	CRYPT_MD5Start(md5);
+	FX_FILESIZE size = pFile->GetSize();
+	for (FX_FILESIZE offset = 0; offset < size; offset += sizeof(buffer)) {
+		size_t read_size = (size_t)FX_MIN((FX_FILESIZE)sizeof(buffer), size - offset);
+		if (!pFile->ReadBlock(buffer, offset, read_size)) {
+			break;
+		}
+		CRYPT_MD5Update(md5, buffer, (FX_DWORD)read_size);
+	}
+	CRYPT_MD5Finish(md5, digest);
+	key += "md5:";
+	key += CFX_ByteStringC(digest, 16);
+	return key;
+}
+DLLEXPORT FPDF_DOCSCHHANDLE STDCALL FPDFText_BuildDocIndex(FPDF_DOCUMENT document)
+{
+	if (!document) return NULL;
+	CPDF_Document* pDoc = (CPDF_Document*)document;
+	IPDF_TextIndex* pIndex = IPDF_TextIndex::CreateTextIndex();
+	if (!pIndex) return NULL;
+	pIndex->SetDocumentKey(_GetDocIndexKey(pDoc));
+	CPDF_ViewerPreferences viewRef(pDoc);
+	int nPages = pDoc->GetPageCount();
+	for (int i = 0; i < nPages; i ++) {
+		CPDF_Dictionary* pDict = pDoc->GetPage(i);
+		if (pDict == NULL) continue;
+		IPDF_TextPage* textpage = NULL;
+		try
+		{
+			textpage = IPDF_TextPage::CreateTextOnlyPage(pDoc, pDict, viewRef.IsDirectionR2L());
+			textpage->ParseTextPage();
+			pIndex->AddPage(i, textpage);
+		}
+		catch (...)
+		{
+		}
+		if (textpage)
+			delete textpage;
+	}
+	pIndex->FinishIndex();
+	return FX_NEW CPDF_DocTextIndex(pIndex);
+}
+DLLEXPORT FPDF_DOCSCHHANDLE STDCALL FPDFText_LoadDocIndex(FPDF_DOCUMENT document, const void* data, unsigned long size)
+{
+	if (!document || !data) return NULL;
+	IPDF_TextIndex* pIndex = IPDF_TextIndex::CreateTextIndex();
+	if (!pIndex) return NULL;
+	if (!pIndex->Load((FX_LPCBYTE)data, size) || pIndex->GetDocumentKey() != _GetDocIndexKey((CPDF_Document*)document)) {
+		delete pIndex;
+		return NULL;
+	}
+	return FX_NEW CPDF_DocTextIndex(pIndex);
+}
+DLLEXPORT unsigned long STDCALL FPDFText_SaveDocIndex(FPDF_DOCSCHHANDLE handle, void* buffer, unsigned long buflen)
+{
+	if (!handle) return 0;
+	CPDF_DocTextIndex* pDocIndex = (CPDF_DocTextIndex*)handle;
+	CFX_ArchiveSaver saver;
+	pDocIndex->m_pIndex->Save(saver);
+	unsigned long size = (unsigned long)saver.GetLength();
+	if (buffer && buflen >= size)
+		FXSYS_memcpy(buffer, saver.GetBuffer(), size);
+	return size;
+}
+DLLEXPORT int STDCALL FPDFText_DocIndexFindAll(FPDF_DOCSCHHANDLE handle, FPDF_WIDESTRING findwhat, unsigned long flags)
+{
+	if (!handle) return 0;
+	CPDF_DocTextIndex* pDocIndex = (CPDF_DocTextIndex*)handle;
+	pDocIndex->m_RectHit = -1;
+	if (!findwhat) {
+		pDocIndex->m_Hits.RemoveAll();
+		return 0;
+	}
+	return pDocIndex->m_pIndex->FindAll(CFX_WideString::FromUTF16LE(findwhat), flags, pDocIndex->m_Hits);
+}
+DLLEXPORT FPDF_BOOL STDCALL FPDFText_DocIndexGetHit(FPDF_DOCSCHHANDLE handle, int hit_index, int* page_index,
+													int* start_index, int* count)
+{
+	if (!handle) return FALSE;
+	CPDF_DocTextIndex* pDocIndex = (CPDF_DocTextIndex*)handle;
+	if (hit_index < 0 || hit_index >= pDocIndex->m_Hits.GetSize()) return FALSE;
+	const FPDF_TEXTINDEX_HIT& hit = pDocIndex->m_Hits[hit_index];
+	if (page_index) *page_index = hit.m_PageIndex;
+	if (start_index) *start_index = hit.m_CharIndex;
+	if (count) *count = hit.m_CharCount;
+	return TRUE;
+}
+DLLEXPORT int STDCALL FPDFText_DocIndexCountHitRects(FPDF_DOCSCHHANDLE handle, int hit_index)
+{
+	if (!handle) return 0;
+	CPDF_DocTextIndex* pDocIndex = (CPDF_DocTextIndex*)handle;
+	return pDocIndex->GetHitRects(hit_index).GetSize();
+}
+DLLEXPORT void STDCALL FPDFText_DocIndexGetHitRect(FPDF_DOCSCHHANDLE handle, int hit_index, int rect_index,
+												   double* left, double* top, double* right, double* bottom)
+{
+	if (!handle) return;
+	CPDF_DocTextIndex* pDocIndex = (CPDF_DocTextIndex*)handle;
+	const CFX_RectArray& rects = pDocIndex->GetHitRects(hit_index);
+	if (rect_index < 0 || rect_index >= rects.GetSize()) return;
+	CFX_FloatRect rect = rects.GetAt(rect_index);
+	*left = rect.left;
+	*right = rect.right;
+	*top = rect.top;
+	*bottom = rect.bottom;
+}
+DLLEXPORT void STDCALL FPDFText_CloseDocIndex(FPDF_DOCSCHHANDLE handle)
+{
+	if (!handle) return;
+	CPDF_DocTextIndex* pDocIndex = (CPDF_DocTextIndex*)handle;
+	delete pDocIndex;
+}
+
 //web link
 DLLEXPORT FPDF_PAGELINK STDCALL FPDFLink_LoadWebLinks(FPDF_TEXTPAGE text_page)
 {
@@ -215,6 +215,7 @@ DLLEXPORT void STDCALL FPDF_DestroyLibrary()
 #if _FX_OS_ == _FX_LINUX_EMBEDDED_
 	if (g_pFontMapper) delete g_pFontMapper;
 #endif
+	FPDF_SetPageImageCache(NULL, 0);
 #ifdef API5
 	g_pModuleMgr->Destroy();
 #else
@@ -267,12 +268,62 @@ DLLEXPORT void	STDCALL FPDF_SetSandBoxPolicy(FPDF_DWORD policy, FPDF_BOOL enable
 	return FSDK_SetSandBoxPolicy(policy, enable);
 }
 
+DLLEXPORT void STDCALL FPDF_SetThreadSafeMode(FPDF_BOOL enable)
+{
+	FX_SetThreadSafeMode(enable);
+}
+
+DLLEXPORT void STDCALL FPDF_SetGlyphCacheLimit(unsigned long max_bytes)
+{
+	CFX_GEModule::Get()->SetGlyphCacheLimit(max_bytes);
+}
+
+DLLEXPORT void STDCALL FPDF_GetGlyphCacheStats(FPDF_GLYPHCACHE_STATS* stats, FPDF_BOOL reset)
+{
+	if (stats == NULL) return;
+	FX_GLYPHCACHE_STATS cache_stats;
+	CFX_GEModule::Get()->GetGlyphCacheStats(cache_stats);
+	stats->hits = cache_stats.m_nHits;
+	stats->misses = cache_stats.m_nMisses;
+	stats->evictions = cache_stats.m_nEvictions;
+	stats->glyphs = cache_stats.m_nGlyphs;
+	stats->bytes = (unsigned long)cache_stats.m_nBytes;
+	stats->limit = (unsigned long)cache_stats.m_nLimit;
+	if (reset) CFX_GEModule::Get()->ResetGlyphCacheStats();
+}
+
+DLLEXPORT void STDCALL FPDF_SetImageStretchThreads(int thread_count)
+{
+	CFX_GEModule::Get()->SetStretchThreadCount(thread_count);
+}
+
+DLLEXPORT void STDCALL FPDF_SetJpxDecodeThreads(int thread_count)
+{
+	CPDF_ModuleMgr::Get()->GetCodecModule()->SetJpxDecodeThreadCount(thread_count);
+}
+
+DLLEXPORT void STDCALL FPDF_SetSystemFontIndexFile(FPDF_STRING file_path)
+{
+	CFX_GEModule::Get()->SetFontIndexFile(file_path ? file_path : "");
+}
+
 DLLEXPORT FPDF_DOCUMENT STDCALL FPDF_LoadDocument(FPDF_STRING file_path, FPDF_BYTESTRING password)
+{
+	return FPDF_LoadDocumentEx(file_path, password, 0);
+}
+
+DLLEXPORT FPDF_DOCUMENT STDCALL FPDF_LoadDocumentEx(FPDF_STRING file_path, FPDF_BYTESTRING password, int flags)
 {
 	CPDF_Parser* pParser = FX_NEW CPDF_Parser;
 	pParser->SetPassword(password);
 	try {
-		FX_DWORD err_code = pParser->StartParse((FX_LPCSTR)file_path);
+		FX_DWORD err_code;
+		if (flags & FPDF_LOADDOC_MEMORYMAPPED) {
+			IFX_FileRead* pFileAccess = FX_CreateFileStream((FX_LPCSTR)file_path, FX_FILEMODE_ReadOnly | FX_FILEMODE_MemoryMapped);
+			err_code = pFileAccess ? pParser->StartParse(pFileAccess) : PDFPARSE_ERROR_FILE;
+		} else {
+			err_code = pParser->StartParse((FX_LPCSTR)file_path);
+		}
 		if (err_code) {
 			delete pParser;
 			ProcessParseError(err_code);
@@ -602,29 +653,41 @@ DLLEXPORT void STDCALL FPDF_RenderPage(HDC dc, FPDF_PAGE page, int start_x, int
 }
 #endif
 
-DLLEXPORT void STDCALL FPDF_RenderPageBitmap(FPDF_BITMAP bitmap, FPDF_PAGE page, int start_x, int start_y, 
+static IPDF_PageImageCache* g_pPageImageCache = NULL;
+
+DLLEXPORT FPDF_BOOL STDCALL FPDF_SetPageImageCache(FPDF_BYTESTRING cache_dir, unsigned long max_bytes)
+{
+	if (g_pPageImageCache) {
+		delete g_pPageImageCache;
+		g_pPageImageCache = NULL;
+	}
+	if (cache_dir == NULL) return TRUE;
+	g_pPageImageCache = IPDF_PageImageCache::Create(cache_dir);
+	if (g_pPageImageCache == NULL) return FALSE;
+	g_pPageImageCache->SetCacheLimit(max_bytes > 0xffffffff ? 0xffffffff : (FX_DWORD)max_bytes);
+	return TRUE;
+}
+
+static void RenderPageBitmapDirect(CFX_DIBitmap* pBitmap, FPDF_PAGE page, int start_x, int start_y,
 						int size_x, int size_y, int rotate, int flags)
 {
-	if (bitmap == NULL || page == NULL) return;
 	CPDF_Page* pPage = (CPDF_Page*)page;
-
-
 	CRenderContext* pContext = FX_NEW CRenderContext;
 	pPage->SetPrivateData((void*)1, pContext, DropContext);
 #ifdef _SKIA_SUPPORT_
 	pContext->m_pDevice = FX_NEW CFX_SkiaDevice;
 
 	if (flags & FPDF_REVERSE_BYTE_ORDER)
-		((CFX_SkiaDevice*)pContext->m_pDevice)->Attach((CFX_DIBitmap*)bitmap,0,TRUE);
+		((CFX_SkiaDevice*)pContext->m_pDevice)->Attach(pBitmap,0,TRUE);
 	else
-		((CFX_SkiaDevice*)pContext->m_pDevice)->Attach((CFX_DIBitmap*)bitmap);
+		((CFX_SkiaDevice*)pContext->m_pDevice)->Attach(pBitmap);
 #else
 	pContext->m_pDevice = FX_NEW CFX_FxgeDevice;
 
 	if (flags & FPDF_REVERSE_BYTE_ORDER)
-		((CFX_FxgeDevice*)pContext->m_pDevice)->Attach((CFX_DIBitmap*)bitmap,0,TRUE);
+		((CFX_FxgeDevice*)pContext->m_pDevice)->Attach(pBitmap,0,TRUE);
 	else
-		((CFX_FxgeDevice*)pContext->m_pDevice)->Attach((CFX_DIBitmap*)bitmap);
+		((CFX_FxgeDevice*)pContext->m_pDevice)->Attach(pBitmap);
 #endif
 	if (flags & FPDF_NO_CATCH)
 		Func_RenderPage(pContext, page, start_x, start_y, size_x, size_y, rotate, flags,TRUE,NULL);
@@ -639,6 +702,47 @@ DLLEXPORT void STDCALL FPDF_RenderPageBitmap(FPDF_BITMAP bitmap, FPDF_PAGE page,
 	pPage->RemovePrivateData((void*)1);
 }
 
+// A cache hit copies the pixels a direct render produced earlier onto the same uniform backdrop, so
+// blend modes and knockout groups come out exactly as without the cache. On a miss the page is
+// rendered directly into the bitmap and the resulting area is stored.
+static FX_BOOL RenderPageBitmapCached(CFX_DIBitmap* pDest, FPDF_PAGE page, int start_x, int start_y,
+						int size_x, int size_y, int rotate, int flags)
+{
+	if (g_pPageImageCache == NULL || (flags & FPDF_REVERSE_BYTE_ORDER)) return FALSE;
+	FX_RECT rect(start_x, start_y, start_x + size_x, start_y + size_y);
+	FX_DWORD backdrop;
+	if (!IPDF_PageImageCache::GetUniformBackdrop(pDest, rect, backdrop)) return FALSE;
+	CPDF_Page* pPage = (CPDF_Page*)page;
+	CFX_ByteString key;
+	if (!g_pPageImageCache->GetPageKey(pPage, size_x, size_y, rotate, flags, pDest->GetFormat(), backdrop, key))
+		return FALSE;
+	CFX_DIBitmap* pImage = g_pPageImageCache->LoadPageImage(key);
+	if (pImage && pImage->GetWidth() == size_x && pImage->GetHeight() == size_y && pImage->GetFormat() == pDest->GetFormat()) {
+		pDest->TransferBitmap(start_x, start_y, size_x, size_y, pImage, 0, 0);
+		delete pImage;
+		return TRUE;
+	}
+	if (pImage) delete pImage;
+	RenderPageBitmapDirect(pDest, page, start_x, start_y, size_x, size_y, rotate, flags);
+	pImage = pDest->Clone(&rect);
+	if (pImage) {
+		g_pPageImageCache->StorePageImage(key, pImage);
+		delete pImage;
+	}
+	return TRUE;
+}
+
+DLLEXPORT void STDCALL FPDF_RenderPageBitmap(FPDF_BITMAP bitmap, FPDF_PAGE page, int start_x, int start_y, 
+						int size_x, int size_y, int rotate, int flags)
+{
+	if (bitmap == NULL || page == NULL) return;
+
+	if (RenderPageBitmapCached((CFX_DIBitmap*)bitmap, page, start_x, start_y, size_x, size_y, rotate, flags))
+		return;
+
+	RenderPageBitmapDirect((CFX_DIBitmap*)bitmap, page, start_x, start_y, size_x, size_y, rotate, flags);
+}
+
 DLLEXPORT void STDCALL FPDF_ClosePage(FPDF_PAGE page)
 {
 	if (!page) return;
@@ -776,38 +880,43 @@ DLLEXPORT void STDCALL FPDFBitmap_Destroy(FPDF_BITMAP bitmap)
 	delete (CFX_DIBitmap*)bitmap;
 }
 
-void FPDF_RenderPage_Retail(CRenderContext* pContext, FPDF_PAGE page, int start_x, int start_y, int size_x, int size_y,
-						int rotate, int flags,FX_BOOL bNeedToRestore, IFSDK_PAUSE_Adapter * pause )
+static void FPDF_SetRenderOptions(CPDF_RenderOptions* pOptions, CPDF_Page* pPage, int flags)
 {
-//#ifdef _LICENSED_BUILD_
-	CPDF_Page* pPage = (CPDF_Page*)page;
-	if (pPage == NULL) return;
-
-	if (!pContext->m_pOptions)
-		pContext->m_pOptions = new CPDF_RenderOptions;
-//	CPDF_RenderOptions options;
 	if (flags & FPDF_LCD_TEXT)
-		pContext->m_pOptions->m_Flags |= RENDER_CLEARTYPE;
+		pOptions->m_Flags |= RENDER_CLEARTYPE;
 	else
-		pContext->m_pOptions->m_Flags &= ~RENDER_CLEARTYPE;
+		pOptions->m_Flags &= ~RENDER_CLEARTYPE;
 	if (flags & FPDF_NO_NATIVETEXT)
-		pContext->m_pOptions->m_Flags |= RENDER_NO_NATIVETEXT;
+		pOptions->m_Flags |= RENDER_NO_NATIVETEXT;
 	if (flags & FPDF_RENDER_LIMITEDIMAGECACHE)
-		pContext->m_pOptions->m_Flags |= RENDER_LIMITEDIMAGECACHE;
+		pOptions->m_Flags |= RENDER_LIMITEDIMAGECACHE;
 	if (flags & FPDF_RENDER_FORCEHALFTONE)
-		pContext->m_pOptions->m_Flags |= RENDER_FORCE_HALFTONE;
+		pOptions->m_Flags |= RENDER_FORCE_HALFTONE;
 	//Grayscale output
 	if (flags & FPDF_GRAYSCALE)
 	{
-		pContext->m_pOptions->m_ColorMode = RENDER_COLOR_GRAY;
-		pContext->m_pOptions->m_ForeColor = 0;
-		pContext->m_pOptions->m_BackColor = 0xffffff;
+		pOptions->m_ColorMode = RENDER_COLOR_GRAY;
+		pOptions->m_ForeColor = 0;
+		pOptions->m_BackColor = 0xffffff;
 	}
 	const CPDF_OCContext::UsageType usage = (flags & FPDF_PRINTING) ? CPDF_OCContext::Print : CPDF_OCContext::View;
 
-	pContext->m_pOptions->m_AddFlags = flags >> 8;
+	pOptions->m_AddFlags = flags >> 8;
+
+	pOptions->m_pOCContext = new CPDF_OCContext(pPage->m_pDocument, usage);
+}
 
-	pContext->m_pOptions->m_pOCContext = new CPDF_OCContext(pPage->m_pDocument, usage);
+void FPDF_RenderPage_Retail(CRenderContext* pContext, FPDF_PAGE page, int start_x, int start_y, int size_x, int size_y,
+						int rotate, int flags,FX_BOOL bNeedToRestore, IFSDK_PAUSE_Adapter * pause )
+{
+//#ifdef _LICENSED_BUILD_
+	CPDF_Page* pPage = (CPDF_Page*)page;
+	if (pPage == NULL) return;
+
+	if (!pContext->m_pOptions)
+		pContext->m_pOptions = new CPDF_RenderOptions;
+//	CPDF_RenderOptions options;
+	FPDF_SetRenderOptions(pContext->m_pOptions, pPage, flags);
 
 
 	CFX_AffineMatrix matrix;
@@ -841,6 +950,118 @@ void FPDF_RenderPage_Retail(CRenderContext* pContext, FPDF_PAGE page, int start_
 //#endif
 }
 
+#define FPDF_RENDER_TILE_SIZE	512
+
+struct FPDF_TILEDRENDER {
+	CFX_DIBitmap*		m_pBitmap;
+	CPDF_Page*			m_pPage;
+	CPDF_AnnotList*		m_pAnnots;
+	CFX_AffineMatrix	m_Matrix;
+	FX_RECT				m_ClipRect;
+	int					m_nTilesX;
+	int					m_nTiles;
+	int					m_Flags;
+	long volatile		m_NextTile;
+};
+
+// Worker of FPDF_RenderPageBitmapTiled. Takes tiles until none is left; every tile is rendered
+// with the full page matrix and only clipped to the tile, so the output matches a single render.
+// Workers share the page read-only: its content is fully parsed (with the object grid built)
+// before they start, fonts lock their lazily loaded metrics, and image caches are per worker.
+static void FPDF_RenderTiles(FX_LPVOID param)
+{
+	FPDF_TILEDRENDER* pJob = (FPDF_TILEDRENDER*)param;
+	CPDF_RenderOptions options;
+	FPDF_SetRenderOptions(&options, pJob->m_pPage, pJob->m_Flags);
+	// The page's own image cache is not thread-safe, each worker keeps a private one.
+	CPDF_PageRenderCache cache(pJob->m_pPage);
+	while (1) {
+		int index = FX_AtomicIncrement(&pJob->m_NextTile) - 1;
+		if (index >= pJob->m_nTiles) break;
+		FX_RECT tile;
+		tile.left = pJob->m_ClipRect.left + index % pJob->m_nTilesX * FPDF_RENDER_TILE_SIZE;
+		tile.top = pJob->m_ClipRect.top + index / pJob->m_nTilesX * FPDF_RENDER_TILE_SIZE;
+		tile.right = tile.left + FPDF_RENDER_TILE_SIZE;
+		tile.bottom = tile.top + FPDF_RENDER_TILE_SIZE;
+		tile.Intersect(pJob->m_ClipRect);
+#ifdef _SKIA_SUPPORT_
+		CFX_SkiaDevice device;
+#else
+		CFX_FxgeDevice device;
+#endif
+		device.Attach(pJob->m_pBitmap, 0, (pJob->m_Flags & FPDF_REVERSE_BYTE_ORDER) != 0);
+		device.SetClip_Rect(&tile);
+		CPDF_RenderContext context;
+		context.Create(pJob->m_pPage->m_pDocument, &cache, pJob->m_pPage->m_pPageResources);
+		context.AppendObjectList(pJob->m_pPage, &pJob->m_Matrix);
+		if (pJob->m_pAnnots)
+			pJob->m_pAnnots->DisplayAnnots(pJob->m_pPage, &context, FALSE, &pJob->m_Matrix, TRUE, NULL);
+		if (pJob->m_Flags & FPDF_NO_CATCH)
+			context.Render(&device, &options);
+		else {
+			try {
+				context.Render(&device, &options);
+			} catch (...) {
+			}
+		}
+	}
+	delete options.m_pOCContext;
+}
+
+DLLEXPORT void STDCALL FPDF_RenderPageBitmapTiled(FPDF_BITMAP bitmap, FPDF_PAGE page, int start_x, int start_y, 
+						int size_x, int size_y, int rotate, int flags, int thread_count)
+{
+	if (bitmap == NULL || page == NULL) return;
+	CPDF_Page* pPage = (CPDF_Page*)page;
+	CFX_DIBitmap* pBitmap = (CFX_DIBitmap*)bitmap;
+
+	FPDF_TILEDRENDER job;
+	job.m_pBitmap = pBitmap;
+	job.m_pPage = pPage;
+	job.m_pAnnots = NULL;
+	job.m_Flags = flags;
+	job.m_NextTile = 0;
+	pPage->GetDisplayMatrix(job.m_Matrix, start_x, start_y, size_x, size_y, rotate);
+	job.m_ClipRect = FX_RECT(start_x, start_y, start_x + size_x, start_y + size_y);
+	job.m_ClipRect.Intersect(FX_RECT(0, 0, pBitmap->GetWidth(), pBitmap->GetHeight()));
+	if (job.m_ClipRect.IsEmpty()) return;
+	job.m_nTilesX = (job.m_ClipRect.Width() + FPDF_RENDER_TILE_SIZE - 1) / FPDF_RENDER_TILE_SIZE;
+	job.m_nTiles = job.m_nTilesX * ((job.m_ClipRect.Height() + FPDF_RENDER_TILE_SIZE - 1) / FPDF_RENDER_TILE_SIZE);
+
+	if (pPage->GetParseState() == PDF_CONTENT_PARSING)
+		pPage->ContinueParse(NULL);
+	else if (!pPage->IsParsed())
+		pPage->ParseContent();
+
+	if (flags & FPDF_ANNOT) {
+		// Load the annotation appearances up front, the workers only read them.
+		job.m_pAnnots = FX_NEW CPDF_AnnotList(pPage);
+		CPDF_RenderContext context;
+		context.Create(pPage);
+		job.m_pAnnots->DisplayAnnots(pPage, &context, FALSE, &job.m_Matrix, TRUE, NULL);
+	}
+
+	if (!FX_IsThreadSafeMode())
+		thread_count = 1;
+	else if (thread_count <= 0)
+		thread_count = FX_Thread_GetProcessorCount();
+	if (thread_count > job.m_nTiles)
+		thread_count = job.m_nTiles;
+	FX_LPVOID* pThreads = NULL;
+	if (thread_count > 1) {
+		pThreads = FX_Alloc(FX_LPVOID, thread_count - 1);
+		for (int i = 0; i < thread_count - 1; i ++)
+			pThreads[i] = FX_Thread_Create(FPDF_RenderTiles, &job);
+	}
+	FPDF_RenderTiles(&job);
+	if (pThreads) {
+		for (int i = 0; i < thread_count - 1; i ++)
+			FX_Thread_Join(pThreads[i]);
+		FX_Free(pThreads);
+	}
+	if (job.m_pAnnots) delete job.m_pAnnots;
+}
+
 DLLEXPORT int STDCALL FPDF_GetPageSizeByIndex(FPDF_DOCUMENT document, int page_index, double* width, double* height)
 {
 	CPDF_Document* pDoc = (CPDF_Document*)document;
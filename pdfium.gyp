@@ -279,6 +279,7 @@
         'core/src/fpdfapi/fpdf_render/fpdf_render_cache.cpp',
         'core/src/fpdfapi/fpdf_render/fpdf_render_image.cpp',
         'core/src/fpdfapi/fpdf_render/fpdf_render_loadimage.cpp',
+        'core/src/fpdfapi/fpdf_render/fpdf_render_pagecache.cpp',
         'core/src/fpdfapi/fpdf_render/fpdf_render_pattern.cpp',
         'core/src/fpdfapi/fpdf_render/fpdf_render_text.cpp',
         'core/src/fpdfapi/fpdf_render/render_int.h',
@@ -292,6 +293,7 @@
         'core/include/fpdftext/fpdf_text.h',
         'core/src/fpdftext/fpdf_text.cpp',
         'core/src/fpdftext/fpdf_text_int.cpp',
+        'core/src/fpdftext/fpdf_text_index.cpp',
         'core/src/fpdftext/fpdf_text_search.cpp',
         'core/src/fpdftext/text_int.h',
         'core/src/fpdftext/txtproc.h',
@@ -480,6 +482,7 @@
         'core/include/fxcrt/fx_stream.h',
         'core/include/fxcrt/fx_string.h',
         'core/include/fxcrt/fx_system.h',
+        'core/include/fxcrt/fx_thread.h',
         'core/include/fxcrt/fx_ucd.h',
         'core/include/fxcrt/fx_xml.h',
         'core/src/fxcrt/extension.h',
@@ -505,6 +508,7 @@
         'core/src/fxcrt/fx_basic_util.cpp',
         'core/src/fxcrt/fx_basic_wstring.cpp',
         'core/src/fxcrt/fx_extension.cpp',
+        'core/src/fxcrt/fx_thread.cpp',
         'core/src/fxcrt/fx_ucddata.cpp',
         'core/src/fxcrt/fx_unicode.cpp',
         'core/src/fxcrt/fx_xml_composer.cpp',
@@ -559,6 +563,7 @@
         'core/src/fxge/apple/fx_quartz_device.cpp',
         'core/src/fxge/dib/dib_int.h',
         'core/src/fxge/dib/fx_dib_composite.cpp',
+        'core/src/fxge/dib/fx_dib_composite_sse2.cpp',
         'core/src/fxge/dib/fx_dib_convert.cpp',
         'core/src/fxge/dib/fx_dib_engine.cpp',
         'core/src/fxge/dib/fx_dib_main.cpp',